@@ -166,7 +166,8 @@ extern "C"
     {
       GASPI_MEM_UNINITIALIZED = 0, /* Memory will not be initialized */
       GASPI_MEM_INITIALIZED = 1,	 /* Memory will be initialized (zero-ed) */
-      GASPI_MEM_GPU = 2
+      GASPI_MEM_GPU = 2,
+      GASPI_MEM_NOTIFY_SUMMARY = 4	 /* Keep a summary of the active notifications */
     };
 
 #define GASPI_ALLOC_DEFAULT GASPI_MEM_UNINITIALIZED
@@ -182,6 +183,46 @@ extern "C"
       GASPI_TOPOLOGY_DYNAMIC = 2  /* Dynamically connect peers (as needed) */
     } gaspi_topology_t;
 
+  /**
+   * Waiting policy (for gaspi_wait and the notification waits).
+   *
+   */
+  typedef enum
+    {
+      GASPI_WAIT_SPIN = 0,	/* Busy wait until done or timeout */
+      GASPI_WAIT_ADAPTIVE = 1	/* Spin, then yield the CPU, then block */
+    } gaspi_wait_policy_t;
+
+  /**
+   * What a post to a full queue does.
+   *
+   */
+  typedef enum
+    {
+      GASPI_QUEUE_FULL_ERROR = 0, /* Fail with GASPI_ERR_MANY_Q_REQS */
+      GASPI_QUEUE_FULL_REAP = 1	  /* Wait for as many requests of the queue as needed */
+    } gaspi_queue_full_policy_t;
+
+  /**
+   * How a write with notification carries the notification.
+   *
+   * Fused, gaspi_write_notify and gaspi_write_list_notify post one
+   * request less (two with a summary flag). On IB the notification is
+   * the immediate of the write, for values up to 2047 (larger ones
+   * are written after the data). A thread of the receiving rank sets
+   * it as it arrives, whatever the rank is doing, and the notification
+   * waits and gaspi_notify_reset apply those already received: no wait
+   * is needed before a reset or a read of the notification space. A
+   * notification that failed to arrive makes the next notification
+   * wait return GASPI_ERROR. All ranks must use the same mode.
+   *
+   */
+  typedef enum
+    {
+      GASPI_NOTIFY_SEPARATE = 0, /* A write of the notification after the data */
+      GASPI_NOTIFY_FUSED = 1	 /* One request with the data (write with immediate on IB) */
+    } gaspi_notify_mode_t;
+
   /**
    * A structure with configuration.
    *
@@ -207,6 +248,11 @@ extern "C"
     gaspi_size_t allreduce_buf_size;
     gaspi_number_t allreduce_elem_max;
     gaspi_topology_t build_infrastructure;
+    gaspi_wait_policy_t wait_policy; /* how to wait for completions and notifications */
+    gaspi_uint wait_spin_us;	     /* adaptive: usecs to spin before yielding */
+    gaspi_queue_full_policy_t queue_full_policy; /* posting to a full queue */
+    gaspi_uint netdev_num;   /* the number of rails (ports/links) the queues take round-robin */
+    gaspi_notify_mode_t notify_mode; /* how write_notify carries the notification */
 
   } gaspi_config_t;
 
@@ -680,6 +726,9 @@ extern "C"
 
   /** All Reduce collective operation.
    *
+   * Element counts above gaspi_allreduce_elem_max are reduced with a
+   * bandwidth optimized algorithm (reduce-scatter followed by an
+   * allgather) and are limited only by the size of the buffers.
    *
    * @param buffer_send The buffer with data for the operation.
    * @param buffer_receive The buffer to receive the result of the operation.
@@ -700,6 +749,26 @@ extern "C"
 				  const gaspi_group_t group,
 				  const gaspi_timeout_t timeout_ms);
 
+  /** All Reduce collective operation with a user defined reduction.
+   *
+   * Like gaspi_allreduce, larger messages (more elements or bytes than
+   * gaspi_allreduce_elem_max and gaspi_allreduce_buf_size) are reduced
+   * with the bandwidth optimized algorithm, which calls the reduction
+   * on blocks of whole elements. The element size is limited to 32 KiB
+   * there.
+   *
+   * @param buffer_send The buffer with data for the operation.
+   * @param buffer_receive The buffer to receive the result of the operation.
+   * @param num The number of data elements in the buffer.
+   * @param element_size The size in bytes of one element.
+   * @param reduce_operation The reduction applied element-wise.
+   * @param reduce_state The state passed to the reduction.
+   * @param group The group involved in the operation.
+   * @param timeout_ms Timeout in milliseconds (or GASPI_BLOCK/GASPI_TEST).
+   *
+   * @return GASPI_SUCCESS in case of success, GASPI_ERROR in case of
+   * error, GASPI_TIMEOUT in case of timeout.
+   */
   gaspi_return_t gaspi_allreduce_user (const gaspi_pointer_t buffer_send,
 				       gaspi_pointer_t const buffer_receive,
 				       const gaspi_number_t num,
@@ -972,7 +1041,8 @@ extern "C"
    *
    * @param queue The queue ID to delete.
    *
-   * @return GASPI_SUCCESS in case of success, GASPI_ERROR in case of error.
+   * @return GASPI_SUCCESS in case of success, GASPI_ERROR in case of error,
+   * GASPI_ERR_INV_QUEUE if endpoints still use the queue.
    */
   gaspi_return_t gaspi_queue_delete(const gaspi_queue_id_t queue);
 
@@ -1022,6 +1092,8 @@ extern "C"
 
   /** Get the internal buffer size for gaspi_allreduce_user.
    *
+   * Reductions of more bytes than the buffer holds are not refused:
+   * they take the bandwidth optimized algorithm instead.
    *
    * @param buf_size Output parameter with the buffer size.
    *
@@ -1029,10 +1101,13 @@ extern "C"
    */
   gaspi_return_t gaspi_allreduce_buf_size (gaspi_size_t * const buf_size);
 
-  /** Get the maximum number of elements allowed in gaspi_allreduce.
+  /** Get the number of elements up to which gaspi_allreduce and
+   * gaspi_allreduce_user take the latency optimized algorithm.
    *
+   * It is not a limit: more elements take the bandwidth optimized
+   * algorithm instead.
    *
-   * @param elem_max Output parameter with the maximum number of elements.
+   * @param elem_max Output parameter with the number of elements.
    *
    * @return GASPI_SUCCESS in case of success, GASPI_ERROR in case of error.
    */
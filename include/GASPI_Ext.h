@@ -164,6 +164,1025 @@ extern "C"
 				     const gaspi_rank_t rank,
 				     gaspi_size_t * const size);
 
+  /** Broadcast collective operation.
+   *
+   * The data of the root is sent to all ranks of the group along a
+   * binomial tree or, for large messages, along a pipelined chain.
+   * All ranks must pass the same size and root.
+   *
+   * @param buffer The buffer with the data (root) or to receive it.
+   * @param size The size of the data in bytes.
+   * @param root The rank holding the data.
+   * @param group The group involved in the operation.
+   * @param timeout_ms Timeout in milliseconds (or GASPI_BLOCK/GASPI_TEST).
+   *
+   * @return GASPI_SUCCESS in case of success, GASPI_ERROR in case of
+   * error, GASPI_TIMEOUT in case of timeout.
+   */
+  gaspi_return_t gaspi_bcast (gaspi_pointer_t const buffer,
+			      const gaspi_size_t size,
+			      const gaspi_rank_t root,
+			      const gaspi_group_t group,
+			      const gaspi_timeout_t timeout_ms);
+
+  /** Allgather collective operation.
+   *
+   * The blocks of all ranks of the group are gathered on every rank,
+   * in the order of the group ranks (see gaspi_group_ranks), starting
+   * at the given offset of the segment. Each rank provides its own
+   * block in place, at offset + i * size for the i-th rank of the
+   * group. The segment must be registered with all ranks of the
+   * group and the result is written directly into it.
+   *
+   * @param segment_id The segment holding the blocks.
+   * @param offset The offset of the first block.
+   * @param size The size of each block in bytes.
+   * @param group The group involved in the operation.
+   * @param timeout_ms Timeout in milliseconds (or GASPI_BLOCK/GASPI_TEST).
+   *
+   * @return GASPI_SUCCESS in case of success, GASPI_ERROR in case of
+   * error, GASPI_TIMEOUT in case of timeout.
+   */
+  gaspi_return_t gaspi_allgather (const gaspi_segment_id_t segment_id,
+				  const gaspi_offset_t offset,
+				  const gaspi_size_t size,
+				  const gaspi_group_t group,
+				  const gaspi_timeout_t timeout_ms);
+
+  /** Allgather collective operation with blocks of different sizes.
+   *
+   * As gaspi_allgather but the block of the i-th rank of the group
+   * has sizes[i] bytes. Blocks are packed, i.e. the i-th block starts
+   * at offset + sizes[0] + ... + sizes[i - 1].
+   *
+   * @param segment_id The segment holding the blocks.
+   * @param offset The offset of the first block.
+   * @param sizes The size of the block of each rank of the group.
+   * @param group The group involved in the operation.
+   * @param timeout_ms Timeout in milliseconds (or GASPI_BLOCK/GASPI_TEST).
+   *
+   * @return GASPI_SUCCESS in case of success, GASPI_ERROR in case of
+   * error, GASPI_TIMEOUT in case of timeout.
+   */
+  gaspi_return_t gaspi_allgatherv (const gaspi_segment_id_t segment_id,
+				   const gaspi_offset_t offset,
+				   const gaspi_size_t * const sizes,
+				   const gaspi_group_t group,
+				   const gaspi_timeout_t timeout_ms);
+
+  /** Alltoall collective operation.
+   *
+   * Every rank of the group sends a distinct block to every rank
+   * (including itself). The blocks to send are in the order of the
+   * group ranks (see gaspi_group_ranks), the i-th one at offset_send
+   * + i * size of segment_id_send. The block received from the i-th
+   * rank is stored at offset_recv + i * size of segment_id_recv. The
+   * send and receive areas must not overlap.
+   *
+   * The blocks of the ranks running on the same node are combined,
+   * such that only one message per pair of nodes crosses the network.
+   *
+   * @param segment_id_send The segment holding the blocks to send.
+   * @param offset_send The offset of the first block to send.
+   * @param segment_id_recv The segment receiving the blocks.
+   * @param offset_recv The offset of the first block received.
+   * @param size The size of each block in bytes.
+   * @param group The group involved in the operation.
+   * @param timeout_ms Timeout in milliseconds (or GASPI_BLOCK/GASPI_TEST).
+   *
+   * @return GASPI_SUCCESS in case of success, GASPI_ERROR in case of
+   * error, GASPI_TIMEOUT in case of timeout.
+   */
+  gaspi_return_t gaspi_alltoall (const gaspi_segment_id_t segment_id_send,
+				 const gaspi_offset_t offset_send,
+				 const gaspi_segment_id_t segment_id_recv,
+				 const gaspi_offset_t offset_recv,
+				 const gaspi_size_t size,
+				 const gaspi_group_t group,
+				 const gaspi_timeout_t timeout_ms);
+
+  /** Alltoall collective operation with blocks of different sizes.
+   *
+   * As gaspi_alltoall but the block for the i-th rank of the group
+   * has send_sizes[i] bytes and the one from the i-th rank has
+   * recv_sizes[i] bytes. Blocks are packed, i.e. the i-th block to
+   * send starts at offset_send + send_sizes[0] + ... +
+   * send_sizes[i - 1] and likewise for the blocks received. The
+   * recv_sizes[j] of rank i must match the send_sizes[i] of rank j.
+   *
+   * @param segment_id_send The segment holding the blocks to send.
+   * @param offset_send The offset of the first block to send.
+   * @param send_sizes The size of the block for each rank of the group.
+   * @param segment_id_recv The segment receiving the blocks.
+   * @param offset_recv The offset of the first block received.
+   * @param recv_sizes The size of the block from each rank of the group.
+   * @param group The group involved in the operation.
+   * @param timeout_ms Timeout in milliseconds (or GASPI_BLOCK/GASPI_TEST).
+   *
+   * @return GASPI_SUCCESS in case of success, GASPI_ERROR in case of
+   * error, GASPI_TIMEOUT in case of timeout.
+   */
+  gaspi_return_t gaspi_alltoallv (const gaspi_segment_id_t segment_id_send,
+				  const gaspi_offset_t offset_send,
+				  const gaspi_size_t * const send_sizes,
+				  const gaspi_segment_id_t segment_id_recv,
+				  const gaspi_offset_t offset_recv,
+				  const gaspi_size_t * const recv_sizes,
+				  const gaspi_group_t group,
+				  const gaspi_timeout_t timeout_ms);
+
+  /** Reduce collective operation.
+   *
+   * The data of all ranks of the group is reduced along a binomial
+   * tree to the root. As for gaspi_allreduce, the operation is
+   * taken to be associative and commutative. The element count is
+   * only limited by the size of the buffers.
+   *
+   * @param buffer_send The buffer with data for the operation.
+   * @param buffer_receive The buffer to receive the result (only
+   * used on the root).
+   * @param num The number of data elements in the buffer.
+   * @param operation The type of operations (see gaspi_operation_t).
+   * @param datatyp Type of data (see gaspi_datatype_t).
+   * @param root The rank receiving the result.
+   * @param group The group involved in the operation.
+   * @param timeout_ms Timeout in milliseconds (or GASPI_BLOCK/GASPI_TEST).
+   *
+   * @return GASPI_SUCCESS in case of success, GASPI_ERROR in case of
+   * error, GASPI_TIMEOUT in case of timeout.
+   */
+  gaspi_return_t gaspi_reduce (const gaspi_pointer_t buffer_send,
+			       gaspi_pointer_t const buffer_receive,
+			       const gaspi_number_t num,
+			       const gaspi_operation_t operation,
+			       const gaspi_datatype_t datatyp,
+			       const gaspi_rank_t root,
+			       const gaspi_group_t group,
+			       const gaspi_timeout_t timeout_ms);
+
+  /** Reduce collective operation with a user defined operation.
+   *
+   * @see gaspi_reduce and gaspi_allreduce_user.
+   */
+  gaspi_return_t gaspi_reduce_user (const gaspi_pointer_t buffer_send,
+				    gaspi_pointer_t const buffer_receive,
+				    const gaspi_number_t num,
+				    const gaspi_size_t element_size,
+				    gaspi_reduce_operation_t const reduce_operation,
+				    gaspi_state_t const reduce_state,
+				    const gaspi_rank_t root,
+				    const gaspi_group_t group,
+				    const gaspi_timeout_t timeout_ms);
+
+  /** Reduce-scatter collective operation with equal blocks.
+   *
+   * The send buffer holds one block of num elements for every rank of
+   * the group, in the order of the group ranks (see
+   * gaspi_group_ranks). The i-th rank receives the reduction of the
+   * i-th blocks of all ranks. Fails with GASPI_ERR_INV_NUM if the
+   * group is too large to split the internal buffers among it.
+   *
+   * @param buffer_send The buffer with the blocks for all ranks.
+   * @param buffer_receive The buffer to receive the reduced block.
+   * @param num The number of data elements in a block.
+   * @param operation The type of operations (see gaspi_operation_t).
+   * @param datatyp Type of data (see gaspi_datatype_t).
+   * @param group The group involved in the operation.
+   * @param timeout_ms Timeout in milliseconds (or GASPI_BLOCK/GASPI_TEST).
+   *
+   * @return GASPI_SUCCESS in case of success, GASPI_ERROR in case of
+   * error, GASPI_TIMEOUT in case of timeout.
+   */
+  gaspi_return_t gaspi_reduce_scatter_block (const gaspi_pointer_t buffer_send,
+					     gaspi_pointer_t const buffer_receive,
+					     const gaspi_number_t num,
+					     const gaspi_operation_t operation,
+					     const gaspi_datatype_t datatyp,
+					     const gaspi_group_t group,
+					     const gaspi_timeout_t timeout_ms);
+
+  /** Reduce-scatter collective operation with a user defined operation.
+   *
+   * @see gaspi_reduce_scatter_block and gaspi_allreduce_user.
+   */
+  gaspi_return_t gaspi_reduce_scatter_block_user (const gaspi_pointer_t buffer_send,
+						  gaspi_pointer_t const buffer_receive,
+						  const gaspi_number_t num,
+						  const gaspi_size_t element_size,
+						  gaspi_reduce_operation_t const reduce_operation,
+						  gaspi_state_t const reduce_state,
+						  const gaspi_group_t group,
+						  const gaspi_timeout_t timeout_ms);
+
+  /** Inclusive scan (prefix reduction) collective operation.
+   *
+   * The i-th rank of the group (see gaspi_group_ranks) receives the
+   * reduction of the data of the ranks 0 to i, computed in log2 steps
+   * of the group size.
+   *
+   * @param buffer_send The buffer with data for the operation.
+   * @param buffer_receive The buffer to receive the result (may be
+   * buffer_send).
+   * @param num The number of data elements in the buffer.
+   * @param operation The type of operations (see gaspi_operation_t).
+   * @param datatyp Type of data (see gaspi_datatype_t).
+   * @param group The group involved in the operation.
+   * @param timeout_ms Timeout in milliseconds (or GASPI_BLOCK/GASPI_TEST).
+   *
+   * @return GASPI_SUCCESS in case of success, GASPI_ERROR in case of
+   * error, GASPI_TIMEOUT in case of timeout.
+   */
+  gaspi_return_t gaspi_scan (const gaspi_pointer_t buffer_send,
+			     gaspi_pointer_t const buffer_receive,
+			     const gaspi_number_t num,
+			     const gaspi_operation_t operation,
+			     const gaspi_datatype_t datatyp,
+			     const gaspi_group_t group,
+			     const gaspi_timeout_t timeout_ms);
+
+  /** Inclusive scan with a user defined operation.
+   *
+   * @see gaspi_scan and gaspi_allreduce_user.
+   */
+  gaspi_return_t gaspi_scan_user (const gaspi_pointer_t buffer_send,
+				  gaspi_pointer_t const buffer_receive,
+				  const gaspi_number_t num,
+				  const gaspi_size_t element_size,
+				  gaspi_reduce_operation_t const reduce_operation,
+				  gaspi_state_t const reduce_state,
+				  const gaspi_group_t group,
+				  const gaspi_timeout_t timeout_ms);
+
+  /** Exclusive scan collective operation.
+   *
+   * As gaspi_scan but the i-th rank receives the reduction of the
+   * data of the ranks 0 to i - 1. The receive buffer of the first
+   * rank is left untouched.
+   *
+   * @param buffer_send The buffer with data for the operation.
+   * @param buffer_receive The buffer to receive the result (may be
+   * buffer_send).
+   * @param num The number of data elements in the buffer.
+   * @param operation The type of operations (see gaspi_operation_t).
+   * @param datatyp Type of data (see gaspi_datatype_t).
+   * @param group The group involved in the operation.
+   * @param timeout_ms Timeout in milliseconds (or GASPI_BLOCK/GASPI_TEST).
+   *
+   * @return GASPI_SUCCESS in case of success, GASPI_ERROR in case of
+   * error, GASPI_TIMEOUT in case of timeout.
+   */
+  gaspi_return_t gaspi_exscan (const gaspi_pointer_t buffer_send,
+			       gaspi_pointer_t const buffer_receive,
+			       const gaspi_number_t num,
+			       const gaspi_operation_t operation,
+			       const gaspi_datatype_t datatyp,
+			       const gaspi_group_t group,
+			       const gaspi_timeout_t timeout_ms);
+
+  /** Exclusive scan with a user defined operation.
+   *
+   * @see gaspi_exscan and gaspi_allreduce_user.
+   */
+  gaspi_return_t gaspi_exscan_user (const gaspi_pointer_t buffer_send,
+				    gaspi_pointer_t const buffer_receive,
+				    const gaspi_number_t num,
+				    const gaspi_size_t element_size,
+				    gaspi_reduce_operation_t const reduce_operation,
+				    gaspi_state_t const reduce_state,
+				    const gaspi_group_t group,
+				    const gaspi_timeout_t timeout_ms);
+
+  /** Allreduce collective operation on segments.
+   *
+   * As gaspi_allreduce, but the data is read from and the result
+   * written to segments, without staging copies and for any number
+   * of elements. The same segments and offsets must be used on all
+   * ranks of the group, the result segment must be registered with
+   * all of them and the input and the result must not overlap. Meant
+   * for vectors beyond a few hundred elements, below that
+   * gaspi_allreduce is faster.
+   *
+   * @param segment_id_send The segment with the data for the operation.
+   * @param offset_send The offset of the data.
+   * @param segment_id_recv The segment to receive the result.
+   * @param offset_recv The offset of the result.
+   * @param num The number of data elements.
+   * @param operation The type of operations (see gaspi_operation_t).
+   * @param datatyp Type of data (see gaspi_datatype_t).
+   * @param group The group involved in the operation.
+   * @param timeout_ms Timeout in milliseconds (or GASPI_BLOCK/GASPI_TEST).
+   *
+   * @return GASPI_SUCCESS in case of success, GASPI_ERROR in case of
+   * error, GASPI_TIMEOUT in case of timeout.
+   */
+  gaspi_return_t gaspi_allreduce_segment (const gaspi_segment_id_t segment_id_send,
+					  const gaspi_offset_t offset_send,
+					  const gaspi_segment_id_t segment_id_recv,
+					  const gaspi_offset_t offset_recv,
+					  const gaspi_number_t num,
+					  const gaspi_operation_t operation,
+					  const gaspi_datatype_t datatyp,
+					  const gaspi_group_t group,
+					  const gaspi_timeout_t timeout_ms);
+
+  /** Handle of a non-blocking collective operation. */
+  typedef struct gaspi_coll_request *gaspi_coll_request_t;
+
+  /** Non-blocking barrier.
+   *
+   * Starts a barrier of the group and returns. It is completed by
+   * gaspi_coll_test or gaspi_coll_wait. Up to 4 non-blocking
+   * collectives may be outstanding per group and all ranks must
+   * start them in the same order. They progress in gaspi_coll_test,
+   * gaspi_coll_wait, gaspi_wait and gaspi_notify_waitsome, but not
+   * in the blocking collectives.
+   *
+   * @param group The group involved in the operation.
+   * @param request Output parameter with the handle of the operation.
+   *
+   * @return GASPI_SUCCESS in case of success, GASPI_ERROR in case of
+   * error, GASPI_ERR_ACTIVE_COLL if too many non-blocking collectives
+   * of the group were not completed yet.
+   */
+  gaspi_return_t gaspi_ibarrier (const gaspi_group_t group,
+				 gaspi_coll_request_t * const request);
+
+  /** Non-blocking allreduce.
+   *
+   * As gaspi_allreduce (for up to gaspi_allreduce_elem_max elements),
+   * completed as gaspi_ibarrier. The buffers must not be touched
+   * until the operation completed.
+   *
+   * @param buffer_send The buffer with data for the operation.
+   * @param buffer_receive The buffer to receive the result.
+   * @param num The number of data elements in the buffer.
+   * @param operation The type of operations (see gaspi_operation_t).
+   * @param datatyp Type of data (see gaspi_datatype_t).
+   * @param group The group involved in the operation.
+   * @param request Output parameter with the handle of the operation.
+   *
+   * @return GASPI_SUCCESS in case of success, GASPI_ERROR in case of
+   * error, GASPI_ERR_ACTIVE_COLL if too many non-blocking collectives
+   * of the group were not completed yet.
+   */
+  gaspi_return_t gaspi_iallreduce (const gaspi_pointer_t buffer_send,
+				   gaspi_pointer_t const buffer_receive,
+				   const gaspi_number_t num,
+				   const gaspi_operation_t operation,
+				   const gaspi_datatype_t datatyp,
+				   const gaspi_group_t group,
+				   gaspi_coll_request_t * const request);
+
+  /** Non-blocking allreduce with a user defined operation.
+   *
+   * @see gaspi_iallreduce and gaspi_allreduce_user.
+   */
+  gaspi_return_t gaspi_iallreduce_user (const gaspi_pointer_t buffer_send,
+					gaspi_pointer_t const buffer_receive,
+					const gaspi_number_t num,
+					const gaspi_size_t element_size,
+					gaspi_reduce_operation_t const reduce_operation,
+					gaspi_state_t const reduce_state,
+					const gaspi_group_t group,
+					gaspi_coll_request_t * const request);
+
+  /** Wait for the completion of a non-blocking collective.
+   *
+   * On completion the request is released and set to NULL.
+   *
+   * @param request The handle of the operation.
+   * @param timeout_ms Timeout in milliseconds (or GASPI_BLOCK/GASPI_TEST).
+   *
+   * @return GASPI_SUCCESS in case of success, GASPI_ERROR in case of
+   * error, GASPI_TIMEOUT in case of timeout.
+   */
+  gaspi_return_t gaspi_coll_wait (gaspi_coll_request_t * const request,
+				  const gaspi_timeout_t timeout_ms);
+
+  /** Test for the completion of a non-blocking collective.
+   *
+   * Same as gaspi_coll_wait with GASPI_TEST, but returning whether
+   * the operation completed in flag.
+   *
+   * @param request The handle of the operation.
+   * @param flag Output parameter, 1 if the operation completed (and
+   * the request was released), 0 otherwise.
+   *
+   * @return GASPI_SUCCESS in case of success, GASPI_ERROR in case of
+   * error.
+   */
+  gaspi_return_t gaspi_coll_test (gaspi_coll_request_t * const request,
+				  gaspi_number_t * const flag);
+
+  /** Algorithms of gaspi_barrier and gaspi_allreduce. */
+  typedef enum
+  {
+    GASPI_COLL_ALG_AUTO = 0,		/**< decision table or built-in choice */
+    GASPI_BARRIER_DISSEMINATION = 1,	/**< dissemination among all ranks */
+    GASPI_BARRIER_NODE = 2,		/**< shared memory within the nodes, dissemination among them */
+    GASPI_ALLREDUCE_DOUBLING = 3,	/**< recursive doubling (latency bound) */
+    GASPI_ALLREDUCE_RSAG = 4		/**< reduce-scatter and allgather (bandwidth bound) */
+  } gaspi_coll_algorithm_t;
+
+  /** Select the algorithms of gaspi_barrier and gaspi_allreduce in a
+   * group.
+   *
+   * With GASPI_COLL_ALG_AUTO the algorithm is taken from the decision
+   * table in the file named by the environment variable
+   * GASPI_COLL_TUNING (as written by the coll_tune microbenchmark),
+   * loaded in gaspi_proc_init, or else chosen as by default.
+   * Recursive doubling is limited to gaspi_allreduce_elem_max
+   * elements and gaspi_allreduce_buf_size bytes, beyond that the
+   * reduce-scatter is used anyway. All members of the group must
+   * select the same algorithms (and load the same table) and no
+   * collective of the group may be in progress.
+   *
+   * @param group The group.
+   * @param barrier The barrier algorithm (GASPI_COLL_ALG_AUTO or GASPI_BARRIER_*).
+   * @param allreduce The allreduce algorithm (GASPI_COLL_ALG_AUTO or GASPI_ALLREDUCE_*).
+   *
+   * @return GASPI_SUCCESS in case of success, GASPI_ERROR in case of
+   * error.
+   */
+  gaspi_return_t gaspi_coll_algorithm_set (const gaspi_group_t group,
+					   const gaspi_coll_algorithm_t barrier,
+					   const gaspi_coll_algorithm_t allreduce);
+
+  /** Get the algorithms gaspi_barrier and gaspi_allreduce use in a
+   * group.
+   *
+   * @param group The group.
+   * @param num The number of data elements of the allreduce.
+   * @param datatyp Type of data (see gaspi_datatype_t).
+   * @param barrier Output parameter with the barrier algorithm.
+   * @param allreduce Output parameter with the allreduce algorithm
+   * for num elements of type datatyp.
+   *
+   * @return GASPI_SUCCESS in case of success, GASPI_ERROR in case of
+   * error.
+   */
+  gaspi_return_t gaspi_coll_algorithm_get (const gaspi_group_t group,
+					   const gaspi_number_t num,
+					   const gaspi_datatype_t datatyp,
+					   gaspi_coll_algorithm_t * const barrier,
+					   gaspi_coll_algorithm_t * const allreduce);
+
+  /** Wait for any notification of a segment.
+   *
+   * As gaspi_notify_waitsome over all notifications of the segment
+   * (0 up to GASPI_MAX_NOTIFICATION). Segments allocated with
+   * GASPI_MEM_NOTIFY_SUMMARY keep a summary of the blocks of
+   * notifications that were set, with which this call and
+   * gaspi_notify_waitsome look only at the active blocks instead of
+   * the whole range. On InfiniBand each notification into such a
+   * segment costs a second (small) request in its queue.
+   *
+   * @param segment_id_local The segment ID containing the notifications.
+   * @param first_id Output parameter with the ID of a set notification.
+   * @param timeout_ms Timeout in milliseconds (or GASPI_BLOCK/GASPI_TEST).
+   *
+   * @return GASPI_SUCCESS in case of success, GASPI_ERROR in case of
+   * error, GASPI_TIMEOUT in case of timeout.
+   */
+  gaspi_return_t gaspi_notify_waitany (const gaspi_segment_id_t segment_id_local,
+				       gaspi_notification_id_t * const first_id,
+				       const gaspi_timeout_t timeout_ms);
+
+  /** Wait for notifications and take all that are set at once.
+   *
+   * Waits as gaspi_notify_waitsome for a set notification of the
+   * range and then takes the set notifications of the range, from
+   * the first one on, up to max_ids of them: their IDs and values are
+   * returned and they are reset, each with an atomic exchange, in the
+   * same pass. Replaces a gaspi_notify_waitsome and gaspi_notify_reset
+   * per notification, which rescans the range from the beginning for
+   * each of them. The rest of the range is scanned after the first
+   * notification, in a segment with notification summary (see
+   * gaspi_notify_waitany) only its active blocks.
+   *
+   * @param segment_id_local The segment ID containing the notifications.
+   * @param notification_begin The notification ID to start to wait for.
+   * @param num The number of notifications to wait for.
+   * @param ids Output array (of max_ids entries) with the IDs of the
+   * notifications taken, in ascending order.
+   * @param values Output array (of max_ids entries) with their values
+   * (or NULL).
+   * @param max_ids The maximum number of notifications to take.
+   * @param count Output parameter with the number of notifications
+   * taken (at least one on success).
+   * @param timeout_ms Timeout in milliseconds (or GASPI_BLOCK/GASPI_TEST).
+   *
+   * @return GASPI_SUCCESS in case of success, GASPI_ERROR in case of
+   * error, GASPI_TIMEOUT in case of timeout.
+   */
+  gaspi_return_t gaspi_notify_waitsome_multi (const gaspi_segment_id_t segment_id_local,
+					      const gaspi_notification_id_t notification_begin,
+					      const gaspi_number_t num,
+					      gaspi_notification_id_t * const ids,
+					      gaspi_notification_t * const values,
+					      const gaspi_number_t max_ids,
+					      gaspi_number_t * const count,
+					      const gaspi_timeout_t timeout_ms);
+
+  /** Wait for some notification, serving the notifications in turn.
+   *
+   * As gaspi_notify_waitsome, but instead of the lowest set
+   * notification of the range it returns the first set one after the
+   * one it returned last (on the same segment, from the same thread),
+   * wrapping around at the end of the range. Under sustained load a
+   * set notification is thus returned within one round over the
+   * range, whereas gaspi_notify_waitsome keeps serving the low IDs.
+   *
+   * @param segment_id_local The segment ID containing the notifications.
+   * @param notification_begin The notification ID to start to wait for.
+   * @param num The number of notifications to wait for.
+   * @param first_id Output parameter with the ID of a set notification.
+   * @param timeout_ms Timeout in milliseconds (or GASPI_BLOCK/GASPI_TEST).
+   *
+   * @return GASPI_SUCCESS in case of success, GASPI_ERROR in case of
+   * error, GASPI_TIMEOUT in case of timeout.
+   */
+  gaspi_return_t gaspi_notify_waitsome_fair (const gaspi_segment_id_t segment_id_local,
+					     const gaspi_notification_id_t notification_begin,
+					     const gaspi_number_t num,
+					     gaspi_notification_id_t * const first_id,
+					     const gaspi_timeout_t timeout_ms);
+
+  /** Add to a notification of a remote segment.
+   *
+   * As gaspi_notify, but instead of overwriting the notification its
+   * value is atomically incremented by notification_value: several
+   * ranks may thus signal the same notification ID, and a consumer
+   * waits for all of them with gaspi_notify_wait_count instead of
+   * scanning one notification per producer.
+   *
+   * Only even notification IDs can be added to, and the odd ID after
+   * it is reserved: it must not be notified, reset or waited on. On
+   * InfiniBand the increment is an atomic fetch-and-add on the 8-byte
+   * word holding both, which is atomic only against other adds: the
+   * sum of the adds into a notification must stay below 2^32, and a
+   * gaspi_notify_reset of it must not race with adds still in flight.
+   *
+   * @param segment_id_remote The remote segment to notify.
+   * @param rank The rank to notify.
+   * @param notification_id The notification ID to add to (even).
+   * @param notification_value The value to add (must be > 0).
+   * @param queue The queue to use.
+   * @param timeout_ms Timeout in milliseconds (or GASPI_BLOCK/GASPI_TEST).
+   *
+   * @return GASPI_SUCCESS in case of success, GASPI_ERROR in case of
+   * error, GASPI_TIMEOUT in case of timeout.
+   */
+  gaspi_return_t gaspi_notify_add (const gaspi_segment_id_t segment_id_remote,
+				   const gaspi_rank_t rank,
+				   const gaspi_notification_id_t notification_id,
+				   const gaspi_notification_t notification_value,
+				   const gaspi_queue_id_t queue,
+				   const gaspi_timeout_t timeout_ms);
+
+  /** Write to a remote segment and add to a notification.
+   *
+   * As gaspi_write_notify, with the notification incremented as by
+   * gaspi_notify_add once the data is in place.
+   *
+   * @param segment_id_local The local segment ID to read from.
+   * @param offset_local The local offset to read from.
+   * @param rank The rank to write to.
+   * @param segment_id_remote The remote segment to write to.
+   * @param offset_remote The remote offset to write to.
+   * @param size The size of the data to write.
+   * @param notification_id The notification ID to add to (even).
+   * @param notification_value The value to add (must be > 0).
+   * @param queue The queue to use.
+   * @param timeout_ms Timeout in milliseconds (or GASPI_BLOCK/GASPI_TEST).
+   *
+   * @return GASPI_SUCCESS in case of success, GASPI_ERROR in case of
+   * error, GASPI_TIMEOUT in case of timeout.
+   */
+  gaspi_return_t gaspi_write_notify_add (const gaspi_segment_id_t segment_id_local,
+					 const gaspi_offset_t offset_local,
+					 const gaspi_rank_t rank,
+					 const gaspi_segment_id_t segment_id_remote,
+					 const gaspi_offset_t offset_remote,
+					 const gaspi_size_t size,
+					 const gaspi_notification_id_t notification_id,
+					 const gaspi_notification_t notification_value,
+					 const gaspi_queue_id_t queue,
+					 const gaspi_timeout_t timeout_ms);
+
+  /** Read from a remote segment and set a local notification.
+   *
+   * As gaspi_read, with the notification notification_id of the local
+   * segment set to 1 once all the data read is in place. The read can
+   * then be consumed with gaspi_notify_waitsome on its own, without
+   * waiting on the whole queue; the queue must still be waited on (or
+   * purged) to take the completion of the request.
+   *
+   * @param segment_id_local The local segment ID to read into.
+   * @param offset_local The local offset to read into.
+   * @param rank The rank to read from.
+   * @param segment_id_remote The remote segment to read from.
+   * @param offset_remote The remote offset to read from.
+   * @param size The size of the data to read.
+   * @param notification_id The local notification ID to set.
+   * @param queue The queue to use.
+   * @param timeout_ms Timeout in milliseconds (or GASPI_BLOCK/GASPI_TEST).
+   *
+   * @return GASPI_SUCCESS in case of success, GASPI_ERROR in case of
+   * error, GASPI_TIMEOUT in case of timeout.
+   */
+  gaspi_return_t gaspi_read_notify (const gaspi_segment_id_t segment_id_local,
+				    const gaspi_offset_t offset_local,
+				    const gaspi_rank_t rank,
+				    const gaspi_segment_id_t segment_id_remote,
+				    const gaspi_offset_t offset_remote,
+				    const gaspi_size_t size,
+				    const gaspi_notification_id_t notification_id,
+				    const gaspi_queue_id_t queue,
+				    const gaspi_timeout_t timeout_ms);
+
+  /** Read a list of remote regions and set a local notification.
+   *
+   * As gaspi_read_list, with the notification notification_id of the
+   * local segment segment_id_notification set to 1 once the data of
+   * all elements is in place.
+   *
+   * @param num The number of elements in the list.
+   * @param segment_id_local The local segments to read into.
+   * @param offset_local The local offsets to read into.
+   * @param rank The rank to read from.
+   * @param segment_id_remote The remote segments to read from.
+   * @param offset_remote The remote offsets to read from.
+   * @param size The sizes of the data to read.
+   * @param segment_id_notification The local segment of the notification.
+   * @param notification_id The local notification ID to set.
+   * @param queue The queue to use.
+   * @param timeout_ms Timeout in milliseconds (or GASPI_BLOCK/GASPI_TEST).
+   *
+   * @return GASPI_SUCCESS in case of success, GASPI_ERROR in case of
+   * error, GASPI_TIMEOUT in case of timeout.
+   */
+  gaspi_return_t gaspi_read_list_notify (const gaspi_number_t num,
+					 gaspi_segment_id_t * const segment_id_local,
+					 gaspi_offset_t * const offset_local,
+					 const gaspi_rank_t rank,
+					 gaspi_segment_id_t * const segment_id_remote,
+					 gaspi_offset_t * const offset_remote,
+					 gaspi_size_t * const size,
+					 const gaspi_segment_id_t segment_id_notification,
+					 const gaspi_notification_id_t notification_id,
+					 const gaspi_queue_id_t queue,
+					 const gaspi_timeout_t timeout_ms);
+
+  /** Wait until a notification reaches a count.
+   *
+   * Waits until the value of the notification is at least count, as
+   * accumulated by gaspi_notify_add and gaspi_write_notify_add. The
+   * notification is left as it is: reset it (gaspi_notify_reset) once
+   * all adds expected have arrived.
+   *
+   * @param segment_id_local The segment ID containing the notification.
+   * @param notification_id The notification ID to wait for.
+   * @param count The value to wait for (must be > 0).
+   * @param timeout_ms Timeout in milliseconds (or GASPI_BLOCK/GASPI_TEST).
+   *
+   * @return GASPI_SUCCESS in case of success, GASPI_ERROR in case of
+   * error, GASPI_TIMEOUT in case of timeout.
+   */
+  gaspi_return_t gaspi_notify_wait_count (const gaspi_segment_id_t segment_id_local,
+					  const gaspi_notification_id_t notification_id,
+					  const gaspi_notification_t count,
+					  const gaspi_timeout_t timeout_ms);
+
+  /** Select the least loaded queue of a set of queues.
+   *
+   * Picks the queue with the fewest requests among queue_first to
+   * queue_first + num - 1 and, if the requests to post do not fit
+   * into it, takes just as many of its completions as needed to make
+   * room (instead of waiting for the whole queue). With several
+   * threads posting to the set, the room is not reserved: configure
+   * queue_full_policy to GASPI_QUEUE_FULL_REAP to have the posts make
+   * room themselves.
+   *
+   * @param queue_first The first queue of the set.
+   * @param num The number of queues in the set.
+   * @param requests The number of requests to post.
+   * @param queue Output parameter with the selected queue.
+   * @param timeout_ms Timeout in milliseconds (or GASPI_BLOCK/GASPI_TEST).
+   *
+   * @return GASPI_SUCCESS in case of success, GASPI_ERROR in case of
+   * error, GASPI_TIMEOUT in case of timeout.
+   */
+  gaspi_return_t gaspi_queue_select (const gaspi_queue_id_t queue_first,
+				     const gaspi_number_t num,
+				     const gaspi_number_t requests,
+				     gaspi_queue_id_t * const queue,
+				     const gaspi_timeout_t timeout_ms);
+
+  /** Handle of a thread endpoint. */
+  typedef struct gaspi_endpoint *gaspi_endpoint_t;
+
+  /** Create a thread endpoint.
+   *
+   * An endpoint gives a thread a communication queue of its own: a
+   * queue created for endpoints and used by no other endpoint,
+   * created with gaspi_queue_create if none is left over from
+   * deleted endpoints. Once gaspi_queue_max queues exist, endpoints
+   * share the queues created for them (or, if there are none, all
+   * queues), each endpoint going to the queue used by the fewest
+   * endpoints. Communication is posted as always, to the queue of
+   * the endpoint (gaspi_endpoint_queue), and without taking a lock;
+   * segments and notifications are not affected. Create one
+   * endpoint per thread.
+   *
+   * @param endpoint Output parameter with the handle of the endpoint.
+   * @param timeout_ms Timeout in milliseconds (or GASPI_BLOCK/GASPI_TEST).
+   *
+   * @return GASPI_SUCCESS in case of success, GASPI_ERROR in case of
+   * error (or if GASPI_MAX_ENDPOINTS endpoints exist), GASPI_TIMEOUT
+   * in case of timeout.
+   */
+  gaspi_return_t gaspi_endpoint_create (gaspi_endpoint_t * const endpoint,
+					const gaspi_timeout_t timeout_ms);
+
+  /** Delete a thread endpoint.
+   *
+   * The queue of the endpoint is kept for the endpoints created
+   * later. Wait for the requests of the endpoint before deleting it.
+   *
+   * @param endpoint The endpoint to delete.
+   *
+   * @return GASPI_SUCCESS in case of success, GASPI_ERROR in case of
+   * error.
+   */
+  gaspi_return_t gaspi_endpoint_delete (gaspi_endpoint_t endpoint);
+
+  /** Get the queue of a thread endpoint.
+   *
+   * @param endpoint The endpoint.
+   * @param queue Output parameter with the queue to post to.
+   * @param shared Output parameter, 1 if the queue is used by other
+   * endpoints or is not one created for endpoints, 0 otherwise (may
+   * be NULL).
+   *
+   * @return GASPI_SUCCESS in case of success, GASPI_ERROR in case of
+   * error.
+   */
+  gaspi_return_t gaspi_endpoint_queue (const gaspi_endpoint_t endpoint,
+				       gaspi_queue_id_t * const queue,
+				       gaspi_number_t * const shared);
+
+  /** Wait for the requests posted through a thread endpoint.
+   *
+   * As gaspi_wait on the queue of the endpoint: when the queue is
+   * shared, the requests of the other endpoints are waited for too.
+   *
+   * @param endpoint The endpoint.
+   * @param timeout_ms Timeout in milliseconds (or GASPI_BLOCK/GASPI_TEST).
+   *
+   * @return GASPI_SUCCESS in case of success, GASPI_ERROR in case of
+   * error, GASPI_TIMEOUT in case of timeout.
+   */
+  gaspi_return_t gaspi_endpoint_wait (const gaspi_endpoint_t endpoint,
+				      const gaspi_timeout_t timeout_ms);
+
+  /** The maximum number of dimensions of a strided transfer. */
+#define GASPI_STRIDED_MAX_DIMS (3)
+
+  /** Write strided (non-contiguous) data to a remote segment.
+   *
+   * Transfers count[0] x ... x count[dims - 1] blocks of block_size
+   * bytes each, as a (dims + 1)-dimensional subarray: the blocks of
+   * dimension d start stride_local[d] bytes apart at the local side
+   * and stride_remote[d] bytes apart at the remote side (the layouts
+   * of both sides may differ, the blocks go in the same order). No
+   * packing is needed: dimensions contiguous on both sides are merged
+   * and the device moves the rest with as few requests as it can
+   * (one on the TCP device, one per contiguous remote run, gathering
+   * local blocks, on Infiniband). A transfer that may take more
+   * requests than the queue holds is posted in parts, each of the
+   * parts after the first taking completions of the queue to fit in
+   * (as with GASPI_QUEUE_FULL_REAP). If it then fails or times out,
+   * the parts already posted are in flight and must still be waited
+   * for on the queue.
+   *
+   * @param segment_id_local The local segment ID to read from.
+   * @param offset_local The local offset of the first block.
+   * @param stride_local The local stride in bytes of each dimension.
+   * @param rank The rank to write to.
+   * @param segment_id_remote The remote segment to write to.
+   * @param offset_remote The remote offset of the first block.
+   * @param stride_remote The remote stride in bytes of each dimension.
+   * @param block_size The size in bytes of a contiguous block.
+   * @param count The number of blocks of each dimension.
+   * @param dims The number of dimensions (up to GASPI_STRIDED_MAX_DIMS).
+   * @param queue The queue where to post the request.
+   * @param timeout_ms Timeout in milliseconds (or GASPI_BLOCK/GASPI_TEST).
+   *
+   * @return GASPI_SUCCESS in case of success, GASPI_ERROR in case of
+   * error, GASPI_TIMEOUT in case of timeout.
+   */
+  gaspi_return_t gaspi_write_strided (const gaspi_segment_id_t segment_id_local,
+				      const gaspi_offset_t offset_local,
+				      const gaspi_size_t * const stride_local,
+				      const gaspi_rank_t rank,
+				      const gaspi_segment_id_t segment_id_remote,
+				      const gaspi_offset_t offset_remote,
+				      const gaspi_size_t * const stride_remote,
+				      const gaspi_size_t block_size,
+				      const gaspi_number_t * const count,
+				      const gaspi_number_t dims,
+				      const gaspi_queue_id_t queue,
+				      const gaspi_timeout_t timeout_ms);
+
+  /** Read strided (non-contiguous) data from a remote segment.
+   *
+   * The counterpart of gaspi_write_strided: the blocks are read from
+   * the remote side into the local side.
+   *
+   * @param segment_id_local The local segment ID to write to.
+   * @param offset_local The local offset of the first block.
+   * @param stride_local The local stride in bytes of each dimension.
+   * @param rank The rank to read from.
+   * @param segment_id_remote The remote segment to read from.
+   * @param offset_remote The remote offset of the first block.
+   * @param stride_remote The remote stride in bytes of each dimension.
+   * @param block_size The size in bytes of a contiguous block.
+   * @param count The number of blocks of each dimension.
+   * @param dims The number of dimensions (up to GASPI_STRIDED_MAX_DIMS).
+   * @param queue The queue where to post the request.
+   * @param timeout_ms Timeout in milliseconds (or GASPI_BLOCK/GASPI_TEST).
+   *
+   * @return GASPI_SUCCESS in case of success, GASPI_ERROR in case of
+   * error, GASPI_TIMEOUT in case of timeout.
+   */
+  gaspi_return_t gaspi_read_strided (const gaspi_segment_id_t segment_id_local,
+				     const gaspi_offset_t offset_local,
+				     const gaspi_size_t * const stride_local,
+				     const gaspi_rank_t rank,
+				     const gaspi_segment_id_t segment_id_remote,
+				     const gaspi_offset_t offset_remote,
+				     const gaspi_size_t * const stride_remote,
+				     const gaspi_size_t block_size,
+				     const gaspi_number_t * const count,
+				     const gaspi_number_t dims,
+				     const gaspi_queue_id_t queue,
+				     const gaspi_timeout_t timeout_ms);
+
+  /** Write strided data to a remote segment followed by a notification.
+   *
+   * As gaspi_write_strided, then sets the notification in the remote
+   * segment once all the data is in place.
+   *
+   * @param segment_id_local The local segment ID to read from.
+   * @param offset_local The local offset of the first block.
+   * @param stride_local The local stride in bytes of each dimension.
+   * @param rank The rank to write to.
+   * @param segment_id_remote The remote segment to write to.
+   * @param offset_remote The remote offset of the first block.
+   * @param stride_remote The remote stride in bytes of each dimension.
+   * @param block_size The size in bytes of a contiguous block.
+   * @param count The number of blocks of each dimension.
+   * @param dims The number of dimensions (up to GASPI_STRIDED_MAX_DIMS).
+   * @param notification_id The notification ID to set.
+   * @param notification_value The notification value (not zero).
+   * @param queue The queue where to post the request.
+   * @param timeout_ms Timeout in milliseconds (or GASPI_BLOCK/GASPI_TEST).
+   *
+   * @return GASPI_SUCCESS in case of success, GASPI_ERROR in case of
+   * error, GASPI_TIMEOUT in case of timeout.
+   */
+  gaspi_return_t gaspi_write_strided_notify (const gaspi_segment_id_t segment_id_local,
+					     const gaspi_offset_t offset_local,
+					     const gaspi_size_t * const stride_local,
+					     const gaspi_rank_t rank,
+					     const gaspi_segment_id_t segment_id_remote,
+					     const gaspi_offset_t offset_remote,
+					     const gaspi_size_t * const stride_remote,
+					     const gaspi_size_t block_size,
+					     const gaspi_number_t * const count,
+					     const gaspi_number_t dims,
+					     const gaspi_notification_id_t notification_id,
+					     const gaspi_notification_t notification_value,
+					     const gaspi_queue_id_t queue,
+					     const gaspi_timeout_t timeout_ms);
+
+  /** Wait for a set of queues.
+   *
+   * Waits for all requests of queue_first to queue_first + num - 1,
+   * as gaspi_wait does for each, the timeout covering the whole set.
+   *
+   * @param queue_first The first queue of the set.
+   * @param num The number of queues in the set.
+   * @param timeout_ms Timeout in milliseconds (or GASPI_BLOCK/GASPI_TEST).
+   *
+   * @return GASPI_SUCCESS in case of success, GASPI_ERROR in case of
+   * error, GASPI_TIMEOUT in case of timeout.
+   */
+  gaspi_return_t gaspi_wait_queues (const gaspi_queue_id_t queue_first,
+				    const gaspi_number_t num,
+				    const gaspi_timeout_t timeout_ms);
+
+  /** Write data of any size to a remote segment, striped over a set
+   * of queues.
+   *
+   * The data is cut into stripes of at least 1 MiB, one per queue of
+   * queue_first to queue_first + num - 1, and each stripe into
+   * transfers of up to gaspi_transfer_size_max bytes, a request each.
+   * All queues are reserved first: if one of them is full (or the
+   * timeout expires), nothing is posted. On an error while posting,
+   * the stripes already posted are in flight: the set of queues must
+   * still be waited for. Wait for the write with gaspi_wait_queues. With several rails (netdev_num), consecutive
+   * queues take different rails, so the stripes use them all.
+   *
+   * @param segment_id_local The local segment ID to read from.
+   * @param offset_local The local offset to read from.
+   * @param rank The rank to write to.
+   * @param segment_id_remote The remote segment to write to.
+   * @param offset_remote The remote offset to write to.
+   * @param size The size of the data to write.
+   * @param queue_first The first queue of the set.
+   * @param num The number of queues in the set.
+   * @param timeout_ms Timeout in milliseconds (or GASPI_BLOCK/GASPI_TEST).
+   *
+   * @return GASPI_SUCCESS in case of success, GASPI_ERROR in case of
+   * error, GASPI_TIMEOUT in case of timeout.
+   */
+  gaspi_return_t gaspi_write_striped (const gaspi_segment_id_t segment_id_local,
+				      const gaspi_offset_t offset_local,
+				      const gaspi_rank_t rank,
+				      const gaspi_segment_id_t segment_id_remote,
+				      const gaspi_offset_t offset_remote,
+				      const gaspi_size_t size,
+				      const gaspi_queue_id_t queue_first,
+				      const gaspi_number_t num,
+				      const gaspi_timeout_t timeout_ms);
+
+  /** Read data of any size from a remote segment, striped over a set
+   * of queues.
+   *
+   * The counterpart of gaspi_write_striped.
+   *
+   * @param segment_id_local The local segment ID to write to.
+   * @param offset_local The local offset to write to.
+   * @param rank The rank to read from.
+   * @param segment_id_remote The remote segment to read from.
+   * @param offset_remote The remote offset to read from.
+   * @param size The size of the data to read.
+   * @param queue_first The first queue of the set.
+   * @param num The number of queues in the set.
+   * @param timeout_ms Timeout in milliseconds (or GASPI_BLOCK/GASPI_TEST).
+   *
+   * @return GASPI_SUCCESS in case of success, GASPI_ERROR in case of
+   * error, GASPI_TIMEOUT in case of timeout.
+   */
+  gaspi_return_t gaspi_read_striped (const gaspi_segment_id_t segment_id_local,
+				     const gaspi_offset_t offset_local,
+				     const gaspi_rank_t rank,
+				     const gaspi_segment_id_t segment_id_remote,
+				     const gaspi_offset_t offset_remote,
+				     const gaspi_size_t size,
+				     const gaspi_queue_id_t queue_first,
+				     const gaspi_number_t num,
+				     const gaspi_timeout_t timeout_ms);
+
+  /** Write data of any size striped over a set of queues, with a
+   * notification once all of it arrived.
+   *
+   * As gaspi_write_striped, each stripe then adding its share of
+   * notification_value to the notification (as gaspi_notify_add).
+   * The notification reaches notification_value only with the last
+   * stripe: wait for it with gaspi_notify_wait_count. There are no
+   * more stripes than notification_value. The notification ID must be
+   * even (see gaspi_notify_add).
+   *
+   * @param segment_id_local The local segment ID to read from.
+   * @param offset_local The local offset to read from.
+   * @param rank The rank to write to.
+   * @param segment_id_remote The remote segment to write to.
+   * @param offset_remote The remote offset to write to.
+   * @param size The size of the data to write.
+   * @param notification_id The notification ID to add to (even).
+   * @param notification_value The value of the notification once complete (not zero).
+   * @param queue_first The first queue of the set.
+   * @param num The number of queues in the set.
+   * @param timeout_ms Timeout in milliseconds (or GASPI_BLOCK/GASPI_TEST).
+   *
+   * @return GASPI_SUCCESS in case of success, GASPI_ERROR in case of
+   * error, GASPI_TIMEOUT in case of timeout.
+   */
+  gaspi_return_t gaspi_write_striped_notify (const gaspi_segment_id_t segment_id_local,
+					     const gaspi_offset_t offset_local,
+					     const gaspi_rank_t rank,
+					     const gaspi_segment_id_t segment_id_remote,
+					     const gaspi_offset_t offset_remote,
+					     const gaspi_size_t size,
+					     const gaspi_notification_id_t notification_id,
+					     const gaspi_notification_t notification_value,
+					     const gaspi_queue_id_t queue_first,
+					     const gaspi_number_t num,
+					     const gaspi_timeout_t timeout_ms);
+
 #ifdef __cplusplus
 }
 #endif
@@ -25,6 +25,7 @@ extern "C"
 #endif
 
 #include "GASPI.h"
+#include "GASPI_Ext.h"
 
   gaspi_return_t pgaspi_config_get (gaspi_config_t * const config);
   
@@ -184,6 +185,157 @@ extern "C"
 					const gaspi_group_t group,
 					const gaspi_timeout_t timeout_ms);
 
+  gaspi_return_t pgaspi_bcast (gaspi_pointer_t const buffer,
+			       const gaspi_size_t size,
+			       const gaspi_rank_t root,
+			       const gaspi_group_t group,
+			       const gaspi_timeout_t timeout_ms);
+
+  gaspi_return_t pgaspi_allgather (const gaspi_segment_id_t segment_id,
+				   const gaspi_offset_t offset,
+				   const gaspi_size_t size,
+				   const gaspi_group_t group,
+				   const gaspi_timeout_t timeout_ms);
+
+  gaspi_return_t pgaspi_allgatherv (const gaspi_segment_id_t segment_id,
+				    const gaspi_offset_t offset,
+				    const gaspi_size_t * const sizes,
+				    const gaspi_group_t group,
+				    const gaspi_timeout_t timeout_ms);
+
+  gaspi_return_t pgaspi_alltoall (const gaspi_segment_id_t segment_id_send,
+				  const gaspi_offset_t offset_send,
+				  const gaspi_segment_id_t segment_id_recv,
+				  const gaspi_offset_t offset_recv,
+				  const gaspi_size_t size,
+				  const gaspi_group_t group,
+				  const gaspi_timeout_t timeout_ms);
+
+  gaspi_return_t pgaspi_alltoallv (const gaspi_segment_id_t segment_id_send,
+				   const gaspi_offset_t offset_send,
+				   const gaspi_size_t * const send_sizes,
+				   const gaspi_segment_id_t segment_id_recv,
+				   const gaspi_offset_t offset_recv,
+				   const gaspi_size_t * const recv_sizes,
+				   const gaspi_group_t group,
+				   const gaspi_timeout_t timeout_ms);
+
+  gaspi_return_t pgaspi_reduce (const gaspi_pointer_t buffer_send,
+				gaspi_pointer_t const buffer_receive,
+				const gaspi_number_t num,
+				const gaspi_operation_t operation,
+				const gaspi_datatype_t datatyp,
+				const gaspi_rank_t root,
+				const gaspi_group_t group,
+				const gaspi_timeout_t timeout_ms);
+
+  gaspi_return_t pgaspi_reduce_user (const gaspi_pointer_t buffer_send,
+				     gaspi_pointer_t const buffer_receive,
+				     const gaspi_number_t num,
+				     const gaspi_size_t element_size,
+				     gaspi_reduce_operation_t const reduce_operation,
+				     gaspi_state_t const reduce_state,
+				     const gaspi_rank_t root,
+				     const gaspi_group_t group,
+				     const gaspi_timeout_t timeout_ms);
+
+  gaspi_return_t pgaspi_reduce_scatter_block (const gaspi_pointer_t buffer_send,
+					      gaspi_pointer_t const buffer_receive,
+					      const gaspi_number_t num,
+					      const gaspi_operation_t operation,
+					      const gaspi_datatype_t datatyp,
+					      const gaspi_group_t group,
+					      const gaspi_timeout_t timeout_ms);
+
+  gaspi_return_t pgaspi_reduce_scatter_block_user (const gaspi_pointer_t buffer_send,
+						   gaspi_pointer_t const buffer_receive,
+						   const gaspi_number_t num,
+						   const gaspi_size_t element_size,
+						   gaspi_reduce_operation_t const reduce_operation,
+						   gaspi_state_t const reduce_state,
+						   const gaspi_group_t group,
+						   const gaspi_timeout_t timeout_ms);
+
+  gaspi_return_t pgaspi_scan (const gaspi_pointer_t buffer_send,
+			      gaspi_pointer_t const buffer_receive,
+			      const gaspi_number_t num,
+			      const gaspi_operation_t operation,
+			      const gaspi_datatype_t datatyp,
+			      const gaspi_group_t group,
+			      const gaspi_timeout_t timeout_ms);
+
+  gaspi_return_t pgaspi_scan_user (const gaspi_pointer_t buffer_send,
+				   gaspi_pointer_t const buffer_receive,
+				   const gaspi_number_t num,
+				   const gaspi_size_t element_size,
+				   gaspi_reduce_operation_t const reduce_operation,
+				   gaspi_state_t const reduce_state,
+				   const gaspi_group_t group,
+				   const gaspi_timeout_t timeout_ms);
+
+  gaspi_return_t pgaspi_exscan (const gaspi_pointer_t buffer_send,
+				gaspi_pointer_t const buffer_receive,
+				const gaspi_number_t num,
+				const gaspi_operation_t operation,
+				const gaspi_datatype_t datatyp,
+				const gaspi_group_t group,
+				const gaspi_timeout_t timeout_ms);
+
+  gaspi_return_t pgaspi_exscan_user (const gaspi_pointer_t buffer_send,
+				     gaspi_pointer_t const buffer_receive,
+				     const gaspi_number_t num,
+				     const gaspi_size_t element_size,
+				     gaspi_reduce_operation_t const reduce_operation,
+				     gaspi_state_t const reduce_state,
+				     const gaspi_group_t group,
+				     const gaspi_timeout_t timeout_ms);
+
+  gaspi_return_t pgaspi_allreduce_segment (const gaspi_segment_id_t segment_id_send,
+					   const gaspi_offset_t offset_send,
+					   const gaspi_segment_id_t segment_id_recv,
+					   const gaspi_offset_t offset_recv,
+					   const gaspi_number_t num,
+					   const gaspi_operation_t operation,
+					   const gaspi_datatype_t datatyp,
+					   const gaspi_group_t group,
+					   const gaspi_timeout_t timeout_ms);
+
+  gaspi_return_t pgaspi_ibarrier (const gaspi_group_t group,
+				  gaspi_coll_request_t * const request);
+
+  gaspi_return_t pgaspi_iallreduce (const gaspi_pointer_t buffer_send,
+				    gaspi_pointer_t const buffer_receive,
+				    const gaspi_number_t num,
+				    const gaspi_operation_t operation,
+				    const gaspi_datatype_t datatyp,
+				    const gaspi_group_t group,
+				    gaspi_coll_request_t * const request);
+
+  gaspi_return_t pgaspi_iallreduce_user (const gaspi_pointer_t buffer_send,
+					 gaspi_pointer_t const buffer_receive,
+					 const gaspi_number_t num,
+					 const gaspi_size_t element_size,
+					 gaspi_reduce_operation_t const reduce_operation,
+					 gaspi_state_t const reduce_state,
+					 const gaspi_group_t group,
+					 gaspi_coll_request_t * const request);
+
+  gaspi_return_t pgaspi_coll_wait (gaspi_coll_request_t * const request,
+				   const gaspi_timeout_t timeout_ms);
+
+  gaspi_return_t pgaspi_coll_test (gaspi_coll_request_t * const request,
+				   gaspi_number_t * const flag);
+
+  gaspi_return_t pgaspi_coll_algorithm_set (const gaspi_group_t group,
+					    const gaspi_coll_algorithm_t barrier,
+					    const gaspi_coll_algorithm_t allreduce);
+
+  gaspi_return_t pgaspi_coll_algorithm_get (const gaspi_group_t group,
+					    const gaspi_number_t num,
+					    const gaspi_datatype_t datatyp,
+					    gaspi_coll_algorithm_t * const barrier,
+					    gaspi_coll_algorithm_t * const allreduce);
+
   gaspi_return_t pgaspi_atomic_fetch_add (const gaspi_segment_id_t segment_id,
 					  const gaspi_offset_t offset,
 					  const gaspi_rank_t rank,
@@ -222,6 +374,18 @@ extern "C"
 				const gaspi_queue_id_t queue,
 				const gaspi_timeout_t timeout_ms);
 
+  gaspi_return_t pgaspi_notify_add (const gaspi_segment_id_t segment_id_remote,
+				    const gaspi_rank_t rank,
+				    const gaspi_notification_id_t notification_id,
+				    const gaspi_notification_t notification_value,
+				    const gaspi_queue_id_t queue,
+				    const gaspi_timeout_t timeout_ms);
+
+  gaspi_return_t pgaspi_notify_wait_count (const gaspi_segment_id_t segment_id_local,
+					   const gaspi_notification_id_t notification_id,
+					   const gaspi_notification_t count,
+					   const gaspi_timeout_t timeout_ms);
+
   gaspi_return_t pgaspi_notify_waitsome (const gaspi_segment_id_t
 					 segment_id_local,
 					 const gaspi_notification_id_t
@@ -231,6 +395,25 @@ extern "C"
 					 const first_id,
 					 const gaspi_timeout_t timeout_ms);
 
+  gaspi_return_t pgaspi_notify_waitsome_fair (const gaspi_segment_id_t segment_id_local,
+					      const gaspi_notification_id_t notification_begin,
+					      const gaspi_number_t num,
+					      gaspi_notification_id_t * const first_id,
+					      const gaspi_timeout_t timeout_ms);
+
+  gaspi_return_t pgaspi_notify_waitany (const gaspi_segment_id_t segment_id_local,
+					gaspi_notification_id_t * const first_id,
+					const gaspi_timeout_t timeout_ms);
+
+  gaspi_return_t pgaspi_notify_waitsome_multi (const gaspi_segment_id_t segment_id_local,
+					       const gaspi_notification_id_t notification_begin,
+					       const gaspi_number_t num,
+					       gaspi_notification_id_t * const ids,
+					       gaspi_notification_t * const values,
+					       const gaspi_number_t max_ids,
+					       gaspi_number_t * const count,
+					       const gaspi_timeout_t timeout_ms);
+
   gaspi_return_t pgaspi_notify_reset (const gaspi_segment_id_t
 				      segment_id_local,
 				      const gaspi_notification_id_t
@@ -253,6 +436,17 @@ extern "C"
 				      const gaspi_queue_id_t queue,
 				      const gaspi_timeout_t timeout_ms);
 
+  gaspi_return_t pgaspi_write_notify_add (const gaspi_segment_id_t segment_id_local,
+					  const gaspi_offset_t offset_local,
+					  const gaspi_rank_t rank,
+					  const gaspi_segment_id_t segment_id_remote,
+					  const gaspi_offset_t offset_remote,
+					  const gaspi_size_t size,
+					  const gaspi_notification_id_t notification_id,
+					  const gaspi_notification_t notification_value,
+					  const gaspi_queue_id_t queue,
+					  const gaspi_timeout_t timeout_ms);
+
   gaspi_return_t pgaspi_write_list_notify (const gaspi_number_t num,
 					   gaspi_segment_id_t *
 					   const segment_id_local,
@@ -272,6 +466,28 @@ extern "C"
 					   const gaspi_queue_id_t queue,
 					   const gaspi_timeout_t timeout_ms);
 
+  gaspi_return_t pgaspi_read_notify (const gaspi_segment_id_t segment_id_local,
+				     const gaspi_offset_t offset_local,
+				     const gaspi_rank_t rank,
+				     const gaspi_segment_id_t segment_id_remote,
+				     const gaspi_offset_t offset_remote,
+				     const gaspi_size_t size,
+				     const gaspi_notification_id_t notification_id,
+				     const gaspi_queue_id_t queue,
+				     const gaspi_timeout_t timeout_ms);
+
+  gaspi_return_t pgaspi_read_list_notify (const gaspi_number_t num,
+					  gaspi_segment_id_t * const segment_id_local,
+					  gaspi_offset_t * const offset_local,
+					  const gaspi_rank_t rank,
+					  gaspi_segment_id_t * const segment_id_remote,
+					  gaspi_offset_t * const offset_remote,
+					  gaspi_size_t * const size,
+					  const gaspi_segment_id_t segment_id_notification,
+					  const gaspi_notification_id_t notification_id,
+					  const gaspi_queue_id_t queue,
+					  const gaspi_timeout_t timeout_ms);
+
   gaspi_return_t pgaspi_queue_size (const gaspi_queue_id_t queue,
 				    gaspi_number_t * const queue_size);
 
@@ -284,6 +500,101 @@ extern "C"
 
   gaspi_return_t pgaspi_queue_size_max (gaspi_number_t * const queue_size_max);
 
+  gaspi_return_t pgaspi_queue_select (const gaspi_queue_id_t queue_first,
+				      const gaspi_number_t num,
+				      const gaspi_number_t requests,
+				      gaspi_queue_id_t * const queue,
+				      const gaspi_timeout_t timeout_ms);
+
+  gaspi_return_t pgaspi_endpoint_create (gaspi_endpoint_t * const endpoint,
+					 const gaspi_timeout_t timeout_ms);
+
+  gaspi_return_t pgaspi_endpoint_delete (gaspi_endpoint_t endpoint);
+
+  gaspi_return_t pgaspi_endpoint_queue (const gaspi_endpoint_t endpoint,
+					gaspi_queue_id_t * const queue,
+					gaspi_number_t * const shared);
+
+  gaspi_return_t pgaspi_endpoint_wait (const gaspi_endpoint_t endpoint,
+				       const gaspi_timeout_t timeout_ms);
+
+  gaspi_return_t pgaspi_write_strided (const gaspi_segment_id_t segment_id_local,
+				       const gaspi_offset_t offset_local,
+				       const gaspi_size_t * const stride_local,
+				       const gaspi_rank_t rank,
+				       const gaspi_segment_id_t segment_id_remote,
+				       const gaspi_offset_t offset_remote,
+				       const gaspi_size_t * const stride_remote,
+				       const gaspi_size_t block_size,
+				       const gaspi_number_t * const count,
+				       const gaspi_number_t dims,
+				       const gaspi_queue_id_t queue,
+				       const gaspi_timeout_t timeout_ms);
+
+  gaspi_return_t pgaspi_read_strided (const gaspi_segment_id_t segment_id_local,
+				      const gaspi_offset_t offset_local,
+				      const gaspi_size_t * const stride_local,
+				      const gaspi_rank_t rank,
+				      const gaspi_segment_id_t segment_id_remote,
+				      const gaspi_offset_t offset_remote,
+				      const gaspi_size_t * const stride_remote,
+				      const gaspi_size_t block_size,
+				      const gaspi_number_t * const count,
+				      const gaspi_number_t dims,
+				      const gaspi_queue_id_t queue,
+				      const gaspi_timeout_t timeout_ms);
+
+  gaspi_return_t pgaspi_write_strided_notify (const gaspi_segment_id_t segment_id_local,
+					      const gaspi_offset_t offset_local,
+					      const gaspi_size_t * const stride_local,
+					      const gaspi_rank_t rank,
+					      const gaspi_segment_id_t segment_id_remote,
+					      const gaspi_offset_t offset_remote,
+					      const gaspi_size_t * const stride_remote,
+					      const gaspi_size_t block_size,
+					      const gaspi_number_t * const count,
+					      const gaspi_number_t dims,
+					      const gaspi_notification_id_t notification_id,
+					      const gaspi_notification_t notification_value,
+					      const gaspi_queue_id_t queue,
+					      const gaspi_timeout_t timeout_ms);
+
+  gaspi_return_t pgaspi_wait_queues (const gaspi_queue_id_t queue_first,
+				     const gaspi_number_t num,
+				     const gaspi_timeout_t timeout_ms);
+
+  gaspi_return_t pgaspi_write_striped (const gaspi_segment_id_t segment_id_local,
+				       const gaspi_offset_t offset_local,
+				       const gaspi_rank_t rank,
+				       const gaspi_segment_id_t segment_id_remote,
+				       const gaspi_offset_t offset_remote,
+				       const gaspi_size_t size,
+				       const gaspi_queue_id_t queue_first,
+				       const gaspi_number_t num,
+				       const gaspi_timeout_t timeout_ms);
+
+  gaspi_return_t pgaspi_read_striped (const gaspi_segment_id_t segment_id_local,
+				      const gaspi_offset_t offset_local,
+				      const gaspi_rank_t rank,
+				      const gaspi_segment_id_t segment_id_remote,
+				      const gaspi_offset_t offset_remote,
+				      const gaspi_size_t size,
+				      const gaspi_queue_id_t queue_first,
+				      const gaspi_number_t num,
+				      const gaspi_timeout_t timeout_ms);
+
+  gaspi_return_t pgaspi_write_striped_notify (const gaspi_segment_id_t segment_id_local,
+					      const gaspi_offset_t offset_local,
+					      const gaspi_rank_t rank,
+					      const gaspi_segment_id_t segment_id_remote,
+					      const gaspi_offset_t offset_remote,
+					      const gaspi_size_t size,
+					      const gaspi_notification_id_t notification_id,
+					      const gaspi_notification_t notification_value,
+					      const gaspi_queue_id_t queue_first,
+					      const gaspi_number_t num,
+					      const gaspi_timeout_t timeout_ms);
+
   gaspi_return_t pgaspi_transfer_size_min (gaspi_size_t *
 					   const transfer_size_min);
 
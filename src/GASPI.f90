@@ -102,6 +102,22 @@ module GASPI
     enum, bind(C) !:: gaspi_alloc_policy_flags
       enumerator :: GASPI_MEM_UNINITIALIZED=0
       enumerator :: GASPI_MEM_INITIALIZED=1
+      enumerator :: GASPI_MEM_NOTIFY_SUMMARY=4
+    end enum 
+
+    enum, bind(C) !:: gaspi_wait_policy_t
+      enumerator :: GASPI_WAIT_SPIN=0
+      enumerator :: GASPI_WAIT_ADAPTIVE=1
+    end enum 
+
+    enum, bind(C) !:: gaspi_queue_full_policy_t
+      enumerator :: GASPI_QUEUE_FULL_ERROR=0
+      enumerator :: GASPI_QUEUE_FULL_REAP=1
+    end enum 
+
+    enum, bind(C) !:: gaspi_notify_mode_t
+      enumerator :: GASPI_NOTIFY_SEPARATE=0
+      enumerator :: GASPI_NOTIFY_FUSED=1
     end enum 
 
     enum, bind(C) !:: gaspi_statistic_argument_t
@@ -128,6 +144,11 @@ module GASPI
       integer (gaspi_size_t)   :: allreduce_buf_size
       integer (gaspi_number_t) :: allreduce_elem_max
       integer (gaspi_number_t) :: build_infrastructure
+      integer (gaspi_int)      :: wait_policy
+      integer (gaspi_int)      :: wait_spin_us
+      integer (gaspi_int)      :: queue_full_policy
+      integer (gaspi_int)      :: netdev_num
+      integer (gaspi_int)      :: notify_mode
     end type gaspi_config_t
 
     interface ! gaspi_config_get
@@ -127,6 +127,7 @@ pgaspi_init_core(void)
       GASPI_RESET_GROUP(glb_gaspi_group_ctx, i);
       glb_gaspi_group_ctx[i].gl.lock = 0;
       glb_gaspi_group_ctx[i].del.lock = 0;
+      glb_gaspi_group_ctx[i].nbc_lock.lock = 0;
     }
 
   /* Set number of "created" communication queues */
@@ -199,10 +200,11 @@ pgaspi_proc_init (const gaspi_timeout_t timeout_ms)
     {
       glb_gaspi_ctx.lockPS.lock = 0;
       glb_gaspi_ctx.lockPR.lock = 0;
+      glb_gaspi_ctx.lockGRP.lock = 0;
 
       for(i = 0; i < num_queues; i++)
 	{
-	  glb_gaspi_ctx.lockC[i].lock = 0;
+	  glb_gaspi_ctx.queues[i].lock.lock = 0;
 	}
 
       memset (&glb_gaspi_ctx, 0, sizeof (gaspi_context));
@@ -223,6 +225,17 @@ pgaspi_proc_init (const gaspi_timeout_t timeout_ms)
 
       glb_gaspi_ctx.cycles_to_msecs = 1.0f / (glb_gaspi_ctx.mhz * 1000.0f);
 
+      if( GASPI_WAIT_ADAPTIVE == glb_gaspi_cfg.wait_policy )
+	{
+	  glb_gaspi_ctx.wait_spin_cycles = (gaspi_cycles_t) (glb_gaspi_cfg.wait_spin_us * glb_gaspi_ctx.mhz);
+	  glb_gaspi_ctx.wait_yield_cycles = 2 * glb_gaspi_ctx.wait_spin_cycles;
+	}
+      else
+	{
+	  glb_gaspi_ctx.wait_spin_cycles = GASPI_BLOCK;
+	  glb_gaspi_ctx.wait_yield_cycles = GASPI_BLOCK;
+	}
+
       //handle environment
       if( gaspi_handle_env(&glb_gaspi_ctx) )
 	{
@@ -339,6 +352,8 @@ pgaspi_proc_init (const gaspi_timeout_t timeout_ms)
   __sync_fetch_and_add( &gaspi_master_topo_data, 1);
 
   gaspi_init_collectives();
+  gaspi_init_coll_tuning();
+  gaspi_init_notify_scan();
 
   glb_gaspi_init = 1;
 
@@ -441,6 +456,8 @@ pgaspi_cleanup_core(void)
 	  glb_gaspi_group_ctx[i].rrcd[glb_gaspi_ctx.rank].data.buf = NULL;
 	  glb_gaspi_group_ctx[i].rrcd[glb_gaspi_ctx.rank].notif_spc.buf = NULL;
 
+	  pgaspi_group_node_release(i);
+
 	  free (glb_gaspi_group_ctx[i].rank_grp);
 	  glb_gaspi_group_ctx[i].rank_grp = NULL;
 
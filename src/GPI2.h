@@ -28,8 +28,46 @@ along with GPI-2. If not, see <http://www.gnu.org/licenses/>.
 
 #define COLL_MEM_SEND     (131136)
 #define COLL_MEM_RECV     (COLL_MEM_SEND + 73728)
-#define NEXT_OFFSET       (COLL_MEM_RECV + 73728)
-#define NOTIFY_OFFSET     (65536*4)
+#define COLL_MEM_LARGE    (COLL_MEM_RECV + 73728)
+#define COLL_MEM_BCAST    (COLL_MEM_LARGE + 2 * GPI2_REDUX_LARGE_SLOT)
+#define COLL_MEM_ALLGATHER (COLL_MEM_BCAST + GPI2_BCAST_SIZE)
+#define COLL_MEM_ALLTOALL (COLL_MEM_ALLGATHER + GPI2_ALLGATHER_SIZE)
+#define COLL_MEM_REDUCE   (COLL_MEM_ALLTOALL + GPI2_ALLTOALL_SIZE)
+#define COLL_MEM_NBC      (COLL_MEM_REDUCE + GPI2_REDUCE_SIZE)
+/* flags of the dissemination among the node leaders, laid out as the
+   flags of the flat barrier at the start of the buffer */
+#define COLL_MEM_NODE_BARRIER (COLL_MEM_NBC + GPI2_NBC_SIZE)
+#define NEXT_OFFSET       (COLL_MEM_NODE_BARRIER + COLL_MEM_SEND)
+/* The notification space holds the notifications followed by their
+   summary, one flag for each NOTIFY_SUMMARY_BLOCK notifications that
+   is set after every notification into a segment allocated with
+   GASPI_MEM_NOTIFY_SUMMARY. It is padded to keep the data page aligned;
+   in the local source space, the padding after the summary receives
+   the (discarded) old values of the atomic adds of gaspi_notify_add.
+   The last two words of the padding of a segment hold a notification
+   and a summary flag of 1, read behind the data of gaspi_read_notify
+   into the local notification and its flag. */
+#define NOTIFY_SUMMARY_OFFSET (65536*4)
+#define NOTIFY_SUMMARY_BLOCK  (64)
+#define NOTIFY_SUMMARY_SIZE   (GASPI_MAX_NOTIFICATION / NOTIFY_SUMMARY_BLOCK)
+#define NOTIFY_ADD_SINK_OFFSET (NOTIFY_SUMMARY_OFFSET + NOTIFY_SUMMARY_SIZE)
+#define NOTIFY_OFFSET     (NOTIFY_SUMMARY_OFFSET + 4096)
+#define NOTIFY_READ_ONE_OFFSET (NOTIFY_OFFSET - 2 * sizeof(gaspi_notification_t))
+#define NOTIFY_READ_FLAG_OFFSET (NOTIFY_OFFSET - sizeof(gaspi_notification_t))
+
+/* With notify_mode GASPI_NOTIFY_FUSED, the notification of a write
+   goes with its data. On IB it is the 32 bit immediate of the write:
+   the segment (5 bits), the id (16 bits) and the value (11 bits); a
+   larger value is written as a notification of its own. */
+#define NOTIFY_IMM_ID_BITS    (16)
+#define NOTIFY_IMM_VALUE_BITS (11)
+#define NOTIFY_IMM_VALUE_MAX  ((1U << NOTIFY_IMM_VALUE_BITS) - 1)
+#define NOTIFY_IMM(seg, id, val) \
+  (((uint32_t) (seg) << (NOTIFY_IMM_ID_BITS + NOTIFY_IMM_VALUE_BITS)) \
+   | ((uint32_t) (id) << NOTIFY_IMM_VALUE_BITS) | (uint32_t) (val))
+#define NOTIFY_IMM_SEG(imm)   ((imm) >> (NOTIFY_IMM_ID_BITS + NOTIFY_IMM_VALUE_BITS))
+#define NOTIFY_IMM_ID(imm)    (((imm) >> NOTIFY_IMM_VALUE_BITS) & ((1U << NOTIFY_IMM_ID_BITS) - 1))
+#define NOTIFY_IMM_VALUE(imm) ((imm) & NOTIFY_IMM_VALUE_MAX)
 
 gaspi_context glb_gaspi_ctx;
 gaspi_group_ctx glb_gaspi_group_ctx[GASPI_MAX_GROUPS];
@@ -133,4 +171,74 @@ unlock_gaspi (gaspi_lock_t * l)
   GASPI_ATOMIC_UNLOCK (&l->lock);
 }
 
+/* Waiting with a timeout: the timeout is kept in cycles and, with
+   GASPI_WAIT_ADAPTIVE, the waiter spins for wait_spin_us, then yields
+   the CPU for as long and then asks its caller to block on the device
+   (never longer than GASPI_WAIT_BLOCK_US at once) */
+#define GASPI_WAIT_BLOCK_US (1000)
+
+enum
+  {
+    GASPI_WAIT_PHASE_SPIN = 0,
+    GASPI_WAIT_PHASE_YIELD = 1,
+    GASPI_WAIT_PHASE_BLOCK = 2,
+    GASPI_WAIT_PHASE_EXPIRED = 3
+  };
+
+typedef struct
+{
+  gaspi_cycles_t start;
+  gaspi_cycles_t timeout;
+} gaspi_waiter_t;
+
+static inline void
+gaspi_waiter_init (gaspi_waiter_t * w, const gaspi_timeout_t timeout_ms)
+{
+  const double cycles = (double) timeout_ms * glb_gaspi_ctx.mhz * 1000.0;
+
+  w->start = gaspi_get_cycles ();
+
+  if (timeout_ms == GASPI_BLOCK || cycles >= (double) GASPI_BLOCK)
+    w->timeout = GASPI_BLOCK;
+  else
+    w->timeout = (gaspi_cycles_t) cycles;
+}
+
+/* Called when there was nothing to wait for: spins or yields and
+   returns the phase of the wait. For GASPI_WAIT_PHASE_BLOCK, block_us
+   is set to the time to block for. */
+static inline int
+gaspi_waiter_idle (const gaspi_waiter_t * w, long * const block_us)
+{
+  const gaspi_cycles_t elapsed = gaspi_get_cycles () - w->start;
+
+  if (elapsed > w->timeout)
+    return GASPI_WAIT_PHASE_EXPIRED;
+
+  if (elapsed < glb_gaspi_ctx.wait_spin_cycles)
+    {
+      gaspi_delay ();
+      return GASPI_WAIT_PHASE_SPIN;
+    }
+
+  if (elapsed < glb_gaspi_ctx.wait_yield_cycles)
+    {
+      sched_yield ();
+      return GASPI_WAIT_PHASE_YIELD;
+    }
+
+  *block_us = GASPI_WAIT_BLOCK_US;
+  if (w->timeout != GASPI_BLOCK)
+    {
+      const long left_us = (long) ((w->timeout - elapsed) / glb_gaspi_ctx.mhz) + 1;
+      *block_us = MIN (left_us, GASPI_WAIT_BLOCK_US);
+    }
+
+  return GASPI_WAIT_PHASE_BLOCK;
+}
+
+/* Select the notification scan for the running CPU (GPI2_IO.c) */
+void
+gaspi_init_notify_scan (void);
+
 #endif //_GPI2_H_
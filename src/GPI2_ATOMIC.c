@@ -49,8 +49,11 @@ pgaspi_atomic_fetch_add (const gaspi_segment_id_t segment_id,
 	}
     }
 
+  /* the device polls the collectives queue */
+  lock_gaspi (&glb_gaspi_ctx.lockGRP);
   eret = pgaspi_dev_atomic_fetch_add(segment_id, offset, rank,
 				     val_add);
+  unlock_gaspi (&glb_gaspi_ctx.lockGRP);
 
   if( eret != GASPI_SUCCESS )
     {
@@ -93,8 +96,10 @@ pgaspi_atomic_compare_swap (const gaspi_segment_id_t segment_id,
 	  goto endL;
 	}
     }
+  lock_gaspi (&glb_gaspi_ctx.lockGRP);
   eret = pgaspi_dev_atomic_compare_swap(segment_id, offset, rank,
 					comparator, val_new);
+  unlock_gaspi (&glb_gaspi_ctx.lockGRP);
 
   if( eret != GASPI_SUCCESS )
     {
@@ -42,7 +42,12 @@ gaspi_config_t glb_gaspi_cfg = {
   GASPI_MAX_TSIZE_P,		//passive_transfer_size_max;
   NEXT_OFFSET,			//allreduce_buf_size;
   255,				//allreduce_elem_max;
-  GASPI_TOPOLOGY_STATIC         //build_infrastructure;
+  GASPI_TOPOLOGY_STATIC,        //build_infrastructure;
+  GASPI_WAIT_SPIN,		//wait_policy;
+  50,				//wait_spin_us;
+  GASPI_QUEUE_FULL_ERROR,	//queue_full_policy;
+  1,				//netdev_num;
+  GASPI_NOTIFY_SEPARATE		//notify_mode;
 };
 
 #pragma weak gaspi_config_get = pgaspi_config_get
@@ -121,6 +126,40 @@ pgaspi_config_set (const gaspi_config_t nconf)
   
   glb_gaspi_cfg.sn_port = nconf.sn_port;
 
+  if( nconf.wait_policy != GASPI_WAIT_SPIN && nconf.wait_policy != GASPI_WAIT_ADAPTIVE )
+    {
+      gaspi_print_error("Invalid value for parameter wait_policy");
+      return GASPI_ERR_CONFIG;
+    }
+
+  glb_gaspi_cfg.wait_policy = nconf.wait_policy;
+  glb_gaspi_cfg.wait_spin_us = nconf.wait_spin_us;
+
+  if( nconf.queue_full_policy != GASPI_QUEUE_FULL_ERROR
+      && nconf.queue_full_policy != GASPI_QUEUE_FULL_REAP )
+    {
+      gaspi_print_error("Invalid value for parameter queue_full_policy");
+      return GASPI_ERR_CONFIG;
+    }
+
+  glb_gaspi_cfg.queue_full_policy = nconf.queue_full_policy;
+
+  if( nconf.netdev_num < 1 || nconf.netdev_num > GASPI_MAX_RAILS )
+    {
+      gaspi_print_error("Invalid value for parameter netdev_num (min=1 and max=GASPI_MAX_RAILS)");
+      return GASPI_ERR_CONFIG;
+    }
+
+  glb_gaspi_cfg.netdev_num = nconf.netdev_num;
+
+  if( nconf.notify_mode != GASPI_NOTIFY_SEPARATE && nconf.notify_mode != GASPI_NOTIFY_FUSED )
+    {
+      gaspi_print_error("Invalid value for parameter notify_mode");
+      return GASPI_ERR_CONFIG;
+    }
+
+  glb_gaspi_cfg.notify_mode = nconf.notify_mode;
+
   glb_gaspi_cfg.net_info = nconf.net_info;
   glb_gaspi_cfg.logger = nconf.logger;
   glb_gaspi_cfg.port_check = nconf.port_check;
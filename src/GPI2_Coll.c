@@ -15,372 +15,242 @@ GNU General Public License for more details.
 You should have received a copy of the GNU General Public License
 along with GPI-2. If not, see <http://www.gnu.org/licenses/>.
 */
+#include <stdio.h>
+#include <string.h>
+
+#include "GASPI_Ext.h"
 #include "GPI2_Coll.h"
 #include "GPI2_Utility.h"
 
+/* The pre-defined collective operations are generated from a single
+   element-wise loop template. The template is instantiated once as a
+   portable fallback and, on x86 with GCC, once per SIMD instruction
+   set (SSE2, AVX2, AVX-512F) with the vectorizer enabled for that
+   target. The best instance supported by the running CPU is selected
+   in gaspi_init_collectives. The result buffer never overlaps the
+   inputs (see _gaspi_allreduce) hence the restrict qualifiers. */
+
+#if defined(__GNUC__) && !defined(__INTEL_COMPILER) && !defined(MIC) \
+  && (defined(__x86_64__) || defined(__i386__))
+#define GPI2_REDUX_X86 1
+#if defined(__clang__)
+#define GPI2_REDUX_VECT
+#else
+#define GPI2_REDUX_VECT optimize("tree-vectorize", "vect-cost-model=dynamic"),
+#endif
+#define GPI2_REDUX_SSE2 __attribute__((GPI2_REDUX_VECT target("sse2")))
+#define GPI2_REDUX_AVX2 __attribute__((GPI2_REDUX_VECT target("avx2")))
+#if defined(__clang__) || (__GNUC__ >= 5)
+#define GPI2_REDUX_AVX512 1
+#define GPI2_REDUX_AVX512F __attribute__((GPI2_REDUX_VECT target("avx512f")))
+#endif
+#endif
+
+#define GPI2_REDUX_SUM(a,b) ((a) + (b))
+
+#define GPI2_REDUX_KERNEL(attr, isa, opname, OPFN, tname, ctype)	\
+  static attr void							\
+  op##opname##tname##GASPI##isa (void *res, void *localVal, void *dstVal, \
+				 const gaspi_number_t cnt)		\
+  {									\
+    gaspi_number_t i;							\
+									\
+    ctype * const restrict rv = (ctype *) res;				\
+    const ctype * const restrict lv = (const ctype *) localVal;	\
+    const ctype * const restrict dv = (const ctype *) dstVal;		\
+									\
+    for (i = 0; i < cnt; i++)						\
+      {									\
+	rv[i] = OPFN (lv[i], dv[i]);					\
+      }									\
+  }
+
+#define GPI2_REDUX_KERNEL_OP(attr, isa, opname, OPFN)			\
+  GPI2_REDUX_KERNEL(attr, isa, opname, OPFN, Int, int)			\
+  GPI2_REDUX_KERNEL(attr, isa, opname, OPFN, UInt, unsigned int)	\
+  GPI2_REDUX_KERNEL(attr, isa, opname, OPFN, Float, float)		\
+  GPI2_REDUX_KERNEL(attr, isa, opname, OPFN, Double, double)		\
+  GPI2_REDUX_KERNEL(attr, isa, opname, OPFN, Long, long)		\
+  GPI2_REDUX_KERNEL(attr, isa, opname, OPFN, ULong, unsigned long)
+
+/* Table order must match op * 6 + type (see GASPI.h) */
+#define GPI2_REDUX_KERNEL_SET(attr, isa)				\
+  GPI2_REDUX_KERNEL_OP(attr, isa, Min, MIN)				\
+  GPI2_REDUX_KERNEL_OP(attr, isa, Max, MAX)				\
+  GPI2_REDUX_KERNEL_OP(attr, isa, Sum, GPI2_REDUX_SUM)			\
+									\
+  static gaspi_redux_fct_t const redux_set##isa[GASPI_COLL_OP_TYPES] = \
+    {									\
+      &opMinIntGASPI##isa, &opMinUIntGASPI##isa,			\
+      &opMinFloatGASPI##isa, &opMinDoubleGASPI##isa,			\
+      &opMinLongGASPI##isa, &opMinULongGASPI##isa,			\
+      &opMaxIntGASPI##isa, &opMaxUIntGASPI##isa,			\
+      &opMaxFloatGASPI##isa, &opMaxDoubleGASPI##isa,			\
+      &opMaxLongGASPI##isa, &opMaxULongGASPI##isa,			\
+      &opSumIntGASPI##isa, &opSumUIntGASPI##isa,			\
+      &opSumFloatGASPI##isa, &opSumDoubleGASPI##isa,			\
+      &opSumLongGASPI##isa, &opSumULongGASPI##isa			\
+    };
 
 //pre-defined coll. operations
-void
-opMinIntGASPI (void *res, void *localVal, void *dstVal,
-	       const unsigned char cnt)
-{
-  unsigned char i;
-
-  int *rv = (int *) res;
-  int *lv = (int *) localVal;
-  int *dv = (int *) dstVal;
-
-  for (i = 0; i < cnt; i++)
-    {
-      *rv = MIN (*lv, *dv);
-      lv++;
-      dv++;
-      rv++;
-    }
-}
-
-void
-opMaxIntGASPI (void *res, void *localVal, void *dstVal,
-	       const unsigned char cnt)
-{
-  unsigned char i;
-
-  int *rv = (int *) res;
-  int *lv = (int *) localVal;
-  int *dv = (int *) dstVal;
-
-  for (i = 0; i < cnt; i++)
-    {
-      *rv = MAX (*lv, *dv);
-      lv++;
-      dv++;
-      rv++;
-    }
-}
-
-void
-opSumIntGASPI (void *res, void *localVal, void *dstVal,
-	       const unsigned char cnt)
-{
-  unsigned char i;
-
-  int *rv = (int *) res;
-  int *lv = (int *) localVal;
-  int *dv = (int *) dstVal;
-
-  for (i = 0; i < cnt; i++)
-    {
-      *rv = *lv + *dv;
-      lv++;
-      dv++;
-      rv++;
-    }
-}
-
-void
-opMinUIntGASPI (void *res, void *localVal, void *dstVal,
-		const unsigned char cnt)
-{
-  unsigned char i;
+GPI2_REDUX_KERNEL_SET(, )
 
-  unsigned int *rv = (unsigned int *) res;
-  unsigned int *lv = (unsigned int *) localVal;
-  unsigned int *dv = (unsigned int *) dstVal;
+#ifdef GPI2_REDUX_X86
+GPI2_REDUX_KERNEL_SET(GPI2_REDUX_SSE2, _sse2)
+GPI2_REDUX_KERNEL_SET(GPI2_REDUX_AVX2, _avx2)
+#ifdef GPI2_REDUX_AVX512
+GPI2_REDUX_KERNEL_SET(GPI2_REDUX_AVX512F, _avx512f)
+#endif
+#endif
 
-  for (i = 0; i < cnt; i++)
-    {
-      *rv = MIN (*lv, *dv);
-      lv++;
-      dv++;
-      rv++;
-    }
-}
-
-void
-opMaxUIntGASPI (void *res, void *localVal, void *dstVal,
-		const unsigned char cnt)
-{
-  unsigned char i;
-
-  unsigned int *rv = (unsigned int *) res;
-  unsigned int *lv = (unsigned int *) localVal;
-  unsigned int *dv = (unsigned int *) dstVal;
-
-  for (i = 0; i < cnt; i++)
-    {
-      *rv = MAX (*lv, *dv);
-      lv++;
-      dv++;
-      rv++;
-    }
-}
-
-void
-opSumUIntGASPI (void *res, void *localVal, void *dstVal,
-		const unsigned char cnt)
-{
-  unsigned char i;
-
-  unsigned int *rv = (unsigned int *) res;
-  unsigned int *lv = (unsigned int *) localVal;
-  unsigned int *dv = (unsigned int *) dstVal;
-
-  for (i = 0; i < cnt; i++)
-    {
-      *rv = *lv + *dv;
-      lv++;
-      dv++;
-      rv++;
-    }
-}
-
-void
-opMinFloatGASPI (void *res, void *localVal, void *dstVal,
-		 const unsigned char cnt)
-{
-  unsigned char i;
-
-  float *rv = (float *) res;
-  float *lv = (float *) localVal;
-  float *dv = (float *) dstVal;
-
-  for (i = 0; i < cnt; i++)
-    {
-      *rv = MIN (*lv, *dv);
-      lv++;
-      dv++;
-      rv++;
-    }
-}
+gaspi_redux_fct_t fctArrayGASPI[GASPI_COLL_OP_TYPES];
 
 void
-opMaxFloatGASPI (void *res, void *localVal, void *dstVal,
-		 const unsigned char cnt)
+gaspi_init_collectives (void)
 {
-  unsigned char i;
+  int i;
+  gaspi_redux_fct_t const *set = redux_set;
 
-  float *rv = (float *) res;
-  float *lv = (float *) localVal;
-  float *dv = (float *) dstVal;
+#ifdef GPI2_REDUX_X86
+  __builtin_cpu_init ();
 
-  for (i = 0; i < cnt; i++)
+#ifdef GPI2_REDUX_AVX512
+  if( __builtin_cpu_supports ("avx512f") )
     {
-      *rv = MAX (*lv, *dv);
-      lv++;
-      dv++;
-      rv++;
+      set = redux_set_avx512f;
     }
-}
-
-void
-opSumFloatGASPI (void *res, void *localVal, void *dstVal,
-		 const unsigned char cnt)
-{
-  unsigned char i;
-
-  float *rv = (float *) res;
-  float *lv = (float *) localVal;
-  float *dv = (float *) dstVal;
-
-  for (i = 0; i < cnt; i++)
+  else
+#endif
+  if( __builtin_cpu_supports ("avx2") )
     {
-      *rv = *lv + *dv;
-      lv++;
-      dv++;
-      rv++;
+      set = redux_set_avx2;
     }
-}
-
-void
-opMinDoubleGASPI (void *res, void *localVal, void *dstVal,
-		  const unsigned char cnt)
-{
-  unsigned char i;
-
-  double *rv = (double *) res;
-  double *lv = (double *) localVal;
-  double *dv = (double *) dstVal;
-
-  for (i = 0; i < cnt; i++)
+  else if( __builtin_cpu_supports ("sse2") )
     {
-      *rv = MIN (*lv, *dv);
-      lv++;
-      dv++;
-      rv++;
+      set = redux_set_sse2;
     }
-}
+#endif
 
-void
-opMaxDoubleGASPI (void *res, void *localVal, void *dstVal,
-		  const unsigned char cnt)
-{
-  unsigned char i;
-
-  double *rv = (double *) res;
-  double *lv = (double *) localVal;
-  double *dv = (double *) dstVal;
-
-  for (i = 0; i < cnt; i++)
+  for(i = 0; i < GASPI_COLL_OP_TYPES; i++)
     {
-      *rv = MAX (*lv, *dv);
-      lv++;
-      dv++;
-      rv++;
+      fctArrayGASPI[i] = set[i];
     }
 }
 
-void
-opSumDoubleGASPI (void *res, void *localVal, void *dstVal,
-		  const unsigned char cnt)
-{
-  unsigned char i;
-
-  double *rv = (double *) res;
-  double *lv = (double *) localVal;
-  double *dv = (double *) dstVal;
+#define GPI2_TUNE_MAX_RULES 64
 
-  for (i = 0; i < cnt; i++)
-    {
-      *rv = *lv + *dv;
-      lv++;
-      dv++;
-      rv++;
-    }
-}
-
-void
-opMinLongGASPI (void *res, void *localVal, void *dstVal,
-		const unsigned char cnt)
+static struct
 {
-  unsigned char i;
+  gaspi_tune_coll_t coll;
+  int min_ranks, max_ranks;
+  long value;
+} gpi2_tune_rules[GPI2_TUNE_MAX_RULES];
 
-  long *rv = (long *) res;
-  long *lv = (long *) localVal;
-  long *dv = (long *) dstVal;
-
-  for (i = 0; i < cnt; i++)
-    {
-      *rv = MIN (*lv, *dv);
-      lv++;
-      dv++;
-      rv++;
-    }
-}
+static int gpi2_tune_nrules = 0;
 
 void
-opMaxLongGASPI (void *res, void *localVal, void *dstVal,
-		const unsigned char cnt)
+gaspi_init_coll_tuning (void)
 {
-  unsigned char i;
+  char line[256];
+  int lineno = 0;
 
-  long *rv = (long *) res;
-  long *lv = (long *) localVal;
-  long *dv = (long *) dstVal;
+  gpi2_tune_nrules = 0;
 
-  for (i = 0; i < cnt; i++)
+  const char *tunePtr = getenv ("GASPI_COLL_TUNING");
+  if( tunePtr == NULL )
     {
-      *rv = MAX (*lv, *dv);
-      lv++;
-      dv++;
-      rv++;
+      return;
     }
-}
-
-void
-opSumLongGASPI (void *res, void *localVal, void *dstVal,
-		const unsigned char cnt)
-{
-  unsigned char i;
 
-  long *rv = (long *) res;
-  long *lv = (long *) localVal;
-  long *dv = (long *) dstVal;
-
-  for (i = 0; i < cnt; i++)
+  FILE *f = fopen (tunePtr, "r");
+  if( f == NULL )
     {
-      *rv = *lv + *dv;
-      lv++;
-      dv++;
-      rv++;
+      gaspi_print_warning ("Failed to open collectives tuning file %s", tunePtr);
+      return;
     }
-}
-
-void
-opMinULongGASPI (void *res, void *localVal, void *dstVal,
-		 const unsigned char cnt)
-{
-  unsigned char i;
-
-  unsigned long *rv = (unsigned long *) res;
-  unsigned long *lv = (unsigned long *) localVal;
-  unsigned long *dv = (unsigned long *) dstVal;
 
-  for (i = 0; i < cnt; i++)
+  while( fgets (line, sizeof (line), f) != NULL )
     {
-      *rv = MIN (*lv, *dv);
-      lv++;
-      dv++;
-      rv++;
+      char coll[32], alg[32];
+      int min_ranks, max_ranks;
+      long value = -1;
+
+      lineno++;
+
+      const char *l = line + strspn (line, " \t");
+      if( *l == '#' || *l == '\n' || *l == '\0' )
+	{
+	  continue;
+	}
+
+      if( sscanf (l, "%31s %d %d %31s", coll, &min_ranks, &max_ranks, alg) != 4
+	  || min_ranks > max_ranks )
+	{
+	  gaspi_print_warning ("Ignoring line %d of %s", lineno, tunePtr);
+	  continue;
+	}
+
+      if( gpi2_tune_nrules == GPI2_TUNE_MAX_RULES )
+	{
+	  gaspi_print_warning ("Too many rules in %s", tunePtr);
+	  break;
+	}
+
+      if( strcmp (coll, "barrier") == 0 )
+	{
+	  gpi2_tune_rules[gpi2_tune_nrules].coll = GPI2_TUNE_BARRIER;
+
+	  if( strcmp (alg, "dissemination") == 0 )
+	    {
+	      value = GASPI_BARRIER_DISSEMINATION;
+	    }
+	  else if( strcmp (alg, "node") == 0 )
+	    {
+	      value = GASPI_BARRIER_NODE;
+	    }
+	}
+      else if( strcmp (coll, "allreduce") == 0 )
+	{
+	  char *end;
+
+	  gpi2_tune_rules[gpi2_tune_nrules].coll = GPI2_TUNE_ALLREDUCE;
+
+	  value = strtol (alg, &end, 10);
+	  if( *end != '\0' )
+	    {
+	      value = -1;
+	    }
+	}
+
+      if( value < 0 )
+	{
+	  gaspi_print_warning ("Ignoring line %d of %s", lineno, tunePtr);
+	  continue;
+	}
+
+      gpi2_tune_rules[gpi2_tune_nrules].min_ranks = min_ranks;
+      gpi2_tune_rules[gpi2_tune_nrules].max_ranks = max_ranks;
+      gpi2_tune_rules[gpi2_tune_nrules].value = value;
+      gpi2_tune_nrules++;
     }
-}
-
-void
-opMaxULongGASPI (void *res, void *localVal, void *dstVal,
-		 const unsigned char cnt)
-{
-  unsigned char i;
 
-  unsigned long *rv = (unsigned long *) res;
-  unsigned long *lv = (unsigned long *) localVal;
-  unsigned long *dv = (unsigned long *) dstVal;
-
-  for (i = 0; i < cnt; i++)
-    {
-      *rv = MAX (*lv, *dv);
-      lv++;
-      dv++;
-      rv++;
-    }
+  fclose (f);
 }
 
-void
-opSumULongGASPI (void *res, void *localVal, void *dstVal,
-		 const unsigned char cnt)
+long
+gaspi_coll_tuning_lookup (const gaspi_tune_coll_t coll, const int ranks)
 {
-  unsigned char i;
-
-  unsigned long *rv = (unsigned long *) res;
-  unsigned long *lv = (unsigned long *) localVal;
-  unsigned long *dv = (unsigned long *) dstVal;
+  int i;
 
-  for (i = 0; i < cnt; i++)
+  for(i = 0; i < gpi2_tune_nrules; i++)
     {
-      *rv = *lv + *dv;
-      lv++;
-      dv++;
-      rv++;
+      if( gpi2_tune_rules[i].coll == coll
+	  && ranks >= gpi2_tune_rules[i].min_ranks
+	  && ranks <= gpi2_tune_rules[i].max_ranks )
+	{
+	  return gpi2_tune_rules[i].value;
+	}
     }
-}
 
-void
-gaspi_init_collectives (void)
-{
-  fctArrayGASPI[0] = &opMinIntGASPI;
-  fctArrayGASPI[1] = &opMinUIntGASPI;
-  fctArrayGASPI[2] = &opMinFloatGASPI;
-  fctArrayGASPI[3] = &opMinDoubleGASPI;
-  fctArrayGASPI[4] = &opMinLongGASPI;
-  fctArrayGASPI[5] = &opMinULongGASPI;
-  fctArrayGASPI[6] = &opMaxIntGASPI;
-  fctArrayGASPI[7] = &opMaxUIntGASPI;
-  fctArrayGASPI[8] = &opMaxFloatGASPI;
-  fctArrayGASPI[9] = &opMaxDoubleGASPI;
-  fctArrayGASPI[10] = &opMaxLongGASPI;
-  fctArrayGASPI[11] = &opMaxULongGASPI;
-  fctArrayGASPI[12] = &opSumIntGASPI;
-  fctArrayGASPI[13] = &opSumIntGASPI;
-  fctArrayGASPI[14] = &opSumFloatGASPI;
-  fctArrayGASPI[15] = &opSumDoubleGASPI;
-  fctArrayGASPI[16] = &opSumLongGASPI;
-  fctArrayGASPI[17] = &opSumULongGASPI;
+  return -1;
 }
@@ -52,9 +52,42 @@ struct redux_args
   } f_args;
 };
 
-void (*fctArrayGASPI[GASPI_COLL_OP_TYPES]) (void *, void *, void *, const unsigned char cnt);
+typedef void (*gaspi_redux_fct_t) (void *, void *, void *, const gaspi_number_t cnt);
+
+/* The kernels of the pre-defined operations selected for the running
+   CPU, one per operation and type (GPI2_Coll.c) */
+extern gaspi_redux_fct_t fctArrayGASPI[GASPI_COLL_OP_TYPES];
+
+/* The kernel of operation op on type */
+static inline gaspi_redux_fct_t
+gaspi_redux_fct (const gaspi_operation_t op, const gaspi_datatype_t type)
+{
+  return fctArrayGASPI[op * (GASPI_TYPE_ULONG + 1) + type];
+}
 
 void
 gaspi_init_collectives (void);
 
+/* Decision table of the blocking barrier and allreduce, read from the
+   file named by GASPI_COLL_TUNING. A rule applies to groups of
+   min_ranks to max_ranks ranks, the first matching rule wins:
+
+     barrier   <min_ranks> <max_ranks> dissemination|node
+     allreduce <min_ranks> <max_ranks> <bytes>
+
+   where the allreduce switches to reduce-scatter/allgather from bytes
+   on. Lines starting with # are comments. */
+typedef enum
+  {
+    GPI2_TUNE_BARRIER,
+    GPI2_TUNE_ALLREDUCE
+  } gaspi_tune_coll_t;
+
+void
+gaspi_init_coll_tuning (void);
+
+/* The value of the rule for a group of ranks ranks, -1 if none */
+long
+gaspi_coll_tuning_lookup (const gaspi_tune_coll_t coll, const int ranks);
+
 #endif //_GPI2_COLL_H_
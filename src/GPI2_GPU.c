@@ -282,7 +282,7 @@ pgaspi_gpu_write(const gaspi_segment_id_t segment_id_local,
       return gaspi_write(segment_id_local, offset_local, rank, segment_id_remote, offset_remote, size, queue, timeout_ms);
     }
 
-  if(lock_gaspi_tout (&glb_gaspi_ctx.lockC[queue], timeout_ms))
+  if(lock_gaspi_tout (&glb_gaspi_ctx.queues[queue].lock, timeout_ms))
     return GASPI_TIMEOUT;
 
   char* host_ptr = (char*)(glb_gaspi_ctx.rrmd[segment_id_local][glb_gaspi_ctx.rank].host_ptr + NOTIFY_OFFSET + offset_local);
@@ -314,11 +314,11 @@ pgaspi_gpu_write(const gaspi_segment_id_t segment_id_local,
 
 	  if( cudaMemcpyAsync(host_ptr + gpu_offset, device_ptr + gpu_offset, copy_size, cudaMemcpyDeviceToHost, agpu->streams[queue]))
 	    {
-	      unlock_gaspi(&glb_gaspi_ctx.lockC[queue]);
+	      unlock_gaspi(&glb_gaspi_ctx.queues[queue].lock);
 	      return GASPI_ERROR;
 	    }
 
-	  glb_gaspi_ctx.ne_count_c[queue]++;
+	  __sync_fetch_and_add (&glb_gaspi_ctx.queues[queue].ne_count, 1);
 
 	  agpu->events[queue][i].segment_remote = segment_id_remote;
 	  agpu->events[queue][i].segment_local = segment_id_local;
@@ -332,7 +332,7 @@ pgaspi_gpu_write(const gaspi_segment_id_t segment_id_local,
 	  if(err != cudaSuccess)
 	    {
 	      glb_gaspi_ctx.qp_state_vec[queue][rank] = GASPI_STATE_CORRUPT;
-	      unlock_gaspi(&glb_gaspi_ctx.lockC[queue]);
+	      unlock_gaspi(&glb_gaspi_ctx.queues[queue].lock);
 	      return GASPI_ERROR;
 	    }
 
@@ -349,7 +349,7 @@ pgaspi_gpu_write(const gaspi_segment_id_t segment_id_local,
 	      do
 		{
 		  ne = ibv_poll_cq (glb_gaspi_ctx_ib.scqC[queue], 1, &wc);
-		  glb_gaspi_ctx.ne_count_c[queue] -= ne;
+		  __sync_fetch_and_sub (&glb_gaspi_ctx.queues[queue].ne_count, ne);
 		  if (ne == 0)
 		    {
 		      const gaspi_cycles_t s1 = gaspi_get_cycles ();
@@ -358,7 +358,7 @@ pgaspi_gpu_write(const gaspi_segment_id_t segment_id_local,
 		      const float ms = (float) tdelta * glb_gaspi_ctx.cycles_to_msecs;
 		      if (ms > timeout_ms)
 			{
-			  unlock_gaspi (&glb_gaspi_ctx.lockC[queue]);
+			  unlock_gaspi (&glb_gaspi_ctx.queues[queue].lock);
 			  return GASPI_TIMEOUT;
 			}
 		    }
@@ -379,7 +379,7 @@ pgaspi_gpu_write(const gaspi_segment_id_t segment_id_local,
 		    {
 		      if (_gaspi_event_send(&agpu->events[queue][i],queue))
 			{
-			  unlock_gaspi (&glb_gaspi_ctx.lockC[queue]);
+			  unlock_gaspi (&glb_gaspi_ctx.queues[queue].lock);
 			  return GASPI_ERROR;
 			}
 
@@ -393,13 +393,13 @@ pgaspi_gpu_write(const gaspi_segment_id_t segment_id_local,
 		      const float ms = (float) tdelta * glb_gaspi_ctx.cycles_to_msecs;
 		      if (ms > timeout_ms)
 			{
-			  unlock_gaspi (&glb_gaspi_ctx.lockC[queue]);
+			  unlock_gaspi (&glb_gaspi_ctx.queues[queue].lock);
 			  return GASPI_TIMEOUT;
 			}
 		    }
 		  else
 		    {
-		      unlock_gaspi (&glb_gaspi_ctx.lockC[queue]);
+		      unlock_gaspi (&glb_gaspi_ctx.queues[queue].lock);
 		      return GASPI_ERROR;
 		    }
 		} while(error != cudaSuccess);
@@ -407,7 +407,7 @@ pgaspi_gpu_write(const gaspi_segment_id_t segment_id_local,
 	}
     }
 
-  unlock_gaspi (&glb_gaspi_ctx.lockC[queue]);
+  unlock_gaspi (&glb_gaspi_ctx.queues[queue].lock);
 
   return GASPI_SUCCESS;
 }
@@ -432,7 +432,7 @@ pgaspi_gpu_write_notify(const gaspi_segment_id_t segment_id_local,
       return gaspi_write_notify(segment_id_local, offset_local, rank, segment_id_remote, offset_remote, size,notification_id, notification_value, queue, timeout_ms);
     }
 
-  if(lock_gaspi_tout (&glb_gaspi_ctx.lockC[queue], timeout_ms))
+  if(lock_gaspi_tout (&glb_gaspi_ctx.queues[queue].lock, timeout_ms))
     return GASPI_TIMEOUT;
 
   char *host_ptr = (char*)(glb_gaspi_ctx.rrmd[segment_id_local][glb_gaspi_ctx.rank].host_ptr+NOTIFY_OFFSET+offset_local);
@@ -442,7 +442,7 @@ pgaspi_gpu_write_notify(const gaspi_segment_id_t segment_id_local,
   if( !agpu )
     {
       gaspi_print_error("No GPU found or not initialized (gaspi_init_GPUs).");
-      unlock_gaspi(&glb_gaspi_ctx.lockC[queue]);
+      unlock_gaspi(&glb_gaspi_ctx.queues[queue].lock);
       return GASPI_ERROR;
     }
 
@@ -465,11 +465,11 @@ pgaspi_gpu_write_notify(const gaspi_segment_id_t segment_id_local,
 
 	  if(cudaMemcpyAsync(host_ptr+gpu_offset, device_ptr + gpu_offset, copy_size, cudaMemcpyDeviceToHost, agpu->streams[queue]))
 	    {
-	      unlock_gaspi(&glb_gaspi_ctx.lockC[queue]);
+	      unlock_gaspi(&glb_gaspi_ctx.queues[queue].lock);
 	      return GASPI_ERROR;
 	    }
 
-	  glb_gaspi_ctx.ne_count_c[queue]++;
+	  __sync_fetch_and_add (&glb_gaspi_ctx.queues[queue].ne_count, 1);
 
 	  agpu->events[queue][i].segment_remote = segment_id_remote;
 	  agpu->events[queue][i].segment_local = segment_id_local;
@@ -481,7 +481,7 @@ pgaspi_gpu_write_notify(const gaspi_segment_id_t segment_id_local,
 	  cudaError_t err = cudaEventRecord(agpu->events[queue][i].event,agpu->streams[queue]);
 	  if(err != cudaSuccess)
 	    {
-	      unlock_gaspi(&glb_gaspi_ctx.lockC[queue]);
+	      unlock_gaspi(&glb_gaspi_ctx.queues[queue].lock);
 	      return GASPI_ERROR;
 	    }
 	  /* Thats not beautiful at all, however, else we have a overflow soon in the queue */
@@ -492,7 +492,7 @@ pgaspi_gpu_write_notify(const gaspi_segment_id_t segment_id_local,
 	      do
 		{
 		  ne = ibv_poll_cq (glb_gaspi_ctx_ib.scqC[queue], 1, &wc);
-		  glb_gaspi_ctx.ne_count_c[queue] -= ne;
+		  __sync_fetch_and_sub (&glb_gaspi_ctx.queues[queue].ne_count, ne);
 		  if (ne == 0)
 		    {
 		      const gaspi_cycles_t s1 = gaspi_get_cycles ();
@@ -501,7 +501,7 @@ pgaspi_gpu_write_notify(const gaspi_segment_id_t segment_id_local,
 		      const float ms = (float) tdelta * glb_gaspi_ctx.cycles_to_msecs;
 		      if (ms > timeout_ms)
 			{
-			  unlock_gaspi (&glb_gaspi_ctx.lockC[queue]);
+			  unlock_gaspi (&glb_gaspi_ctx.queues[queue].lock);
 			  return GASPI_TIMEOUT;
 			}
 		    }
@@ -528,7 +528,7 @@ pgaspi_gpu_write_notify(const gaspi_segment_id_t segment_id_local,
 		    {
 		      if (_gaspi_event_send(&agpu->events[queue][i],queue) )
 			{
-			  unlock_gaspi (&glb_gaspi_ctx.lockC[queue]);
+			  unlock_gaspi (&glb_gaspi_ctx.queues[queue].lock);
 			  return GASPI_ERROR;
 			}
 
@@ -542,13 +542,13 @@ pgaspi_gpu_write_notify(const gaspi_segment_id_t segment_id_local,
 		      const float ms = (float) tdelta * glb_gaspi_ctx.cycles_to_msecs;
 		      if (ms > timeout_ms)
 			{
-			  unlock_gaspi (&glb_gaspi_ctx.lockC[queue]);
+			  unlock_gaspi (&glb_gaspi_ctx.queues[queue].lock);
 			  return GASPI_TIMEOUT;
 			}
 		    }
 		  else
 		    {
-		      unlock_gaspi (&glb_gaspi_ctx.lockC[queue]);
+		      unlock_gaspi (&glb_gaspi_ctx.queues[queue].lock);
 		      return GASPI_ERROR;
 		    }
 		} while(error != cudaSuccess);
@@ -588,13 +588,13 @@ pgaspi_gpu_write_notify(const gaspi_segment_id_t segment_id_local,
   if (ibv_post_send (glb_gaspi_ctx_ib.qpC[queue][rank], &swrN, &bad_wr))
     {
       glb_gaspi_ctx.qp_state_vec[queue][rank] = GASPI_STATE_CORRUPT;
-      unlock_gaspi (&glb_gaspi_ctx.lockC[queue]);
+      unlock_gaspi (&glb_gaspi_ctx.queues[queue].lock);
       return GASPI_ERROR;
     }
 
-  glb_gaspi_ctx.ne_count_c[queue]++;
+  __sync_fetch_and_add (&glb_gaspi_ctx.queues[queue].ne_count, 1);
 
-  unlock_gaspi (&glb_gaspi_ctx.lockC[queue]);
+  unlock_gaspi (&glb_gaspi_ctx.queues[queue].lock);
 
   return GASPI_SUCCESS;
 }
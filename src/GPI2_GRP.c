@@ -15,7 +15,9 @@ GNU General Public License for more details.
 You should have received a copy of the GNU General Public License
 along with GPI-2. If not, see <http://www.gnu.org/licenses/>.
 */
+#include <fcntl.h>
 #include <stdint.h>
+#include <sys/stat.h>
 #include <sys/timeb.h>
 #include <sys/mman.h>
 #include <unistd.h>
@@ -28,11 +30,15 @@ along with GPI-2. If not, see <http://www.gnu.org/licenses/>.
 #include "GPI2_SN.h"
 #include "GPI2_Utility.h"
 
+extern gaspi_config_t glb_gaspi_cfg;
+
 const unsigned int glb_gaspi_typ_size[6] = { 4, 4, 4, 8, 8, 8 };
 
 static inline gaspi_return_t
 _gaspi_release_group_mem(const gaspi_group_t group)
 {
+  pgaspi_group_node_release(group);
+
   if( glb_gaspi_group_ctx[group].rrcd != NULL )
     {
 
@@ -105,6 +111,7 @@ pgaspi_group_create (gaspi_group_t * const group)
 
   glb_gaspi_group_ctx[id].gl.lock = 0;
   glb_gaspi_group_ctx[id].del.lock = 0;
+  glb_gaspi_group_ctx[id].nbc_lock.lock = 0;
 
   /* TODO: dynamic space (re-)allocation to avoid reservation for all nodes */
   /* or maybe gaspi_group_create should have the number of ranks as input ? */
@@ -180,6 +187,10 @@ pgaspi_group_delete (const gaspi_group_t group)
   if(group == GASPI_GROUP_ALL)
     return GASPI_ERR_INV_GROUP;
 
+  /* non-blocking collectives still use the group buffer */
+  if(glb_gaspi_group_ctx[group].nbc_issued != glb_gaspi_group_ctx[group].nbc_released)
+    return GASPI_ERR_ACTIVE_COLL;
+
   lock_gaspi_tout (&glb_gaspi_ctx_lock, GASPI_BLOCK);
   lock_gaspi_tout (&glb_gaspi_group_ctx[group].del, GASPI_BLOCK);
 
@@ -471,550 +482,4488 @@ pgaspi_allreduce_elem_max (gaspi_number_t * const elem_max)
   return GASPI_SUCCESS;
 }
 
-/* Group collectives */
-#pragma weak gaspi_barrier = pgaspi_barrier
-gaspi_return_t
-pgaspi_barrier (const gaspi_group_t g, const gaspi_timeout_t timeout_ms)
+/* Reap completed writes of the collectives queue, which all groups,
+   the non-blocking collectives and the atomics share: one thread
+   polls at a time and the count of requests in flight changes
+   atomically. */
+static inline gaspi_return_t
+_gaspi_coll_poll (void)
 {
-  gaspi_verify_init("gaspi_barrier");
-  gaspi_verify_group(g);
+  lock_gaspi (&glb_gaspi_ctx.lockGRP);
 
-  gaspi_return_t eret = GASPI_ERROR;
+  const int pret = pgaspi_dev_poll_groups();
+  if( pret > 0 )
+    {
+      __sync_fetch_and_sub(&glb_gaspi_ctx.ne_count_grp, pret);
+    }
 
-  GPI2_STATS_START_TIMER(GASPI_BARRIER_TIMER);
+  unlock_gaspi (&glb_gaspi_ctx.lockGRP);
 
-  if(lock_gaspi_tout (&glb_gaspi_group_ctx[g].gl, timeout_ms))
+  return (pret < 0) ? GASPI_ERR_DEVICE : GASPI_SUCCESS;
+}
+
+/* Helpers for the collectives below: post a write (and connect or
+   commit on demand) to group member dst and wait on a completion flag
+   in the local collective buffer. Writes are posted without waiting,
+   but at most half a queue depth of them stay in flight (with
+   GASPI_TEST, GASPI_TIMEOUT tells to retry once some completed). */
+static inline gaspi_return_t
+_gaspi_coll_prepare (const gaspi_group_t g,
+		     const int dst,
+		     const gaspi_timeout_t timeout_ms)
+{
+  gaspi_return_t eret = GASPI_ERROR;
+
+  if( GASPI_ENDPOINT_DISCONNECTED == glb_gaspi_ctx.ep_conn[dst].cstat )
     {
-      return GASPI_TIMEOUT;
+      if( (eret = pgaspi_connect((gaspi_rank_t) dst, timeout_ms)) != GASPI_SUCCESS )
+	{
+	  gaspi_print_error("Failed to connect to rank %u", dst);
+	  return eret;
+	}
     }
 
-  if(!(glb_gaspi_group_ctx[g].coll_op & GASPI_BARRIER))
+  if( !glb_gaspi_group_ctx[g].committed_rank[dst] )
     {
-      unlock_gaspi (&glb_gaspi_group_ctx[g].gl);
-      return GASPI_ERR_ACTIVE_COLL;
+      if( (eret = _pgaspi_group_commit_to(g, dst, timeout_ms)) != GASPI_SUCCESS )
+	{
+	  gaspi_print_error("Failed to commit to rank %u", dst);
+	  return eret;
+	}
     }
 
-  glb_gaspi_group_ctx[g].coll_op = GASPI_BARRIER;
+  /* keep the number of requests in flight within the queue depth */
+  while( glb_gaspi_ctx.ne_count_grp >= (int) glb_gaspi_cfg.queue_depth / 2 )
+    {
+      if( _gaspi_coll_poll() != GASPI_SUCCESS )
+	{
+	  return GASPI_ERR_DEVICE;
+	}
 
-  int index;
+      if( timeout_ms == GASPI_TEST
+	  && glb_gaspi_ctx.ne_count_grp >= (int) glb_gaspi_cfg.queue_depth / 2 )
+	{
+	  return GASPI_TIMEOUT;
+	}
+    }
 
-  const int size = glb_gaspi_group_ctx[g].tnc;
+  return GASPI_SUCCESS;
+}
 
-  if(glb_gaspi_group_ctx[g].lastmask == 0x1)
+static inline gaspi_return_t
+_gaspi_coll_post_write (const gaspi_group_t g,
+			const int dst,
+			void * const local_addr,
+			const int length,
+			const unsigned long remote_offset,
+			const gaspi_timeout_t timeout_ms)
+{
+  gaspi_return_t eret = GASPI_ERROR;
+
+  if( (eret = _gaspi_coll_prepare(g, dst, timeout_ms)) != GASPI_SUCCESS )
     {
-      glb_gaspi_group_ctx[g].barrier_cnt++;
+      return eret;
     }
 
-  unsigned char *barrier_ptr =
-    glb_gaspi_group_ctx[g].rrcd[glb_gaspi_ctx.rank].data.buf + 2 * size + glb_gaspi_group_ctx[g].togle;
+  if( pgaspi_dev_post_group_write(local_addr, length, dst,
+				  (void *) (glb_gaspi_group_ctx[g].rrcd[dst].data.addr + remote_offset),
+				  g) != 0 )
+    {
+      glb_gaspi_ctx.qp_state_vec[GASPI_COLL_QP][dst] = GASPI_STATE_CORRUPT;
+      return GASPI_ERR_DEVICE;
+    }
 
-  barrier_ptr[0] = glb_gaspi_group_ctx[g].barrier_cnt;
+  __sync_fetch_and_add(&glb_gaspi_ctx.ne_count_grp, 1);
 
-  volatile unsigned char *rbuf =
-    (volatile unsigned char *) (glb_gaspi_group_ctx[g].rrcd[glb_gaspi_ctx.rank].data.buf);
+  return GASPI_SUCCESS;
+}
 
-  const int rank = glb_gaspi_group_ctx[g].rank;
+/* Same between user segments (same segment and offset on both sides),
+   in pieces the device can handle */
+#define GPI2_COLL_MAX_WRITE (1UL << 30)
 
-  int mask = glb_gaspi_group_ctx[g].lastmask&0x7fffffff;
-  int jmp = glb_gaspi_group_ctx[g].lastmask>>31;
+static inline gaspi_return_t
+_gaspi_coll_post_seg_write (const gaspi_group_t g,
+			    const int dst,
+			    const gaspi_segment_id_t seg,
+			    const gaspi_offset_t offset,
+			    const gaspi_size_t size,
+			    const gaspi_timeout_t timeout_ms)
+{
+  gaspi_size_t done;
+  gaspi_return_t eret = GASPI_ERROR;
 
-  const gaspi_cycles_t s0 = gaspi_get_cycles();
+  gaspi_verify_remote_off(offset, seg, dst, size);
 
-  while (mask < size)
+  if( (eret = _gaspi_coll_prepare(g, dst, timeout_ms)) != GASPI_SUCCESS )
     {
-      const int dst = glb_gaspi_group_ctx[g].rank_grp[(rank + mask) % size];
-      const int src = (rank - mask + size) % size;
-
-      if(jmp)
-	{
-	  jmp = 0;
-	  goto B0;
-	}
-      if( GASPI_ENDPOINT_DISCONNECTED == glb_gaspi_ctx.ep_conn[dst].cstat )
-	if( ( eret = pgaspi_connect((gaspi_rank_t) dst, timeout_ms)) != GASPI_SUCCESS )
-	  {
-	    gaspi_print_error("Failed to connect to rank %u", dst);
-	    unlock_gaspi (&glb_gaspi_group_ctx[g].gl);
-	    return eret;
-	  }
+      return eret;
+    }
 
-      if( !glb_gaspi_group_ctx[g].committed_rank[dst] )
-	{
-	  if( ( eret = _pgaspi_group_commit_to(g, dst, timeout_ms)) != GASPI_SUCCESS )
-	    {
-	      gaspi_print_error("Failed to commit to rank %u", dst);
-	      unlock_gaspi (&glb_gaspi_group_ctx[g].gl);
-	      return eret;
-	    }
-	}
+  for(done = 0; done < size; done += GPI2_COLL_MAX_WRITE)
+    {
+      const unsigned int length = (unsigned int) MIN(GPI2_COLL_MAX_WRITE, size - done);
 
-      if(pgaspi_dev_post_group_write((void *)barrier_ptr, 1, dst,
-				     (void *) (glb_gaspi_group_ctx[g].rrcd[dst].data.addr + (2 * rank + glb_gaspi_group_ctx[g].togle)),
-				     g) != 0)
+      if( pgaspi_dev_post_group_segment_write(seg, offset + done, dst,
+					      seg, offset + done, length) != 0 )
 	{
 	  glb_gaspi_ctx.qp_state_vec[GASPI_COLL_QP][dst] = GASPI_STATE_CORRUPT;
-	  unlock_gaspi (&glb_gaspi_group_ctx[g].gl);
 	  return GASPI_ERR_DEVICE;
 	}
-      glb_gaspi_ctx.ne_count_grp++;
 
-    B0:
-      index = 2 * src + glb_gaspi_group_ctx[g].togle;
+      __sync_fetch_and_add(&glb_gaspi_ctx.ne_count_grp, 1);
+    }
 
-      while (rbuf[index] != glb_gaspi_group_ctx[g].barrier_cnt)
-	{
-	  //here we check for timeout to avoid active polling
-	  const gaspi_cycles_t s1 = gaspi_get_cycles();
-	  const gaspi_cycles_t tdelta = s1 - s0;
-	  const float ms = (float) tdelta * glb_gaspi_ctx.cycles_to_msecs;
+  return GASPI_SUCCESS;
+}
 
-	  if(ms > timeout_ms)
-	    {
-	      glb_gaspi_group_ctx[g].lastmask = mask|0x80000000;
-	      unlock_gaspi (&glb_gaspi_group_ctx[g].gl);
-	      return GASPI_TIMEOUT;
-	    }
-	  // gaspi_delay ();
-	}
+/* From a user segment into the group buffer of dst */
+static inline gaspi_return_t
+_gaspi_coll_post_seg_buf_write (const gaspi_group_t g,
+				const int dst,
+				const gaspi_segment_id_t seg,
+				const gaspi_offset_t offset,
+				const unsigned int length,
+				const unsigned long remote_offset,
+				const gaspi_timeout_t timeout_ms)
+{
+  gaspi_return_t eret = GASPI_ERROR;
 
-      mask <<= 1;
-    } //while...
+  if( (eret = _gaspi_coll_prepare(g, dst, timeout_ms)) != GASPI_SUCCESS )
+    {
+      return eret;
+    }
 
-  const int pret = pgaspi_dev_poll_groups();
-  if (pret < 0)
+  if( pgaspi_dev_post_group_segment_buf_write(seg, offset, dst, g, remote_offset, length) != 0 )
     {
-      unlock_gaspi (&glb_gaspi_group_ctx[g].gl);
+      glb_gaspi_ctx.qp_state_vec[GASPI_COLL_QP][dst] = GASPI_STATE_CORRUPT;
       return GASPI_ERR_DEVICE;
     }
 
-  glb_gaspi_ctx.ne_count_grp -= pret;
+  __sync_fetch_and_add(&glb_gaspi_ctx.ne_count_grp, 1);
 
-  glb_gaspi_group_ctx[g].togle = (glb_gaspi_group_ctx[g].togle ^ 0x1);
-  glb_gaspi_group_ctx[g].coll_op = GASPI_NONE;
-  glb_gaspi_group_ctx[g].lastmask = 0x1;
+  return GASPI_SUCCESS;
+}
 
-  GPI2_STATS_INC_COUNT(GASPI_STATS_COUNTER_NUM_BARRIER, 1);
-  GPI2_STATS_STOP_TIMER(GASPI_BARRIER_TIMER);
-  GPI2_STATS_INC_TIMER(GASPI_STATS_TIME_BARRIER, GPI2_STATS_GET_TIMER(GASPI_BARRIER_TIMER));
+static inline gaspi_return_t
+_gaspi_coll_wait_flag (volatile unsigned int * const flag,
+		       const unsigned int val,
+		       const gaspi_cycles_t s0,
+		       const gaspi_timeout_t timeout_ms)
+{
+  while( *flag != val )
+    {
+      const gaspi_cycles_t s1 = gaspi_get_cycles();
+      const gaspi_cycles_t tdelta = s1 - s0;
+      const float ms = (float) tdelta * glb_gaspi_ctx.cycles_to_msecs;
 
-  unlock_gaspi (&glb_gaspi_group_ctx[g].gl);
+      if( ms > timeout_ms )
+	{
+	  return GASPI_TIMEOUT;
+	}
+    }
 
   return GASPI_SUCCESS;
 }
+
+/* As above for a counter that only grows (modulo wrap-around) */
 static inline gaspi_return_t
-_gaspi_allreduce (const gaspi_pointer_t buf_send,
-		  gaspi_pointer_t const buf_recv,
-		  const gaspi_number_t elem_cnt,
-		  struct redux_args *r_args,
-		  const gaspi_group_t g,
-		  const gaspi_timeout_t timeout_ms)
+_gaspi_coll_wait_count (volatile unsigned int * const cnt,
+			const unsigned int val,
+			const gaspi_cycles_t s0,
+			const gaspi_timeout_t timeout_ms)
 {
-  int idst, dst, bid = 0;
-  int mask, tmprank, tmpdst;
+  while( (int) (*cnt - val) < 0 )
+    {
+      const gaspi_cycles_t s1 = gaspi_get_cycles();
+      const gaspi_cycles_t tdelta = s1 - s0;
+      const float ms = (float) tdelta * glb_gaspi_ctx.cycles_to_msecs;
 
-  gaspi_return_t eret = GASPI_ERROR;
+      if( ms > timeout_ms )
+	{
+	  return GASPI_TIMEOUT;
+	}
+    }
 
-  const int dsize = r_args->elem_size * elem_cnt;
+  return GASPI_SUCCESS;
+}
 
-  if( glb_gaspi_group_ctx[g].level == 0 )
+/* Wait until all writes posted to the collectives queue completed,
+   i.e. until their local buffers may be reused */
+static inline gaspi_return_t
+_gaspi_coll_drain (const gaspi_cycles_t s0, const gaspi_timeout_t timeout_ms)
+{
+  while( glb_gaspi_ctx.ne_count_grp > 0 )
     {
-      glb_gaspi_group_ctx[g].barrier_cnt++;
-    }
+      if( _gaspi_coll_poll() != GASPI_SUCCESS )
+	{
+	  return GASPI_ERR_DEVICE;
+	}
 
-  const int size = glb_gaspi_group_ctx[g].tnc;
-  const int rank = glb_gaspi_group_ctx[g].rank;
+      const gaspi_cycles_t s1 = gaspi_get_cycles();
+      const gaspi_cycles_t tdelta = s1 - s0;
+      const float ms = (float) tdelta * glb_gaspi_ctx.cycles_to_msecs;
 
-  unsigned char *barrier_ptr = glb_gaspi_group_ctx[g].rrcd[glb_gaspi_ctx.rank].data.buf + 2 * size + glb_gaspi_group_ctx[g].togle;
-  barrier_ptr[0] = glb_gaspi_group_ctx[g].barrier_cnt;
+      if( glb_gaspi_ctx.ne_count_grp > 0 && ms > timeout_ms )
+	{
+	  return GASPI_TIMEOUT;
+	}
+    }
 
-  volatile unsigned char *poll_buf = (volatile unsigned char *) (glb_gaspi_group_ctx[g].rrcd[glb_gaspi_ctx.rank].data.buf);
+  return GASPI_SUCCESS;
+}
 
-  unsigned char *send_ptr = glb_gaspi_group_ctx[g].rrcd[glb_gaspi_ctx.rank].data.buf + COLL_MEM_SEND + (glb_gaspi_group_ctx[g].togle * 18 * GPI2_REDUX_BUF_SIZE);
-  memcpy (send_ptr, buf_send, dsize);
+static inline void
+_gaspi_redux_apply (struct redux_args * const r_args,
+		    void * const res,
+		    void * const local_val,
+		    void * const dst_val,
+		    const gaspi_number_t cnt,
+		    const gaspi_timeout_t timeout_ms)
+{
+  if( r_args->f_type == GASPI_OP )
+    {
+      gaspi_redux_fct (r_args->f_args.op, r_args->f_args.type) (res, local_val, dst_val, cnt);
+    }
+  else if( r_args->f_type == GASPI_USER )
+    {
+      r_args->f_args.user_fct (local_val, dst_val, res, r_args->f_args.rstate,
+			       cnt, r_args->elem_size, timeout_ms);
+    }
+}
 
-  unsigned char *recv_ptr = glb_gaspi_group_ctx[g].rrcd[glb_gaspi_ctx.rank].data.buf + COLL_MEM_RECV;
+/* Group collectives */
 
-  const int rest = size - glb_gaspi_group_ctx[g].next_pof2;
+/* Node level of the barrier: members of a group running on the same
+   host synchronise through a shared memory segment and only one
+   leader per host (the member with the lowest group rank) takes part
+   in the dissemination over the network. */
+struct node_member
+{
+  const char *hn;
+  int idx;
+};
 
-  const gaspi_cycles_t s0 = gaspi_get_cycles();
+static int
+gaspi_comp_node_member (const void *a, const void *b)
+{
+  const struct node_member *ma = (const struct node_member *) a;
+  const struct node_member *mb = (const struct node_member *) b;
 
-  if(glb_gaspi_group_ctx[g].level >= 2)
+  const int c = strcmp (ma->hn, mb->hn);
+  if( c != 0 )
     {
-      tmprank = glb_gaspi_group_ctx[g].tmprank;
-      bid = glb_gaspi_group_ctx[g].bid;
-      send_ptr += glb_gaspi_group_ctx[g].dsize;
-      //goto L2;
-      if(glb_gaspi_group_ctx[g].level==2) goto L2;
-      else if(glb_gaspi_group_ctx[g].level==3) goto L3;
+      return c;
     }
 
-  if(rank < 2 * rest)
+  return ma->idx - mb->idx;
+}
+
+static gaspi_return_t
+_gaspi_group_node_topology (const gaspi_group_t g)
+{
+  int i, k, first, leader = -1;
+  gaspi_group_ctx * const grp_ctx = &(glb_gaspi_group_ctx[g]);
+
+  struct node_member *members = (struct node_member *) malloc (grp_ctx->tnc * sizeof (struct node_member));
+  int *node_of = (int *) malloc (grp_ctx->tnc * sizeof (int));
+  grp_ctx->node_leaders = (int *) malloc (grp_ctx->tnc * sizeof (int));
+  grp_ctx->node_first = (int *) calloc (grp_ctx->tnc + 1, sizeof (int));
+  grp_ctx->node_members = (int *) malloc (grp_ctx->tnc * sizeof (int));
+  if( members == NULL || node_of == NULL || grp_ctx->node_leaders == NULL
+      || grp_ctx->node_first == NULL || grp_ctx->node_members == NULL )
     {
-      if(rank % 2 == 0)
-	{
-	  dst = glb_gaspi_group_ctx[g].rank_grp[rank + 1];
+      free (members);
+      free (node_of);
+      pgaspi_group_node_release (g);
+      return GASPI_ERR_MEMALLOC;
+    }
 
-	  if( GASPI_ENDPOINT_DISCONNECTED == glb_gaspi_ctx.ep_conn[dst].cstat )
-	    if( (eret = pgaspi_connect((gaspi_rank_t) dst, timeout_ms)) != GASPI_SUCCESS)
-	      {
-		gaspi_print_error("Failed to connect to rank %u", dst);
-		return eret;
-	      }
+  for(i = 0; i < grp_ctx->tnc; i++)
+    {
+      members[i].hn = gaspi_get_hn (grp_ctx->rank_grp[i]);
+      members[i].idx = i;
+    }
 
-	  if( !glb_gaspi_group_ctx[g].committed_rank[dst] )
-	    {
-	      if( (eret = _pgaspi_group_commit_to(g, dst, timeout_ms)) != GASPI_SUCCESS )
-		{
-		  gaspi_print_error("Failed to commit to rank %u", dst);
-		  unlock_gaspi (&glb_gaspi_group_ctx[g].gl);
-		  return eret;
-		}
-	    }
+  qsort (members, grp_ctx->tnc, sizeof (struct node_member), gaspi_comp_node_member);
 
-	  if(pgaspi_dev_post_group_write(send_ptr,
-					 dsize,
-					 dst,
-					 (void *)(glb_gaspi_group_ctx[g].rrcd[dst].data.addr + (COLL_MEM_RECV + (2 * bid + glb_gaspi_group_ctx[g].togle) * GPI2_REDUX_BUF_SIZE)),
-					 g) != 0)
+  /* runs of equal host names form the nodes */
+  grp_ctx->nnodes = 0;
+  for(first = 0; first < grp_ctx->tnc; first = i)
+    {
+      for(i = first; i < grp_ctx->tnc; i++)
+	{
+	  if( strcmp (members[i].hn, members[first].hn) != 0 )
 	    {
-	      glb_gaspi_ctx.qp_state_vec[GASPI_COLL_QP][dst] = GASPI_STATE_CORRUPT;
-	      return GASPI_ERR_DEVICE;
+	      break;
 	    }
 
-	  if(pgaspi_dev_post_group_write(barrier_ptr, 1, dst,
-					 (void *)(glb_gaspi_group_ctx[g].rrcd[dst].data.addr + (2 * rank + glb_gaspi_group_ctx[g].togle)),
-					 g) != 0)
+	  if( members[i].idx == grp_ctx->rank )
 	    {
-	      glb_gaspi_ctx.qp_state_vec[GASPI_COLL_QP][dst] = GASPI_STATE_CORRUPT;
-	      return GASPI_ERR_DEVICE;
+	      leader = members[first].idx;
+	      grp_ctx->local_idx = i - first;
 	    }
-	  glb_gaspi_ctx.ne_count_grp+=2;
-	  tmprank = -1;
 	}
-      else
+
+      if( leader == members[first].idx )
 	{
+	  grp_ctx->nlocal = i - first;
+	}
 
-	  dst = 2 * (rank - 1) + glb_gaspi_group_ctx[g].togle;
-	  while (poll_buf[dst] != glb_gaspi_group_ctx[g].barrier_cnt)
-	    {
-	      //timeout...
-	      const gaspi_cycles_t s1 = gaspi_get_cycles();
-	      const gaspi_cycles_t tdelta = s1 - s0;
-	      const float ms = (float) tdelta * glb_gaspi_ctx.cycles_to_msecs;
+      grp_ctx->node_leaders[grp_ctx->nnodes++] = members[first].idx;
+    }
 
-	      if(ms > timeout_ms)
-		{
-		  glb_gaspi_group_ctx[g].level = 1;
+  qsort (grp_ctx->node_leaders, grp_ctx->nnodes, sizeof (int), gaspi_comp_ranks);
 
-		  return GASPI_TIMEOUT;
-		}
+  for(i = 0; i < grp_ctx->nnodes; i++)
+    {
+      if( grp_ctx->node_leaders[i] == leader )
+	{
+	  grp_ctx->node_idx = i;
+	}
+    }
 
-	      //gaspi_delay ();
-	    }
+  /* nodes are numbered in the order of their leaders, list the
+     members of each node in group order */
+  for(first = 0; first < grp_ctx->tnc; first = i)
+    {
+      const int *node = (const int *) bsearch (&members[first].idx, grp_ctx->node_leaders,
+					       grp_ctx->nnodes, sizeof (int), gaspi_comp_ranks);
 
-	  void *dst_val = (void *) (recv_ptr + (2 * bid + glb_gaspi_group_ctx[g].togle) * GPI2_REDUX_BUF_SIZE);
-	  void *local_val = (void *) send_ptr;
-	  send_ptr += dsize;
-	  glb_gaspi_group_ctx[g].dsize+=dsize;
+      for(i = first; i < grp_ctx->tnc && strcmp (members[i].hn, members[first].hn) == 0; i++)
+	{
+	  node_of[members[i].idx] = (int) (node - grp_ctx->node_leaders);
+	  grp_ctx->node_first[node_of[members[i].idx] + 1]++;
+	}
+    }
 
-	  if(r_args->f_type == GASPI_OP)
-	    {
-	      gaspi_operation_t op = r_args->f_args.op;
-	      gaspi_datatype_t type = r_args->f_args.type;
-	      //TODO: magic number
-	      fctArrayGASPI[op * 6 + type] ((void *) send_ptr, local_val, dst_val,elem_cnt);
-	    }
-	  else if(r_args->f_type == GASPI_USER)
-	    {
-	      r_args->f_args.user_fct (local_val, dst_val, (void *) send_ptr, r_args->f_args.rstate, elem_cnt, r_args->elem_size, timeout_ms);
-	    }
+  for(i = 0; i < grp_ctx->nnodes; i++)
+    {
+      grp_ctx->node_first[i + 1] += grp_ctx->node_first[i];
+    }
 
-	  tmprank = rank >> 1;
+  for(i = 0; i < grp_ctx->tnc; i++)
+    {
+      k = node_of[i];
+      grp_ctx->node_members[grp_ctx->node_first[k]++] = i;
+    }
+
+  /* undo the shift of the placement */
+  for(i = grp_ctx->nnodes; i > 0; i--)
+    {
+      grp_ctx->node_first[i] = grp_ctx->node_first[i - 1];
+    }
+  grp_ctx->node_first[0] = 0;
+
+  free (members);
+  free (node_of);
+
+  return GASPI_SUCCESS;
+}
+
+static void
+_gaspi_group_node_shm_name (const gaspi_group_t g, char *name, const size_t len)
+{
+  const gaspi_group_ctx * const grp_ctx = &(glb_gaspi_group_ctx[g]);
+
+  snprintf (name, len, "/dev/shm/gpi2-%u-%u-%d-%d",
+	    (unsigned int) getuid (), glb_gaspi_cfg.sn_port, g,
+	    grp_ctx->rank_grp[grp_ctx->node_leaders[grp_ctx->node_idx]]);
+}
+
+/* Shared memory used by alltoall on a node: a flag per local member
+   telling it entered and one telling its blocks are staged, a flag
+   telling the leader received the blocks of the other nodes and the
+   block sizes of every local member (for two calls). The staging
+   area follows, see _gaspi_alltoall_stage. */
+static inline size_t
+_gaspi_alltoall_node_size (const int nlocal, const int tnc)
+{
+  return (2 * nlocal + 1) * GPI2_NODE_FLAG_STRIDE
+    + 2 * nlocal * 2 * tnc * sizeof (gaspi_size_t);
+}
+
+static inline size_t
+_gaspi_page_align (const size_t size)
+{
+  const size_t page = (size_t) sysconf (_SC_PAGESIZE);
+
+  return (size + page - 1) / page * page;
+}
+
+/* Leader creates the segment, the other local members attach to it.
+   The barrier flags are followed by the alltoall area. The file is
+   kept open to grow the staging area after it. */
+static void
+_gaspi_group_node_shm_map (const gaspi_group_t g, const int create)
+{
+  char name[128];
+  gaspi_group_ctx * const grp_ctx = &(glb_gaspi_group_ctx[g]);
+
+  const size_t flags_size = (grp_ctx->nlocal + 1) * GPI2_NODE_FLAG_STRIDE;
+  const size_t size =
+    _gaspi_page_align (flags_size + _gaspi_alltoall_node_size (grp_ctx->nlocal, grp_ctx->tnc));
+
+  _gaspi_group_node_shm_name (g, name, sizeof (name));
+
+  if( create )
+    {
+      unlink (name);
+    }
+
+  const int fd = open (name, create ? (O_RDWR | O_CREAT | O_EXCL) : O_RDWR, S_IRUSR | S_IWUSR);
+  if( fd < 0 )
+    {
+      gaspi_print_error ("Failed to open %s", name);
+      return;
+    }
+
+  if( create && ftruncate (fd, size) != 0 )
+    {
+      gaspi_print_error ("Failed to size %s", name);
+      close (fd);
+      unlink (name);
+      return;
+    }
+
+  void *ptr = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+  if( ptr == MAP_FAILED )
+    {
+      gaspi_print_error ("Failed to map %s", name);
+      close (fd);
+      if( create )
+	{
+	  unlink (name);
 	}
+      return;
+    }
 
-      bid++;
+  grp_ctx->node_shm_fd = fd;
+  grp_ctx->node_shm = ptr;
+  grp_ctx->node_shm_size = size;
+  grp_ctx->node_a2a = (unsigned char *) ptr + flags_size;
+  grp_ctx->node_a2a_size = size - flags_size;
+}
+
+/* The staging area of alltoall, for total bytes. It is shared with
+   the other local members through the file of the node area, which
+   only grows (every member asks for the same size), or private when
+   alone on the node. */
+static gaspi_return_t
+_gaspi_alltoall_stage (const gaspi_group_t g, const gaspi_size_t total)
+{
+  gaspi_group_ctx * const grp_ctx = &(glb_gaspi_group_ctx[g]);
+
+  if( total <= grp_ctx->node_stage_size )
+    {
+      return GASPI_SUCCESS;
+    }
+
+  const size_t size = _gaspi_page_align (total);
+  void *ptr = MAP_FAILED;
+
+  if( grp_ctx->node_stage != NULL )
+    {
+      munmap (grp_ctx->node_stage, grp_ctx->node_stage_size);
+      grp_ctx->node_stage = NULL;
+      grp_ctx->node_stage_size = 0;
+    }
+
+  if( grp_ctx->node_shm_fd >= 0 )
+    {
+      const int ret = posix_fallocate (grp_ctx->node_shm_fd, grp_ctx->node_shm_size, size);
+      if( ret != 0 )
+	{
+	  gaspi_print_error ("Failed to allocate %lu bytes of alltoall staging memory (%s)",
+			     size, strerror (ret));
+	  return GASPI_ERROR;
+	}
 
+      ptr = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+		  grp_ctx->node_shm_fd, grp_ctx->node_shm_size);
     }
   else
     {
+      ptr = mmap (NULL, size, PROT_READ | PROT_WRITE,
+		  MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    }
 
-      tmprank = rank - rest;
-      if (rest) bid++;
+  if( ptr == MAP_FAILED )
+    {
+      gaspi_print_error ("Failed to map %lu bytes of alltoall staging memory", size);
+      return GASPI_ERROR;
     }
 
-  glb_gaspi_group_ctx[g].tmprank = tmprank;
-  glb_gaspi_group_ctx[g].bid = bid;
-  glb_gaspi_group_ctx[g].level = 2;
+  grp_ctx->node_stage = (unsigned char *) ptr;
+  grp_ctx->node_stage_size = size;
 
-  //second phase
- L2:
+  return GASPI_SUCCESS;
+}
 
-  if (tmprank != -1)
+void
+pgaspi_group_node_release (const gaspi_group_t group)
+{
+  if( glb_gaspi_group_ctx[group].node_stage != NULL )
     {
+      munmap (glb_gaspi_group_ctx[group].node_stage, glb_gaspi_group_ctx[group].node_stage_size);
+      glb_gaspi_group_ctx[group].node_stage = NULL;
+      glb_gaspi_group_ctx[group].node_stage_size = 0;
+    }
 
-      //mask = 0x1;
-      mask = glb_gaspi_group_ctx[g].lastmask & 0x7fffffff;
-      int jmp = glb_gaspi_group_ctx[g].lastmask>>31;
+  if( glb_gaspi_group_ctx[group].node_shm_fd >= 0 )
+    {
+      close (glb_gaspi_group_ctx[group].node_shm_fd);
+      glb_gaspi_group_ctx[group].node_shm_fd = -1;
+    }
 
-      while (mask < glb_gaspi_group_ctx[g].next_pof2)
+  if( glb_gaspi_group_ctx[group].node_shm != NULL )
+    {
+      munmap (glb_gaspi_group_ctx[group].node_shm, glb_gaspi_group_ctx[group].node_shm_size);
+      glb_gaspi_group_ctx[group].node_shm = NULL;
+    }
+  else
+    {
+      free (glb_gaspi_group_ctx[group].node_a2a);
+    }
+
+  glb_gaspi_group_ctx[group].node_a2a = NULL;
+
+  free (glb_gaspi_group_ctx[group].node_leaders);
+  glb_gaspi_group_ctx[group].node_leaders = NULL;
+  free (glb_gaspi_group_ctx[group].node_first);
+  glb_gaspi_group_ctx[group].node_first = NULL;
+  free (glb_gaspi_group_ctx[group].node_members);
+  glb_gaspi_group_ctx[group].node_members = NULL;
+}
+
+/* Dissemination barrier among the group members members[0..size)
+   (all members if members is NULL), idx being our position. The
+   flags at base are indexed by group rank and parity togle, cnt
+   being the value of this barrier. */
+static gaspi_return_t
+_gaspi_barrier_dissemination (const gaspi_group_t g,
+			      const int * const members,
+			      const int size,
+			      const int idx,
+			      const unsigned long base,
+			      const unsigned char cnt,
+			      const int togle,
+			      const gaspi_timeout_t timeout_ms)
+{
+  gaspi_return_t eret = GASPI_ERROR;
+  int index;
+
+  unsigned char *barrier_ptr =
+    glb_gaspi_group_ctx[g].rrcd[glb_gaspi_ctx.rank].data.buf + base + 2 * glb_gaspi_group_ctx[g].tnc + togle;
+
+  barrier_ptr[0] = cnt;
+
+  volatile unsigned char *rbuf =
+    (volatile unsigned char *) (glb_gaspi_group_ctx[g].rrcd[glb_gaspi_ctx.rank].data.buf + base);
+
+  const int rank = glb_gaspi_group_ctx[g].rank;
+
+  int mask = glb_gaspi_group_ctx[g].lastmask&0x7fffffff;
+  int jmp = glb_gaspi_group_ctx[g].lastmask>>31;
+
+  const gaspi_cycles_t s0 = gaspi_get_cycles();
+
+  while (mask < size)
+    {
+      const int idst = (members == NULL) ? (idx + mask) % size : members[(idx + mask) % size];
+      const int dst = glb_gaspi_group_ctx[g].rank_grp[idst];
+      const int src = (members == NULL) ? (idx - mask + size) % size : members[(idx - mask + size) % size];
+
+      if(jmp)
 	{
+	  jmp = 0;
+	  goto B0;
+	}
 
-	  tmpdst = tmprank ^ mask;
-	  idst = (tmpdst < rest) ? tmpdst * 2 + 1 : tmpdst + rest;
-	  dst = glb_gaspi_group_ctx[g].rank_grp[idst];
-	  if(jmp)
+      if( (eret = _gaspi_coll_post_write(g, dst, (void *) barrier_ptr, 1,
+					 base + 2 * rank + togle,
+					 timeout_ms)) != GASPI_SUCCESS )
+	{
+	  return eret;
+	}
+
+    B0:
+      index = 2 * src + togle;
+
+      while (rbuf[index] != cnt)
+	{
+	  //here we check for timeout to avoid active polling
+	  const gaspi_cycles_t s1 = gaspi_get_cycles();
+	  const gaspi_cycles_t tdelta = s1 - s0;
+	  const float ms = (float) tdelta * glb_gaspi_ctx.cycles_to_msecs;
+
+	  if(ms > timeout_ms)
 	    {
-	      jmp = 0;
-	      goto J2;
+	      glb_gaspi_group_ctx[g].lastmask = mask|0x80000000;
+	      return GASPI_TIMEOUT;
 	    }
+	  // gaspi_delay ();
+	}
 
-	  if( GASPI_ENDPOINT_DISCONNECTED == glb_gaspi_ctx.ep_conn[dst].cstat )
-	    if( (eret = pgaspi_connect((gaspi_rank_t) dst, timeout_ms)) != GASPI_SUCCESS)
-	      {
-		gaspi_print_error("Failed to connect to rank %u", dst);
-		return eret;
-	      }
+      mask <<= 1;
+    } //while...
 
-	  if( !glb_gaspi_group_ctx[g].committed_rank[dst] )
+  if( _gaspi_coll_poll() != GASPI_SUCCESS )
+    {
+      return GASPI_ERR_DEVICE;
+    }
+
+  glb_gaspi_group_ctx[g].lastmask = 0x1;
+
+  return GASPI_SUCCESS;
+}
+
+static gaspi_return_t
+_gaspi_barrier_flat (const gaspi_group_t g, const gaspi_timeout_t timeout_ms)
+{
+  gaspi_return_t eret = GASPI_ERROR;
+
+  if(glb_gaspi_group_ctx[g].lastmask == 0x1)
+    {
+      glb_gaspi_group_ctx[g].barrier_cnt++;
+    }
+
+  eret = _gaspi_barrier_dissemination(g, NULL, glb_gaspi_group_ctx[g].tnc,
+				      glb_gaspi_group_ctx[g].rank, 0,
+				      glb_gaspi_group_ctx[g].barrier_cnt,
+				      glb_gaspi_group_ctx[g].togle, timeout_ms);
+  if( eret != GASPI_SUCCESS )
+    {
+      return eret;
+    }
+
+  glb_gaspi_group_ctx[g].togle = (glb_gaspi_group_ctx[g].togle ^ 0x1);
+
+  return GASPI_SUCCESS;
+}
+
+/* Two level barrier. The state (level) is 1 while the local members
+   arrive, 2 while the leaders run the dissemination and 3 while the
+   local members wait for the release by their leader. The leaders
+   use flags and a count of their own: the other members do not take
+   part, hence their flags of the flat collectives would go stale. */
+static gaspi_return_t
+_gaspi_barrier_node (const gaspi_group_t g, const gaspi_timeout_t timeout_ms)
+{
+  gaspi_return_t eret = GASPI_ERROR;
+  gaspi_group_ctx * const grp_ctx = &(glb_gaspi_group_ctx[g]);
+
+  if( grp_ctx->level == 0 )
+    {
+      grp_ctx->node_barrier_cnt++;
+      grp_ctx->node_epoch++;
+      grp_ctx->level = 1;
+    }
+
+  const unsigned int epoch = grp_ctx->node_epoch;
+  unsigned char * const shm = (unsigned char *) grp_ctx->node_shm;
+  volatile unsigned int * const release = (volatile unsigned int *) shm;
+
+  const gaspi_cycles_t s0 = gaspi_get_cycles();
+
+  if( grp_ctx->level == 1 )
+    {
+      if( grp_ctx->local_idx != 0 )
+	{
+	  volatile unsigned int * const arrive =
+	    (volatile unsigned int *) (shm + (grp_ctx->local_idx + 1) * GPI2_NODE_FLAG_STRIDE);
+
+	  __sync_synchronize();
+	  *arrive = epoch;
+	  grp_ctx->level = 3;
+	}
+      else
+	{
+	  int i;
+	  for(i = 1; i < grp_ctx->nlocal; i++)
 	    {
-	      if( (eret = _pgaspi_group_commit_to(g, dst, timeout_ms)) != GASPI_SUCCESS )
+	      volatile unsigned int * const arrive =
+		(volatile unsigned int *) (shm + (i + 1) * GPI2_NODE_FLAG_STRIDE);
+
+	      if( _gaspi_coll_wait_flag(arrive, epoch, s0, timeout_ms) != GASPI_SUCCESS )
 		{
-		  gaspi_print_error("Failed to commit to rank %u", dst);
-		  unlock_gaspi (&glb_gaspi_group_ctx[g].gl);
-		  return eret;
+		  return GASPI_TIMEOUT;
 		}
 	    }
+	  grp_ctx->level = 2;
+	}
+    }
 
-	  if(pgaspi_dev_post_group_write(send_ptr, dsize, dst,
-					 (void *)(glb_gaspi_group_ctx[g].rrcd[dst].data.addr + (COLL_MEM_RECV + (2 * bid + glb_gaspi_group_ctx[g].togle) * GPI2_REDUX_BUF_SIZE)),
-					 g) != 0)
+  if( grp_ctx->level == 2 )
+    {
+      if( grp_ctx->nnodes > 1 )
+	{
+	  eret = _gaspi_barrier_dissemination(g, grp_ctx->node_leaders, grp_ctx->nnodes,
+					      grp_ctx->node_idx, COLL_MEM_NODE_BARRIER,
+					      grp_ctx->node_barrier_cnt,
+					      grp_ctx->node_barrier_cnt & 0x1, timeout_ms);
+	  if( eret != GASPI_SUCCESS )
 	    {
-	      glb_gaspi_ctx.qp_state_vec[GASPI_COLL_QP][dst] = GASPI_STATE_CORRUPT;
-	      return GASPI_ERR_DEVICE;
+	      return eret;
 	    }
+	}
 
-	  if(pgaspi_dev_post_group_write(barrier_ptr, 1, dst,
-					 (void *)(glb_gaspi_group_ctx[g].rrcd[dst].data.addr + (2 * rank + glb_gaspi_group_ctx[g].togle)),
-					 g) != 0)
-	    {
-	      glb_gaspi_ctx.qp_state_vec[GASPI_COLL_QP][dst] = GASPI_STATE_CORRUPT;
-	      return GASPI_ERR_DEVICE;
-	    }
-	    glb_gaspi_ctx.ne_count_grp+=2;
-	J2:
-	  dst = 2 * idst + glb_gaspi_group_ctx[g].togle;
-	  while (poll_buf[dst] != glb_gaspi_group_ctx[g].barrier_cnt)
-	    {
-	      //timeout...
-	      const gaspi_cycles_t s1 = gaspi_get_cycles();
-	      const gaspi_cycles_t tdelta = s1 - s0;
-	      const float ms = (float) tdelta * glb_gaspi_ctx.cycles_to_msecs;
+      if( grp_ctx->nlocal > 1 )
+	{
+	  __sync_synchronize();
+	  *release = epoch;
+	}
+    }
+  else if( grp_ctx->level == 3 )
+    {
+      if( _gaspi_coll_wait_flag(release, epoch, s0, timeout_ms) != GASPI_SUCCESS )
+	{
+	  return GASPI_TIMEOUT;
+	}
+    }
+
+  grp_ctx->level = 0;
+
+  return GASPI_SUCCESS;
+}
+
+static inline gaspi_return_t
+_gaspi_allreduce (const gaspi_pointer_t buf_send,
+		  gaspi_pointer_t const buf_recv,
+		  const gaspi_number_t elem_cnt,
+		  struct redux_args *r_args,
+		  const gaspi_group_t g,
+		  const gaspi_timeout_t timeout_ms);
+
+/* Set up the node level on the first barrier of a group. Besides the
+   topology (local), this needs a barrier between the creation and
+   the attachment of the shared memory and an agreement on whether
+   all nodes succeeded. */
+static gaspi_return_t
+_gaspi_group_node_setup (const gaspi_group_t g, const gaspi_timeout_t timeout_ms)
+{
+  gaspi_return_t eret = GASPI_ERROR;
+  gaspi_group_ctx * const grp_ctx = &(glb_gaspi_group_ctx[g]);
+
+  if( grp_ctx->node_state == GASPI_NODE_UNKNOWN )
+    {
+      if( (eret = _gaspi_group_node_topology(g)) != GASPI_SUCCESS )
+	{
+	  return eret;
+	}
+
+      /* nothing to share */
+      if( grp_ctx->nnodes == grp_ctx->tnc )
+	{
+	  grp_ctx->node_state = GASPI_NODE_FLAT;
+	  return GASPI_SUCCESS;
+	}
+
+      if( grp_ctx->local_idx == 0 && grp_ctx->nlocal > 1 )
+	{
+	  _gaspi_group_node_shm_map(g, 1);
+	}
+
+      grp_ctx->node_state = GASPI_NODE_SETUP_SYNC;
+    }
+
+  if( grp_ctx->node_state == GASPI_NODE_SETUP_SYNC )
+    {
+      if( (eret = _gaspi_barrier_flat(g, timeout_ms)) != GASPI_SUCCESS )
+	{
+	  return eret;
+	}
+
+      if( grp_ctx->local_idx != 0 )
+	{
+	  _gaspi_group_node_shm_map(g, 0);
+	}
+
+      grp_ctx->node_state = GASPI_NODE_SETUP_AGREE;
+    }
+
+  if( grp_ctx->node_state == GASPI_NODE_SETUP_AGREE )
+    {
+      int ok = (grp_ctx->nlocal == 1 || grp_ctx->node_shm != NULL);
+      int all_ok = 0;
+
+      struct redux_args r_args;
+      r_args.f_type = GASPI_OP;
+      r_args.f_args.op = GASPI_OP_MIN;
+      r_args.f_args.type = GASPI_TYPE_INT;
+      r_args.elem_size = sizeof (int);
+
+      const gaspi_async_coll_t coll_op = grp_ctx->coll_op;
+      eret = _gaspi_allreduce(&ok, &all_ok, 1, &r_args, g, timeout_ms);
+      grp_ctx->coll_op = coll_op;
+      if( eret != GASPI_SUCCESS )
+	{
+	  return eret;
+	}
+
+      /* everybody is attached: the name is no longer needed */
+      if( grp_ctx->local_idx == 0 && grp_ctx->node_shm != NULL )
+	{
+	  char name[128];
+	  _gaspi_group_node_shm_name (g, name, sizeof (name));
+	  unlink (name);
+	}
+
+      if( all_ok )
+	{
+	  grp_ctx->node_state = GASPI_NODE_READY;
+	}
+      else
+	{
+	  pgaspi_group_node_release(g);
+	  grp_ctx->node_state = GASPI_NODE_FLAT;
+	}
+    }
+
+  return GASPI_SUCCESS;
+}
+
+/* The algorithms of the blocking barrier and allreduce: as set with
+   gaspi_coll_algorithm_set, else as in the decision table, else the
+   built-in choice. All members must come to the same decision. */
+static gaspi_coll_algorithm_t
+_gaspi_barrier_algorithm (const gaspi_group_t g)
+{
+  if( glb_gaspi_group_ctx[g].barrier_alg != GASPI_COLL_ALG_AUTO )
+    {
+      return glb_gaspi_group_ctx[g].barrier_alg;
+    }
+
+  const long rule = gaspi_coll_tuning_lookup(GPI2_TUNE_BARRIER, glb_gaspi_group_ctx[g].tnc);
+  if( rule >= 0 )
+    {
+      return (gaspi_coll_algorithm_t) rule;
+    }
+
+  return GASPI_BARRIER_NODE;
+}
+
+static gaspi_coll_algorithm_t
+_gaspi_allreduce_algorithm (const gaspi_group_t g,
+			    const gaspi_number_t elem_cnt,
+			    const gaspi_size_t elem_size)
+{
+  /* recursive doubling is limited to the small message buffer */
+  if( elem_cnt > 255 )
+    {
+      return GASPI_ALLREDUCE_RSAG;
+    }
+
+  if( glb_gaspi_group_ctx[g].allreduce_alg != GASPI_COLL_ALG_AUTO )
+    {
+      return glb_gaspi_group_ctx[g].allreduce_alg;
+    }
+
+  const long rule = gaspi_coll_tuning_lookup(GPI2_TUNE_ALLREDUCE, glb_gaspi_group_ctx[g].tnc);
+  if( rule >= 0 && elem_cnt * elem_size >= (gaspi_size_t) rule )
+    {
+      return GASPI_ALLREDUCE_RSAG;
+    }
+
+  return GASPI_ALLREDUCE_DOUBLING;
+}
+
+#pragma weak gaspi_coll_algorithm_set = pgaspi_coll_algorithm_set
+gaspi_return_t
+pgaspi_coll_algorithm_set (const gaspi_group_t g,
+			   const gaspi_coll_algorithm_t barrier,
+			   const gaspi_coll_algorithm_t allreduce)
+{
+  gaspi_verify_init("gaspi_coll_algorithm_set");
+  gaspi_verify_group(g);
+
+  if( barrier != GASPI_COLL_ALG_AUTO
+      && barrier != GASPI_BARRIER_DISSEMINATION
+      && barrier != GASPI_BARRIER_NODE )
+    {
+      gaspi_print_error("Invalid barrier algorithm (%d)", barrier);
+      return GASPI_ERROR;
+    }
+
+  if( allreduce != GASPI_COLL_ALG_AUTO
+      && allreduce != GASPI_ALLREDUCE_DOUBLING
+      && allreduce != GASPI_ALLREDUCE_RSAG )
+    {
+      gaspi_print_error("Invalid allreduce algorithm (%d)", allreduce);
+      return GASPI_ERROR;
+    }
+
+  lock_gaspi (&glb_gaspi_group_ctx[g].gl);
+
+  if( glb_gaspi_group_ctx[g].coll_op != GASPI_NONE )
+    {
+      unlock_gaspi (&glb_gaspi_group_ctx[g].gl);
+      return GASPI_ERR_ACTIVE_COLL;
+    }
+
+  glb_gaspi_group_ctx[g].barrier_alg = barrier;
+  glb_gaspi_group_ctx[g].allreduce_alg = allreduce;
+
+  unlock_gaspi (&glb_gaspi_group_ctx[g].gl);
+
+  return GASPI_SUCCESS;
+}
+
+#pragma weak gaspi_coll_algorithm_get = pgaspi_coll_algorithm_get
+gaspi_return_t
+pgaspi_coll_algorithm_get (const gaspi_group_t g,
+			   const gaspi_number_t num,
+			   const gaspi_datatype_t datatyp,
+			   gaspi_coll_algorithm_t * const barrier,
+			   gaspi_coll_algorithm_t * const allreduce)
+{
+  gaspi_verify_init("gaspi_coll_algorithm_get");
+  gaspi_verify_group(g);
+  gaspi_verify_null_ptr(barrier);
+  gaspi_verify_null_ptr(allreduce);
+
+  *barrier = _gaspi_barrier_algorithm(g);
+  *allreduce = _gaspi_allreduce_algorithm(g, num, glb_gaspi_typ_size[datatyp]);
+
+  return GASPI_SUCCESS;
+}
+
+#pragma weak gaspi_barrier = pgaspi_barrier
+gaspi_return_t
+pgaspi_barrier (const gaspi_group_t g, const gaspi_timeout_t timeout_ms)
+{
+  gaspi_verify_init("gaspi_barrier");
+  gaspi_verify_group(g);
+
+  gaspi_return_t eret = GASPI_ERROR;
+
+  GPI2_STATS_START_TIMER(GASPI_BARRIER_TIMER);
+
+  if(lock_gaspi_tout (&glb_gaspi_group_ctx[g].gl, timeout_ms))
+    {
+      return GASPI_TIMEOUT;
+    }
+
+  if(!(glb_gaspi_group_ctx[g].coll_op & GASPI_BARRIER))
+    {
+      unlock_gaspi (&glb_gaspi_group_ctx[g].gl);
+      return GASPI_ERR_ACTIVE_COLL;
+    }
+
+  glb_gaspi_group_ctx[g].coll_op = GASPI_BARRIER;
+
+  const gaspi_coll_algorithm_t alg = _gaspi_barrier_algorithm(g);
+
+  if( alg == GASPI_BARRIER_NODE
+      && glb_gaspi_group_ctx[g].node_state != GASPI_NODE_READY
+      && glb_gaspi_group_ctx[g].node_state != GASPI_NODE_FLAT )
+    {
+      if( (eret = _gaspi_group_node_setup(g, timeout_ms)) != GASPI_SUCCESS )
+	{
+	  unlock_gaspi (&glb_gaspi_group_ctx[g].gl);
+	  return eret;
+	}
+    }
+
+  if( alg == GASPI_BARRIER_NODE
+      && glb_gaspi_group_ctx[g].node_state == GASPI_NODE_READY )
+    {
+      eret = _gaspi_barrier_node(g, timeout_ms);
+    }
+  else
+    {
+      eret = _gaspi_barrier_flat(g, timeout_ms);
+    }
+
+  if( eret != GASPI_SUCCESS )
+    {
+      unlock_gaspi (&glb_gaspi_group_ctx[g].gl);
+      return eret;
+    }
+
+  glb_gaspi_group_ctx[g].coll_op = GASPI_NONE;
+
+  GPI2_STATS_INC_COUNT(GASPI_STATS_COUNTER_NUM_BARRIER, 1);
+  GPI2_STATS_STOP_TIMER(GASPI_BARRIER_TIMER);
+  GPI2_STATS_INC_TIMER(GASPI_STATS_TIME_BARRIER, GPI2_STATS_GET_TIMER(GASPI_BARRIER_TIMER));
+
+  unlock_gaspi (&glb_gaspi_group_ctx[g].gl);
+
+  return GASPI_SUCCESS;
+}
+
+static inline gaspi_return_t
+_gaspi_allreduce (const gaspi_pointer_t buf_send,
+		  gaspi_pointer_t const buf_recv,
+		  const gaspi_number_t elem_cnt,
+		  struct redux_args *r_args,
+		  const gaspi_group_t g,
+		  const gaspi_timeout_t timeout_ms)
+{
+  int idst, dst, bid = 0;
+  int mask, tmprank, tmpdst;
+
+  gaspi_return_t eret = GASPI_ERROR;
+
+  const int dsize = r_args->elem_size * elem_cnt;
+
+  if( glb_gaspi_group_ctx[g].level == 0 )
+    {
+      glb_gaspi_group_ctx[g].barrier_cnt++;
+    }
+
+  const int size = glb_gaspi_group_ctx[g].tnc;
+  const int rank = glb_gaspi_group_ctx[g].rank;
+
+  unsigned char *barrier_ptr = glb_gaspi_group_ctx[g].rrcd[glb_gaspi_ctx.rank].data.buf + 2 * size + glb_gaspi_group_ctx[g].togle;
+  barrier_ptr[0] = glb_gaspi_group_ctx[g].barrier_cnt;
+
+  volatile unsigned char *poll_buf = (volatile unsigned char *) (glb_gaspi_group_ctx[g].rrcd[glb_gaspi_ctx.rank].data.buf);
+
+  unsigned char *send_ptr = glb_gaspi_group_ctx[g].rrcd[glb_gaspi_ctx.rank].data.buf + COLL_MEM_SEND + (glb_gaspi_group_ctx[g].togle * 18 * GPI2_REDUX_BUF_SIZE);
+  memcpy (send_ptr, buf_send, dsize);
+
+  unsigned char *recv_ptr = glb_gaspi_group_ctx[g].rrcd[glb_gaspi_ctx.rank].data.buf + COLL_MEM_RECV;
+
+  const int rest = size - glb_gaspi_group_ctx[g].next_pof2;
+
+  const gaspi_cycles_t s0 = gaspi_get_cycles();
+
+  if(glb_gaspi_group_ctx[g].level >= 2)
+    {
+      tmprank = glb_gaspi_group_ctx[g].tmprank;
+      bid = glb_gaspi_group_ctx[g].bid;
+      send_ptr += glb_gaspi_group_ctx[g].dsize;
+      //goto L2;
+      if(glb_gaspi_group_ctx[g].level==2) goto L2;
+      else if(glb_gaspi_group_ctx[g].level==3) goto L3;
+    }
+
+  if(rank < 2 * rest)
+    {
+      if(rank % 2 == 0)
+	{
+	  dst = glb_gaspi_group_ctx[g].rank_grp[rank + 1];
+
+	  if( GASPI_ENDPOINT_DISCONNECTED == glb_gaspi_ctx.ep_conn[dst].cstat )
+	    if( (eret = pgaspi_connect((gaspi_rank_t) dst, timeout_ms)) != GASPI_SUCCESS)
+	      {
+		gaspi_print_error("Failed to connect to rank %u", dst);
+		return eret;
+	      }
+
+	  if( !glb_gaspi_group_ctx[g].committed_rank[dst] )
+	    {
+	      if( (eret = _pgaspi_group_commit_to(g, dst, timeout_ms)) != GASPI_SUCCESS )
+		{
+		  gaspi_print_error("Failed to commit to rank %u", dst);
+		  unlock_gaspi (&glb_gaspi_group_ctx[g].gl);
+		  return eret;
+		}
+	    }
+
+	  if(pgaspi_dev_post_group_write(send_ptr,
+					 dsize,
+					 dst,
+					 (void *)(glb_gaspi_group_ctx[g].rrcd[dst].data.addr + (COLL_MEM_RECV + (2 * bid + glb_gaspi_group_ctx[g].togle) * GPI2_REDUX_BUF_SIZE)),
+					 g) != 0)
+	    {
+	      glb_gaspi_ctx.qp_state_vec[GASPI_COLL_QP][dst] = GASPI_STATE_CORRUPT;
+	      return GASPI_ERR_DEVICE;
+	    }
+
+	  if(pgaspi_dev_post_group_write(barrier_ptr, 1, dst,
+					 (void *)(glb_gaspi_group_ctx[g].rrcd[dst].data.addr + (2 * rank + glb_gaspi_group_ctx[g].togle)),
+					 g) != 0)
+	    {
+	      glb_gaspi_ctx.qp_state_vec[GASPI_COLL_QP][dst] = GASPI_STATE_CORRUPT;
+	      return GASPI_ERR_DEVICE;
+	    }
+	  __sync_fetch_and_add(&glb_gaspi_ctx.ne_count_grp, 2);
+	  tmprank = -1;
+	}
+      else
+	{
+
+	  dst = 2 * (rank - 1) + glb_gaspi_group_ctx[g].togle;
+	  while (poll_buf[dst] != glb_gaspi_group_ctx[g].barrier_cnt)
+	    {
+	      //timeout...
+	      const gaspi_cycles_t s1 = gaspi_get_cycles();
+	      const gaspi_cycles_t tdelta = s1 - s0;
+	      const float ms = (float) tdelta * glb_gaspi_ctx.cycles_to_msecs;
+
+	      if(ms > timeout_ms)
+		{
+		  glb_gaspi_group_ctx[g].level = 1;
+
+		  return GASPI_TIMEOUT;
+		}
+
+	      //gaspi_delay ();
+	    }
+
+	  void *dst_val = (void *) (recv_ptr + (2 * bid + glb_gaspi_group_ctx[g].togle) * GPI2_REDUX_BUF_SIZE);
+	  void *local_val = (void *) send_ptr;
+	  send_ptr += dsize;
+	  glb_gaspi_group_ctx[g].dsize+=dsize;
+
+	  if(r_args->f_type == GASPI_OP)
+	    {
+	      gaspi_operation_t op = r_args->f_args.op;
+	      gaspi_datatype_t type = r_args->f_args.type;
+	      //TODO: magic number
+	      gaspi_redux_fct (op, type) ((void *) send_ptr, local_val, dst_val,elem_cnt);
+	    }
+	  else if(r_args->f_type == GASPI_USER)
+	    {
+	      r_args->f_args.user_fct (local_val, dst_val, (void *) send_ptr, r_args->f_args.rstate, elem_cnt, r_args->elem_size, timeout_ms);
+	    }
+
+	  tmprank = rank >> 1;
+	}
+
+      bid++;
+
+    }
+  else
+    {
+
+      tmprank = rank - rest;
+      if (rest) bid++;
+    }
+
+  glb_gaspi_group_ctx[g].tmprank = tmprank;
+  glb_gaspi_group_ctx[g].bid = bid;
+  glb_gaspi_group_ctx[g].level = 2;
+
+  //second phase
+ L2:
+
+  if (tmprank != -1)
+    {
+
+      //mask = 0x1;
+      mask = glb_gaspi_group_ctx[g].lastmask & 0x7fffffff;
+      int jmp = glb_gaspi_group_ctx[g].lastmask>>31;
+
+      while (mask < glb_gaspi_group_ctx[g].next_pof2)
+	{
+
+	  tmpdst = tmprank ^ mask;
+	  idst = (tmpdst < rest) ? tmpdst * 2 + 1 : tmpdst + rest;
+	  dst = glb_gaspi_group_ctx[g].rank_grp[idst];
+	  if(jmp)
+	    {
+	      jmp = 0;
+	      goto J2;
+	    }
+
+	  if( GASPI_ENDPOINT_DISCONNECTED == glb_gaspi_ctx.ep_conn[dst].cstat )
+	    if( (eret = pgaspi_connect((gaspi_rank_t) dst, timeout_ms)) != GASPI_SUCCESS)
+	      {
+		gaspi_print_error("Failed to connect to rank %u", dst);
+		return eret;
+	      }
+
+	  if( !glb_gaspi_group_ctx[g].committed_rank[dst] )
+	    {
+	      if( (eret = _pgaspi_group_commit_to(g, dst, timeout_ms)) != GASPI_SUCCESS )
+		{
+		  gaspi_print_error("Failed to commit to rank %u", dst);
+		  unlock_gaspi (&glb_gaspi_group_ctx[g].gl);
+		  return eret;
+		}
+	    }
+
+	  if(pgaspi_dev_post_group_write(send_ptr, dsize, dst,
+					 (void *)(glb_gaspi_group_ctx[g].rrcd[dst].data.addr + (COLL_MEM_RECV + (2 * bid + glb_gaspi_group_ctx[g].togle) * GPI2_REDUX_BUF_SIZE)),
+					 g) != 0)
+	    {
+	      glb_gaspi_ctx.qp_state_vec[GASPI_COLL_QP][dst] = GASPI_STATE_CORRUPT;
+	      return GASPI_ERR_DEVICE;
+	    }
+
+	  if(pgaspi_dev_post_group_write(barrier_ptr, 1, dst,
+					 (void *)(glb_gaspi_group_ctx[g].rrcd[dst].data.addr + (2 * rank + glb_gaspi_group_ctx[g].togle)),
+					 g) != 0)
+	    {
+	      glb_gaspi_ctx.qp_state_vec[GASPI_COLL_QP][dst] = GASPI_STATE_CORRUPT;
+	      return GASPI_ERR_DEVICE;
+	    }
+	    __sync_fetch_and_add(&glb_gaspi_ctx.ne_count_grp, 2);
+	J2:
+	  dst = 2 * idst + glb_gaspi_group_ctx[g].togle;
+	  while (poll_buf[dst] != glb_gaspi_group_ctx[g].barrier_cnt)
+	    {
+	      //timeout...
+	      const gaspi_cycles_t s1 = gaspi_get_cycles();
+	      const gaspi_cycles_t tdelta = s1 - s0;
+	      const float ms = (float) tdelta * glb_gaspi_ctx.cycles_to_msecs;
+
+	      if(ms > timeout_ms)
+		{
+		  glb_gaspi_group_ctx[g].lastmask = mask|0x80000000;
+		  glb_gaspi_group_ctx[g].bid = bid;
+
+		  return GASPI_TIMEOUT;
+		}
+	    }
+
+	  void *dst_val = (void *) (recv_ptr + (2 * bid + glb_gaspi_group_ctx[g].togle) * GPI2_REDUX_BUF_SIZE);
+	  void *local_val = (void *) send_ptr;
+	  send_ptr += dsize;
+	  glb_gaspi_group_ctx[g].dsize += dsize;
+
+	  if(r_args->f_type == GASPI_OP)
+	    {
+	      gaspi_operation_t op = r_args->f_args.op;
+	      gaspi_datatype_t type = r_args->f_args.type;
+
+	      gaspi_redux_fct (op, type) ((void *) send_ptr, local_val, dst_val, elem_cnt);
+	    }
+	  else if(r_args->f_type == GASPI_USER)
+	    {
+	      r_args->f_args.user_fct (local_val, dst_val, (void *) send_ptr, r_args->f_args.rstate, elem_cnt, r_args->elem_size, timeout_ms);
+	    }
+
+	  mask <<= 1;
+	  bid++;
+	}
+
+    }
+
+  glb_gaspi_group_ctx[g].bid = bid;
+  glb_gaspi_group_ctx[g].level = 3;
+  //third phase
+ L3:
+
+  if (rank < 2 * rest)
+    {
+
+      if (rank % 2){
+
+	dst = glb_gaspi_group_ctx[g].rank_grp[rank - 1];
+
+	if( GASPI_ENDPOINT_DISCONNECTED == glb_gaspi_ctx.ep_conn[dst].cstat )
+	  if( (eret = pgaspi_connect((gaspi_rank_t) dst, timeout_ms)) != GASPI_SUCCESS)
+	    {
+	      gaspi_print_error("Failed to connect to rank %u", dst);
+	      return eret;
+	    }
+
+	if( !glb_gaspi_group_ctx[g].committed_rank[dst] )
+	  {
+	    if( (eret = _pgaspi_group_commit_to(g, dst, timeout_ms)) != GASPI_SUCCESS )
+	      {
+		gaspi_print_error("Failed to commit to rank %u", dst);
+		unlock_gaspi (&glb_gaspi_group_ctx[g].gl);
+		return eret;
+	      }
+	  }
+
+	if(pgaspi_dev_post_group_write(send_ptr, dsize, dst,
+				       (void *)(glb_gaspi_group_ctx[g].rrcd[dst].data.addr + (COLL_MEM_RECV + (2 * bid + glb_gaspi_group_ctx[g].togle) * GPI2_REDUX_BUF_SIZE)),
+				       g) != 0)
+	  {
+	    glb_gaspi_ctx.qp_state_vec[GASPI_COLL_QP][dst] = GASPI_STATE_CORRUPT;
+	    return GASPI_ERR_DEVICE;
+	  }
+
+	if(pgaspi_dev_post_group_write(barrier_ptr, 1, dst,
+				       (void *)(glb_gaspi_group_ctx[g].rrcd[dst].data.addr + (2 * rank + glb_gaspi_group_ctx[g].togle)),
+				       g) != 0)
+	  {
+	    glb_gaspi_ctx.qp_state_vec[GASPI_COLL_QP][dst] = GASPI_STATE_CORRUPT;
+	    return GASPI_ERR_DEVICE;
+	  }
+	  __sync_fetch_and_add(&glb_gaspi_ctx.ne_count_grp, 2);
+      }
+      else
+	{
+	  dst = 2 * (rank + 1) + glb_gaspi_group_ctx[g].togle;
+
+	  while (poll_buf[dst] != glb_gaspi_group_ctx[g].barrier_cnt)
+	    {
+	      //timeout...
+	      const gaspi_cycles_t s1 = gaspi_get_cycles();
+	      const gaspi_cycles_t tdelta = s1 - s0;
+	      const float ms = (float) tdelta * glb_gaspi_ctx.cycles_to_msecs;
+
+	      if(ms > timeout_ms)
+		{
+		  return GASPI_TIMEOUT;
+		}
+	      //gaspi_delay ();
+	    }
+
+	  bid += glb_gaspi_group_ctx[g].pof2_exp;
+	  send_ptr = (recv_ptr + (2 * bid + glb_gaspi_group_ctx[g].togle) * GPI2_REDUX_BUF_SIZE);
+	}
+    }
+  if( _gaspi_coll_poll() != GASPI_SUCCESS )
+    {
+      return GASPI_ERR_DEVICE;
+    }
+
+  glb_gaspi_group_ctx[g].togle = (glb_gaspi_group_ctx[g].togle ^ 0x1);
+
+  glb_gaspi_group_ctx[g].coll_op = GASPI_NONE;
+  glb_gaspi_group_ctx[g].lastmask = 0x1;
+  glb_gaspi_group_ctx[g].level = 0;
+  glb_gaspi_group_ctx[g].dsize = 0;
+  glb_gaspi_group_ctx[g].bid   = 0;
+
+  memcpy (buf_recv, send_ptr, dsize);
+
+  return GASPI_SUCCESS;
+}
+
+/* Large allreduce: Rabenseifner's reduce-scatter (recursive halving)
+   followed by an allgather (recursive doubling) among the largest
+   power of two subset of the group. The remaining ranks fold their
+   data into a partner first and get the result back at the end.
+
+   The user buffer is processed in chunks that fit the group's
+   GPI2_REDUX_LARGE_SLOT, alternating between two slots so that a
+   chunk can be sent while the previous one is still being drained by
+   slower ranks. Every message is followed by a write of the chunk
+   sequence number into a per-step flag of the receiver.
+
+   State for resuming after a timeout: bid is the chunk, level the
+   step within the chunk and the top bit of lastmask is set if the
+   writes of that step were already posted. */
+#define GPI2_REDUX_LARGE_W     (GPI2_REDUX_LARGE_FLAGS)
+#define GPI2_REDUX_LARGE_T     (GPI2_REDUX_LARGE_W + GPI2_REDUX_LARGE_CHUNK)
+#define GPI2_REDUX_LARGE_FOLD  (GPI2_REDUX_LARGE_T + GPI2_REDUX_LARGE_CHUNK)
+#define GPI2_REDUX_LARGE_RS    (GPI2_REDUX_LARGE_FOLD + GPI2_REDUX_LARGE_CHUNK)
+
+#define GPI2_REDUX_FLAG_FOLD    (0)
+#define GPI2_REDUX_FLAG_RESULT  (1)
+#define GPI2_REDUX_FLAG_RS(s)   (1 + (s))
+#define GPI2_REDUX_FLAG_AG(s)   (33 + (s))
+#define GPI2_REDUX_FLAG_SRC     (GPI2_REDUX_LARGE_FLAGS / sizeof(unsigned int) - 1)
+
+static inline gaspi_number_t
+_gaspi_allreduce_large_chunk (const gaspi_group_t g, const gaspi_size_t elem_size)
+{
+  const gaspi_number_t chunk_elems = (gaspi_number_t) (GPI2_REDUX_LARGE_CHUNK / elem_size);
+
+  /* whole chunks are split into equal blocks among the subset */
+  return chunk_elems - (chunk_elems % glb_gaspi_group_ctx[g].next_pof2);
+}
+
+/* User segments of gaspi_allreduce_segment. The input is then read
+   from and the result reduced into them directly, and the allgather
+   and the result for the folded ranks go from segment to segment,
+   the segments and offsets being the same on all ranks. */
+struct gaspi_coll_segs
+{
+  gaspi_segment_id_t seg_send, seg_recv;
+  gaspi_offset_t off_send, off_recv;
+};
+
+/* Post a write of local memory, in the group buffer or in one of the
+   user segments, into the group buffer of dst */
+static inline gaspi_return_t
+_gaspi_allreduce_large_post (const gaspi_group_t g,
+			     const int dst,
+			     const struct gaspi_coll_segs * const segs,
+			     unsigned char * const local,
+			     const gaspi_size_t length,
+			     const unsigned long remote_offset,
+			     const gaspi_timeout_t timeout_ms)
+{
+  if( segs != NULL )
+    {
+      const gaspi_rc_mseg * const send = &(glb_gaspi_ctx.rrmd[segs->seg_send][glb_gaspi_ctx.rank]);
+      const gaspi_rc_mseg * const recv = &(glb_gaspi_ctx.rrmd[segs->seg_recv][glb_gaspi_ctx.rank]);
+
+      if( local >= send->data.buf && local < send->data.buf + send->size )
+	{
+	  return _gaspi_coll_post_seg_buf_write(g, dst, segs->seg_send, local - send->data.buf,
+						(unsigned int) length, remote_offset, timeout_ms);
+	}
+
+      if( local >= recv->data.buf && local < recv->data.buf + recv->size )
+	{
+	  return _gaspi_coll_post_seg_buf_write(g, dst, segs->seg_recv, local - recv->data.buf,
+						(unsigned int) length, remote_offset, timeout_ms);
+	}
+    }
+
+  return _gaspi_coll_post_write(g, dst, local, length, remote_offset, timeout_ms);
+}
+
+static gaspi_return_t
+_gaspi_allreduce_large (const gaspi_pointer_t buf_send,
+			gaspi_pointer_t const buf_recv,
+			const gaspi_number_t elem_cnt,
+			struct redux_args *r_args,
+			const struct gaspi_coll_segs * const segs,
+			const gaspi_group_t g,
+			const gaspi_timeout_t timeout_ms)
+{
+  gaspi_return_t eret = GASPI_ERROR;
+  gaspi_group_ctx * const grp_ctx = &(glb_gaspi_group_ctx[g]);
+
+  const int size = grp_ctx->tnc;
+  const int rank = grp_ctx->rank;
+  const int pof2 = grp_ctx->next_pof2;
+  const int pof2_exp = grp_ctx->pof2_exp;
+  const int rest = size - pof2;
+  const gaspi_size_t esize = r_args->elem_size;
+
+  const gaspi_number_t chunk_max = _gaspi_allreduce_large_chunk(g, esize);
+  const gaspi_number_t nchunks = (elem_cnt + chunk_max - 1) / chunk_max;
+
+  /* rank inside the power of two subset, -1 if folded */
+  int tmprank;
+  if( rank < 2 * rest )
+    {
+      tmprank = (rank % 2) ? (rank >> 1) : -1;
+    }
+  else
+    {
+      tmprank = rank - rest;
+    }
+
+  const int step_result = 2 * pof2_exp + 1;
+
+  const gaspi_cycles_t s0 = gaspi_get_cycles();
+
+  int step = grp_ctx->level;
+  int jmp = grp_ctx->lastmask >> 31;
+
+  while( (gaspi_number_t) grp_ctx->bid < nchunks )
+    {
+      const gaspi_number_t off = grp_ctx->bid * chunk_max;
+      const gaspi_number_t n = MIN(chunk_max, elem_cnt - off);
+      const gaspi_number_t bsize = (n + pof2 - 1) / pof2;
+      const unsigned int seq = grp_ctx->seq + 1;
+
+      const unsigned long slot_off = COLL_MEM_LARGE + grp_ctx->togle * GPI2_REDUX_LARGE_SLOT;
+      unsigned char * const slot = grp_ctx->rrcd[glb_gaspi_ctx.rank].data.buf + slot_off;
+      volatile unsigned int * const flags = (volatile unsigned int *) slot;
+      unsigned int * const flag_src = (unsigned int *) slot + GPI2_REDUX_FLAG_SRC;
+
+      unsigned char * const chunk_send = (unsigned char *) buf_send + off * esize;
+      unsigned char * const work_buf = (segs != NULL)
+	? (unsigned char *) buf_recv + off * esize
+	: slot + GPI2_REDUX_LARGE_W;
+      unsigned char * const tmp_buf = slot + GPI2_REDUX_LARGE_T;
+
+      /* The reduce-scatter alternates between the two work buffers
+	 such that its last step ends up in work_buf. Its input is a
+	 copy of the chunk, or the chunk itself if in a segment. */
+#define REDUX_ALT(s) ((((pof2_exp - (s)) & 1)) ? tmp_buf : work_buf)
+#define REDUX_BUF(s) (((s) == 0) ? buf0 : REDUX_ALT(s))
+#define REDUX_BLK(b) ((gaspi_number_t) MIN((gaspi_number_t) (b) * bsize, n))
+
+      const int in_seg = (segs != NULL && rank >= 2 * rest && pof2_exp > 0);
+      unsigned char * const buf0 = in_seg ? chunk_send : REDUX_ALT(0);
+
+      *flag_src = seq;
+
+      if( step == 0 )
+	{
+	  if( tmprank == -1 )
+	    {
+	      const int dst = grp_ctx->rank_grp[rank + 1];
+
+	      if( !jmp )
+		{
+		  unsigned char *fold_buf = chunk_send;
+
+		  if( segs == NULL )
+		    {
+		      memcpy(REDUX_BUF(0), chunk_send, n * esize);
+		      fold_buf = REDUX_BUF(0);
+		    }
+
+		  if( (eret = _gaspi_allreduce_large_post(g, dst, segs, fold_buf, n * esize,
+							  slot_off + GPI2_REDUX_LARGE_FOLD,
+							  timeout_ms)) != GASPI_SUCCESS )
+		    {
+		      goto postL;
+		    }
+
+		  if( (eret = _gaspi_coll_post_write(g, dst, flag_src, sizeof(unsigned int),
+						     slot_off + GPI2_REDUX_FLAG_FOLD * sizeof(unsigned int),
+						     timeout_ms)) != GASPI_SUCCESS )
+		    {
+		      goto postL;
+		    }
+		}
+	      step = step_result;
+	    }
+	  else if( rank < 2 * rest )
+	    {
+	      if( _gaspi_coll_wait_flag(&flags[GPI2_REDUX_FLAG_FOLD], seq, s0, timeout_ms) != GASPI_SUCCESS )
+		{
+		  goto timeoutL;
+		}
+
+	      _gaspi_redux_apply(r_args, REDUX_BUF(0), chunk_send,
+				 slot + GPI2_REDUX_LARGE_FOLD, n, timeout_ms);
+	      step = 1;
+	    }
+	  else
+	    {
+	      if( !in_seg )
+		{
+		  memcpy(REDUX_BUF(0), chunk_send, n * esize);
+		}
+	      step = 1;
+	    }
+	  jmp = 0;
+	}
+
+      //reduce-scatter
+      while( step >= 1 && step <= pof2_exp )
+	{
+	  const int mask = pof2 >> step;
+	  const int tmpdst = tmprank ^ mask;
+	  const int idst = (tmpdst < rest) ? tmpdst * 2 + 1 : tmpdst + rest;
+	  const int dst = grp_ctx->rank_grp[idst];
+
+	  const gaspi_number_t keep_lo = REDUX_BLK(tmprank & ~(mask - 1));
+	  const gaspi_number_t keep_hi = REDUX_BLK((tmprank & ~(mask - 1)) + mask);
+	  const gaspi_number_t send_lo = REDUX_BLK(tmpdst & ~(mask - 1));
+	  const gaspi_number_t send_hi = REDUX_BLK((tmpdst & ~(mask - 1)) + mask);
+	  const unsigned long rs_off = GPI2_REDUX_LARGE_RS + (pof2 - 2 * mask) * bsize * esize;
+
+	  if( !jmp )
+	    {
+	      if( send_hi > send_lo )
+		{
+		  if( (eret = _gaspi_allreduce_large_post(g, dst, segs, REDUX_BUF(step - 1) + send_lo * esize,
+							  (send_hi - send_lo) * esize,
+							  slot_off + rs_off, timeout_ms)) != GASPI_SUCCESS )
+		    {
+		      goto postL;
+		    }
+		}
+
+	      if( (eret = _gaspi_coll_post_write(g, dst, flag_src, sizeof(unsigned int),
+						 slot_off + GPI2_REDUX_FLAG_RS(step) * sizeof(unsigned int),
+						 timeout_ms)) != GASPI_SUCCESS )
+		{
+		  goto postL;
+		}
+	    }
+
+	  if( _gaspi_coll_wait_flag(&flags[GPI2_REDUX_FLAG_RS(step)], seq, s0, timeout_ms) != GASPI_SUCCESS )
+	    {
+	      goto timeoutL;
+	    }
+
+	  if( keep_hi > keep_lo )
+	    {
+	      _gaspi_redux_apply(r_args, REDUX_BUF(step) + keep_lo * esize,
+				 REDUX_BUF(step - 1) + keep_lo * esize,
+				 slot + rs_off, keep_hi - keep_lo, timeout_ms);
+	    }
+
+	  jmp = 0;
+	  step++;
+	}
+
+      //allgather
+      while( step > pof2_exp && step < step_result )
+	{
+	  const int mask = 1 << (step - pof2_exp - 1);
+	  const int tmpdst = tmprank ^ mask;
+	  const int idst = (tmpdst < rest) ? tmpdst * 2 + 1 : tmpdst + rest;
+	  const int dst = grp_ctx->rank_grp[idst];
+
+	  const gaspi_number_t my_lo = REDUX_BLK(tmprank & ~(mask - 1));
+	  const gaspi_number_t my_hi = REDUX_BLK((tmprank & ~(mask - 1)) + mask);
+
+	  if( !jmp )
+	    {
+	      if( my_hi > my_lo && segs != NULL )
+		{
+		  if( (eret = _gaspi_coll_post_seg_write(g, dst, segs->seg_recv,
+							 segs->off_recv + (off + my_lo) * esize,
+							 (my_hi - my_lo) * esize,
+							 timeout_ms)) != GASPI_SUCCESS )
+		    {
+		      goto postL;
+		    }
+		}
+	      else if( my_hi > my_lo )
+		{
+		  if( (eret = _gaspi_coll_post_write(g, dst, work_buf + my_lo * esize,
+						     (my_hi - my_lo) * esize,
+						     slot_off + GPI2_REDUX_LARGE_W + my_lo * esize,
+						     timeout_ms)) != GASPI_SUCCESS )
+		    {
+		      goto postL;
+		    }
+		}
+
+	      if( (eret = _gaspi_coll_post_write(g, dst, flag_src, sizeof(unsigned int),
+						 slot_off + GPI2_REDUX_FLAG_AG(step - pof2_exp - 1) * sizeof(unsigned int),
+						 timeout_ms)) != GASPI_SUCCESS )
+		{
+		  goto postL;
+		}
+	    }
+
+	  if( _gaspi_coll_wait_flag(&flags[GPI2_REDUX_FLAG_AG(step - pof2_exp - 1)], seq, s0, timeout_ms) != GASPI_SUCCESS )
+	    {
+	      goto timeoutL;
+	    }
+
+	  jmp = 0;
+	  step++;
+	}
+
+      //give result back to folded ranks
+      if( rank < 2 * rest )
+	{
+	  if( tmprank == -1 )
+	    {
+	      if( _gaspi_coll_wait_flag(&flags[GPI2_REDUX_FLAG_RESULT], seq, s0, timeout_ms) != GASPI_SUCCESS )
+		{
+		  goto timeoutL;
+		}
+	    }
+	  else
+	    {
+	      const int dst = grp_ctx->rank_grp[rank - 1];
+
+	      if( segs != NULL )
+		{
+		  eret = _gaspi_coll_post_seg_write(g, dst, segs->seg_recv,
+						    segs->off_recv + off * esize,
+						    n * esize, timeout_ms);
+		}
+	      else
+		{
+		  eret = _gaspi_coll_post_write(g, dst, work_buf, n * esize,
+						slot_off + GPI2_REDUX_LARGE_W,
+						timeout_ms);
+		}
+
+	      if( eret != GASPI_SUCCESS )
+		{
+		  goto postL;
+		}
+
+	      if( (eret = _gaspi_coll_post_write(g, dst, flag_src, sizeof(unsigned int),
+						 slot_off + GPI2_REDUX_FLAG_RESULT * sizeof(unsigned int),
+						 timeout_ms)) != GASPI_SUCCESS )
+		{
+		  goto postL;
+		}
+	    }
+	}
+
+#undef REDUX_ALT
+#undef REDUX_BUF
+#undef REDUX_BLK
+
+      if( segs == NULL )
+	{
+	  memcpy((unsigned char *) buf_recv + off * esize, work_buf, n * esize);
+	}
+
+      if( _gaspi_coll_poll() != GASPI_SUCCESS )
+	{
+	  return GASPI_ERR_DEVICE;
+	}
+
+      grp_ctx->seq++;
+      grp_ctx->togle = (grp_ctx->togle ^ 0x1);
+      grp_ctx->bid++;
+      step = 0;
+      jmp = 0;
+    }
+
+  grp_ctx->coll_op = GASPI_NONE;
+  grp_ctx->lastmask = 0x1;
+  grp_ctx->level = 0;
+  grp_ctx->bid = 0;
+
+  return GASPI_SUCCESS;
+
+ timeoutL:
+  grp_ctx->level = step;
+  grp_ctx->lastmask = 0x80000001;
+
+  return GASPI_TIMEOUT;
+
+  /* the collectives queue is full: the step posts again (the same
+     data to the same place) when resumed */
+ postL:
+  if( eret == GASPI_TIMEOUT )
+    {
+      grp_ctx->level = step;
+      grp_ctx->lastmask = 0x1;
+    }
+
+  return eret;
+}
+
+#pragma weak gaspi_allreduce = pgaspi_allreduce
+gaspi_return_t
+pgaspi_allreduce (const gaspi_pointer_t buf_send,
+		  gaspi_pointer_t const buf_recv,
+		  const gaspi_number_t elem_cnt,
+		  const gaspi_operation_t op,
+		  const gaspi_datatype_t type,
+		  const gaspi_group_t g,
+		  const gaspi_timeout_t timeout_ms)
+{
+  gaspi_verify_init("gaspi_allreduce_user");
+  gaspi_verify_null_ptr(buf_send);
+  gaspi_verify_null_ptr(buf_recv);
+  gaspi_verify_group(g);
+
+  /* beyond the small message buffer (or from the size given in the
+     decision table) use the bandwidth optimized algorithm, as long
+     as a chunk can be split among the group */
+  const int large = (_gaspi_allreduce_algorithm(g, elem_cnt, glb_gaspi_typ_size[type])
+		     == GASPI_ALLREDUCE_RSAG);
+
+  if(large && _gaspi_allreduce_large_chunk(g, glb_gaspi_typ_size[type]) == 0)
+    return GASPI_ERR_INV_NUM;
+
+  if(lock_gaspi_tout (&glb_gaspi_group_ctx[g].gl, timeout_ms))
+    {
+      return GASPI_TIMEOUT;
+    }
+
+  if(!(glb_gaspi_group_ctx[g].coll_op & GASPI_ALLREDUCE))
+    {
+      unlock_gaspi (&glb_gaspi_group_ctx[g].gl);
+      return GASPI_ERR_ACTIVE_COLL;
+    }
+
+  glb_gaspi_group_ctx[g].coll_op = GASPI_ALLREDUCE;
+
+  struct redux_args r_args;
+  r_args.f_type = GASPI_OP;
+  r_args.f_args.op = op;
+  r_args.f_args.type = type;
+  r_args.elem_size = glb_gaspi_typ_size[type];
+
+  gaspi_return_t eret = GASPI_ERROR;
+  if(large)
+    {
+      eret = _gaspi_allreduce_large(buf_send, buf_recv, elem_cnt,
+				    &r_args, NULL, g, timeout_ms);
+    }
+  else
+    {
+      eret = _gaspi_allreduce(buf_send, buf_recv, elem_cnt,
+			      &r_args, g, timeout_ms);
+    }
+
+
+  unlock_gaspi (&glb_gaspi_group_ctx[g].gl);
+
+  return eret;
+}
+
+#pragma weak gaspi_allreduce_segment = pgaspi_allreduce_segment
+gaspi_return_t
+pgaspi_allreduce_segment (const gaspi_segment_id_t segment_id_send,
+			  const gaspi_offset_t offset_send,
+			  const gaspi_segment_id_t segment_id_recv,
+			  const gaspi_offset_t offset_recv,
+			  const gaspi_number_t elem_cnt,
+			  const gaspi_operation_t op,
+			  const gaspi_datatype_t type,
+			  const gaspi_group_t g,
+			  const gaspi_timeout_t timeout_ms)
+{
+  gaspi_verify_init("gaspi_allreduce_segment");
+  gaspi_verify_group(g);
+
+  const gaspi_size_t esize = glb_gaspi_typ_size[type];
+  const gaspi_size_t bytes = elem_cnt * esize;
+
+  gaspi_verify_local_off(offset_send, segment_id_send, bytes);
+  gaspi_verify_local_off(offset_recv, segment_id_recv, bytes);
+
+  if( _gaspi_allreduce_large_chunk(g, esize) == 0 )
+    return GASPI_ERR_INV_NUM;
+
+  unsigned char * const buf_send =
+    glb_gaspi_ctx.rrmd[segment_id_send][glb_gaspi_ctx.rank].data.buf + offset_send;
+  unsigned char * const buf_recv =
+    glb_gaspi_ctx.rrmd[segment_id_recv][glb_gaspi_ctx.rank].data.buf + offset_recv;
+
+  /* the input is read while the result is built up */
+  if( buf_send < buf_recv + bytes && buf_recv < buf_send + bytes )
+    {
+      gaspi_print_error("Input and result of gaspi_allreduce_segment overlap");
+      return GASPI_ERR_INV_LOC_OFF;
+    }
+
+  const struct gaspi_coll_segs segs =
+    {
+      .seg_send = segment_id_send,
+      .seg_recv = segment_id_recv,
+      .off_send = offset_send,
+      .off_recv = offset_recv
+    };
+
+  if(lock_gaspi_tout (&glb_gaspi_group_ctx[g].gl, timeout_ms))
+    {
+      return GASPI_TIMEOUT;
+    }
+
+  if(!(glb_gaspi_group_ctx[g].coll_op & GASPI_ALLREDUCE))
+    {
+      unlock_gaspi (&glb_gaspi_group_ctx[g].gl);
+      return GASPI_ERR_ACTIVE_COLL;
+    }
+
+  glb_gaspi_group_ctx[g].coll_op = GASPI_ALLREDUCE;
+
+  struct redux_args r_args;
+  r_args.f_type = GASPI_OP;
+  r_args.f_args.op = op;
+  r_args.f_args.type = type;
+  r_args.elem_size = esize;
+
+  const gaspi_return_t eret = _gaspi_allreduce_large(buf_send, buf_recv, elem_cnt,
+						     &r_args, &segs, g, timeout_ms);
+
+  unlock_gaspi (&glb_gaspi_group_ctx[g].gl);
+
+  return eret;
+}
+
+#pragma weak gaspi_allreduce_user = pgaspi_allreduce_user
+gaspi_return_t
+pgaspi_allreduce_user (const gaspi_pointer_t buf_send,
+		       gaspi_pointer_t const buf_recv,
+		       const gaspi_number_t elem_cnt,
+		       const gaspi_size_t elem_size,
+		       gaspi_reduce_operation_t const user_fct,
+		       gaspi_state_t const rstate,
+		       const gaspi_group_t g,
+		       const gaspi_timeout_t timeout_ms)
+{
+  gaspi_verify_init("gaspi_allreduce_user");
+  gaspi_verify_null_ptr(buf_send);
+  gaspi_verify_null_ptr(buf_recv);
+  gaspi_verify_group(g);
+
+  /* beyond the small message buffer use the bandwidth optimized
+     algorithm, which applies the operation to blocks of whole
+     elements, as long as a chunk can be split among the group */
+  const int large = (elem_cnt > 255 || elem_size * elem_cnt > GPI2_REDUX_BUF_SIZE);
+
+  if(large && _gaspi_allreduce_large_chunk(g, elem_size) == 0)
+    return GASPI_ERR_INV_SIZE;
+
+  if(lock_gaspi_tout (&glb_gaspi_group_ctx[g].gl, timeout_ms))
+    {
+      return GASPI_TIMEOUT;
+    }
+
+  if(!(glb_gaspi_group_ctx[g].coll_op & GASPI_ALLREDUCE_USER))
+    {
+      unlock_gaspi (&glb_gaspi_group_ctx[g].gl);
+      return GASPI_ERR_ACTIVE_COLL;
+    }
+
+  glb_gaspi_group_ctx[g].coll_op = GASPI_ALLREDUCE_USER;
+
+  gaspi_return_t eret = GASPI_ERROR;
+
+  struct redux_args r_args;
+  r_args.f_type = GASPI_USER;
+  r_args.elem_size = elem_size;
+  r_args.f_args.user_fct = user_fct;
+  r_args.f_args.rstate = rstate;
+
+  if(large)
+    {
+      eret = _gaspi_allreduce_large(buf_send, buf_recv, elem_cnt,
+				    &r_args, NULL, g, timeout_ms);
+    }
+  else
+    {
+      eret = _gaspi_allreduce(buf_send, buf_recv, elem_cnt,
+			      &r_args, g, timeout_ms);
+    }
+
+  unlock_gaspi (&glb_gaspi_group_ctx[g].gl);
+
+  return eret;
+}
+
+/* Broadcast.
+
+   The message travels down a tree rooted at root: a binomial tree or,
+   for large messages, a chain. It is cut in chunks of GPI2_BCAST_CHUNK
+   bytes staged in a ring of GPI2_BCAST_DEPTH slots of the group buffer
+   such that a rank forwards a chunk to its children while the next
+   ones arrive.
+
+   Chunks are numbered with the group sequence number (seq), which all
+   members advance identically, and a chunk is announced by writing
+   its number + 1 into the flag of its slot. Once a chunk is forwarded
+   and copied out, a rank acknowledges it to its parent by writing the
+   number of chunks consumed so far into the parent's counter for this
+   rank. A parent only writes into a slot of a child after the child
+   consumed the previous chunk of that slot. As the tree depends on
+   the root, each rank first tells its (new) parent how far it is.
+
+   State for resuming after a timeout: bid is the chunk of the message,
+   level the step within the chunk (0: receive, 1..n: send to child n)
+   and the top bit of lastmask is set once the parent was told. */
+#define GPI2_BCAST_FLAG(p)    ((p) * sizeof(unsigned int))
+#define GPI2_BCAST_SRC(p)     (128 + (p) * sizeof(unsigned int))
+#define GPI2_BCAST_ACK_SRC(p) (256 + (p) * sizeof(unsigned int))
+#define GPI2_BCAST_RING(p)    (GPI2_BCAST_FLAGS + (p) * GPI2_BCAST_CHUNK)
+#define GPI2_BCAST_ACK(r)     (GPI2_BCAST_RING(GPI2_BCAST_DEPTH) + (r) * sizeof(unsigned int))
+
+/* The chain forwards each chunk once per rank while in the binomial
+   tree a rank sends it to each of its children. With n chunks and a
+   tree of depth d, the chain needs about n + tnc - 2 steps and the
+   tree n * d. */
+static inline int
+_gaspi_bcast_chain (const gaspi_group_t g, const gaspi_size_t size)
+{
+  const gaspi_group_ctx * const grp_ctx = &(glb_gaspi_group_ctx[g]);
+
+  const gaspi_size_t nchunks = (size + GPI2_BCAST_CHUNK - 1) / GPI2_BCAST_CHUNK;
+  const gaspi_size_t depth = grp_ctx->pof2_exp + (grp_ctx->next_pof2 < grp_ctx->tnc);
+
+  return (nchunks + grp_ctx->tnc - 2 < nchunks * depth);
+}
+
+/* Parent and children (group indices) of the calling rank, children
+   with the largest subtrees first. Returns the number of children. */
+static int
+_gaspi_bcast_tree (const gaspi_group_t g,
+		   const int root,
+		   const int chain,
+		   int * const parent,
+		   int * const children)
+{
+  int mask, nchildren = 0;
+  const gaspi_group_ctx * const grp_ctx = &(glb_gaspi_group_ctx[g]);
+
+  const int size = grp_ctx->tnc;
+  const int vrank = (grp_ctx->rank - root + size) % size;
+
+  *parent = -1;
+
+  if( chain )
+    {
+      if( vrank > 0 )
+	{
+	  *parent = (vrank - 1 + root) % size;
+	}
+
+      if( vrank + 1 < size )
+	{
+	  children[nchildren++] = (vrank + 1 + root) % size;
+	}
+
+      return nchildren;
+    }
+
+  for(mask = 1; mask < size; mask <<= 1)
+    {
+      if( vrank & mask )
+	{
+	  *parent = (vrank - mask + root) % size;
+	  break;
+	}
+    }
+
+  for(mask >>= 1; mask > 0; mask >>= 1)
+    {
+      if( vrank + mask < size )
+	{
+	  children[nchildren++] = (vrank + mask + root) % size;
+	}
+    }
+
+  return nchildren;
+}
+
+static gaspi_return_t
+_gaspi_bcast (gaspi_pointer_t const buf,
+	      const gaspi_size_t size,
+	      const int root,
+	      const gaspi_group_t g,
+	      const gaspi_timeout_t timeout_ms)
+{
+  int i, parent;
+  int children[32];
+  gaspi_return_t eret = GASPI_ERROR;
+  gaspi_group_ctx * const grp_ctx = &(glb_gaspi_group_ctx[g]);
+
+  const int nchildren = _gaspi_bcast_tree(g, root, _gaspi_bcast_chain(g, size),
+					  &parent, children);
+
+  const gaspi_number_t nchunks = (gaspi_number_t) ((size + GPI2_BCAST_CHUNK - 1) / GPI2_BCAST_CHUNK);
+
+  unsigned char * const base = grp_ctx->rrcd[glb_gaspi_ctx.rank].data.buf + COLL_MEM_BCAST;
+  volatile unsigned int * const flags = (volatile unsigned int *) (base + GPI2_BCAST_FLAG(0));
+  volatile unsigned int * const acks = (volatile unsigned int *) (base + GPI2_BCAST_ACK(0));
+  unsigned int * const flag_src = (unsigned int *) (base + GPI2_BCAST_SRC(0));
+  unsigned int * const ack_src = (unsigned int *) (base + GPI2_BCAST_ACK_SRC(0));
+
+  const gaspi_cycles_t s0 = gaspi_get_cycles();
+
+  if( parent >= 0 && !(grp_ctx->lastmask >> 31) )
+    {
+      ack_src[GPI2_BCAST_DEPTH] = grp_ctx->seq;
+
+      if( (eret = _gaspi_coll_post_write(g, grp_ctx->rank_grp[parent],
+					 &ack_src[GPI2_BCAST_DEPTH], sizeof(unsigned int),
+					 COLL_MEM_BCAST + GPI2_BCAST_ACK(grp_ctx->rank),
+					 timeout_ms)) != GASPI_SUCCESS )
+	{
+	  return eret;
+	}
+
+      grp_ctx->lastmask = 0x80000001;
+    }
+
+  while( (gaspi_number_t) grp_ctx->bid < nchunks )
+    {
+      const unsigned int cseq = grp_ctx->seq + grp_ctx->bid;
+      const unsigned int pos = cseq % GPI2_BCAST_DEPTH;
+      const gaspi_size_t off = (gaspi_size_t) grp_ctx->bid * GPI2_BCAST_CHUNK;
+      const gaspi_size_t len = MIN(GPI2_BCAST_CHUNK, size - off);
+
+      unsigned char * const slot = base + GPI2_BCAST_RING(pos);
+
+      if( grp_ctx->level == 0 )
+	{
+	  if( parent < 0 )
+	    {
+	      /* the slot is still the source of an earlier chunk */
+	      for(i = 0; i < nchildren; i++)
+		{
+		  if( _gaspi_coll_wait_count(&acks[children[i]], cseq - GPI2_BCAST_DEPTH + 1,
+					     s0, timeout_ms) != GASPI_SUCCESS )
+		    {
+		      return GASPI_TIMEOUT;
+		    }
+		}
+
+	      memcpy(slot, (unsigned char *) buf + off, len);
+	    }
+	  else if( _gaspi_coll_wait_flag(&flags[pos], cseq + 1, s0, timeout_ms) != GASPI_SUCCESS )
+	    {
+	      return GASPI_TIMEOUT;
+	    }
+
+	  flag_src[pos] = cseq + 1;
+	  grp_ctx->level = 1;
+	}
+
+      while( grp_ctx->level <= nchildren )
+	{
+	  const int child = children[grp_ctx->level - 1];
+	  const int dst = grp_ctx->rank_grp[child];
+
+	  if( _gaspi_coll_wait_count(&acks[child], cseq - GPI2_BCAST_DEPTH + 1,
+				     s0, timeout_ms) != GASPI_SUCCESS )
+	    {
+	      return GASPI_TIMEOUT;
+	    }
+
+	  if( (eret = _gaspi_coll_post_write(g, dst, slot, len,
+					     COLL_MEM_BCAST + GPI2_BCAST_RING(pos),
+					     timeout_ms)) != GASPI_SUCCESS )
+	    {
+	      return eret;
+	    }
+
+	  if( (eret = _gaspi_coll_post_write(g, dst, &flag_src[pos], sizeof(unsigned int),
+					     COLL_MEM_BCAST + GPI2_BCAST_FLAG(pos),
+					     timeout_ms)) != GASPI_SUCCESS )
+	    {
+	      return eret;
+	    }
+
+	  grp_ctx->level++;
+	}
+
+      if( parent >= 0 )
+	{
+	  memcpy((unsigned char *) buf + off, slot, len);
+
+	  /* the parent may refill the slot once we are done sending it */
+	  if( (eret = _gaspi_coll_drain(s0, timeout_ms)) != GASPI_SUCCESS )
+	    {
+	      return eret;
+	    }
+
+	  ack_src[pos] = cseq + 1;
+
+	  if( (eret = _gaspi_coll_post_write(g, grp_ctx->rank_grp[parent],
+					     &ack_src[pos], sizeof(unsigned int),
+					     COLL_MEM_BCAST + GPI2_BCAST_ACK(grp_ctx->rank),
+					     timeout_ms)) != GASPI_SUCCESS )
+	    {
+	      return eret;
+	    }
+	}
+
+      grp_ctx->bid++;
+      grp_ctx->level = 0;
+    }
+
+  /* the ring may be refilled by other parents in the next broadcast */
+  if( (eret = _gaspi_coll_drain(s0, timeout_ms)) != GASPI_SUCCESS )
+    {
+      return eret;
+    }
+
+  grp_ctx->seq += nchunks;
+  grp_ctx->coll_op = GASPI_NONE;
+  grp_ctx->lastmask = 0x1;
+  grp_ctx->level = 0;
+  grp_ctx->bid = 0;
+
+  return GASPI_SUCCESS;
+}
+
+#pragma weak gaspi_bcast = pgaspi_bcast
+gaspi_return_t
+pgaspi_bcast (gaspi_pointer_t const buf,
+	      const gaspi_size_t size,
+	      const gaspi_rank_t root,
+	      const gaspi_group_t g,
+	      const gaspi_timeout_t timeout_ms)
+{
+  gaspi_verify_init("gaspi_bcast");
+  gaspi_verify_null_ptr(buf);
+  gaspi_verify_group(g);
+
+  const int key = (int) root;
+  const int * const groot = (const int *) bsearch (&key, glb_gaspi_group_ctx[g].rank_grp,
+						   glb_gaspi_group_ctx[g].tnc, sizeof (int),
+						   gaspi_comp_ranks);
+  if( groot == NULL )
+    {
+      return GASPI_ERR_INV_RANK;
+    }
+
+  if( size == 0 || glb_gaspi_group_ctx[g].tnc == 1 )
+    {
+      return GASPI_SUCCESS;
+    }
+
+  if(lock_gaspi_tout (&glb_gaspi_group_ctx[g].gl, timeout_ms))
+    {
+      return GASPI_TIMEOUT;
+    }
+
+  if(!(glb_gaspi_group_ctx[g].coll_op & GASPI_BCAST))
+    {
+      unlock_gaspi (&glb_gaspi_group_ctx[g].gl);
+      return GASPI_ERR_ACTIVE_COLL;
+    }
+
+  glb_gaspi_group_ctx[g].coll_op = GASPI_BCAST;
+
+  const gaspi_return_t eret = _gaspi_bcast(buf, size,
+					   (int) (groot - glb_gaspi_group_ctx[g].rank_grp),
+					   g, timeout_ms);
+
+  unlock_gaspi (&glb_gaspi_group_ctx[g].gl);
+
+  return eret;
+}
+
+/* Allgather.
+
+   Each member's block is in place in the user segment and is written
+   directly into the same segment and offset of the other members:
+   with recursive doubling (power of two groups) or Bruck's algorithm
+   in log2 steps for small totals and around a ring otherwise. Blocks
+   are sent at their final position, so Bruck needs no rotation and
+   a step sends at most two pieces.
+
+   A write is followed by a flag carrying the group sequence number
+   plus step + 1 (the ring counts its steps in a single flag). As the
+   result lands in user memory, a member only writes to a peer after
+   the peer announced that it entered the operation.
+
+   State for resuming after a timeout: level is the step, the top bit
+   of lastmask is set once the peers were told that we entered and
+   the next one once the writes of the current step were posted. */
+#define GPI2_ALLGATHER_FLAG(k)   ((k) * sizeof(unsigned int))
+#define GPI2_ALLGATHER_READY(k)  ((GPI2_ALLGATHER_STEPS + (k)) * sizeof(unsigned int))
+#define GPI2_ALLGATHER_SRC(k)    ((2 * GPI2_ALLGATHER_STEPS + (k)) * sizeof(unsigned int))
+#define GPI2_ALLGATHER_READY_SRC (3 * GPI2_ALLGATHER_STEPS * sizeof(unsigned int))
+
+enum gaspi_allgather_alg
+{
+  GPI2_ALLGATHER_RD,
+  GPI2_ALLGATHER_BRUCK,
+  GPI2_ALLGATHER_RING
+};
+
+struct gaspi_allgather_step
+{
+  int dst, src;
+  int first, count;
+  int flag;
+};
+
+static inline enum gaspi_allgather_alg
+_gaspi_allgather_algorithm (const gaspi_group_t g, const gaspi_size_t total)
+{
+  const gaspi_group_ctx * const grp_ctx = &(glb_gaspi_group_ctx[g]);
+
+  if( total > GPI2_ALLGATHER_SHORT )
+    {
+      return GPI2_ALLGATHER_RING;
+    }
+
+  return (grp_ctx->next_pof2 == grp_ctx->tnc) ? GPI2_ALLGATHER_RD : GPI2_ALLGATHER_BRUCK;
+}
+
+static inline int
+_gaspi_allgather_nsteps (const gaspi_group_t g, const enum gaspi_allgather_alg alg)
+{
+  const gaspi_group_ctx * const grp_ctx = &(glb_gaspi_group_ctx[g]);
+
+  if( alg == GPI2_ALLGATHER_RING )
+    {
+      return grp_ctx->tnc - 1;
+    }
+
+  return grp_ctx->pof2_exp + (grp_ctx->next_pof2 < grp_ctx->tnc);
+}
+
+/* Peers (group indices), blocks sent and flag used in step k */
+static inline void
+_gaspi_allgather_step (const gaspi_group_t g,
+		       const enum gaspi_allgather_alg alg,
+		       const int k,
+		       struct gaspi_allgather_step * const st)
+{
+  const gaspi_group_ctx * const grp_ctx = &(glb_gaspi_group_ctx[g]);
+
+  const int size = grp_ctx->tnc;
+  const int rank = grp_ctx->rank;
+  const int mask = 1 << k;
+
+  switch( alg )
+    {
+    case GPI2_ALLGATHER_RD:
+      st->dst = st->src = rank ^ mask;
+      st->first = rank & ~(mask - 1);
+      st->count = mask;
+      st->flag = k;
+      break;
+    case GPI2_ALLGATHER_BRUCK:
+      st->dst = (rank - mask + size) % size;
+      st->src = (rank + mask) % size;
+      st->first = rank;
+      st->count = MIN(mask, size - mask);
+      st->flag = k;
+      break;
+    case GPI2_ALLGATHER_RING:
+      st->dst = (rank + 1) % size;
+      st->src = (rank - 1 + size) % size;
+      st->first = (rank - k + size) % size;
+      st->count = 1;
+      st->flag = 0;
+      break;
+    }
+}
+
+/* displs has tnc + 1 entries, block i spans [displs[i], displs[i + 1]) */
+static gaspi_return_t
+_gaspi_allgather (const gaspi_segment_id_t seg,
+		  const gaspi_offset_t offset,
+		  const gaspi_offset_t * const displs,
+		  const gaspi_group_t g,
+		  const gaspi_timeout_t timeout_ms)
+{
+  int k;
+  struct gaspi_allgather_step st;
+  gaspi_return_t eret = GASPI_ERROR;
+  gaspi_group_ctx * const grp_ctx = &(glb_gaspi_group_ctx[g]);
+
+  const int size = grp_ctx->tnc;
+  const enum gaspi_allgather_alg alg = _gaspi_allgather_algorithm(g, displs[size]);
+  const int nsteps = _gaspi_allgather_nsteps(g, alg);
+
+  unsigned char * const base = grp_ctx->rrcd[glb_gaspi_ctx.rank].data.buf + COLL_MEM_ALLGATHER;
+  volatile unsigned int * const flags = (volatile unsigned int *) (base + GPI2_ALLGATHER_FLAG(0));
+  volatile unsigned int * const ready = (volatile unsigned int *) (base + GPI2_ALLGATHER_READY(0));
+  unsigned int * const flag_src = (unsigned int *) (base + GPI2_ALLGATHER_SRC(0));
+  unsigned int * const ready_src = (unsigned int *) (base + GPI2_ALLGATHER_READY_SRC);
+
+  const gaspi_cycles_t s0 = gaspi_get_cycles();
+
+  /* tell whoever writes to us that we are in */
+  if( !(grp_ctx->lastmask >> 31) )
+    {
+      *ready_src = grp_ctx->seq + 1;
+
+      for(k = 0; k < (alg == GPI2_ALLGATHER_RING ? 1 : nsteps); k++)
+	{
+	  _gaspi_allgather_step(g, alg, k, &st);
+
+	  if( (eret = _gaspi_coll_post_write(g, grp_ctx->rank_grp[st.src], ready_src,
+					     sizeof(unsigned int),
+					     COLL_MEM_ALLGATHER + GPI2_ALLGATHER_READY(k),
+					     timeout_ms)) != GASPI_SUCCESS )
+	    {
+	      return eret;
+	    }
+	}
+
+      grp_ctx->lastmask = 0x80000001;
+    }
+
+  while( grp_ctx->level < nsteps )
+    {
+      const int step = grp_ctx->level;
+      const unsigned int val = grp_ctx->seq + step + 1;
+
+      _gaspi_allgather_step(g, alg, step, &st);
+
+      if( !(grp_ctx->lastmask & 0x40000000) )
+	{
+	  const int dst = grp_ctx->rank_grp[st.dst];
+	  const int last = st.first + st.count;
+
+	  if( _gaspi_coll_wait_count(&ready[alg == GPI2_ALLGATHER_RING ? 0 : step],
+				     grp_ctx->seq + 1, s0, timeout_ms) != GASPI_SUCCESS )
+	    {
+	      return GASPI_TIMEOUT;
+	    }
+
+	  /* the ring reuses the words the flags are written from */
+	  if( step >= GPI2_ALLGATHER_STEPS && step % GPI2_ALLGATHER_STEPS == 0 )
+	    {
+	      if( (eret = _gaspi_coll_drain(s0, timeout_ms)) != GASPI_SUCCESS )
+		{
+		  return eret;
+		}
+	    }
+
+	  /* blocks past the end wrap around to the start */
+	  const gaspi_offset_t lo0 = displs[st.first];
+	  const gaspi_offset_t hi0 = displs[MIN(last, size)];
+	  const gaspi_offset_t hi1 = (last > size) ? displs[last - size] : 0;
+
+	  if( hi0 > lo0 )
+	    {
+	      if( (eret = _gaspi_coll_post_seg_write(g, dst, seg, offset + lo0, hi0 - lo0,
+						     timeout_ms)) != GASPI_SUCCESS )
+		{
+		  return eret;
+		}
+	    }
+
+	  if( hi1 > 0 )
+	    {
+	      if( (eret = _gaspi_coll_post_seg_write(g, dst, seg, offset, hi1,
+						     timeout_ms)) != GASPI_SUCCESS )
+		{
+		  return eret;
+		}
+	    }
+
+	  flag_src[step % GPI2_ALLGATHER_STEPS] = val;
+
+	  if( (eret = _gaspi_coll_post_write(g, dst, &flag_src[step % GPI2_ALLGATHER_STEPS],
+					     sizeof(unsigned int),
+					     COLL_MEM_ALLGATHER + GPI2_ALLGATHER_FLAG(st.flag),
+					     timeout_ms)) != GASPI_SUCCESS )
+	    {
+	      return eret;
+	    }
+
+	  grp_ctx->lastmask |= 0x40000000;
+	}
+
+      if( _gaspi_coll_wait_count(&flags[st.flag], val, s0, timeout_ms) != GASPI_SUCCESS )
+	{
+	  return GASPI_TIMEOUT;
+	}
+
+      grp_ctx->lastmask &= ~0x40000000;
+      grp_ctx->level++;
+    }
+
+  /* our segment is the source of the writes */
+  if( (eret = _gaspi_coll_drain(s0, timeout_ms)) != GASPI_SUCCESS )
+    {
+      return eret;
+    }
+
+  grp_ctx->seq += nsteps;
+  grp_ctx->coll_op = GASPI_NONE;
+  grp_ctx->lastmask = 0x1;
+  grp_ctx->level = 0;
+
+  return GASPI_SUCCESS;
+}
+
+static gaspi_return_t
+_gaspi_allgather_entry (const gaspi_segment_id_t seg,
+			const gaspi_offset_t offset,
+			const gaspi_size_t size,
+			const gaspi_size_t * const sizes,
+			const gaspi_group_t g,
+			const gaspi_timeout_t timeout_ms)
+{
+  int i;
+  gaspi_size_t total = 0;
+  gaspi_return_t eret = GASPI_ERROR;
+
+  const int tnc = glb_gaspi_group_ctx[g].tnc;
+
+  for(i = 0; i < tnc; i++)
+    {
+      total += (sizes == NULL) ? size : sizes[i];
+    }
+
+  gaspi_verify_local_off(offset, seg, total);
+
+  if( tnc == 1 || total == 0 )
+    {
+      return GASPI_SUCCESS;
+    }
+
+  gaspi_offset_t *displs = (gaspi_offset_t *) malloc ((tnc + 1) * sizeof (gaspi_offset_t));
+  if( displs == NULL )
+    {
+      return GASPI_ERR_MEMALLOC;
+    }
+
+  displs[0] = 0;
+  for(i = 0; i < tnc; i++)
+    {
+      displs[i + 1] = displs[i] + ((sizes == NULL) ? size : sizes[i]);
+    }
+
+  if(lock_gaspi_tout (&glb_gaspi_group_ctx[g].gl, timeout_ms))
+    {
+      free (displs);
+      return GASPI_TIMEOUT;
+    }
+
+  if(!(glb_gaspi_group_ctx[g].coll_op & GASPI_ALLGATHER))
+    {
+      unlock_gaspi (&glb_gaspi_group_ctx[g].gl);
+      free (displs);
+      return GASPI_ERR_ACTIVE_COLL;
+    }
+
+  glb_gaspi_group_ctx[g].coll_op = GASPI_ALLGATHER;
+
+  eret = _gaspi_allgather(seg, offset, displs, g, timeout_ms);
+
+  unlock_gaspi (&glb_gaspi_group_ctx[g].gl);
+
+  free (displs);
+
+  return eret;
+}
+
+#pragma weak gaspi_allgather = pgaspi_allgather
+gaspi_return_t
+pgaspi_allgather (const gaspi_segment_id_t segment_id,
+		  const gaspi_offset_t offset,
+		  const gaspi_size_t size,
+		  const gaspi_group_t g,
+		  const gaspi_timeout_t timeout_ms)
+{
+  gaspi_verify_init("gaspi_allgather");
+  gaspi_verify_group(g);
+
+  return _gaspi_allgather_entry(segment_id, offset, size, NULL, g, timeout_ms);
+}
+
+#pragma weak gaspi_allgatherv = pgaspi_allgatherv
+gaspi_return_t
+pgaspi_allgatherv (const gaspi_segment_id_t segment_id,
+		   const gaspi_offset_t offset,
+		   const gaspi_size_t * const sizes,
+		   const gaspi_group_t g,
+		   const gaspi_timeout_t timeout_ms)
+{
+  gaspi_verify_init("gaspi_allgatherv");
+  gaspi_verify_null_ptr(sizes);
+  gaspi_verify_group(g);
+
+  return _gaspi_allgather_entry(segment_id, offset, 0, sizes, g, timeout_ms);
+}
+
+/* Alltoall.
+
+   The blocks go through the node leaders: the members of a node stage
+   their blocks in the node's shared memory, ordered by destination
+   node, and a leader sends the blocks for another node as a single
+   message to that node's leader, which stages them for its members.
+   The number of messages between nodes thus drops from tnc^2 to
+   nnodes^2. Without a node level, members stage in private memory
+   and are their own leader.
+
+   Local members synchronise through flags in the shared memory
+   carrying the node epoch: all entered and published their block
+   sizes (so the staging area of the last call is free), all staged
+   their blocks, and the leader received the messages of the other
+   nodes.
+
+   The leaders exchange the messages pairwise, in round r sending to
+   node + r and receiving from node - r. A message travels in chunks
+   through the GPI2_ALLTOALL_DEPTH receive slots of the group buffer
+   and the receiver grants the slots with a credit counter at the
+   sender: the number of chunks the sender may have written. The
+   first credit of a round tells that the receiver is ready and is
+   sent even for empty messages; the sender resets the counter once
+   it got the last credit of the round. A chunk is announced by
+   writing its number + 1 into the flag of its slot, reset when the
+   chunk is consumed.
+
+   State for resuming after a timeout: level is the phase (0: enter,
+   1: stage, 2: copy out the local blocks, 3: exchange between the
+   leaders, 4: copy out the other blocks), bid the round, tmprank and
+   dsize the chunks sent and received in the round. The top bit of
+   lastmask is set once the first credit of the round was sent and
+   the next one once all chunks of the round were sent. */
+#define GPI2_ALLTOALL_FLAG(p)       ((p) * sizeof(unsigned int))
+#define GPI2_ALLTOALL_FLAG_SRC(p)   (64 + (p) * sizeof(unsigned int))
+#define GPI2_ALLTOALL_CREDIT_SRC(p) (128 + (p) * sizeof(unsigned int))
+#define GPI2_ALLTOALL_SEND(p)       (GPI2_ALLTOALL_FLAGS + (p) * GPI2_ALLTOALL_CHUNK)
+#define GPI2_ALLTOALL_RECV(p)       (GPI2_ALLTOALL_SEND(GPI2_ALLTOALL_DEPTH + (p)))
+#define GPI2_ALLTOALL_CREDIT(r)     (GPI2_ALLTOALL_SEND(2 * GPI2_ALLTOALL_DEPTH) + (r) * sizeof(unsigned int))
+
+/* Node area (see _gaspi_alltoall_node_size) for nl local members */
+#define GPI2_ALLTOALL_ENTERED(nl, i) ((i) * GPI2_NODE_FLAG_STRIDE)
+#define GPI2_ALLTOALL_STAGED(nl, i)  (((nl) + (i)) * GPI2_NODE_FLAG_STRIDE)
+#define GPI2_ALLTOALL_DONE(nl)       (2 * (nl) * GPI2_NODE_FLAG_STRIDE)
+#define GPI2_ALLTOALL_SIZES(nl, t, e, i)				\
+  ((2 * (nl) + 1) * GPI2_NODE_FLAG_STRIDE				\
+   + ((((e) & 1) * (nl) + (i)) * 2 * (t)) * sizeof(gaspi_size_t))
+
+/* Where the blocks are in the user segments and in the staging area */
+struct gaspi_alltoall_layout
+{
+  gaspi_size_t *msg_send;	/* message to each node */
+  gaspi_size_t *msg_recv;	/* message from each node */
+  gaspi_size_t *send_base;
+  gaspi_size_t *recv_base;
+  gaspi_size_t *stage_off;	/* our block for each member */
+  gaspi_size_t *unstage_off;	/* the block from each member */
+  gaspi_size_t *send_displ;
+  gaspi_size_t *recv_displ;
+  gaspi_size_t total;
+};
+
+/* Without a node level, every member is a node of its own */
+static gaspi_return_t
+_gaspi_alltoall_flat_topology (const gaspi_group_t g)
+{
+  int i;
+  gaspi_group_ctx * const grp_ctx = &(glb_gaspi_group_ctx[g]);
+
+  grp_ctx->node_first = (int *) malloc ((grp_ctx->tnc + 1) * sizeof (int));
+  grp_ctx->node_members = (int *) malloc (grp_ctx->tnc * sizeof (int));
+  if( grp_ctx->node_first == NULL || grp_ctx->node_members == NULL )
+    {
+      pgaspi_group_node_release (g);
+      return GASPI_ERR_MEMALLOC;
+    }
+
+  for(i = 0; i < grp_ctx->tnc; i++)
+    {
+      grp_ctx->node_first[i] = i;
+      grp_ctx->node_members[i] = i;
+    }
+  grp_ctx->node_first[grp_ctx->tnc] = grp_ctx->tnc;
+
+  grp_ctx->nnodes = grp_ctx->tnc;
+  grp_ctx->node_idx = grp_ctx->rank;
+  grp_ctx->nlocal = 1;
+  grp_ctx->local_idx = 0;
+
+  return GASPI_SUCCESS;
+}
+
+/* Offsets of all blocks of this call. The staging area holds the
+   messages to every node (our own included), each ordered by the
+   receiving member and then by the sending member, followed by the
+   messages received from the other nodes, in the same order. */
+static void
+_gaspi_alltoall_layout (const gaspi_group_t g, struct gaspi_alltoall_layout * const l)
+{
+  int d, k, i;
+  gaspi_size_t off = 0;
+  const gaspi_group_ctx * const grp_ctx = &(glb_gaspi_group_ctx[g]);
+
+  const int tnc = grp_ctx->tnc;
+  const int nl = grp_ctx->nlocal;
+  const int li = grp_ctx->local_idx;
+  const int node = grp_ctx->node_idx;
+  const int * const local = &grp_ctx->node_members[grp_ctx->node_first[node]];
+
+  /* row i: what local member i sends, followed by what it receives */
+  const gaspi_size_t * const sizes = (const gaspi_size_t *)
+    (grp_ctx->node_a2a + GPI2_ALLTOALL_SIZES(nl, tnc, grp_ctx->node_epoch, 0));
+
+  l->send_displ[0] = l->recv_displ[0] = 0;
+  for(k = 0; k < tnc; k++)
+    {
+      l->send_displ[k + 1] = l->send_displ[k] + sizes[li * 2 * tnc + k];
+      l->recv_displ[k + 1] = l->recv_displ[k] + sizes[li * 2 * tnc + tnc + k];
+    }
+
+  for(d = 0; d < grp_ctx->nnodes; d++)
+    {
+      l->send_base[d] = off;
+
+      for(k = grp_ctx->node_first[d]; k < grp_ctx->node_first[d + 1]; k++)
+	{
+	  const int j = grp_ctx->node_members[k];
+
+	  for(i = 0; i < nl; i++)
+	    {
+	      if( i == li )
+		{
+		  l->stage_off[j] = off;
+		}
+
+	      if( j == grp_ctx->rank )
+		{
+		  l->unstage_off[local[i]] = off;
+		}
+
+	      off += sizes[i * 2 * tnc + j];
+	    }
+	}
+
+      l->msg_send[d] = off - l->send_base[d];
+    }
+
+  off = (off + 63) & ~((gaspi_size_t) 63);
+
+  for(d = 0; d < grp_ctx->nnodes; d++)
+    {
+      l->recv_base[d] = off;
+
+      if( d != node )
+	{
+	  for(i = 0; i < nl; i++)
+	    {
+	      for(k = grp_ctx->node_first[d]; k < grp_ctx->node_first[d + 1]; k++)
+		{
+		  const int m = grp_ctx->node_members[k];
+
+		  if( i == li )
+		    {
+		      l->unstage_off[m] = off;
+		    }
+
+		  off += sizes[i * 2 * tnc + tnc + m];
+		}
+	    }
+	}
+
+      l->msg_recv[d] = off - l->recv_base[d];
+    }
+
+  l->total = off;
+}
+
+static inline gaspi_return_t
+_gaspi_alltoall_wait_local (volatile unsigned char * const flags,
+			    const int nlocal,
+			    const unsigned int epoch,
+			    const gaspi_cycles_t s0,
+			    const gaspi_timeout_t timeout_ms)
+{
+  int i;
+
+  for(i = 0; i < nlocal; i++)
+    {
+      if( _gaspi_coll_wait_flag((volatile unsigned int *) (flags + i * GPI2_NODE_FLAG_STRIDE),
+				epoch, s0, timeout_ms) != GASPI_SUCCESS )
+	{
+	  return GASPI_TIMEOUT;
+	}
+    }
+
+  return GASPI_SUCCESS;
+}
+
+/* Exchange of the messages between the node leaders */
+static gaspi_return_t
+_gaspi_alltoall_leaders (const gaspi_group_t g,
+			 const struct gaspi_alltoall_layout * const l,
+			 unsigned char * const stage,
+			 const gaspi_cycles_t s0,
+			 const gaspi_timeout_t timeout_ms)
+{
+  gaspi_return_t eret = GASPI_ERROR;
+  gaspi_group_ctx * const grp_ctx = &(glb_gaspi_group_ctx[g]);
+
+  const int nnodes = grp_ctx->nnodes;
+  const int node = grp_ctx->node_idx;
+
+  unsigned char * const base = grp_ctx->rrcd[glb_gaspi_ctx.rank].data.buf + COLL_MEM_ALLTOALL;
+  volatile unsigned int * const flags = (volatile unsigned int *) (base + GPI2_ALLTOALL_FLAG(0));
+  volatile unsigned int * const credits = (volatile unsigned int *) (base + GPI2_ALLTOALL_CREDIT(0));
+  unsigned int * const flag_src = (unsigned int *) (base + GPI2_ALLTOALL_FLAG_SRC(0));
+  unsigned int * const credit_src = (unsigned int *) (base + GPI2_ALLTOALL_CREDIT_SRC(0));
+
+  while( grp_ctx->bid < nnodes - 1 )
+    {
+      const int d = (node + grp_ctx->bid + 1) % nnodes;
+      const int s = (node - grp_ctx->bid - 1 + nnodes) % nnodes;
+
+      const int dst_idx = grp_ctx->node_members[grp_ctx->node_first[d]];
+      const int dst = grp_ctx->rank_grp[dst_idx];
+      const int src = grp_ctx->rank_grp[grp_ctx->node_members[grp_ctx->node_first[s]]];
+
+      const int nsend = (int) ((l->msg_send[d] + GPI2_ALLTOALL_CHUNK - 1) / GPI2_ALLTOALL_CHUNK);
+      const int nrecv = (int) ((l->msg_recv[s] + GPI2_ALLTOALL_CHUNK - 1) / GPI2_ALLTOALL_CHUNK);
+
+      if( !(grp_ctx->lastmask >> 31) )
+	{
+	  /* connect now, the last chunk is sent after the reset of the credit */
+	  if( (eret = _gaspi_coll_prepare(g, dst, timeout_ms)) != GASPI_SUCCESS )
+	    {
+	      return eret;
+	    }
+
+	  credit_src[GPI2_ALLTOALL_DEPTH] = GPI2_ALLTOALL_DEPTH;
+
+	  if( (eret = _gaspi_coll_post_write(g, src, &credit_src[GPI2_ALLTOALL_DEPTH],
+					     sizeof(unsigned int),
+					     COLL_MEM_ALLTOALL + GPI2_ALLTOALL_CREDIT(grp_ctx->rank),
+					     timeout_ms)) != GASPI_SUCCESS )
+	    {
+	      return eret;
+	    }
+
+	  grp_ctx->lastmask |= 0x80000000;
+	}
+
+      while( !(grp_ctx->lastmask & 0x40000000) || grp_ctx->dsize < nrecv )
+	{
+	  int progress = 0;
+
+	  if( !(grp_ctx->lastmask & 0x40000000) && credits[dst_idx] >= (unsigned int) grp_ctx->tmprank + 1 )
+	    {
+	      const int c = grp_ctx->tmprank;
+
+	      if( c >= nsend - 1 )
+		{
+		  credits[dst_idx] = 0;
+		  grp_ctx->lastmask |= 0x40000000;
+		}
+
+	      if( c < nsend )
+		{
+		  const int p = c % GPI2_ALLTOALL_DEPTH;
+		  const gaspi_size_t off = (gaspi_size_t) c * GPI2_ALLTOALL_CHUNK;
+		  const int len = (int) MIN(GPI2_ALLTOALL_CHUNK, l->msg_send[d] - off);
+
+		  memcpy(base + GPI2_ALLTOALL_SEND(p), stage + l->send_base[d] + off, len);
+		  flag_src[p] = c + 1;
+
+		  if( (eret = _gaspi_coll_post_write(g, dst, base + GPI2_ALLTOALL_SEND(p), len,
+						     COLL_MEM_ALLTOALL + GPI2_ALLTOALL_RECV(p),
+						     timeout_ms)) != GASPI_SUCCESS )
+		    {
+		      return eret;
+		    }
+
+		  if( (eret = _gaspi_coll_post_write(g, dst, &flag_src[p], sizeof(unsigned int),
+						     COLL_MEM_ALLTOALL + GPI2_ALLTOALL_FLAG(p),
+						     timeout_ms)) != GASPI_SUCCESS )
+		    {
+		      return eret;
+		    }
+
+		  grp_ctx->tmprank++;
+		}
+
+	      progress = 1;
+	    }
+
+	  if( grp_ctx->dsize < nrecv )
+	    {
+	      const int c = grp_ctx->dsize;
+	      const int p = c % GPI2_ALLTOALL_DEPTH;
+
+	      if( flags[p] == (unsigned int) c + 1 )
+		{
+		  const gaspi_size_t off = (gaspi_size_t) c * GPI2_ALLTOALL_CHUNK;
+		  const int len = (int) MIN(GPI2_ALLTOALL_CHUNK, l->msg_recv[s] - off);
+
+		  memcpy(stage + l->recv_base[s] + off, base + GPI2_ALLTOALL_RECV(p), len);
+		  flags[p] = 0;
+
+		  if( c + GPI2_ALLTOALL_DEPTH < nrecv )
+		    {
+		      credit_src[p] = c + GPI2_ALLTOALL_DEPTH + 1;
+
+		      if( (eret = _gaspi_coll_post_write(g, src, &credit_src[p], sizeof(unsigned int),
+							 COLL_MEM_ALLTOALL + GPI2_ALLTOALL_CREDIT(grp_ctx->rank),
+							 timeout_ms)) != GASPI_SUCCESS )
+			{
+			  return eret;
+			}
+		    }
+
+		  grp_ctx->dsize++;
+		  progress = 1;
+		}
+	    }
+
+	  if( !progress )
+	    {
+	      const gaspi_cycles_t s1 = gaspi_get_cycles();
+	      const gaspi_cycles_t tdelta = s1 - s0;
+	      const float ms = (float) tdelta * glb_gaspi_ctx.cycles_to_msecs;
+
+	      if( ms > timeout_ms )
+		{
+		  return GASPI_TIMEOUT;
+		}
+	    }
+	}
+
+      /* the slots and the words of the flags are reused in the next round */
+      if( (eret = _gaspi_coll_drain(s0, timeout_ms)) != GASPI_SUCCESS )
+	{
+	  return eret;
+	}
+
+      grp_ctx->bid++;
+      grp_ctx->tmprank = 0;
+      grp_ctx->dsize = 0;
+      grp_ctx->lastmask = 0x1;
+    }
+
+  return GASPI_SUCCESS;
+}
+
+static gaspi_return_t
+_gaspi_alltoall (const gaspi_group_t g,
+		 unsigned char * const send,
+		 unsigned char * const recv,
+		 const gaspi_size_t size,
+		 const gaspi_size_t * const send_sizes,
+		 const gaspi_size_t * const recv_sizes,
+		 const gaspi_timeout_t timeout_ms)
+{
+  int k;
+  gaspi_return_t eret = GASPI_ERROR;
+  gaspi_group_ctx * const grp_ctx = &(glb_gaspi_group_ctx[g]);
+
+  const int tnc = grp_ctx->tnc;
+  const int nnodes = grp_ctx->nnodes;
+  const int nl = grp_ctx->nlocal;
+  const int li = grp_ctx->local_idx;
+  const int node = grp_ctx->node_idx;
+
+  unsigned char * const a2a = grp_ctx->node_a2a;
+  volatile unsigned int * const done = (volatile unsigned int *) (a2a + GPI2_ALLTOALL_DONE(nl));
+
+  const gaspi_cycles_t s0 = gaspi_get_cycles();
+
+  if( grp_ctx->level == 0 )
+    {
+      grp_ctx->node_epoch++;
+
+      gaspi_size_t * const sizes = (gaspi_size_t *)
+	(a2a + GPI2_ALLTOALL_SIZES(nl, tnc, grp_ctx->node_epoch, li));
+
+      for(k = 0; k < tnc; k++)
+	{
+	  sizes[k] = (send_sizes == NULL) ? size : send_sizes[k];
+	  sizes[tnc + k] = (recv_sizes == NULL) ? size : recv_sizes[k];
+	}
+
+      __sync_synchronize();
+      *((volatile unsigned int *) (a2a + GPI2_ALLTOALL_ENTERED(nl, li))) = grp_ctx->node_epoch;
+
+      grp_ctx->bid = 0;
+      grp_ctx->tmprank = 0;
+      grp_ctx->dsize = 0;
+      grp_ctx->lastmask = 0x1;
+      grp_ctx->level = 1;
+    }
+
+  const unsigned int epoch = grp_ctx->node_epoch;
+
+  /* nobody overwrites the flags or the sizes before we enter the next
+     call, so the later phases can rely on them when resuming */
+  if( grp_ctx->level == 1
+      && _gaspi_alltoall_wait_local(a2a + GPI2_ALLTOALL_ENTERED(nl, 0), nl, epoch,
+				    s0, timeout_ms) != GASPI_SUCCESS )
+    {
+      return GASPI_TIMEOUT;
+    }
+
+  struct gaspi_alltoall_layout l;
+  gaspi_size_t *mem = (gaspi_size_t *) malloc ((4 * nnodes + 4 * tnc + 2) * sizeof (gaspi_size_t));
+  if( mem == NULL )
+    {
+      return GASPI_ERR_MEMALLOC;
+    }
+
+  l.msg_send = mem;
+  l.msg_recv = l.msg_send + nnodes;
+  l.send_base = l.msg_recv + nnodes;
+  l.recv_base = l.send_base + nnodes;
+  l.stage_off = l.recv_base + nnodes;
+  l.unstage_off = l.stage_off + tnc;
+  l.send_displ = l.unstage_off + tnc;
+  l.recv_displ = l.send_displ + tnc + 1;
+
+  _gaspi_alltoall_layout(g, &l);
+
+  if( _gaspi_alltoall_stage(g, l.total) != GASPI_SUCCESS )
+    {
+      free (mem);
+      grp_ctx->coll_op = GASPI_NONE;
+      grp_ctx->level = 0;
+      return GASPI_ERROR;
+    }
+
+  unsigned char * const stage = grp_ctx->node_stage;
+
+  if( grp_ctx->level == 1 )
+    {
+      for(k = 0; k < tnc; k++)
+	{
+	  memcpy(stage + l.stage_off[k], send + l.send_displ[k],
+		 l.send_displ[k + 1] - l.send_displ[k]);
+	}
+
+      __sync_synchronize();
+      *((volatile unsigned int *) (a2a + GPI2_ALLTOALL_STAGED(nl, li))) = epoch;
+      grp_ctx->level = 2;
+    }
+
+  if( grp_ctx->level == 2 )
+    {
+      if( _gaspi_alltoall_wait_local(a2a + GPI2_ALLTOALL_STAGED(nl, 0), nl, epoch,
+				     s0, timeout_ms) != GASPI_SUCCESS )
+	{
+	  free (mem);
+	  return GASPI_TIMEOUT;
+	}
+
+      for(k = grp_ctx->node_first[node]; k < grp_ctx->node_first[node + 1]; k++)
+	{
+	  const int m = grp_ctx->node_members[k];
+
+	  memcpy(recv + l.recv_displ[m], stage + l.unstage_off[m],
+		 l.recv_displ[m + 1] - l.recv_displ[m]);
+	}
+
+      grp_ctx->level = (li == 0) ? 3 : 4;
+    }
+
+  if( grp_ctx->level == 3 )
+    {
+      if( (eret = _gaspi_alltoall_leaders(g, &l, stage, s0, timeout_ms)) != GASPI_SUCCESS )
+	{
+	  free (mem);
+	  return eret;
+	}
+
+      __sync_synchronize();
+      *done = epoch;
+      grp_ctx->level = 4;
+    }
+
+  if( nnodes > 1 )
+    {
+      if( _gaspi_coll_wait_flag(done, epoch, s0, timeout_ms) != GASPI_SUCCESS )
+	{
+	  free (mem);
+	  return GASPI_TIMEOUT;
+	}
+
+      for(k = 0; k < tnc; k++)
+	{
+	  const int m = grp_ctx->node_members[k];
+
+	  if( k < grp_ctx->node_first[node] || k >= grp_ctx->node_first[node + 1] )
+	    {
+	      memcpy(recv + l.recv_displ[m], stage + l.unstage_off[m],
+		     l.recv_displ[m + 1] - l.recv_displ[m]);
+	    }
+	}
+    }
+
+  free (mem);
+
+  grp_ctx->coll_op = GASPI_NONE;
+  grp_ctx->lastmask = 0x1;
+  grp_ctx->level = 0;
+  grp_ctx->bid = 0;
+
+  return GASPI_SUCCESS;
+}
+
+static gaspi_return_t
+_gaspi_alltoall_entry (const gaspi_segment_id_t seg_send,
+		       const gaspi_offset_t off_send,
+		       const gaspi_segment_id_t seg_recv,
+		       const gaspi_offset_t off_recv,
+		       const gaspi_size_t size,
+		       const gaspi_size_t * const send_sizes,
+		       const gaspi_size_t * const recv_sizes,
+		       const gaspi_group_t g,
+		       const gaspi_timeout_t timeout_ms)
+{
+  int i;
+  gaspi_size_t send_total = 0, recv_total = 0;
+  gaspi_return_t eret = GASPI_ERROR;
+  gaspi_group_ctx * const grp_ctx = &(glb_gaspi_group_ctx[g]);
+
+  for(i = 0; i < grp_ctx->tnc; i++)
+    {
+      send_total += (send_sizes == NULL) ? size : send_sizes[i];
+      recv_total += (recv_sizes == NULL) ? size : recv_sizes[i];
+    }
+
+  gaspi_verify_local_off(off_send, seg_send, send_total);
+  gaspi_verify_local_off(off_recv, seg_recv, recv_total);
+
+  unsigned char * const send = glb_gaspi_ctx.rrmd[seg_send][glb_gaspi_ctx.rank].data.buf + off_send;
+  unsigned char * const recv = glb_gaspi_ctx.rrmd[seg_recv][glb_gaspi_ctx.rank].data.buf + off_recv;
+
+  if( grp_ctx->tnc == 1 )
+    {
+      memcpy(recv, send, send_total);
+      return GASPI_SUCCESS;
+    }
+
+  if(lock_gaspi_tout (&grp_ctx->gl, timeout_ms))
+    {
+      return GASPI_TIMEOUT;
+    }
+
+  if(!(grp_ctx->coll_op & GASPI_ALLTOALL))
+    {
+      unlock_gaspi (&grp_ctx->gl);
+      return GASPI_ERR_ACTIVE_COLL;
+    }
+
+  grp_ctx->coll_op = GASPI_ALLTOALL;
+
+  if( grp_ctx->node_state != GASPI_NODE_READY
+      && grp_ctx->node_state != GASPI_NODE_FLAT )
+    {
+      if( (eret = _gaspi_group_node_setup(g, timeout_ms)) != GASPI_SUCCESS )
+	{
+	  unlock_gaspi (&grp_ctx->gl);
+	  return eret;
+	}
+    }
+
+  if( grp_ctx->node_first == NULL )
+    {
+      if( (eret = _gaspi_alltoall_flat_topology(g)) != GASPI_SUCCESS )
+	{
+	  unlock_gaspi (&grp_ctx->gl);
+	  return eret;
+	}
+    }
+
+  /* alone on the node: the staging area is private */
+  if( grp_ctx->node_a2a == NULL )
+    {
+      const size_t a2a_size = _gaspi_alltoall_node_size(1, grp_ctx->tnc);
+
+      void *ptr = calloc (1, a2a_size);
+      if( ptr == NULL )
+	{
+	  unlock_gaspi (&grp_ctx->gl);
+	  return GASPI_ERR_MEMALLOC;
+	}
+
+      grp_ctx->node_a2a = (unsigned char *) ptr;
+      grp_ctx->node_a2a_size = a2a_size;
+    }
+
+  eret = _gaspi_alltoall(g, send, recv, size, send_sizes, recv_sizes, timeout_ms);
+
+  unlock_gaspi (&grp_ctx->gl);
+
+  return eret;
+}
+
+#pragma weak gaspi_alltoall = pgaspi_alltoall
+gaspi_return_t
+pgaspi_alltoall (const gaspi_segment_id_t segment_id_send,
+		 const gaspi_offset_t offset_send,
+		 const gaspi_segment_id_t segment_id_recv,
+		 const gaspi_offset_t offset_recv,
+		 const gaspi_size_t size,
+		 const gaspi_group_t g,
+		 const gaspi_timeout_t timeout_ms)
+{
+  gaspi_verify_init("gaspi_alltoall");
+  gaspi_verify_group(g);
+
+  return _gaspi_alltoall_entry(segment_id_send, offset_send, segment_id_recv, offset_recv,
+			       size, NULL, NULL, g, timeout_ms);
+}
+
+#pragma weak gaspi_alltoallv = pgaspi_alltoallv
+gaspi_return_t
+pgaspi_alltoallv (const gaspi_segment_id_t segment_id_send,
+		  const gaspi_offset_t offset_send,
+		  const gaspi_size_t * const send_sizes,
+		  const gaspi_segment_id_t segment_id_recv,
+		  const gaspi_offset_t offset_recv,
+		  const gaspi_size_t * const recv_sizes,
+		  const gaspi_group_t g,
+		  const gaspi_timeout_t timeout_ms)
+{
+  gaspi_verify_init("gaspi_alltoallv");
+  gaspi_verify_null_ptr(send_sizes);
+  gaspi_verify_null_ptr(recv_sizes);
+  gaspi_verify_group(g);
+
+  return _gaspi_alltoall_entry(segment_id_send, offset_send, segment_id_recv, offset_recv,
+			       0, send_sizes, recv_sizes, g, timeout_ms);
+}
+
+
+/* Reduce, reduce-scatter and scan.
+
+   They apply the operations of allreduce, a predefined operation on
+   a predefined type or a user function, in the same way: the
+   operation is taken to be associative and commutative. */
+
+/* Reduce to a root along a binomial tree rooted at it.
+
+   The message goes up the tree in chunks of GPI2_REDUCE_CHUNK bytes.
+   A child has a receive buffer of its own at its parent (the one of
+   the step in which the parent receives from it) and only writes
+   into it once the parent granted the chunk, by writing the sequence
+   number of the chunk into the grant word of the child. A parent
+   grants a chunk when it starts it, so its buffers are free even if
+   the tree changed with the root.
+
+   The parent of a member in step s is the member 2^s below it
+   whatever the root is, so each step has a grant word of its own:
+   it is written by a single member, in order, and a late grant of an
+   earlier parent cannot overwrite the one of the current parent.
+
+   State for resuming after a timeout: bid is the chunk, level the
+   step within the chunk (0: grant the chunk to the children, s:
+   receive from the child in step s - 1, above: send to the parent)
+   and dsize the number of children received. */
+#define GPI2_REDUCE_FLAG(s)  ((s) * sizeof(unsigned int))
+#define GPI2_REDUCE_GRANT(s) (GPI2_REDUCE_FLAG(GPI2_REDUCE_STEPS + (s)))
+#define GPI2_REDUCE_SRC(p)   (GPI2_REDUCE_GRANT(GPI2_REDUCE_STEPS + (p)))
+#define GPI2_REDUCE_BUF(i)   (GPI2_REDUCE_FLAGS + (i) * GPI2_REDUCE_CHUNK)
+#define GPI2_REDUCE_RECV(s)  (GPI2_REDUCE_BUF(4 + (s)))
+
+static gaspi_return_t
+_gaspi_reduce (const gaspi_pointer_t buf_send,
+	       gaspi_pointer_t const buf_recv,
+	       const gaspi_number_t elem_cnt,
+	       struct redux_args * const r_args,
+	       const int root,
+	       const gaspi_group_t g,
+	       const gaspi_timeout_t timeout_ms)
+{
+  int s;
+  gaspi_return_t eret = GASPI_ERROR;
+  gaspi_group_ctx * const grp_ctx = &(glb_gaspi_group_ctx[g]);
+
+  const int size = grp_ctx->tnc;
+  const int vrank = (grp_ctx->rank - root + size) % size;
+  const gaspi_size_t esize = r_args->elem_size;
+
+  const gaspi_number_t chunk_max = (gaspi_number_t) (GPI2_REDUCE_CHUNK / esize);
+  const gaspi_number_t nchunks = (elem_cnt + chunk_max - 1) / chunk_max;
+
+  /* we receive in the steps before the lowest set bit of vrank and
+     send to the parent in that one */
+  int nsteps = 0;
+  while( (1 << nsteps) < size && !(vrank & (1 << nsteps)) )
+    {
+      nsteps++;
+    }
+
+  unsigned char * const slot = grp_ctx->rrcd[glb_gaspi_ctx.rank].data.buf + COLL_MEM_REDUCE;
+  volatile unsigned int * const flags = (volatile unsigned int *) slot;
+  volatile unsigned int * const grant = (volatile unsigned int *) (slot + GPI2_REDUCE_GRANT(nsteps));
+
+  const gaspi_cycles_t s0 = gaspi_get_cycles();
+
+  while( (gaspi_number_t) grp_ctx->bid < nchunks )
+    {
+      const gaspi_number_t off = grp_ctx->bid * chunk_max;
+      const gaspi_number_t n = MIN(chunk_max, elem_cnt - off);
+      const unsigned int seq = grp_ctx->seq + 1;
+
+      unsigned int * const src = (unsigned int *) (slot + GPI2_REDUCE_SRC(seq & 1));
+      unsigned char * const chunk_send = (unsigned char *) buf_send + off * esize;
+
+      if( grp_ctx->level == 0 )
+	{
+	  *src = seq;
+
+	  for(s = 0; s < nsteps; s++)
+	    {
+	      if( vrank + (1 << s) < size )
+		{
+		  const int child = grp_ctx->rank_grp[(vrank + (1 << s) + root) % size];
+
+		  if( (eret = _gaspi_coll_post_write(g, child, src, sizeof(unsigned int),
+						     COLL_MEM_REDUCE + GPI2_REDUCE_GRANT(s),
+						     timeout_ms)) != GASPI_SUCCESS )
+		    {
+		      return eret;
+		    }
+		}
+	    }
+
+	  /* the work buffers may still be the source of the last chunk */
+	  if( (eret = _gaspi_coll_drain(s0, timeout_ms)) != GASPI_SUCCESS )
+	    {
+	      return eret;
+	    }
+
+	  grp_ctx->dsize = 0;
+	  grp_ctx->level = 1;
+	}
+
+      while( grp_ctx->level <= nsteps )
+	{
+	  s = grp_ctx->level - 1;
+
+	  if( vrank + (1 << s) < size )
+	    {
+	      const int c = grp_ctx->dsize;
+
+	      if( _gaspi_coll_wait_flag(&flags[s], seq, s0, timeout_ms) != GASPI_SUCCESS )
+		{
+		  return GASPI_TIMEOUT;
+		}
+
+	      _gaspi_redux_apply(r_args, slot + GPI2_REDUCE_BUF(c & 1),
+				 (c == 0) ? chunk_send : slot + GPI2_REDUCE_BUF((c - 1) & 1),
+				 slot + GPI2_REDUCE_RECV(s), n, timeout_ms);
+	      grp_ctx->dsize++;
+	    }
+
+	  grp_ctx->level++;
+	}
+
+      unsigned char *partial = slot + GPI2_REDUCE_BUF((grp_ctx->dsize - 1) & 1);
+
+      if( vrank == 0 )
+	{
+	  memcpy((unsigned char *) buf_recv + off * esize, partial, n * esize);
+	}
+      else
+	{
+	  const int parent = grp_ctx->rank_grp[(vrank - (1 << nsteps) + root) % size];
+
+	  if( grp_ctx->dsize == 0 )
+	    {
+	      partial = slot + GPI2_REDUCE_BUF(0);
+	      memcpy(partial, chunk_send, n * esize);
+	    }
+
+	  if( _gaspi_coll_wait_count(grant, seq, s0, timeout_ms) != GASPI_SUCCESS )
+	    {
+	      return GASPI_TIMEOUT;
+	    }
+
+	  if( (eret = _gaspi_coll_post_write(g, parent, partial, n * esize,
+					     COLL_MEM_REDUCE + GPI2_REDUCE_RECV(nsteps),
+					     timeout_ms)) != GASPI_SUCCESS )
+	    {
+	      return eret;
+	    }
+
+	  if( (eret = _gaspi_coll_post_write(g, parent, src, sizeof(unsigned int),
+					     COLL_MEM_REDUCE + GPI2_REDUCE_FLAG(nsteps),
+					     timeout_ms)) != GASPI_SUCCESS )
+	    {
+	      return eret;
+	    }
+	}
+
+      if( _gaspi_coll_poll() != GASPI_SUCCESS )
+	{
+	  return GASPI_ERR_DEVICE;
+	}
+
+      grp_ctx->seq++;
+      grp_ctx->bid++;
+      grp_ctx->level = 0;
+    }
+
+  grp_ctx->coll_op = GASPI_NONE;
+  grp_ctx->lastmask = 0x1;
+  grp_ctx->level = 0;
+  grp_ctx->bid = 0;
+  grp_ctx->dsize = 0;
+
+  return GASPI_SUCCESS;
+}
+
+/* Reduce-scatter of equal blocks: recursive halving as in the large
+   allreduce, in its slots, but splitting a chunk at the blocks of the
+   members. A chunk holds the same n elements of every block, such
+   that the i-th member of the power of two subset ends up with the
+   blocks of the members it stands for (two if one was folded into
+   it), and hands the block of the folded member back. */
+static inline gaspi_number_t
+_gaspi_reduce_scatter_chunk (const gaspi_group_t g, const gaspi_size_t elem_size)
+{
+  /* a step receives at most two blocks per member of the subset */
+  return (gaspi_number_t) (GPI2_REDUX_LARGE_CHUNK
+			   / (2 * glb_gaspi_group_ctx[g].next_pof2 * elem_size));
+}
+
+static gaspi_return_t
+_gaspi_reduce_scatter_block (const gaspi_pointer_t buf_send,
+			     gaspi_pointer_t const buf_recv,
+			     const gaspi_number_t elem_cnt,
+			     struct redux_args *r_args,
+			     const gaspi_group_t g,
+			     const gaspi_timeout_t timeout_ms)
+{
+  int i;
+  gaspi_return_t eret = GASPI_ERROR;
+  gaspi_group_ctx * const grp_ctx = &(glb_gaspi_group_ctx[g]);
+
+  const int size = grp_ctx->tnc;
+  const int rank = grp_ctx->rank;
+  const int pof2 = grp_ctx->next_pof2;
+  const int pof2_exp = grp_ctx->pof2_exp;
+  const int rest = size - pof2;
+  const gaspi_size_t esize = r_args->elem_size;
+
+  const gaspi_number_t chunk_max = _gaspi_reduce_scatter_chunk(g, esize);
+  const gaspi_number_t nchunks = (elem_cnt + chunk_max - 1) / chunk_max;
+
+  /* rank inside the power of two subset, -1 if folded */
+  int tmprank;
+  if( rank < 2 * rest )
+    {
+      tmprank = (rank % 2) ? (rank >> 1) : -1;
+    }
+  else
+    {
+      tmprank = rank - rest;
+    }
+
+  const gaspi_cycles_t s0 = gaspi_get_cycles();
+
+  int step = grp_ctx->level;
+  int jmp = grp_ctx->lastmask >> 31;
+
+  while( (gaspi_number_t) grp_ctx->bid < nchunks )
+    {
+      const gaspi_number_t off = grp_ctx->bid * chunk_max;
+      const gaspi_number_t n = MIN(chunk_max, elem_cnt - off);
+      const unsigned int seq = grp_ctx->seq + 1;
+
+      const unsigned long slot_off = COLL_MEM_LARGE + grp_ctx->togle * GPI2_REDUX_LARGE_SLOT;
+      unsigned char * const slot = grp_ctx->rrcd[glb_gaspi_ctx.rank].data.buf + slot_off;
+      volatile unsigned int * const flags = (volatile unsigned int *) slot;
+      unsigned int * const flag_src = (unsigned int *) slot + GPI2_REDUX_FLAG_SRC;
+
+      unsigned char * const work_buf = slot + GPI2_REDUX_LARGE_W;
+      unsigned char * const tmp_buf = slot + GPI2_REDUX_LARGE_T;
+
+#define REDUX_BUF(s) ((((pof2_exp - (s)) & 1)) ? tmp_buf : work_buf)
+#define REDUX_BLK(b) ((gaspi_number_t) (((b) < rest) ? 2 * (b) : (b) + rest) * n)
+
+      /* the chunk of every block, one after the other */
+#define REDUX_PACK(buf)							\
+      for(i = 0; i < size; i++)						\
+	{								\
+	  memcpy((buf) + (gaspi_size_t) i * n * esize,			\
+		 (unsigned char *) buf_send + ((gaspi_size_t) i * elem_cnt + off) * esize, \
+		 n * esize);						\
+	}
+
+      *flag_src = seq;
+
+      if( step == 0 )
+	{
+	  if( tmprank == -1 )
+	    {
+	      const int dst = grp_ctx->rank_grp[rank + 1];
+
+	      if( !jmp )
+		{
+		  REDUX_PACK(REDUX_BUF(0));
+
+		  if( (eret = _gaspi_coll_post_write(g, dst, REDUX_BUF(0), size * n * esize,
+						     slot_off + GPI2_REDUX_LARGE_FOLD,
+						     timeout_ms)) != GASPI_SUCCESS )
+		    {
+		      return eret;
+		    }
+
+		  if( (eret = _gaspi_coll_post_write(g, dst, flag_src, sizeof(unsigned int),
+						     slot_off + GPI2_REDUX_FLAG_FOLD * sizeof(unsigned int),
+						     timeout_ms)) != GASPI_SUCCESS )
+		    {
+		      return eret;
+		    }
+		}
+	      step = pof2_exp + 1;
+	    }
+	  else if( rank < 2 * rest )
+	    {
+	      if( _gaspi_coll_wait_flag(&flags[GPI2_REDUX_FLAG_FOLD], seq, s0, timeout_ms) != GASPI_SUCCESS )
+		{
+		  goto timeoutL;
+		}
+
+	      /* the first step only writes into REDUX_BUF(1) after
+		 reading REDUX_BUF(0) */
+	      REDUX_PACK(REDUX_BUF(1));
+	      _gaspi_redux_apply(r_args, REDUX_BUF(0), REDUX_BUF(1),
+				 slot + GPI2_REDUX_LARGE_FOLD, size * n, timeout_ms);
+	      step = 1;
+	    }
+	  else
+	    {
+	      REDUX_PACK(REDUX_BUF(0));
+	      step = 1;
+	    }
+	  jmp = 0;
+	}
+
+      //reduce-scatter
+      while( step >= 1 && step <= pof2_exp )
+	{
+	  const int mask = pof2 >> step;
+	  const int tmpdst = tmprank ^ mask;
+	  const int idst = (tmpdst < rest) ? tmpdst * 2 + 1 : tmpdst + rest;
+	  const int dst = grp_ctx->rank_grp[idst];
+
+	  const gaspi_number_t keep_lo = REDUX_BLK(tmprank & ~(mask - 1));
+	  const gaspi_number_t keep_hi = REDUX_BLK((tmprank & ~(mask - 1)) + mask);
+	  const gaspi_number_t send_lo = REDUX_BLK(tmpdst & ~(mask - 1));
+	  const gaspi_number_t send_hi = REDUX_BLK((tmpdst & ~(mask - 1)) + mask);
+	  const unsigned long rs_off = GPI2_REDUX_LARGE_RS + (pof2 - 2 * mask) * 2 * n * esize;
+
+	  if( !jmp )
+	    {
+	      if( (eret = _gaspi_coll_post_write(g, dst, REDUX_BUF(step - 1) + send_lo * esize,
+						 (send_hi - send_lo) * esize,
+						 slot_off + rs_off, timeout_ms)) != GASPI_SUCCESS )
+		{
+		  return eret;
+		}
+
+	      if( (eret = _gaspi_coll_post_write(g, dst, flag_src, sizeof(unsigned int),
+						 slot_off + GPI2_REDUX_FLAG_RS(step) * sizeof(unsigned int),
+						 timeout_ms)) != GASPI_SUCCESS )
+		{
+		  return eret;
+		}
+	    }
+
+	  if( _gaspi_coll_wait_flag(&flags[GPI2_REDUX_FLAG_RS(step)], seq, s0, timeout_ms) != GASPI_SUCCESS )
+	    {
+	      goto timeoutL;
+	    }
+
+	  _gaspi_redux_apply(r_args, REDUX_BUF(step) + keep_lo * esize,
+			     REDUX_BUF(step - 1) + keep_lo * esize,
+			     slot + rs_off, keep_hi - keep_lo, timeout_ms);
+
+	  jmp = 0;
+	  step++;
+	}
+
+      //give the block back to the folded rank
+      if( rank < 2 * rest )
+	{
+	  if( tmprank == -1 )
+	    {
+	      if( _gaspi_coll_wait_flag(&flags[GPI2_REDUX_FLAG_RESULT], seq, s0, timeout_ms) != GASPI_SUCCESS )
+		{
+		  goto timeoutL;
+		}
+	    }
+	  else
+	    {
+	      const int dst = grp_ctx->rank_grp[rank - 1];
+
+	      if( (eret = _gaspi_coll_post_write(g, dst, work_buf + (rank - 1) * n * esize, n * esize,
+						 slot_off + GPI2_REDUX_LARGE_W + (rank - 1) * n * esize,
+						 timeout_ms)) != GASPI_SUCCESS )
+		{
+		  return eret;
+		}
+
+	      if( (eret = _gaspi_coll_post_write(g, dst, flag_src, sizeof(unsigned int),
+						 slot_off + GPI2_REDUX_FLAG_RESULT * sizeof(unsigned int),
+						 timeout_ms)) != GASPI_SUCCESS )
+		{
+		  return eret;
+		}
+	    }
+	}
+
+#undef REDUX_BUF
+#undef REDUX_BLK
+#undef REDUX_PACK
+
+      memcpy((unsigned char *) buf_recv + off * esize, work_buf + rank * n * esize, n * esize);
+
+      if( _gaspi_coll_poll() != GASPI_SUCCESS )
+	{
+	  return GASPI_ERR_DEVICE;
+	}
+
+      grp_ctx->seq++;
+      grp_ctx->togle = (grp_ctx->togle ^ 0x1);
+      grp_ctx->bid++;
+      step = 0;
+      jmp = 0;
+    }
+
+  grp_ctx->coll_op = GASPI_NONE;
+  grp_ctx->lastmask = 0x1;
+  grp_ctx->level = 0;
+  grp_ctx->bid = 0;
+
+  return GASPI_SUCCESS;
+
+ timeoutL:
+  grp_ctx->level = step;
+  grp_ctx->lastmask = 0x80000001;
+
+  return GASPI_TIMEOUT;
+}
+
+/* Inclusive and exclusive scan by recursive doubling: in step s the
+   members whose group ranks differ in bit s exchange the reduction of
+   the 2^s ranks up to them and the upper one adds the one it received
+   to its result. This takes log2 steps for any group size.
+
+   Every step has its receive buffer in the slot of the chunk. The
+   slots alternate with the chunks of scans only (scan_slot), as a
+   member cannot get more than one chunk ahead of its partners.
+
+   State for resuming after a timeout: bid is the chunk, level the
+   step within the chunk (0: start the chunk) and the top bit of
+   lastmask is set once the step was sent. The bits of dsize tell
+   which work buffers hold the reduction to send and the result, and
+   whether there is a result yet (GPI2_SCAN_*). */
+#define GPI2_SCAN_SLOT(t)  (COLL_MEM_REDUCE + (1 + (t)) * GPI2_REDUCE_SLOT)
+#define GPI2_SCAN_PART     0x1
+#define GPI2_SCAN_RES      0x2
+#define GPI2_SCAN_HAVE     0x4
+
+static gaspi_return_t
+_gaspi_scan (const gaspi_pointer_t buf_send,
+	     gaspi_pointer_t const buf_recv,
+	     const gaspi_number_t elem_cnt,
+	     struct redux_args * const r_args,
+	     const int exclusive,
+	     const gaspi_group_t g,
+	     const gaspi_timeout_t timeout_ms)
+{
+  gaspi_return_t eret = GASPI_ERROR;
+  gaspi_group_ctx * const grp_ctx = &(glb_gaspi_group_ctx[g]);
+
+  const int size = grp_ctx->tnc;
+  const int rank = grp_ctx->rank;
+  const gaspi_size_t esize = r_args->elem_size;
+
+  const gaspi_number_t chunk_max = (gaspi_number_t) (GPI2_REDUCE_CHUNK / esize);
+  const gaspi_number_t nchunks = (elem_cnt + chunk_max - 1) / chunk_max;
+
+  const gaspi_cycles_t s0 = gaspi_get_cycles();
+
+  int jmp = grp_ctx->lastmask >> 31;
+
+  while( (gaspi_number_t) grp_ctx->bid < nchunks )
+    {
+      const gaspi_number_t off = grp_ctx->bid * chunk_max;
+      const gaspi_number_t n = MIN(chunk_max, elem_cnt - off);
+      const unsigned int seq = grp_ctx->seq + 1;
+
+      const unsigned long slot_off = GPI2_SCAN_SLOT(grp_ctx->scan_slot);
+      unsigned char * const slot = grp_ctx->rrcd[glb_gaspi_ctx.rank].data.buf + slot_off;
+      volatile unsigned int * const flags = (volatile unsigned int *) slot;
+      unsigned int * const src = (unsigned int *) (slot + GPI2_REDUCE_SRC(0));
+      unsigned char * const chunk_send = (unsigned char *) buf_send + off * esize;
+
+      /* the reduction to send in BUF(0/1), the result in BUF(2/3) */
+      if( grp_ctx->level == 0 )
+	{
+	  *src = seq;
+	  memcpy(slot + GPI2_REDUCE_BUF(0), chunk_send, n * esize);
+
+	  grp_ctx->dsize = 0;
+	  grp_ctx->level = 1;
+	}
+
+      while( (1 << (grp_ctx->level - 1)) < size )
+	{
+	  const int s = grp_ctx->level - 1;
+	  const int idst = rank ^ (1 << s);
+
+	  if( idst < size )
+	    {
+	      const int dst = grp_ctx->rank_grp[idst];
+	      const int part = grp_ctx->dsize & GPI2_SCAN_PART;
+	      const int res = (grp_ctx->dsize & GPI2_SCAN_RES) ? 1 : 0;
+
+	      unsigned char * const recv = slot + GPI2_REDUCE_RECV(s);
+
+	      if( !jmp )
+		{
+		  if( (eret = _gaspi_coll_post_write(g, dst, slot + GPI2_REDUCE_BUF(part), n * esize,
+						     slot_off + GPI2_REDUCE_RECV(s),
+						     timeout_ms)) != GASPI_SUCCESS )
+		    {
+		      return eret;
+		    }
+
+		  if( (eret = _gaspi_coll_post_write(g, dst, src, sizeof(unsigned int),
+						     slot_off + GPI2_REDUCE_FLAG(s),
+						     timeout_ms)) != GASPI_SUCCESS )
+		    {
+		      return eret;
+		    }
+		}
+
+	      grp_ctx->lastmask = 0x80000001;
+
+	      if( _gaspi_coll_wait_flag(&flags[s], seq, s0, timeout_ms) != GASPI_SUCCESS )
+		{
+		  return GASPI_TIMEOUT;
+		}
+
+	      /* the reduction is overwritten while it may still be sent */
+	      if( (eret = _gaspi_coll_drain(s0, timeout_ms)) != GASPI_SUCCESS )
+		{
+		  return eret;
+		}
+
+	      if( idst < rank )
+		{
+		  if( grp_ctx->dsize & GPI2_SCAN_HAVE )
+		    {
+		      _gaspi_redux_apply(r_args, slot + GPI2_REDUCE_BUF(2 + !res), recv,
+					 slot + GPI2_REDUCE_BUF(2 + res), n, timeout_ms);
+		      grp_ctx->dsize ^= GPI2_SCAN_RES;
+		    }
+		  else if( exclusive )
+		    {
+		      memcpy(slot + GPI2_REDUCE_BUF(2 + res), recv, n * esize);
+		    }
+		  else
+		    {
+		      _gaspi_redux_apply(r_args, slot + GPI2_REDUCE_BUF(2 + res), recv,
+					 chunk_send, n, timeout_ms);
+		    }
+
+		  grp_ctx->dsize |= GPI2_SCAN_HAVE;
+		}
+
+	      /* the last step has nothing more to send */
+	      if( (2 << s) < size )
+		{
+		  if( idst < rank )
+		    {
+		      _gaspi_redux_apply(r_args, slot + GPI2_REDUCE_BUF(!part), recv,
+					 slot + GPI2_REDUCE_BUF(part), n, timeout_ms);
+		    }
+		  else
+		    {
+		      _gaspi_redux_apply(r_args, slot + GPI2_REDUCE_BUF(!part),
+					 slot + GPI2_REDUCE_BUF(part), recv, n, timeout_ms);
+		    }
+
+		  grp_ctx->dsize ^= GPI2_SCAN_PART;
+		}
+	    }
+
+	  jmp = 0;
+	  grp_ctx->lastmask = 0x1;
+	  grp_ctx->level++;
+	}
+
+      unsigned char * const chunk_recv = (unsigned char *) buf_recv + off * esize;
+
+      /* the first rank has no result of exscan */
+      if( grp_ctx->dsize & GPI2_SCAN_HAVE )
+	{
+	  const int res = (grp_ctx->dsize & GPI2_SCAN_RES) ? 1 : 0;
+	  memcpy(chunk_recv, slot + GPI2_REDUCE_BUF(2 + res), n * esize);
+	}
+      else if( !exclusive && chunk_recv != chunk_send )
+	{
+	  memcpy(chunk_recv, chunk_send, n * esize);
+	}
+
+      grp_ctx->seq++;
+      grp_ctx->scan_slot ^= 0x1;
+      grp_ctx->bid++;
+      grp_ctx->level = 0;
+    }
+
+  grp_ctx->coll_op = GASPI_NONE;
+  grp_ctx->lastmask = 0x1;
+  grp_ctx->level = 0;
+  grp_ctx->bid = 0;
+  grp_ctx->dsize = 0;
+
+  return GASPI_SUCCESS;
+}
+
+enum gaspi_redux_coll
+{
+  GASPI_REDUX_REDUCE,
+  GASPI_REDUX_REDUCE_SCATTER,
+  GASPI_REDUX_SCAN,
+  GASPI_REDUX_EXSCAN
+};
+
+static gaspi_return_t
+_gaspi_redux_coll (const enum gaspi_redux_coll kind,
+		   const gaspi_pointer_t buf_send,
+		   gaspi_pointer_t const buf_recv,
+		   const gaspi_number_t elem_cnt,
+		   struct redux_args * const r_args,
+		   const gaspi_rank_t root,
+		   const gaspi_group_t g,
+		   const gaspi_timeout_t timeout_ms)
+{
+  int groot = 0;
+  gaspi_return_t eret = GASPI_ERROR;
+  gaspi_group_ctx * const grp_ctx = &(glb_gaspi_group_ctx[g]);
+
+  const gaspi_async_coll_t coll =
+    (kind == GASPI_REDUX_REDUCE) ? GASPI_REDUCE
+    : (kind == GASPI_REDUX_REDUCE_SCATTER) ? GASPI_REDUCE_SCATTER : GASPI_SCAN;
+
+  if( kind == GASPI_REDUX_REDUCE )
+    {
+      const int key = (int) root;
+      const int * const r = (const int *) bsearch (&key, grp_ctx->rank_grp, grp_ctx->tnc,
+						   sizeof (int), gaspi_comp_ranks);
+      if( r == NULL )
+	{
+	  return GASPI_ERR_INV_RANK;
+	}
+
+      groot = (int) (r - grp_ctx->rank_grp);
+    }
+
+  if( r_args->elem_size == 0 || r_args->elem_size > GPI2_REDUCE_CHUNK )
+    {
+      return GASPI_ERR_INV_SIZE;
+    }
+
+  if( kind == GASPI_REDUX_REDUCE_SCATTER
+      && _gaspi_reduce_scatter_chunk(g, r_args->elem_size) == 0 )
+    {
+      return GASPI_ERR_INV_NUM;
+    }
+
+  if( elem_cnt == 0 )
+    {
+      return GASPI_SUCCESS;
+    }
+
+  if( grp_ctx->tnc == 1 )
+    {
+      if( kind != GASPI_REDUX_EXSCAN && buf_recv != buf_send )
+	{
+	  memcpy(buf_recv, buf_send, elem_cnt * r_args->elem_size);
+	}
+
+      return GASPI_SUCCESS;
+    }
+
+  if(lock_gaspi_tout (&grp_ctx->gl, timeout_ms))
+    {
+      return GASPI_TIMEOUT;
+    }
+
+  if(!(grp_ctx->coll_op & coll))
+    {
+      unlock_gaspi (&grp_ctx->gl);
+      return GASPI_ERR_ACTIVE_COLL;
+    }
+
+  grp_ctx->coll_op = coll;
+
+  switch(kind)
+    {
+    case GASPI_REDUX_REDUCE:
+      eret = _gaspi_reduce(buf_send, buf_recv, elem_cnt, r_args, groot, g, timeout_ms);
+      break;
+    case GASPI_REDUX_REDUCE_SCATTER:
+      eret = _gaspi_reduce_scatter_block(buf_send, buf_recv, elem_cnt, r_args, g, timeout_ms);
+      break;
+    case GASPI_REDUX_SCAN:
+    case GASPI_REDUX_EXSCAN:
+      eret = _gaspi_scan(buf_send, buf_recv, elem_cnt, r_args,
+			 kind == GASPI_REDUX_EXSCAN, g, timeout_ms);
+      break;
+    }
+
+  unlock_gaspi (&grp_ctx->gl);
+
+  return eret;
+}
+
+#pragma weak gaspi_reduce = pgaspi_reduce
+gaspi_return_t
+pgaspi_reduce (const gaspi_pointer_t buf_send,
+	       gaspi_pointer_t const buf_recv,
+	       const gaspi_number_t elem_cnt,
+	       const gaspi_operation_t op,
+	       const gaspi_datatype_t type,
+	       const gaspi_rank_t root,
+	       const gaspi_group_t g,
+	       const gaspi_timeout_t timeout_ms)
+{
+  gaspi_verify_init("gaspi_reduce");
+  gaspi_verify_null_ptr(buf_send);
+  gaspi_verify_group(g);
+
+  struct redux_args r_args;
+  r_args.f_type = GASPI_OP;
+  r_args.f_args.op = op;
+  r_args.f_args.type = type;
+  r_args.elem_size = glb_gaspi_typ_size[type];
+
+  return _gaspi_redux_coll(GASPI_REDUX_REDUCE, buf_send, buf_recv, elem_cnt,
+			   &r_args, root, g, timeout_ms);
+}
+
+#pragma weak gaspi_reduce_user = pgaspi_reduce_user
+gaspi_return_t
+pgaspi_reduce_user (const gaspi_pointer_t buf_send,
+		    gaspi_pointer_t const buf_recv,
+		    const gaspi_number_t elem_cnt,
+		    const gaspi_size_t elem_size,
+		    gaspi_reduce_operation_t const user_fct,
+		    gaspi_state_t const rstate,
+		    const gaspi_rank_t root,
+		    const gaspi_group_t g,
+		    const gaspi_timeout_t timeout_ms)
+{
+  gaspi_verify_init("gaspi_reduce_user");
+  gaspi_verify_null_ptr(buf_send);
+  gaspi_verify_group(g);
+
+  struct redux_args r_args;
+  r_args.f_type = GASPI_USER;
+  r_args.elem_size = elem_size;
+  r_args.f_args.user_fct = user_fct;
+  r_args.f_args.rstate = rstate;
+
+  return _gaspi_redux_coll(GASPI_REDUX_REDUCE, buf_send, buf_recv, elem_cnt,
+			   &r_args, root, g, timeout_ms);
+}
+
+#pragma weak gaspi_reduce_scatter_block = pgaspi_reduce_scatter_block
+gaspi_return_t
+pgaspi_reduce_scatter_block (const gaspi_pointer_t buf_send,
+			     gaspi_pointer_t const buf_recv,
+			     const gaspi_number_t elem_cnt,
+			     const gaspi_operation_t op,
+			     const gaspi_datatype_t type,
+			     const gaspi_group_t g,
+			     const gaspi_timeout_t timeout_ms)
+{
+  gaspi_verify_init("gaspi_reduce_scatter_block");
+  gaspi_verify_null_ptr(buf_send);
+  gaspi_verify_null_ptr(buf_recv);
+  gaspi_verify_group(g);
+
+  struct redux_args r_args;
+  r_args.f_type = GASPI_OP;
+  r_args.f_args.op = op;
+  r_args.f_args.type = type;
+  r_args.elem_size = glb_gaspi_typ_size[type];
+
+  return _gaspi_redux_coll(GASPI_REDUX_REDUCE_SCATTER, buf_send, buf_recv, elem_cnt,
+			   &r_args, 0, g, timeout_ms);
+}
+
+#pragma weak gaspi_reduce_scatter_block_user = pgaspi_reduce_scatter_block_user
+gaspi_return_t
+pgaspi_reduce_scatter_block_user (const gaspi_pointer_t buf_send,
+				  gaspi_pointer_t const buf_recv,
+				  const gaspi_number_t elem_cnt,
+				  const gaspi_size_t elem_size,
+				  gaspi_reduce_operation_t const user_fct,
+				  gaspi_state_t const rstate,
+				  const gaspi_group_t g,
+				  const gaspi_timeout_t timeout_ms)
+{
+  gaspi_verify_init("gaspi_reduce_scatter_block_user");
+  gaspi_verify_null_ptr(buf_send);
+  gaspi_verify_null_ptr(buf_recv);
+  gaspi_verify_group(g);
+
+  struct redux_args r_args;
+  r_args.f_type = GASPI_USER;
+  r_args.elem_size = elem_size;
+  r_args.f_args.user_fct = user_fct;
+  r_args.f_args.rstate = rstate;
+
+  return _gaspi_redux_coll(GASPI_REDUX_REDUCE_SCATTER, buf_send, buf_recv, elem_cnt,
+			   &r_args, 0, g, timeout_ms);
+}
+
+#pragma weak gaspi_scan = pgaspi_scan
+gaspi_return_t
+pgaspi_scan (const gaspi_pointer_t buf_send,
+	     gaspi_pointer_t const buf_recv,
+	     const gaspi_number_t elem_cnt,
+	     const gaspi_operation_t op,
+	     const gaspi_datatype_t type,
+	     const gaspi_group_t g,
+	     const gaspi_timeout_t timeout_ms)
+{
+  gaspi_verify_init("gaspi_scan");
+  gaspi_verify_null_ptr(buf_send);
+  gaspi_verify_null_ptr(buf_recv);
+  gaspi_verify_group(g);
+
+  struct redux_args r_args;
+  r_args.f_type = GASPI_OP;
+  r_args.f_args.op = op;
+  r_args.f_args.type = type;
+  r_args.elem_size = glb_gaspi_typ_size[type];
+
+  return _gaspi_redux_coll(GASPI_REDUX_SCAN, buf_send, buf_recv, elem_cnt,
+			   &r_args, 0, g, timeout_ms);
+}
+
+#pragma weak gaspi_scan_user = pgaspi_scan_user
+gaspi_return_t
+pgaspi_scan_user (const gaspi_pointer_t buf_send,
+		  gaspi_pointer_t const buf_recv,
+		  const gaspi_number_t elem_cnt,
+		  const gaspi_size_t elem_size,
+		  gaspi_reduce_operation_t const user_fct,
+		  gaspi_state_t const rstate,
+		  const gaspi_group_t g,
+		  const gaspi_timeout_t timeout_ms)
+{
+  gaspi_verify_init("gaspi_scan_user");
+  gaspi_verify_null_ptr(buf_send);
+  gaspi_verify_null_ptr(buf_recv);
+  gaspi_verify_group(g);
+
+  struct redux_args r_args;
+  r_args.f_type = GASPI_USER;
+  r_args.elem_size = elem_size;
+  r_args.f_args.user_fct = user_fct;
+  r_args.f_args.rstate = rstate;
+
+  return _gaspi_redux_coll(GASPI_REDUX_SCAN, buf_send, buf_recv, elem_cnt,
+			   &r_args, 0, g, timeout_ms);
+}
+
+#pragma weak gaspi_exscan = pgaspi_exscan
+gaspi_return_t
+pgaspi_exscan (const gaspi_pointer_t buf_send,
+	       gaspi_pointer_t const buf_recv,
+	       const gaspi_number_t elem_cnt,
+	       const gaspi_operation_t op,
+	       const gaspi_datatype_t type,
+	       const gaspi_group_t g,
+	       const gaspi_timeout_t timeout_ms)
+{
+  gaspi_verify_init("gaspi_exscan");
+  gaspi_verify_null_ptr(buf_send);
+  gaspi_verify_null_ptr(buf_recv);
+  gaspi_verify_group(g);
+
+  struct redux_args r_args;
+  r_args.f_type = GASPI_OP;
+  r_args.f_args.op = op;
+  r_args.f_args.type = type;
+  r_args.elem_size = glb_gaspi_typ_size[type];
+
+  return _gaspi_redux_coll(GASPI_REDUX_EXSCAN, buf_send, buf_recv, elem_cnt,
+			   &r_args, 0, g, timeout_ms);
+}
+
+#pragma weak gaspi_exscan_user = pgaspi_exscan_user
+gaspi_return_t
+pgaspi_exscan_user (const gaspi_pointer_t buf_send,
+		    gaspi_pointer_t const buf_recv,
+		    const gaspi_number_t elem_cnt,
+		    const gaspi_size_t elem_size,
+		    gaspi_reduce_operation_t const user_fct,
+		    gaspi_state_t const rstate,
+		    const gaspi_group_t g,
+		    const gaspi_timeout_t timeout_ms)
+{
+  gaspi_verify_init("gaspi_exscan_user");
+  gaspi_verify_null_ptr(buf_send);
+  gaspi_verify_null_ptr(buf_recv);
+  gaspi_verify_group(g);
+
+  struct redux_args r_args;
+  r_args.f_type = GASPI_USER;
+  r_args.elem_size = elem_size;
+  r_args.f_args.user_fct = user_fct;
+  r_args.f_args.rstate = rstate;
+
+  return _gaspi_redux_coll(GASPI_REDUX_EXSCAN, buf_send, buf_recv, elem_cnt,
+			   &r_args, 0, g, timeout_ms);
+}
+
+/* Non-blocking collectives.
+
+   A barrier or an allreduce (of at most the size of the blocking
+   one) started with a request handle, which is completed by
+   gaspi_coll_test/gaspi_coll_wait. Several of them may be outstanding
+   per group, each in a slot of its own, and they progress in any of
+   those calls and in the other wait calls (gaspi_wait,
+   gaspi_notify_waitsome). The blocking collectives do not progress
+   them.
+
+   Both use the algorithm of the blocking allreduce (recursive
+   doubling, the members beyond the largest power of two being folded
+   into their neighbours), the barrier without data. All members must
+   start the non-blocking collectives of a group in the same order:
+   the i-th one of each member goes to slot i % GPI2_NBC_SLOTS and its
+   flags carry the use count of the slot (gen).
+
+   Reusing a slot: it only starts once the request that used it before
+   was released and once all writes of the collectives queue
+   completed, so that its buffers are free locally. A member only
+   writes the data of use gen + 2 into a remote slot after it
+   completed use gen + 1, which needs the data of use gen + 1 of
+   every partner, which is only sent once use gen completed. Hence two
+   sets of receive buffers and flags, by parity of gen, suffice. */
+#define GPI2_NBC_FOLD    (0)
+#define GPI2_NBC_RESULT  (GPI2_NBC_STEPS + 1)
+
+#define GPI2_NBC_FLAG(p, k) (((p) * (GPI2_NBC_STEPS + 2) + (k)) * sizeof(unsigned int))
+#define GPI2_NBC_SRC(p)     (GPI2_NBC_FLAG(2, (p)))
+#define GPI2_NBC_RECV(p, k) (GPI2_NBC_FLAGS + ((p) * (GPI2_NBC_STEPS + 2) + (k)) * GPI2_REDUX_BUF_SIZE)
+#define GPI2_NBC_WORK(c)    (GPI2_NBC_RECV(2, (c)))
+
+typedef enum
+{
+  GASPI_NBC_FREE = 0,
+  GASPI_NBC_PENDING = 1,
+  GASPI_NBC_RUNNING = 2,
+  GASPI_NBC_DONE = 3
+} gaspi_nbc_state_t;
+
+/* State of a request: step is the flag of the step it is in (fold,
+   1 + log2 of the mask of the exchange, or result), posted tells
+   which writes of this step went out (1: the data, 2: also the flag)
+   and work is the work buffer holding the partial result. */
+struct gaspi_coll_request
+{
+  volatile gaspi_nbc_state_t state;
+  gaspi_return_t eret;
+  gaspi_async_coll_t op;
+  gaspi_group_t group;
+  int slot;
+  unsigned int gen;
+  int step;
+  int posted;
+  int work;
+  gaspi_pointer_t buf_send;
+  gaspi_pointer_t buf_recv;
+  gaspi_number_t elem_cnt;
+  struct redux_args r_args;
+};
+
+static struct gaspi_coll_request glb_gaspi_nbc[GASPI_MAX_GROUPS][GPI2_NBC_SLOTS];
+
+/* Post the step's data (if any) and flag to group member idst,
+   without waiting: GASPI_TIMEOUT if the collectives queue is full,
+   the next call goes on with what was not posted yet */
+static inline gaspi_return_t
+_gaspi_nbc_post (struct gaspi_coll_request * const req,
+		 unsigned char * const slot,
+		 const int idst,
+		 const int k,
+		 unsigned char * const data)
+{
+  gaspi_return_t eret = GASPI_ERROR;
+
+  const gaspi_group_t g = req->group;
+  const int dst = glb_gaspi_group_ctx[g].rank_grp[idst];
+  const int p = req->gen & 1;
+  const unsigned long remote = COLL_MEM_NBC + req->slot * GPI2_NBC_SLOT;
+  const int dsize = (int) (req->elem_cnt * req->r_args.elem_size);
+
+  if( req->posted == 0 )
+    {
+      if( dsize > 0
+	  && (eret = _gaspi_coll_post_write(g, dst, data, dsize,
+					    remote + GPI2_NBC_RECV(p, k),
+					    GASPI_TEST)) != GASPI_SUCCESS )
+	{
+	  return eret;
+	}
+
+      req->posted = 1;
+    }
+
+  if( req->posted == 1 )
+    {
+      if( (eret = _gaspi_coll_post_write(g, dst, slot + GPI2_NBC_SRC(p), sizeof(unsigned int),
+					 remote + GPI2_NBC_FLAG(p, k), GASPI_TEST)) != GASPI_SUCCESS )
+	{
+	  return eret;
+	}
+
+      req->posted = 2;
+    }
+
+  return GASPI_SUCCESS;
+}
+
+/* Advance a request as far as possible without waiting: GASPI_SUCCESS
+   once completed, GASPI_TIMEOUT while it waits for its partners */
+static gaspi_return_t
+_gaspi_nbc_advance (struct gaspi_coll_request * const req)
+{
+  gaspi_return_t eret = GASPI_ERROR;
+  gaspi_group_ctx * const grp_ctx = &(glb_gaspi_group_ctx[req->group]);
+
+  const int rank = grp_ctx->rank;
+  const int rest = grp_ctx->tnc - grp_ctx->next_pof2;
+  const int p = req->gen & 1;
+  const gaspi_size_t dsize = req->elem_cnt * req->r_args.elem_size;
+
+  unsigned char * const slot =
+    grp_ctx->rrcd[glb_gaspi_ctx.rank].data.buf + COLL_MEM_NBC + req->slot * GPI2_NBC_SLOT;
+  volatile unsigned int * const flags = (volatile unsigned int *) (slot + GPI2_NBC_FLAG(p, 0));
+
+  if( req->state == GASPI_NBC_PENDING )
+    {
+      if( _gaspi_coll_poll() != GASPI_SUCCESS )
+	{
+	  return GASPI_ERR_DEVICE;
+	}
 
-	      if(ms > timeout_ms)
-		{
-		  glb_gaspi_group_ctx[g].lastmask = mask|0x80000000;
-		  glb_gaspi_group_ctx[g].bid = bid;
+      if( glb_gaspi_ctx.ne_count_grp > 0 )
+	{
+	  return GASPI_TIMEOUT;
+	}
 
-		  return GASPI_TIMEOUT;
-		}
-	    }
+      *((unsigned int *) (slot + GPI2_NBC_SRC(p))) = req->gen;
 
-	  void *dst_val = (void *) (recv_ptr + (2 * bid + glb_gaspi_group_ctx[g].togle) * GPI2_REDUX_BUF_SIZE);
-	  void *local_val = (void *) send_ptr;
-	  send_ptr += dsize;
-	  glb_gaspi_group_ctx[g].dsize += dsize;
+      if( dsize > 0 )
+	{
+	  memcpy(slot + GPI2_NBC_WORK(0), req->buf_send, dsize);
+	}
 
-	  if(r_args->f_type == GASPI_OP)
+      req->work = 0;
+      req->posted = 0;
+      req->step = (rank < 2 * rest) ? GPI2_NBC_FOLD : 1;
+      req->state = GASPI_NBC_RUNNING;
+    }
+
+  /* rank within the power of two subset, -1 if folded */
+  const int tmprank = (rank < 2 * rest) ? ((rank % 2) ? (rank >> 1) : -1) : rank - rest;
+
+  if( req->step == GPI2_NBC_FOLD )
+    {
+      if( tmprank == -1 )
+	{
+	  if( (eret = _gaspi_nbc_post(req, slot, rank + 1, GPI2_NBC_FOLD,
+				      slot + GPI2_NBC_WORK(0))) != GASPI_SUCCESS )
 	    {
-	      gaspi_operation_t op = r_args->f_args.op;
-	      gaspi_datatype_t type = r_args->f_args.type;
+	      return eret;
+	    }
 
-	      fctArrayGASPI[op * 6 + type] ((void *) send_ptr, local_val, dst_val, elem_cnt);
+	  req->posted = 0;
+	  req->step = GPI2_NBC_RESULT;
+	}
+      else
+	{
+	  if( flags[GPI2_NBC_FOLD] != req->gen )
+	    {
+	      return GASPI_TIMEOUT;
 	    }
-	  else if(r_args->f_type == GASPI_USER)
+
+	  if( dsize > 0 )
 	    {
-	      r_args->f_args.user_fct (local_val, dst_val, (void *) send_ptr, r_args->f_args.rstate, elem_cnt, r_args->elem_size, timeout_ms);
+	      _gaspi_redux_apply(&req->r_args, slot + GPI2_NBC_WORK(1), slot + GPI2_NBC_WORK(0),
+				 slot + GPI2_NBC_RECV(p, GPI2_NBC_FOLD), req->elem_cnt, GASPI_BLOCK);
 	    }
 
-	  mask <<= 1;
-	  bid++;
+	  req->work = 1;
+	  req->step = 1;
 	}
-
     }
 
-  glb_gaspi_group_ctx[g].bid = bid;
-  glb_gaspi_group_ctx[g].level = 3;
-  //third phase
- L3:
-
-  if (rank < 2 * rest)
+  while( req->step <= grp_ctx->pof2_exp )
     {
+      const int tmpdst = tmprank ^ (1 << (req->step - 1));
+      const int idst = (tmpdst < rest) ? tmpdst * 2 + 1 : tmpdst + rest;
 
-      if (rank % 2){
+      if( (eret = _gaspi_nbc_post(req, slot, idst, req->step,
+				  slot + GPI2_NBC_WORK(req->work))) != GASPI_SUCCESS )
+	{
+	  return eret;
+	}
 
-	dst = glb_gaspi_group_ctx[g].rank_grp[rank - 1];
+      if( flags[req->step] != req->gen )
+	{
+	  return GASPI_TIMEOUT;
+	}
 
-	if( GASPI_ENDPOINT_DISCONNECTED == glb_gaspi_ctx.ep_conn[dst].cstat )
-	  if( (eret = pgaspi_connect((gaspi_rank_t) dst, timeout_ms)) != GASPI_SUCCESS)
-	    {
-	      gaspi_print_error("Failed to connect to rank %u", dst);
-	      return eret;
-	    }
+      if( dsize > 0 )
+	{
+	  _gaspi_redux_apply(&req->r_args, slot + GPI2_NBC_WORK(req->work + 1),
+			     slot + GPI2_NBC_WORK(req->work),
+			     slot + GPI2_NBC_RECV(p, req->step), req->elem_cnt, GASPI_BLOCK);
+	}
 
-	if( !glb_gaspi_group_ctx[g].committed_rank[dst] )
-	  {
-	    if( (eret = _pgaspi_group_commit_to(g, dst, timeout_ms)) != GASPI_SUCCESS )
-	      {
-		gaspi_print_error("Failed to commit to rank %u", dst);
-		unlock_gaspi (&glb_gaspi_group_ctx[g].gl);
-		return eret;
-	      }
-	  }
+      req->work++;
+      req->posted = 0;
+      req->step++;
+    }
 
-	if(pgaspi_dev_post_group_write(send_ptr, dsize, dst,
-				       (void *)(glb_gaspi_group_ctx[g].rrcd[dst].data.addr + (COLL_MEM_RECV + (2 * bid + glb_gaspi_group_ctx[g].togle) * GPI2_REDUX_BUF_SIZE)),
-				       g) != 0)
-	  {
-	    glb_gaspi_ctx.qp_state_vec[GASPI_COLL_QP][dst] = GASPI_STATE_CORRUPT;
-	    return GASPI_ERR_DEVICE;
-	  }
+  unsigned char *result = slot + GPI2_NBC_WORK(req->work);
 
-	if(pgaspi_dev_post_group_write(barrier_ptr, 1, dst,
-				       (void *)(glb_gaspi_group_ctx[g].rrcd[dst].data.addr + (2 * rank + glb_gaspi_group_ctx[g].togle)),
-				       g) != 0)
-	  {
-	    glb_gaspi_ctx.qp_state_vec[GASPI_COLL_QP][dst] = GASPI_STATE_CORRUPT;
-	    return GASPI_ERR_DEVICE;
-	  }
-	  glb_gaspi_ctx.ne_count_grp+=2;
-      }
-      else
+  if( tmprank == -1 )
+    {
+      if( flags[GPI2_NBC_RESULT] != req->gen )
 	{
-	  dst = 2 * (rank + 1) + glb_gaspi_group_ctx[g].togle;
+	  return GASPI_TIMEOUT;
+	}
 
-	  while (poll_buf[dst] != glb_gaspi_group_ctx[g].barrier_cnt)
-	    {
-	      //timeout...
-	      const gaspi_cycles_t s1 = gaspi_get_cycles();
-	      const gaspi_cycles_t tdelta = s1 - s0;
-	      const float ms = (float) tdelta * glb_gaspi_ctx.cycles_to_msecs;
+      result = slot + GPI2_NBC_RECV(p, GPI2_NBC_RESULT);
+    }
+  else if( rank < 2 * rest )
+    {
+      if( (eret = _gaspi_nbc_post(req, slot, rank - 1, GPI2_NBC_RESULT, result)) != GASPI_SUCCESS )
+	{
+	  return eret;
+	}
+    }
 
-	      if(ms > timeout_ms)
-		{
-		  return GASPI_TIMEOUT;
-		}
-	      //gaspi_delay ();
-	    }
+  if( dsize > 0 )
+    {
+      memcpy(req->buf_recv, result, dsize);
+    }
 
-	  bid += glb_gaspi_group_ctx[g].pof2_exp;
-	  send_ptr = (recv_ptr + (2 * bid + glb_gaspi_group_ctx[g].togle) * GPI2_REDUX_BUF_SIZE);
-	}
+  return GASPI_SUCCESS;
+}
+
+/* Advance the started requests of group g, if no other thread does
+   and no blocking collective of the group runs (it holds the group
+   lock) */
+static void
+_gaspi_nbc_progress_group (const gaspi_group_t g)
+{
+  int i;
+  gaspi_group_ctx * const grp_ctx = &(glb_gaspi_group_ctx[g]);
+
+  if( grp_ctx->nbc_issued == grp_ctx->nbc_released )
+    {
+      return;
     }
-  const int pret = pgaspi_dev_poll_groups();
 
-  if (pret < 0)
+  if( lock_gaspi_tout(&grp_ctx->nbc_lock, GASPI_TEST) )
     {
-      return GASPI_ERR_DEVICE;
+      return;
     }
 
-  glb_gaspi_ctx.ne_count_grp -= pret;
+  if( lock_gaspi_tout(&grp_ctx->gl, GASPI_TEST) )
+    {
+      unlock_gaspi(&grp_ctx->nbc_lock);
+      return;
+    }
 
-  glb_gaspi_group_ctx[g].togle = (glb_gaspi_group_ctx[g].togle ^ 0x1);
+  for(i = 0; i < GPI2_NBC_SLOTS; i++)
+    {
+      struct gaspi_coll_request * const req = &glb_gaspi_nbc[g][i];
 
-  glb_gaspi_group_ctx[g].coll_op = GASPI_NONE;
-  glb_gaspi_group_ctx[g].lastmask = 0x1;
-  glb_gaspi_group_ctx[g].level = 0;
-  glb_gaspi_group_ctx[g].dsize = 0;
-  glb_gaspi_group_ctx[g].bid   = 0;
+      if( req->state == GASPI_NBC_PENDING || req->state == GASPI_NBC_RUNNING )
+	{
+	  const gaspi_return_t eret = _gaspi_nbc_advance(req);
 
-  memcpy (buf_recv, send_ptr, dsize);
+	  if( eret != GASPI_TIMEOUT )
+	    {
+	      req->eret = eret;
+	      req->state = GASPI_NBC_DONE;
+	      __sync_fetch_and_sub(&glb_gaspi_ctx.nbc_active, 1);
+	    }
+	}
+    }
 
-  return GASPI_SUCCESS;
+  unlock_gaspi(&grp_ctx->gl);
+  unlock_gaspi(&grp_ctx->nbc_lock);
 }
 
-#pragma weak gaspi_allreduce = pgaspi_allreduce
-gaspi_return_t
-pgaspi_allreduce (const gaspi_pointer_t buf_send,
+void
+pgaspi_coll_progress (void)
+{
+  gaspi_group_t g;
+
+  if( glb_gaspi_ctx.nbc_active == 0 )
+    {
+      return;
+    }
+
+  for(g = 0; g < GASPI_MAX_GROUPS; g++)
+    {
+      _gaspi_nbc_progress_group(g);
+    }
+}
+
+static gaspi_return_t
+_gaspi_nbc_start (const gaspi_async_coll_t op,
+		  const gaspi_pointer_t buf_send,
 		  gaspi_pointer_t const buf_recv,
 		  const gaspi_number_t elem_cnt,
-		  const gaspi_operation_t op,
-		  const gaspi_datatype_t type,
+		  struct redux_args * const r_args,
 		  const gaspi_group_t g,
-		  const gaspi_timeout_t timeout_ms)
+		  gaspi_coll_request_t * const request)
 {
-  gaspi_verify_init("gaspi_allreduce_user");
-  gaspi_verify_null_ptr(buf_send);
-  gaspi_verify_null_ptr(buf_recv);
-  gaspi_verify_group(g);
+  gaspi_group_ctx * const grp_ctx = &(glb_gaspi_group_ctx[g]);
 
-  if(elem_cnt > 255)
-    return GASPI_ERR_INV_NUM;
-
-  if(lock_gaspi_tout (&glb_gaspi_group_ctx[g].gl, timeout_ms))
+  if( grp_ctx->pof2_exp > GPI2_NBC_STEPS )
     {
-      return GASPI_TIMEOUT;
+      return GASPI_ERR_INV_GROUP;
     }
 
-  if(!(glb_gaspi_group_ctx[g].coll_op & GASPI_ALLREDUCE))
+  lock_gaspi_tout(&grp_ctx->nbc_lock, GASPI_BLOCK);
+
+  const int slot = (int) (grp_ctx->nbc_issued % GPI2_NBC_SLOTS);
+  struct gaspi_coll_request * const req = &glb_gaspi_nbc[g][slot];
+
+  /* the request of the previous use was not released yet */
+  if( req->state != GASPI_NBC_FREE )
     {
-      unlock_gaspi (&glb_gaspi_group_ctx[g].gl);
+      unlock_gaspi(&grp_ctx->nbc_lock);
       return GASPI_ERR_ACTIVE_COLL;
     }
 
-  glb_gaspi_group_ctx[g].coll_op = GASPI_ALLREDUCE;
+  req->op = op;
+  req->group = g;
+  req->slot = slot;
+  req->gen = grp_ctx->nbc_issued / GPI2_NBC_SLOTS + 1;
+  req->buf_send = buf_send;
+  req->buf_recv = buf_recv;
+  req->elem_cnt = elem_cnt;
+  req->r_args = *r_args;
+  req->eret = GASPI_SUCCESS;
+  req->state = GASPI_NBC_PENDING;
 
-  struct redux_args r_args;
-  r_args.f_type = GASPI_OP;
-  r_args.f_args.op = op;
-  r_args.f_args.type = type;
-  r_args.elem_size = glb_gaspi_typ_size[type];
+  grp_ctx->nbc_issued++;
+  __sync_fetch_and_add(&glb_gaspi_ctx.nbc_active, 1);
 
-  gaspi_return_t eret = GASPI_ERROR;
-  eret = _gaspi_allreduce(buf_send, buf_recv, elem_cnt,
-			  &r_args, g, timeout_ms);
+  unlock_gaspi(&grp_ctx->nbc_lock);
 
+  *request = req;
 
-  unlock_gaspi (&glb_gaspi_group_ctx[g].gl);
+  /* get it going */
+  _gaspi_nbc_progress_group(g);
 
-  return eret;
+  return GASPI_SUCCESS;
 }
 
-#pragma weak gaspi_allreduce_user = pgaspi_allreduce_user
+#pragma weak gaspi_ibarrier = pgaspi_ibarrier
 gaspi_return_t
-pgaspi_allreduce_user (const gaspi_pointer_t buf_send,
-		       gaspi_pointer_t const buf_recv,
-		       const gaspi_number_t elem_cnt,
-		       const gaspi_size_t elem_size,
-		       gaspi_reduce_operation_t const user_fct,
-		       gaspi_state_t const rstate,
-		       const gaspi_group_t g,
-		       const gaspi_timeout_t timeout_ms)
+pgaspi_ibarrier (const gaspi_group_t g, gaspi_coll_request_t * const request)
 {
-  gaspi_verify_init("gaspi_allreduce_user");
+  gaspi_verify_init("gaspi_ibarrier");
+  gaspi_verify_null_ptr(request);
+  gaspi_verify_group(g);
+
+  struct redux_args r_args;
+  r_args.f_type = GASPI_OP;
+  r_args.f_args.op = GASPI_OP_SUM;
+  r_args.f_args.type = GASPI_TYPE_INT;
+  r_args.elem_size = 0;
+
+  return _gaspi_nbc_start(GASPI_BARRIER, NULL, NULL, 0, &r_args, g, request);
+}
+
+#pragma weak gaspi_iallreduce = pgaspi_iallreduce
+gaspi_return_t
+pgaspi_iallreduce (const gaspi_pointer_t buf_send,
+		   gaspi_pointer_t const buf_recv,
+		   const gaspi_number_t elem_cnt,
+		   const gaspi_operation_t op,
+		   const gaspi_datatype_t type,
+		   const gaspi_group_t g,
+		   gaspi_coll_request_t * const request)
+{
+  gaspi_verify_init("gaspi_iallreduce");
   gaspi_verify_null_ptr(buf_send);
   gaspi_verify_null_ptr(buf_recv);
+  gaspi_verify_null_ptr(request);
   gaspi_verify_group(g);
 
   if(elem_cnt > 255)
     return GASPI_ERR_INV_NUM;
 
-  if( elem_size * elem_cnt > GPI2_REDUX_BUF_SIZE)
-      return GASPI_ERR_INV_SIZE;
+  struct redux_args r_args;
+  r_args.f_type = GASPI_OP;
+  r_args.f_args.op = op;
+  r_args.f_args.type = type;
+  r_args.elem_size = glb_gaspi_typ_size[type];
 
-  if(lock_gaspi_tout (&glb_gaspi_group_ctx[g].gl, timeout_ms))
-    {
-      return GASPI_TIMEOUT;
-    }
+  return _gaspi_nbc_start(GASPI_ALLREDUCE, buf_send, buf_recv, elem_cnt,
+			  &r_args, g, request);
+}
 
-  if(!(glb_gaspi_group_ctx[g].coll_op & GASPI_ALLREDUCE_USER))
-    {
-      unlock_gaspi (&glb_gaspi_group_ctx[g].gl);
-      return GASPI_ERR_ACTIVE_COLL;
-    }
+#pragma weak gaspi_iallreduce_user = pgaspi_iallreduce_user
+gaspi_return_t
+pgaspi_iallreduce_user (const gaspi_pointer_t buf_send,
+			gaspi_pointer_t const buf_recv,
+			const gaspi_number_t elem_cnt,
+			const gaspi_size_t elem_size,
+			gaspi_reduce_operation_t const user_fct,
+			gaspi_state_t const rstate,
+			const gaspi_group_t g,
+			gaspi_coll_request_t * const request)
+{
+  gaspi_verify_init("gaspi_iallreduce_user");
+  gaspi_verify_null_ptr(buf_send);
+  gaspi_verify_null_ptr(buf_recv);
+  gaspi_verify_null_ptr(request);
+  gaspi_verify_group(g);
 
-  glb_gaspi_group_ctx[g].coll_op = GASPI_ALLREDUCE_USER;
+  if(elem_cnt > 255)
+    return GASPI_ERR_INV_NUM;
 
-  gaspi_return_t eret = GASPI_ERROR;
+  if( elem_size * elem_cnt > GPI2_REDUX_BUF_SIZE)
+    return GASPI_ERR_INV_SIZE;
 
   struct redux_args r_args;
   r_args.f_type = GASPI_USER;
@@ -1022,10 +4971,72 @@ pgaspi_allreduce_user (const gaspi_pointer_t buf_send,
   r_args.f_args.user_fct = user_fct;
   r_args.f_args.rstate = rstate;
 
-  eret = _gaspi_allreduce(buf_send, buf_recv, elem_cnt,
-			  &r_args, g, timeout_ms);
+  return _gaspi_nbc_start(GASPI_ALLREDUCE_USER, buf_send, buf_recv, elem_cnt,
+			  &r_args, g, request);
+}
 
-  unlock_gaspi (&glb_gaspi_group_ctx[g].gl);
+#pragma weak gaspi_coll_wait = pgaspi_coll_wait
+gaspi_return_t
+pgaspi_coll_wait (gaspi_coll_request_t * const request,
+		  const gaspi_timeout_t timeout_ms)
+{
+  gaspi_verify_init("gaspi_coll_wait");
+  gaspi_verify_null_ptr(request);
+  gaspi_verify_null_ptr(*request);
+
+  struct gaspi_coll_request * const req = *request;
+  gaspi_group_ctx * const grp_ctx = &(glb_gaspi_group_ctx[req->group]);
+
+  const gaspi_cycles_t s0 = gaspi_get_cycles();
+
+  for(;;)
+    {
+      pgaspi_coll_progress();
+
+      if( req->state == GASPI_NBC_DONE )
+	{
+	  break;
+	}
+
+      if( timeout_ms == GASPI_TEST )
+	{
+	  return GASPI_TIMEOUT;
+	}
+
+      if( timeout_ms != GASPI_BLOCK )
+	{
+	  const gaspi_cycles_t s1 = gaspi_get_cycles();
+	  const gaspi_cycles_t tdelta = s1 - s0;
+	  const float ms = (float) tdelta * glb_gaspi_ctx.cycles_to_msecs;
+
+	  if( ms > timeout_ms )
+	    {
+	      return GASPI_TIMEOUT;
+	    }
+	}
+    }
+
+  const gaspi_return_t eret = req->eret;
+
+  lock_gaspi_tout(&grp_ctx->nbc_lock, GASPI_BLOCK);
+  req->state = GASPI_NBC_FREE;
+  grp_ctx->nbc_released++;
+  unlock_gaspi(&grp_ctx->nbc_lock);
+
+  *request = NULL;
 
   return eret;
 }
+
+#pragma weak gaspi_coll_test = pgaspi_coll_test
+gaspi_return_t
+pgaspi_coll_test (gaspi_coll_request_t * const request, gaspi_number_t * const flag)
+{
+  gaspi_verify_null_ptr(flag);
+
+  const gaspi_return_t eret = pgaspi_coll_wait(request, GASPI_TEST);
+
+  *flag = (eret != GASPI_TIMEOUT);
+
+  return (eret == GASPI_TIMEOUT) ? GASPI_SUCCESS : eret;
+}
@@ -19,17 +19,102 @@ along with GPI-2. If not, see <http://www.gnu.org/licenses/>.
 #ifndef GPI2_GRP_H_
 #define GPI2_GRP_H_
 
+#include "GASPI_Ext.h"
 #include "GPI2_Types.h"
 
 #define GPI2_REDUX_BUF_SIZE 2048
 
+/* Large allreduce (reduce-scatter + allgather) is pipelined in chunks
+   of GPI2_REDUX_LARGE_CHUNK bytes. Each chunk parity has its own slot
+   with completion flags, two work buffers, a fold buffer (non power of
+   two groups) and the reduce-scatter receive buffer. */
+#define GPI2_REDUX_LARGE_CHUNK 32768
+#define GPI2_REDUX_LARGE_FLAGS 512
+#define GPI2_REDUX_LARGE_SLOT (GPI2_REDUX_LARGE_FLAGS + 4 * GPI2_REDUX_LARGE_CHUNK)
+
+/* Broadcast stages the message in chunks of GPI2_BCAST_CHUNK bytes in
+   a ring of GPI2_BCAST_DEPTH slots. The ring is preceded by the data
+   flags (and the words they are written from) and followed by one
+   acknowledgement counter per group member. */
+#define GPI2_BCAST_CHUNK 16384
+#define GPI2_BCAST_DEPTH 8
+#define GPI2_BCAST_FLAGS 512
+#define GPI2_BCAST_SIZE (GPI2_BCAST_FLAGS + GPI2_BCAST_DEPTH * GPI2_BCAST_CHUNK \
+			 + GASPI_MAX_NODES * sizeof(unsigned int))
+
+/* Allgather writes straight into the user segment, the group buffer
+   only holds its flags: one per step, one per peer telling that it
+   entered the operation, and the words they are written from. */
+#define GPI2_ALLGATHER_STEPS 64
+#define GPI2_ALLGATHER_SIZE (4 * GPI2_ALLGATHER_STEPS * sizeof(unsigned int))
+
+/* Up to this total size, allgather uses recursive doubling (power of
+   two groups) or Bruck's algorithm, above it a ring */
+#define GPI2_ALLGATHER_SHORT (512 * 1024)
+
+/* Alltoall exchanges one message per pair of nodes between the node
+   leaders. It goes in chunks of GPI2_ALLTOALL_CHUNK bytes through
+   GPI2_ALLTOALL_DEPTH send and receive slots of the group buffer,
+   preceded by the chunk flags (and the words they are written from)
+   and followed by one credit counter per group member. */
+#define GPI2_ALLTOALL_CHUNK 32768
+#define GPI2_ALLTOALL_DEPTH 4
+#define GPI2_ALLTOALL_FLAGS 512
+#define GPI2_ALLTOALL_SIZE (GPI2_ALLTOALL_FLAGS + 2 * GPI2_ALLTOALL_DEPTH * GPI2_ALLTOALL_CHUNK \
+			    + GASPI_MAX_NODES * sizeof(unsigned int))
+
+/* On a node, the blocks are staged in memory shared by the local
+   members, after the node area in the same file. It is allocated by
+   the first alltoall and grown to the largest one. */
+
+/* Reduce and scan go in chunks of GPI2_REDUCE_CHUNK bytes. Reduce
+   uses the first slot, scan the other two (one per chunk parity).
+   A slot holds the flags (and the words they are written from), four
+   work buffers and one receive buffer per step. */
+#define GPI2_REDUCE_CHUNK 8192
+#define GPI2_REDUCE_STEPS 16
+#define GPI2_REDUCE_FLAGS 512
+#define GPI2_REDUCE_SLOT (GPI2_REDUCE_FLAGS + (4 + GPI2_REDUCE_STEPS) * GPI2_REDUCE_CHUNK)
+#define GPI2_REDUCE_SIZE (3 * GPI2_REDUCE_SLOT)
+
+/* Non-blocking collectives. Up to GPI2_NBC_SLOTS of them may be
+   outstanding per group, the i-th one started in a group uses slot
+   i % GPI2_NBC_SLOTS. A slot holds the flags of each parity of its
+   use count (one per step, plus the fold and the result of non power
+   of two groups), the words they are written from, a receive buffer
+   per flag and parity and the work buffers. */
+#define GPI2_NBC_SLOTS 4
+#define GPI2_NBC_STEPS 16
+#define GPI2_NBC_FLAGS 256
+#define GPI2_NBC_SLOT (GPI2_NBC_FLAGS + 3 * (GPI2_NBC_STEPS + 2) * GPI2_REDUX_BUF_SIZE)
+#define GPI2_NBC_SIZE (GPI2_NBC_SLOTS * GPI2_NBC_SLOT)
+
 typedef enum {
   GASPI_BARRIER = 1,
   GASPI_ALLREDUCE = 2,
   GASPI_ALLREDUCE_USER = 4,
-  GASPI_NONE = 7
+  GASPI_BCAST = 8,
+  GASPI_ALLGATHER = 16,
+  GASPI_ALLTOALL = 32,
+  GASPI_REDUCE = 64,
+  GASPI_REDUCE_SCATTER = 128,
+  GASPI_SCAN = 256,
+  GASPI_NONE = 511
 } gaspi_async_coll_t;
 
+/* Setup state of the node (shared memory) level of a group */
+typedef enum {
+  GASPI_NODE_UNKNOWN = 0,
+  GASPI_NODE_SETUP_SYNC = 1,
+  GASPI_NODE_SETUP_AGREE = 2,
+  GASPI_NODE_READY = 3,
+  GASPI_NODE_FLAT = 4
+} gaspi_node_state_t;
+
+/* Shared memory per node and group: the release flag followed by one
+   arrival flag per local member, each in its own cache line */
+#define GPI2_NODE_FLAG_STRIDE 64
+
 typedef struct
 {
   int id;
@@ -37,12 +122,32 @@ typedef struct
   gaspi_lock_t del;
   volatile unsigned char barrier_cnt;
   volatile unsigned char togle;
+  unsigned char scan_slot;
   gaspi_async_coll_t coll_op;
   int lastmask;
   int level, tmprank, dsize, bid;
   int rank, tnc;
   int next_pof2;
   int pof2_exp;
+  unsigned int seq;
+  gaspi_node_state_t node_state;
+  int nnodes, node_idx;
+  int nlocal, local_idx;
+  int *node_leaders;
+  int *node_first;
+  int *node_members;
+  void *node_shm;
+  size_t node_shm_size;
+  int node_shm_fd;
+  unsigned char *node_a2a;
+  size_t node_a2a_size;
+  unsigned char *node_stage;
+  size_t node_stage_size;
+  unsigned int node_epoch;
+  unsigned char node_barrier_cnt;
+  gaspi_coll_algorithm_t barrier_alg, allreduce_alg;
+  unsigned int nbc_issued, nbc_released;
+  gaspi_lock_t nbc_lock;
   int *rank_grp;
   int *committed_rank;
   gaspi_rc_mseg *rrcd;
@@ -55,6 +160,7 @@ typedef struct
     group_ctx[i].committed_rank = NULL;					\
     group_ctx[i].id = -1;						\
     group_ctx[i].togle = 0;						\
+    group_ctx[i].scan_slot = 0;						\
     group_ctx[i].barrier_cnt = 0;					\
     group_ctx[i].rank = 0;						\
     group_ctx[i].tnc = 0;						\
@@ -66,9 +172,37 @@ typedef struct
     group_ctx[i].dsize = 0;						\
     group_ctx[i].next_pof2 = 0;						\
     group_ctx[i].pof2_exp = 0;						\
+    group_ctx[i].seq = 0;						\
+    group_ctx[i].node_state = GASPI_NODE_UNKNOWN;			\
+    group_ctx[i].nnodes = 0;						\
+    group_ctx[i].node_idx = 0;						\
+    group_ctx[i].nlocal = 0;						\
+    group_ctx[i].local_idx = 0;						\
+    group_ctx[i].node_leaders = NULL;					\
+    group_ctx[i].node_first = NULL;					\
+    group_ctx[i].node_members = NULL;					\
+    group_ctx[i].node_shm = NULL;					\
+    group_ctx[i].node_shm_size = 0;					\
+    group_ctx[i].node_shm_fd = -1;					\
+    group_ctx[i].node_a2a = NULL;					\
+    group_ctx[i].node_a2a_size = 0;					\
+    group_ctx[i].node_stage = NULL;					\
+    group_ctx[i].node_stage_size = 0;					\
+    group_ctx[i].node_epoch = 0;					\
+    group_ctx[i].node_barrier_cnt = 0;					\
+    group_ctx[i].barrier_alg = GASPI_COLL_ALG_AUTO;			\
+    group_ctx[i].allreduce_alg = GASPI_COLL_ALG_AUTO;			\
+    group_ctx[i].nbc_issued = 0;					\
+    group_ctx[i].nbc_released = 0;					\
   }  while(0);
 
 gaspi_return_t
 pgaspi_group_all_local_create(const gaspi_timeout_t timeout_ms);
 
+void
+pgaspi_group_node_release(const gaspi_group_t group);
+
+void
+pgaspi_coll_progress(void);
+
 #endif /* GPI2_GRP_H_ */
@@ -16,6 +16,8 @@
   along with GPI-2. If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <stdint.h>
+
 #include "PGASPI.h"
 #include "GPI2.h"
 #include "GPI2_Dev.h"
@@ -25,6 +27,158 @@
 
 extern gaspi_config_t glb_gaspi_cfg;
 
+/* Take completions of a queue until n more requests fit into it */
+static gaspi_return_t
+_gaspi_queue_reap (const gaspi_queue_id_t queue, const int n,
+		   const gaspi_timeout_t timeout_ms)
+{
+  gaspi_return_t eret = GASPI_SUCCESS;
+
+  if( lock_gaspi_tout (&glb_gaspi_ctx.queues[queue].lock, timeout_ms) )
+    return GASPI_TIMEOUT;
+
+  const int excess = glb_gaspi_ctx.queues[queue].ne_count + n - (int) glb_gaspi_cfg.queue_depth;
+
+  if( excess > 0 )
+    {
+      eret = pgaspi_dev_wait (queue, &glb_gaspi_ctx.queues[queue].ne_count, excess, timeout_ms);
+    }
+
+  unlock_gaspi (&glb_gaspi_ctx.queues[queue].lock);
+
+  return eret;
+}
+
+/* Posting to a communication queue takes no lock: the requests are
+   reserved in the count of the queue before they are posted (posting
+   to the device is thread-safe) and the reservation is released if
+   posting fails. This also bounds the queue to its depth: a full
+   queue fails the post or, with GASPI_QUEUE_FULL_REAP, has just
+   enough of its completions taken, within timeout_ms over all the
+   reaps (other threads may fill the queue again in between). Only the
+   waits and purges, which take the completions, hold the lock of the
+   queue. */
+static inline gaspi_return_t
+_gaspi_queue_reserve_policy (const gaspi_queue_id_t queue, const int n,
+			     const gaspi_timeout_t timeout_ms,
+			     const gaspi_queue_full_policy_t policy)
+{
+  gaspi_cycles_t s0 = 0;
+  int reaps = 0;
+
+  for(;;)
+    {
+      const int before = __sync_fetch_and_add (&glb_gaspi_ctx.queues[queue].ne_count, n);
+
+      if( (unsigned) (before + n) <= glb_gaspi_cfg.queue_depth )
+	{
+	  return GASPI_SUCCESS;
+	}
+
+      __sync_fetch_and_sub (&glb_gaspi_ctx.queues[queue].ne_count, n);
+
+      if( GASPI_QUEUE_FULL_REAP != policy
+	  || (unsigned) n > glb_gaspi_cfg.queue_depth )
+	{
+	  return GASPI_ERR_MANY_Q_REQS;
+	}
+
+      gaspi_timeout_t left = timeout_ms;
+
+      if( timeout_ms != GASPI_BLOCK )
+	{
+	  if( reaps == 0 )
+	    {
+	      s0 = gaspi_get_cycles ();
+	    }
+
+	  const float ms = (float) (gaspi_get_cycles () - s0) * glb_gaspi_ctx.cycles_to_msecs;
+
+	  if( ms >= (float) timeout_ms )
+	    {
+	      if( reaps > 0 )
+		{
+		  return GASPI_TIMEOUT;
+		}
+
+	      left = GASPI_TEST;
+	    }
+	  else
+	    {
+	      left = timeout_ms - (gaspi_timeout_t) ms;
+	    }
+	}
+
+      const gaspi_return_t eret = _gaspi_queue_reap (queue, n, left);
+      if( eret != GASPI_SUCCESS )
+	{
+	  return eret;
+	}
+
+      reaps++;
+    }
+}
+
+static inline gaspi_return_t
+_gaspi_queue_reserve (const gaspi_queue_id_t queue, const int n,
+		      const gaspi_timeout_t timeout_ms)
+{
+  return _gaspi_queue_reserve_policy (queue, n, timeout_ms,
+				      glb_gaspi_cfg.queue_full_policy);
+}
+
+static inline void
+_gaspi_queue_release (const gaspi_queue_id_t queue, const int n)
+{
+  __sync_fetch_and_sub (&glb_gaspi_ctx.queues[queue].ne_count, n);
+}
+
+/* Requests a notification into segment_id of rank adds to its queue:
+   on IB the summary flag of the notification is a request of its own */
+static inline int
+_gaspi_notify_requests (const gaspi_segment_id_t segment_id,
+			const gaspi_rank_t rank)
+{
+#ifdef GPI2_DEVICE_IB
+  return 1 + glb_gaspi_ctx.rrmd[segment_id][rank].notif_summary;
+#else
+  return 1;
+#endif
+}
+
+/* Requests the notification of a write adds to its queue: none when
+   it goes with the data (notify_mode GASPI_NOTIFY_FUSED), on IB as
+   the immediate of the write if its value fits */
+static inline int
+_gaspi_write_notify_requests (const gaspi_segment_id_t segment_id,
+			      const gaspi_rank_t rank,
+			      const gaspi_notification_t value)
+{
+  if( GASPI_NOTIFY_FUSED == glb_gaspi_cfg.notify_mode
+#ifdef GPI2_DEVICE_IB
+      && value <= NOTIFY_IMM_VALUE_MAX
+#endif
+      )
+    {
+      return 0;
+    }
+
+  return _gaspi_notify_requests (segment_id, rank);
+}
+
+/* Requests the local notification of a read adds to its queue: on IB
+   the notification (and its summary flag) is read behind the data, on
+   TCP the response of the read sets it */
+static inline int
+_gaspi_read_notify_requests (const gaspi_segment_id_t segment_id)
+{
+#ifdef GPI2_DEVICE_IB
+  return _gaspi_notify_requests (segment_id, glb_gaspi_ctx.rank);
+#else
+  return 0;
+#endif
+}
+
 /* Queue utilities and IO limits */
 #pragma weak gaspi_queue_size = pgaspi_queue_size
 gaspi_return_t
@@ -34,7 +188,7 @@ pgaspi_queue_size (const gaspi_queue_id_t queue,
   gaspi_verify_queue(queue);
   gaspi_verify_null_ptr(queue_size);
 
-  *queue_size = (gaspi_number_t) glb_gaspi_ctx.ne_count_c[queue];
+  *queue_size = (gaspi_number_t) glb_gaspi_ctx.queues[queue].ne_count;
 
   return GASPI_SUCCESS;
 }
@@ -60,6 +214,46 @@ pgaspi_queue_size_max (gaspi_number_t * const queue_size_max)
   return GASPI_SUCCESS;
 }
 
+#pragma weak gaspi_queue_select = pgaspi_queue_select
+gaspi_return_t
+pgaspi_queue_select (const gaspi_queue_id_t queue_first,
+		     const gaspi_number_t num,
+		     const gaspi_number_t requests,
+		     gaspi_queue_id_t * const queue,
+		     const gaspi_timeout_t timeout_ms)
+{
+  gaspi_verify_init("gaspi_queue_select");
+  gaspi_verify_null_ptr(queue);
+
+  if( num < 1 || queue_first + num > glb_gaspi_ctx.num_queues )
+    {
+      return GASPI_ERR_INV_QUEUE;
+    }
+
+  if( requests > glb_gaspi_cfg.queue_depth )
+    {
+      return GASPI_ERR_MANY_Q_REQS;
+    }
+
+  gaspi_queue_id_t q, best = queue_first;
+
+  for(q = queue_first + 1; q < queue_first + num; q++)
+    {
+      if( glb_gaspi_ctx.queues[q].ne_count < glb_gaspi_ctx.queues[best].ne_count )
+	best = q;
+    }
+
+  const gaspi_return_t eret = _gaspi_queue_reap (best, (int) requests, timeout_ms);
+  if( eret != GASPI_SUCCESS )
+    {
+      return eret;
+    }
+
+  *queue = best;
+
+  return GASPI_SUCCESS;
+}
+
 #pragma weak gaspi_transfer_size_min = pgaspi_transfer_size_min
 gaspi_return_t
 pgaspi_transfer_size_min (gaspi_size_t * const transfer_size_min)
@@ -185,21 +379,182 @@ pgaspi_queue_delete(const gaspi_queue_id_t queue_id)
 {
   gaspi_context *ctx = &glb_gaspi_ctx;
 
+  /* (in the order of gaspi_endpoint_create) */
+  lock_gaspi (&ctx->lockEP);
   lock_gaspi (&glb_gaspi_ctx_lock);
 
+  /* endpoints still use the queue */
+  if( ctx->queues[queue_id].ep_bound > 0 )
+    {
+      unlock_gaspi(&glb_gaspi_ctx_lock);
+      unlock_gaspi(&ctx->lockEP);
+      return GASPI_ERR_INV_QUEUE;
+    }
+
   if( pgaspi_dev_comm_queue_delete(queue_id) != 0 )
     {
       unlock_gaspi(&glb_gaspi_ctx_lock);
+      unlock_gaspi(&ctx->lockEP);
       return GASPI_ERR_DEVICE;
     }
 
+  ctx->queues[queue_id].ep_pool = 0;
+  ctx->queues[queue_id].ep_bound = 0;
+
   /* Decrement queue counter */
   __sync_fetch_and_sub( &(ctx->num_queues), 1);
 
   unlock_gaspi(&glb_gaspi_ctx_lock);
+  unlock_gaspi(&ctx->lockEP);
+  return GASPI_SUCCESS;
+}
+
+/* Thread endpoints */
+#pragma weak gaspi_endpoint_create = pgaspi_endpoint_create
+gaspi_return_t
+pgaspi_endpoint_create (gaspi_endpoint_t * const endpoint,
+			const gaspi_timeout_t timeout_ms)
+{
+  gaspi_verify_init("gaspi_endpoint_create");
+  gaspi_verify_null_ptr(endpoint);
+
+  gaspi_context * const ctx = &glb_gaspi_ctx;
+  gaspi_return_t eret = GASPI_ERROR;
+  int e, q, best = -1;
+
+  if( lock_gaspi_tout (&ctx->lockEP, timeout_ms) )
+    return GASPI_TIMEOUT;
+
+  for(e = 0; e < GASPI_MAX_ENDPOINTS; e++)
+    {
+      if( !ctx->endpoints[e].used )
+	break;
+    }
+
+  if( GASPI_MAX_ENDPOINTS == e )
+    {
+      gaspi_print_error("Too many endpoints (max %d)", GASPI_MAX_ENDPOINTS);
+      goto endL;
+    }
+
+  /* A queue of a deleted endpoint, else a new queue */
+  for(q = 0; q < (int) ctx->num_queues; q++)
+    {
+      if( ctx->queues[q].ep_pool && 0 == ctx->queues[q].ep_bound )
+	{
+	  best = q;
+	  break;
+	}
+    }
+
+  if( best < 0 && ctx->num_queues < GASPI_MAX_QP )
+    {
+      gaspi_queue_id_t queue;
+
+      eret = pgaspi_queue_create (&queue, timeout_ms);
+      if( eret != GASPI_SUCCESS )
+	{
+	  goto endL;
+	}
+
+      ctx->queues[queue].ep_pool = 1;
+      best = queue;
+    }
+
+  /* Out of queues: share the least used one */
+  if( best < 0 )
+    {
+      int pool = 0;
+
+      for(q = 0; q < (int) ctx->num_queues; q++)
+	{
+	  pool |= ctx->queues[q].ep_pool;
+	}
+
+      for(q = 0; q < (int) ctx->num_queues; q++)
+	{
+	  if( pool && !ctx->queues[q].ep_pool )
+	    continue;
+
+	  if( best < 0 || ctx->queues[q].ep_bound < ctx->queues[best].ep_bound )
+	    best = q;
+	}
+    }
+
+  ctx->queues[best].ep_bound++;
+
+  ctx->endpoints[e].queue = (gaspi_queue_id_t) best;
+  ctx->endpoints[e].used = 1;
+
+  *endpoint = &ctx->endpoints[e];
+
+  eret = GASPI_SUCCESS;
+
+ endL:
+  unlock_gaspi (&ctx->lockEP);
+  return eret;
+}
+
+#pragma weak gaspi_endpoint_delete = pgaspi_endpoint_delete
+gaspi_return_t
+pgaspi_endpoint_delete (gaspi_endpoint_t endpoint)
+{
+  gaspi_verify_init("gaspi_endpoint_delete");
+  gaspi_verify_null_ptr(endpoint);
+
+  gaspi_context * const ctx = &glb_gaspi_ctx;
+
+  lock_gaspi (&ctx->lockEP);
+
+  if( !endpoint->used )
+    {
+      unlock_gaspi (&ctx->lockEP);
+      return GASPI_ERROR;
+    }
+
+  ctx->queues[endpoint->queue].ep_bound--;
+  endpoint->used = 0;
+
+  unlock_gaspi (&ctx->lockEP);
+
+  return GASPI_SUCCESS;
+}
+
+#pragma weak gaspi_endpoint_queue = pgaspi_endpoint_queue
+gaspi_return_t
+pgaspi_endpoint_queue (const gaspi_endpoint_t endpoint,
+		       gaspi_queue_id_t * const queue,
+		       gaspi_number_t * const shared)
+{
+  gaspi_verify_init("gaspi_endpoint_queue");
+  gaspi_verify_null_ptr(endpoint);
+  gaspi_verify_null_ptr(queue);
+
+  if( !endpoint->used )
+    return GASPI_ERROR;
+
+  *queue = endpoint->queue;
+
+  if( shared != NULL )
+    {
+      *shared = (glb_gaspi_ctx.queues[endpoint->queue].ep_bound > 1
+		 || !glb_gaspi_ctx.queues[endpoint->queue].ep_pool);
+    }
+
   return GASPI_SUCCESS;
 }
 
+#pragma weak gaspi_endpoint_wait = pgaspi_endpoint_wait
+gaspi_return_t
+pgaspi_endpoint_wait (const gaspi_endpoint_t endpoint,
+		      const gaspi_timeout_t timeout_ms)
+{
+  gaspi_verify_init("gaspi_endpoint_wait");
+  gaspi_verify_null_ptr(endpoint);
+
+  return pgaspi_wait (endpoint->queue, timeout_ms);
+}
+
 #pragma weak gaspi_queue_purge = pgaspi_queue_purge
 gaspi_return_t
 pgaspi_queue_purge(const gaspi_queue_id_t queue, const gaspi_timeout_t timeout_ms)
@@ -209,12 +564,12 @@ pgaspi_queue_purge(const gaspi_queue_id_t queue, const gaspi_timeout_t timeout_m
 
   gaspi_return_t eret = GASPI_ERROR;
 
-  if(lock_gaspi_tout (&glb_gaspi_ctx.lockC[queue], timeout_ms))
+  if(lock_gaspi_tout (&glb_gaspi_ctx.queues[queue].lock, timeout_ms))
     return GASPI_TIMEOUT;
 
-  eret = pgaspi_dev_purge(queue, &glb_gaspi_ctx.ne_count_c[queue], timeout_ms);
+  eret = pgaspi_dev_purge(queue, &glb_gaspi_ctx.queues[queue].ne_count, timeout_ms);
 
-  unlock_gaspi (&glb_gaspi_ctx.lockC[queue]);
+  unlock_gaspi (&glb_gaspi_ctx.queues[queue].lock);
 
   return eret;
 }
@@ -240,12 +595,13 @@ pgaspi_write (const gaspi_segment_id_t segment_id_local,
   gaspi_verify_remote_off(offset_remote, segment_id_remote, rank, size);
   gaspi_verify_queue(queue);
   gaspi_verify_comm_size(size, segment_id_local, segment_id_remote, rank, GASPI_MAX_TSIZE_C);
-  gaspi_verify_queue_depth(glb_gaspi_ctx.ne_count_c[queue]);
 
-  gaspi_return_t eret = GASPI_ERROR;
+  const int reqs = 1;
 
-  if(lock_gaspi_tout (&glb_gaspi_ctx.lockC[queue], timeout_ms))
-    return GASPI_TIMEOUT;
+  gaspi_return_t eret = _gaspi_queue_reserve (queue, reqs, timeout_ms);
+
+  if( eret != GASPI_SUCCESS )
+    return eret;
 
   if( GASPI_ENDPOINT_DISCONNECTED == glb_gaspi_ctx.ep_conn[rank].cstat )
     {
@@ -266,13 +622,13 @@ pgaspi_write (const gaspi_segment_id_t segment_id_local,
       goto endL;
     }
 
-  glb_gaspi_ctx.ne_count_c[queue]++;
-
   GPI2_STATS_INC_COUNT(GASPI_STATS_COUNTER_NUM_WRITE, 1);
   GPI2_STATS_INC_COUNT(GASPI_STATS_COUNTER_BYTES_WRITE, size);
 
+  return GASPI_SUCCESS;
+
  endL:
-  unlock_gaspi (&glb_gaspi_ctx.lockC[queue]);
+  _gaspi_queue_release (queue, reqs);
   return eret;
 }
 
@@ -292,12 +648,13 @@ pgaspi_read (const gaspi_segment_id_t segment_id_local,
   gaspi_verify_remote_off(offset_remote, segment_id_remote, rank, size);
   gaspi_verify_queue(queue);
   gaspi_verify_comm_size(size, segment_id_local, segment_id_remote, rank, GASPI_MAX_TSIZE_C);
-  gaspi_verify_queue_depth(glb_gaspi_ctx.ne_count_c[queue]);
 
-  gaspi_return_t eret = GASPI_ERROR;
+  const int reqs = 1;
 
-  if(lock_gaspi_tout (&glb_gaspi_ctx.lockC[queue], timeout_ms))
-    return GASPI_TIMEOUT;
+  gaspi_return_t eret = _gaspi_queue_reserve (queue, reqs, timeout_ms);
+
+  if( eret != GASPI_SUCCESS )
+    return eret;
 
   if( GASPI_ENDPOINT_DISCONNECTED == glb_gaspi_ctx.ep_conn[rank].cstat )
     {
@@ -318,12 +675,13 @@ pgaspi_read (const gaspi_segment_id_t segment_id_local,
       goto endL;
     }
 
-  glb_gaspi_ctx.ne_count_c[queue]++;
-
   GPI2_STATS_INC_COUNT(GASPI_STATS_COUNTER_NUM_READ, 1);
   GPI2_STATS_INC_COUNT(GASPI_STATS_COUNTER_BYTES_READ, size);
+
+  return GASPI_SUCCESS;
+
  endL:
-  unlock_gaspi (&glb_gaspi_ctx.lockC[queue]);
+  _gaspi_queue_release (queue, reqs);
   return eret;
 }
 
@@ -341,10 +699,13 @@ pgaspi_wait (const gaspi_queue_id_t queue,
 
   gaspi_return_t eret = GASPI_ERROR;
 
-  if(lock_gaspi_tout (&glb_gaspi_ctx.lockC[queue], timeout_ms))
+  pgaspi_coll_progress();
+
+  if(lock_gaspi_tout (&glb_gaspi_ctx.queues[queue].lock, timeout_ms))
     return GASPI_TIMEOUT;
 
-  eret = pgaspi_dev_wait(queue, &glb_gaspi_ctx.ne_count_c[queue], timeout_ms);
+  eret = pgaspi_dev_wait(queue, &glb_gaspi_ctx.queues[queue].ne_count,
+			 glb_gaspi_ctx.queues[queue].ne_count, timeout_ms);
 
   if( eret != GASPI_SUCCESS )
     {
@@ -354,7 +715,7 @@ pgaspi_wait (const gaspi_queue_id_t queue,
   GPI2_STATS_INC_COUNT(GASPI_STATS_COUNTER_NUM_WAIT, 1);
 
  endL:
-  unlock_gaspi (&glb_gaspi_ctx.lockC[queue]);
+  unlock_gaspi (&glb_gaspi_ctx.queues[queue].lock);
 
   GPI2_STATS_STOP_TIMER(GASPI_WAIT_TIMER);
   GPI2_STATS_INC_TIMER( GASPI_STATS_TIME_WAIT,
@@ -381,7 +742,6 @@ pgaspi_write_list (const gaspi_number_t num,
 #ifdef DEBUG
   gaspi_verify_init("gaspi_write_list");
   gaspi_verify_queue(queue);
-  gaspi_verify_queue_depth(glb_gaspi_ctx.ne_count_c[queue]);
 
   gaspi_number_t n;
   for(n = 0; n < num; n++)
@@ -393,10 +753,12 @@ pgaspi_write_list (const gaspi_number_t num,
 
 #endif
 
-  gaspi_return_t eret = GASPI_ERROR;
+  const int reqs = (int) num;
 
-  if(lock_gaspi_tout (&glb_gaspi_ctx.lockC[queue], timeout_ms))
-    return GASPI_TIMEOUT;
+  gaspi_return_t eret = _gaspi_queue_reserve (queue, reqs, timeout_ms);
+
+  if( eret != GASPI_SUCCESS )
+    return eret;
 
   if( GASPI_ENDPOINT_DISCONNECTED == glb_gaspi_ctx.ep_conn[rank].cstat )
     {
@@ -417,10 +779,10 @@ pgaspi_write_list (const gaspi_number_t num,
       goto endL;
     }
 
-  glb_gaspi_ctx.ne_count_c[queue] +=  num;
+  return GASPI_SUCCESS;
 
  endL:
-  unlock_gaspi (&glb_gaspi_ctx.lockC[queue]);
+  _gaspi_queue_release (queue, reqs);
   return eret;
 }
 
@@ -442,7 +804,6 @@ pgaspi_read_list (const gaspi_number_t num,
 #ifdef DEBUG
   gaspi_verify_init("gaspi_read_list");
   gaspi_verify_queue(queue);
-  gaspi_verify_queue_depth(glb_gaspi_ctx.ne_count_c[queue]);
 
   gaspi_number_t n;
   for( n = 0; n < num; n++ )
@@ -453,12 +814,12 @@ pgaspi_read_list (const gaspi_number_t num,
     }
 #endif
 
-  gaspi_return_t eret;
+  const int reqs = (int) num;
 
-  if( lock_gaspi_tout (&glb_gaspi_ctx.lockC[queue], timeout_ms) )
-    {
-      return GASPI_TIMEOUT;
-    }
+  gaspi_return_t eret = _gaspi_queue_reserve (queue, reqs, timeout_ms);
+
+  if( eret != GASPI_SUCCESS )
+    return eret;
 
   if( GASPI_ENDPOINT_DISCONNECTED == glb_gaspi_ctx.ep_conn[rank].cstat )
     {
@@ -479,10 +840,10 @@ pgaspi_read_list (const gaspi_number_t num,
       goto endL;
     }
 
-  glb_gaspi_ctx.ne_count_c[queue] += num;
+  return GASPI_SUCCESS;
 
  endL:
-  unlock_gaspi (&glb_gaspi_ctx.lockC[queue]);
+  _gaspi_queue_release (queue, reqs);
   return eret;
 }
 
@@ -500,7 +861,6 @@ pgaspi_notify (const gaspi_segment_id_t segment_id_remote,
   gaspi_verify_null_ptr(glb_gaspi_ctx.rrmd[segment_id_remote]);
   gaspi_verify_rank(rank);
   gaspi_verify_queue(queue);
-  gaspi_verify_queue_depth(glb_gaspi_ctx.ne_count_c[queue]);
 
   if(notification_value == 0)
     {
@@ -508,10 +868,12 @@ pgaspi_notify (const gaspi_segment_id_t segment_id_remote,
       return GASPI_ERR_INV_NOTIF_VAL;
     }
 
-  gaspi_return_t eret = GASPI_ERROR;
+  const int reqs = _gaspi_notify_requests(segment_id_remote, rank);
 
-  if(lock_gaspi_tout (&glb_gaspi_ctx.lockC[queue], timeout_ms))
-    return GASPI_TIMEOUT;
+  gaspi_return_t eret = _gaspi_queue_reserve (queue, reqs, timeout_ms);
+
+  if( eret != GASPI_SUCCESS )
+    return eret;
 
   if( GASPI_ENDPOINT_DISCONNECTED == glb_gaspi_ctx.ep_conn[rank].cstat )
     {
@@ -532,188 +894,1359 @@ pgaspi_notify (const gaspi_segment_id_t segment_id_remote,
       goto endL;
     }
 
-  glb_gaspi_ctx.ne_count_c[queue]++;
+  return GASPI_SUCCESS;
 
- endL:  
-  unlock_gaspi (&glb_gaspi_ctx.lockC[queue]);
+ endL:
+  _gaspi_queue_release (queue, reqs);
   return eret;
 }
 
-#pragma weak gaspi_notify_waitsome  = pgaspi_notify_waitsome
+#pragma weak gaspi_notify_add = pgaspi_notify_add
 gaspi_return_t
-pgaspi_notify_waitsome (const gaspi_segment_id_t segment_id_local,
-			const gaspi_notification_id_t notification_begin,
-			const gaspi_number_t num,
-			gaspi_notification_id_t * const first_id,
-			const gaspi_timeout_t timeout_ms)
+pgaspi_notify_add (const gaspi_segment_id_t segment_id_remote,
+		   const gaspi_rank_t rank,
+		   const gaspi_notification_id_t notification_id,
+		   const gaspi_notification_t notification_value,
+		   const gaspi_queue_id_t queue,
+		   const gaspi_timeout_t timeout_ms)
 {
-  gaspi_verify_init("gaspi_notify_waitsome");
-  gaspi_verify_segment(segment_id_local);
-  gaspi_verify_null_ptr(glb_gaspi_ctx.rrmd[segment_id_local]);
-  gaspi_verify_null_ptr(first_id);
-
-  /* We need to start timing before the lock to include contention in
-     lock when execution is multithreaded */
-  GPI2_STATS_START_TIMER(GASPI_WAITSOME_TIMER);
-
-#ifdef DEBUG
-  if( num >= GASPI_MAX_NOTIFICATION)
-    return GASPI_ERR_INV_NUM;
-#endif
-
-  volatile unsigned char *segPtr;
-  int loop = 1;
-  gaspi_notification_id_t n;
+  gaspi_verify_init("gaspi_notify_add");
+  gaspi_verify_segment(segment_id_remote);
+  gaspi_verify_null_ptr(glb_gaspi_ctx.rrmd[segment_id_remote]);
+  gaspi_verify_rank(rank);
+  gaspi_verify_queue(queue);
 
-  if(num == 0)
-    return GASPI_SUCCESS;
+  if(notification_value == 0)
+    {
+      gaspi_printf("Zero is not allowed as notification value.");
+      return GASPI_ERR_INV_NOTIF_VAL;
+    }
 
-#ifdef GPI2_CUDA
-  if(glb_gaspi_ctx.rrmd[segment_id_local][glb_gaspi_ctx.rank].cudaDevId >=0 )
+  /* the add goes to the 8-byte word of the ID and the odd ID after it */
+  if(notification_id & 1)
     {
-      segPtr =  (volatile unsigned char*)glb_gaspi_ctx.rrmd[segment_id_local][glb_gaspi_ctx.rank].host_addr;
+      gaspi_printf("Only even notification IDs can be added to.");
+      return GASPI_ERR_INV_NOTIF_ID;
     }
-  else
-#endif
 
-  segPtr = (volatile unsigned char *) glb_gaspi_ctx.rrmd[segment_id_local][glb_gaspi_ctx.rank].notif_spc.addr;
+  const int reqs = _gaspi_notify_requests(segment_id_remote, rank);
 
-  volatile unsigned int *p = (volatile unsigned int *) segPtr;
+  gaspi_return_t eret = _gaspi_queue_reserve (queue, reqs, timeout_ms);
+
+  if( eret != GASPI_SUCCESS )
+    return eret;
 
-  if (timeout_ms == GASPI_BLOCK)
+  if( GASPI_ENDPOINT_DISCONNECTED == glb_gaspi_ctx.ep_conn[rank].cstat )
     {
-      while (loop)
+      eret = pgaspi_connect((gaspi_rank_t) rank, timeout_ms);
+      if ( eret != GASPI_SUCCESS)
 	{
-	  for (n = notification_begin; n < (notification_begin + num); n++)
-	    {
-	      if (p[n])
-		{
-		  *first_id = n;
+	  goto endL;
+	}
+    }
 
-		  GPI2_STATS_STOP_TIMER(GASPI_WAITSOME_TIMER);
-		  GPI2_STATS_INC_TIMER( GASPI_STATS_TIME_WAITSOME,
-					GPI2_STATS_GET_TIMER(GASPI_WAITSOME_TIMER));
+  eret = pgaspi_dev_notify_add(segment_id_remote, rank,
+			       notification_id, notification_value,
+			       queue);
+
+  if( eret != GASPI_SUCCESS )
+    {
+      glb_gaspi_ctx.qp_state_vec[queue][rank] = GASPI_STATE_CORRUPT;
+      goto endL;
+    }
+
+  return GASPI_SUCCESS;
+
+ endL:
+  _gaspi_queue_release (queue, reqs);
+  return eret;
+}
+
+/* Scan of the notification space for the first set notification of
+   [begin, end), returning end if none is set. Besides the portable
+   loop, on x86 with GCC the scan tests whole blocks of notifications
+   at once with AVX2 or AVX-512F and finds the notification within a
+   set block with the scalar loop. The best instance supported by the
+   running CPU is selected in gaspi_init_notify_scan. Notifications
+   are single words, a block read does not tear them. */
+#if defined(__GNUC__) && !defined(__INTEL_COMPILER) && !defined(MIC) \
+  && (defined(__x86_64__) || defined(__i386__))
+#define GPI2_NOTIFY_X86 1
+#include <immintrin.h>
+#if defined(__clang__) || (__GNUC__ >= 5)
+#define GPI2_NOTIFY_AVX512 1
+#endif
+#endif
+
+typedef unsigned int (*gaspi_notify_scan_t) (volatile unsigned int * const,
+					     const unsigned int,
+					     const unsigned int);
+
+static unsigned int
+_gaspi_notify_scan (volatile unsigned int * const p,
+		    const unsigned int begin,
+		    const unsigned int end)
+{
+  unsigned int n;
+
+  for(n = begin; n < end; n++)
+    {
+      if( p[n] )
+	{
+	  return n;
+	}
+    }
+
+  return end;
+}
+
+#ifdef GPI2_NOTIFY_X86
+static __attribute__((target("avx2"))) unsigned int
+_gaspi_notify_scan_avx2 (volatile unsigned int * const p,
+			 const unsigned int begin,
+			 const unsigned int end)
+{
+  unsigned int n = begin;
+
+  /* up to the alignment of a vector, then blocks of four vectors */
+  while( n < end && ((uintptr_t) &p[n] & 31) )
+    {
+      if( p[n] )
+	{
+	  return n;
+	}
+      n++;
+    }
+
+  for(; n + 32 <= end; n += 32)
+    {
+      const __m256i *v = (const __m256i *) &p[n];
+      const __m256i any = _mm256_or_si256 (_mm256_or_si256 (_mm256_load_si256 (v),
+							    _mm256_load_si256 (v + 1)),
+					   _mm256_or_si256 (_mm256_load_si256 (v + 2),
+							    _mm256_load_si256 (v + 3)));
+      if( !_mm256_testz_si256 (any, any) )
+	{
+	  break;
+	}
+    }
+
+  return _gaspi_notify_scan (p, n, end);
+}
+
+#ifdef GPI2_NOTIFY_AVX512
+static __attribute__((target("avx512f"))) unsigned int
+_gaspi_notify_scan_avx512f (volatile unsigned int * const p,
+			    const unsigned int begin,
+			    const unsigned int end)
+{
+  unsigned int n = begin;
+
+  while( n < end && ((uintptr_t) &p[n] & 63) )
+    {
+      if( p[n] )
+	{
+	  return n;
+	}
+      n++;
+    }
+
+  for(; n + 64 <= end; n += 64)
+    {
+      const __m512i *v = (const __m512i *) &p[n];
+      const __m512i any = _mm512_or_si512 (_mm512_or_si512 (_mm512_load_si512 (v),
+							    _mm512_load_si512 (v + 1)),
+					   _mm512_or_si512 (_mm512_load_si512 (v + 2),
+							    _mm512_load_si512 (v + 3)));
+      if( _mm512_test_epi32_mask (any, any) )
+	{
+	  break;
+	}
+    }
+
+  return _gaspi_notify_scan (p, n, end);
+}
+#endif
+#endif
+
+static gaspi_notify_scan_t gaspi_notify_scan = _gaspi_notify_scan;
+
+void
+gaspi_init_notify_scan (void)
+{
+  gaspi_notify_scan = _gaspi_notify_scan;
+
+#ifdef GPI2_NOTIFY_X86
+  __builtin_cpu_init ();
+
+#ifdef GPI2_NOTIFY_AVX512
+  if( __builtin_cpu_supports ("avx512f") )
+    {
+      gaspi_notify_scan = _gaspi_notify_scan_avx512f;
+    }
+  else
+#endif
+  if( __builtin_cpu_supports ("avx2") )
+    {
+      gaspi_notify_scan = _gaspi_notify_scan_avx2;
+    }
+#endif
+}
+
+/* Scan guided by the summary s of the notification space: only the
+   blocks of [begin, end) with a set flag are scanned. The flag of a
+   block is written after each notification into it, so a block found
+   idle as a whole gets its flag cleared and is scanned once more, to
+   catch a notification that landed before the clearing. Flags of
+   blocks with set notifications stay set until these are reset and
+   the block is found idle. */
+static unsigned int
+_gaspi_notify_summary_scan (volatile unsigned int * const p,
+			    volatile unsigned char * const s,
+			    const unsigned int begin,
+			    const unsigned int end)
+{
+  unsigned int b = begin / NOTIFY_SUMMARY_BLOCK;
+  const unsigned int bend = (end + NOTIFY_SUMMARY_BLOCK - 1) / NOTIFY_SUMMARY_BLOCK;
+
+  while( b < bend )
+    {
+      /* idle blocks eight flags at a time */
+      if( !(b & 7) && b + 8 <= bend && *((volatile uint64_t *) &s[b]) == 0 )
+	{
+	  b += 8;
+	  continue;
+	}
+
+      if( s[b] )
+	{
+	  const unsigned int lo = MAX(begin, b * NOTIFY_SUMMARY_BLOCK);
+	  const unsigned int hi = MIN(end, (b + 1) * NOTIFY_SUMMARY_BLOCK);
+
+	  unsigned int n = gaspi_notify_scan (p, lo, hi);
+	  if( n < hi )
+	    {
+	      return n;
+	    }
+
+	  if( hi - lo == NOTIFY_SUMMARY_BLOCK )
+	    {
+	      s[b] = 0;
+	      __sync_synchronize ();
+
+	      n = gaspi_notify_scan (p, lo, hi);
+	      if( n < hi )
+		{
+		  s[b] = 1;
+		  return n;
+		}
+	    }
+	}
+
+      b++;
+    }
+
+  return end;
+}
+
+static inline unsigned int
+_gaspi_notify_find (volatile unsigned int * const p,
+		    volatile unsigned char * const s,
+		    const unsigned int begin,
+		    const unsigned int end)
+{
+  if( s != NULL )
+    {
+      return _gaspi_notify_summary_scan (p, s, begin, end);
+    }
+
+  return gaspi_notify_scan (p, begin, end);
+}
+
+/* Where the fair waitsome of this thread resumes its scan, per segment */
+static __thread unsigned int gaspi_notify_cursor[GASPI_MAX_MSEGS];
+
+/* The first set notification of [begin, end) or, with a cursor, the
+   first one from the cursor on, wrapping around at end, moving the
+   cursor past it */
+static inline unsigned int
+_gaspi_notify_next (volatile unsigned int * const p,
+		    volatile unsigned char * const s,
+		    const unsigned int begin,
+		    const unsigned int end,
+		    unsigned int * const cursor)
+{
+  if( cursor == NULL )
+    {
+      return _gaspi_notify_find (p, s, begin, end);
+    }
+
+  const unsigned int from = (*cursor > begin && *cursor < end) ? *cursor : begin;
+
+  unsigned int n = _gaspi_notify_find (p, s, from, end);
+  if( n == end && from > begin )
+    {
+      n = _gaspi_notify_find (p, s, begin, from);
+      if( n == from )
+	{
+	  return end;
+	}
+    }
+
+  if( n < end )
+    {
+      *cursor = n + 1;
+    }
+
+  return n;
+}
+
+/* Wait for the first set notification of [begin, end) (from cursor on
+   if not NULL) */
+static gaspi_return_t
+_gaspi_notify_wait (const gaspi_segment_id_t segment_id_local,
+		    const unsigned int begin,
+		    const unsigned int end,
+		    gaspi_notification_id_t * const first_id,
+		    unsigned int * const cursor,
+		    const gaspi_timeout_t timeout_ms)
+{
+  volatile unsigned char *segPtr;
+  volatile unsigned char *summary = NULL;
+  int loop = 1;
+  unsigned int n;
+
+#ifdef GPI2_CUDA
+  if(glb_gaspi_ctx.rrmd[segment_id_local][glb_gaspi_ctx.rank].cudaDevId >=0 )
+    {
+      segPtr =  (volatile unsigned char*)glb_gaspi_ctx.rrmd[segment_id_local][glb_gaspi_ctx.rank].host_addr;
+    }
+  else
+#endif
+
+  segPtr = (volatile unsigned char *) glb_gaspi_ctx.rrmd[segment_id_local][glb_gaspi_ctx.rank].notif_spc.addr;
+
+  if( glb_gaspi_ctx.rrmd[segment_id_local][glb_gaspi_ctx.rank].notif_summary )
+    {
+      summary = segPtr + NOTIFY_SUMMARY_OFFSET;
+    }
+
+  volatile unsigned int *p = (volatile unsigned int *) segPtr;
+
+  if (timeout_ms == GASPI_TEST)
+    {
+      /* (applies the notifications the device holds) */
+      pgaspi_dev_progress_seq ();
+      pgaspi_coll_progress ();
+
+      if (pgaspi_dev_notify_status () != GASPI_SUCCESS)
+	{
+	  return GASPI_ERROR;
+	}
+
+      n = _gaspi_notify_next (p, summary, begin, end, cursor);
+      if (n < end)
+	{
+	  *first_id = (gaspi_notification_id_t) n;
+	  GPI2_STATS_STOP_TIMER(GASPI_WAITSOME_TIMER);
+	  GPI2_STATS_INC_TIMER( GASPI_STATS_TIME_WAITSOME,
+				GPI2_STATS_GET_TIMER(GASPI_WAITSOME_TIMER));
+	  return GASPI_SUCCESS;
+	}
+
+      return GASPI_TIMEOUT;
+    }
+
+  gaspi_waiter_t w;
+  long block_us;
+
+  gaspi_waiter_init (&w, timeout_ms);
+
+  while (loop)
+    {
+      const unsigned int seq = pgaspi_dev_progress_seq ();
+
+      if (pgaspi_dev_notify_status () != GASPI_SUCCESS)
+	{
+	  return GASPI_ERROR;
+	}
+
+      n = _gaspi_notify_next (p, summary, begin, end, cursor);
+      if (n < end)
+	{
+	  *first_id = (gaspi_notification_id_t) n;
+	  break;
+	}
+
+      pgaspi_coll_progress ();
+
+      const int phase = gaspi_waiter_idle (&w, &block_us);
+
+      if (phase == GASPI_WAIT_PHASE_EXPIRED)
+	{
+	  GPI2_STATS_STOP_TIMER(GASPI_WAITSOME_TIMER);
+	  GPI2_STATS_INC_TIMER( GASPI_STATS_TIME_WAITSOME,
+				GPI2_STATS_GET_TIMER(GASPI_WAITSOME_TIMER));
+
+	  return GASPI_TIMEOUT;
+	}
+
+      if (phase == GASPI_WAIT_PHASE_BLOCK)
+	{
+	  pgaspi_dev_progress_wait (seq, block_us);
+	}
+    }
+
+  GPI2_STATS_STOP_TIMER(GASPI_WAITSOME_TIMER);
+  GPI2_STATS_INC_TIMER( GASPI_STATS_TIME_WAITSOME,
+			GPI2_STATS_GET_TIMER(GASPI_WAITSOME_TIMER));
+
+  return GASPI_SUCCESS;
+}
+
+#pragma weak gaspi_notify_waitsome  = pgaspi_notify_waitsome
+gaspi_return_t
+pgaspi_notify_waitsome (const gaspi_segment_id_t segment_id_local,
+			const gaspi_notification_id_t notification_begin,
+			const gaspi_number_t num,
+			gaspi_notification_id_t * const first_id,
+			const gaspi_timeout_t timeout_ms)
+{
+  gaspi_verify_init("gaspi_notify_waitsome");
+  gaspi_verify_segment(segment_id_local);
+  gaspi_verify_null_ptr(glb_gaspi_ctx.rrmd[segment_id_local]);
+  gaspi_verify_null_ptr(first_id);
+
+  /* We need to start timing before the lock to include contention in
+     lock when execution is multithreaded */
+  GPI2_STATS_START_TIMER(GASPI_WAITSOME_TIMER);
+
+#ifdef DEBUG
+  if( num >= GASPI_MAX_NOTIFICATION)
+    return GASPI_ERR_INV_NUM;
+#endif
+
+  if(num == 0)
+    return GASPI_SUCCESS;
+
+  return _gaspi_notify_wait (segment_id_local, notification_begin,
+			     (unsigned int) notification_begin + num,
+			     first_id, NULL, timeout_ms);
+}
+
+#pragma weak gaspi_notify_waitsome_fair = pgaspi_notify_waitsome_fair
+gaspi_return_t
+pgaspi_notify_waitsome_fair (const gaspi_segment_id_t segment_id_local,
+			     const gaspi_notification_id_t notification_begin,
+			     const gaspi_number_t num,
+			     gaspi_notification_id_t * const first_id,
+			     const gaspi_timeout_t timeout_ms)
+{
+  gaspi_verify_init("gaspi_notify_waitsome_fair");
+  gaspi_verify_segment(segment_id_local);
+  gaspi_verify_null_ptr(glb_gaspi_ctx.rrmd[segment_id_local]);
+  gaspi_verify_null_ptr(first_id);
+
+  GPI2_STATS_START_TIMER(GASPI_WAITSOME_TIMER);
+
+#ifdef DEBUG
+  if( num >= GASPI_MAX_NOTIFICATION)
+    return GASPI_ERR_INV_NUM;
+#endif
+
+  if(num == 0)
+    return GASPI_SUCCESS;
+
+  return _gaspi_notify_wait (segment_id_local, notification_begin,
+			     (unsigned int) notification_begin + num,
+			     first_id, &gaspi_notify_cursor[segment_id_local],
+			     timeout_ms);
+}
+
+#pragma weak gaspi_notify_waitany = pgaspi_notify_waitany
+gaspi_return_t
+pgaspi_notify_waitany (const gaspi_segment_id_t segment_id_local,
+		       gaspi_notification_id_t * const first_id,
+		       const gaspi_timeout_t timeout_ms)
+{
+  gaspi_verify_init("gaspi_notify_waitany");
+  gaspi_verify_segment(segment_id_local);
+  gaspi_verify_null_ptr(glb_gaspi_ctx.rrmd[segment_id_local]);
+  gaspi_verify_null_ptr(first_id);
+
+  GPI2_STATS_START_TIMER(GASPI_WAITSOME_TIMER);
+
+  return _gaspi_notify_wait (segment_id_local, 0, GASPI_MAX_NOTIFICATION,
+			     first_id, NULL, timeout_ms);
+}
+
+#pragma weak gaspi_notify_waitsome_multi = pgaspi_notify_waitsome_multi
+gaspi_return_t
+pgaspi_notify_waitsome_multi (const gaspi_segment_id_t segment_id_local,
+			      const gaspi_notification_id_t notification_begin,
+			      const gaspi_number_t num,
+			      gaspi_notification_id_t * const ids,
+			      gaspi_notification_t * const values,
+			      const gaspi_number_t max_ids,
+			      gaspi_number_t * const count,
+			      const gaspi_timeout_t timeout_ms)
+{
+  gaspi_verify_init("gaspi_notify_waitsome_multi");
+  gaspi_verify_segment(segment_id_local);
+  gaspi_verify_null_ptr(glb_gaspi_ctx.rrmd[segment_id_local]);
+  gaspi_verify_null_ptr(ids);
+  gaspi_verify_null_ptr(count);
+
+#ifdef DEBUG
+  if( num >= GASPI_MAX_NOTIFICATION )
+    return GASPI_ERR_INV_NUM;
+#endif
+
+  gaspi_notification_id_t first;
+  gaspi_return_t eret;
+
+  *count = 0;
+
+  if( num == 0 || max_ids == 0 )
+    return GASPI_SUCCESS;
+
+  const unsigned int end = (unsigned int) notification_begin + num;
+
+  volatile unsigned int *p;
+  volatile unsigned char *summary = NULL;
+
+#ifdef GPI2_CUDA
+  if(glb_gaspi_ctx.rrmd[segment_id_local][glb_gaspi_ctx.rank].cudaDevId >= 0)
+    p = (volatile unsigned int *) glb_gaspi_ctx.rrmd[segment_id_local][glb_gaspi_ctx.rank].host_addr;
+  else
+#endif
+    p = (volatile unsigned int *) glb_gaspi_ctx.rrmd[segment_id_local][glb_gaspi_ctx.rank].notif_spc.addr;
+
+  if( glb_gaspi_ctx.rrmd[segment_id_local][glb_gaspi_ctx.rank].notif_summary )
+    {
+      summary = (volatile unsigned char *) p + NOTIFY_SUMMARY_OFFSET;
+    }
+
+  do
+    {
+      GPI2_STATS_START_TIMER(GASPI_WAITSOME_TIMER);
+
+      eret = _gaspi_notify_wait (segment_id_local, notification_begin, end,
+				 &first, NULL, timeout_ms);
+      if( eret != GASPI_SUCCESS )
+	{
+	  return eret;
+	}
+
+      /* harvest in the same pass, each one taken by an exchange: a
+	 concurrent reset or harvest gets either the value or 0 */
+      unsigned int n = first;
+      while( n < end && *count < max_ids )
+	{
+	  const unsigned int val = __sync_lock_test_and_set (&p[n], 0);
+	  if( val )
+	    {
+	      ids[*count] = (gaspi_notification_id_t) n;
+	      if( values != NULL )
+		{
+		  values[*count] = val;
+		}
+	      (*count)++;
+	    }
+
+	  n = _gaspi_notify_find (p, summary, n + 1, end);
+	}
+    }
+  /* the notification found was taken by another thread meanwhile */
+  while( *count == 0 && timeout_ms == GASPI_BLOCK );
+
+  return (*count > 0) ? GASPI_SUCCESS : GASPI_TIMEOUT;
+}
+
+
+#pragma weak gaspi_notify_wait_count = pgaspi_notify_wait_count
+gaspi_return_t
+pgaspi_notify_wait_count (const gaspi_segment_id_t segment_id_local,
+			  const gaspi_notification_id_t notification_id,
+			  const gaspi_notification_t count,
+			  const gaspi_timeout_t timeout_ms)
+{
+  gaspi_verify_init("gaspi_notify_wait_count");
+  gaspi_verify_segment(segment_id_local);
+  gaspi_verify_null_ptr(glb_gaspi_ctx.rrmd[segment_id_local]);
+
+#ifdef DEBUG
+  if( notification_id >= GASPI_MAX_NOTIFICATION )
+    return GASPI_ERR_INV_NUM;
+#endif
+
+  if(count == 0)
+    {
+      gaspi_printf("Zero is not allowed as notification count.");
+      return GASPI_ERR_INV_NOTIF_VAL;
+    }
+
+  volatile unsigned char *segPtr;
+
+#ifdef GPI2_CUDA
+  if(glb_gaspi_ctx.rrmd[segment_id_local][glb_gaspi_ctx.rank].cudaDevId >= 0)
+    segPtr =  (volatile unsigned char*)glb_gaspi_ctx.rrmd[segment_id_local][glb_gaspi_ctx.rank].host_addr;
+  else
+#endif
+    segPtr = (volatile unsigned char *)
+      glb_gaspi_ctx.rrmd[segment_id_local][glb_gaspi_ctx.rank].notif_spc.addr;
+
+  volatile unsigned int *p = (volatile unsigned int *) segPtr;
+
+  if (timeout_ms == GASPI_TEST)
+    {
+      /* (applies the notifications the device holds) */
+      pgaspi_dev_progress_seq ();
+      pgaspi_coll_progress ();
+
+      if (pgaspi_dev_notify_status () != GASPI_SUCCESS)
+	{
+	  return GASPI_ERROR;
+	}
+
+      return (p[notification_id] >= count) ? GASPI_SUCCESS : GASPI_TIMEOUT;
+    }
+
+  gaspi_waiter_t w;
+  long block_us;
+
+  gaspi_waiter_init (&w, timeout_ms);
+
+  for (;;)
+    {
+      const unsigned int seq = pgaspi_dev_progress_seq ();
+
+      if (pgaspi_dev_notify_status () != GASPI_SUCCESS)
+	{
+	  return GASPI_ERROR;
+	}
+
+      if (p[notification_id] >= count)
+	{
+	  return GASPI_SUCCESS;
+	}
+
+      pgaspi_coll_progress ();
+
+      const int phase = gaspi_waiter_idle (&w, &block_us);
+
+      if (phase == GASPI_WAIT_PHASE_EXPIRED)
+	{
+	  return GASPI_TIMEOUT;
+	}
+
+      if (phase == GASPI_WAIT_PHASE_BLOCK)
+	{
+	  pgaspi_dev_progress_wait (seq, block_us);
+	}
+    }
+}
+
+#pragma weak gaspi_notify_reset = pgaspi_notify_reset
+gaspi_return_t
+pgaspi_notify_reset (const gaspi_segment_id_t segment_id_local,
+		     const gaspi_notification_id_t notification_id,
+		     gaspi_notification_t * const old_notification_val)
+{
+  gaspi_verify_init("gaspi_notify_reset");
+  gaspi_verify_segment(segment_id_local);
+  gaspi_verify_null_ptr(glb_gaspi_ctx.rrmd[segment_id_local]);
+
+#ifdef DEBUG
+  if(old_notification_val == NULL)
+    {
+      gaspi_print_warning("NULL pointer on parameter old_notification_val (gaspi_notify_reset).");
+    }
+#endif
+
+  volatile unsigned char *segPtr;
+
+#ifdef GPI2_CUDA
+  if(glb_gaspi_ctx.rrmd[segment_id_local][glb_gaspi_ctx.rank].cudaDevId >= 0)
+    segPtr =  (volatile unsigned char*)glb_gaspi_ctx.rrmd[segment_id_local][glb_gaspi_ctx.rank].host_addr;
+  else
+#endif
+    segPtr = (volatile unsigned char *)
+        glb_gaspi_ctx.rrmd[segment_id_local][glb_gaspi_ctx.rank].notif_spc.addr;
+
+  volatile unsigned int *p = (volatile unsigned int *) segPtr;
+
+  /* (applies the notifications the device holds) */
+  pgaspi_dev_progress_seq ();
+
+  const unsigned int res = __sync_val_compare_and_swap (&p[notification_id], p[notification_id], 0);
+
+  if(old_notification_val != NULL)
+    *old_notification_val = res;
+
+  return GASPI_SUCCESS;
+}
+
+
+#pragma weak gaspi_write_notify = pgaspi_write_notify
+gaspi_return_t
+pgaspi_write_notify (const gaspi_segment_id_t segment_id_local,
+		     const gaspi_offset_t offset_local,
+		     const gaspi_rank_t rank,
+		     const gaspi_segment_id_t segment_id_remote,
+		     const gaspi_offset_t offset_remote,
+		     const gaspi_size_t size,
+		     const gaspi_notification_id_t notification_id,
+		     const gaspi_notification_t notification_value,
+		     const gaspi_queue_id_t queue,
+		     const gaspi_timeout_t timeout_ms)
+{
+  gaspi_verify_init("gaspi_write_notify");
+  gaspi_verify_local_off(offset_local, segment_id_local, size);
+  gaspi_verify_remote_off(offset_remote, segment_id_remote, rank, size);
+  gaspi_verify_queue(queue);
+  gaspi_verify_comm_size(size, segment_id_local, segment_id_remote, rank, GASPI_MAX_TSIZE_C);
+
+  if(notification_value == 0)
+    {
+      gaspi_printf("Zero is not allowed as notification value.");
+      return GASPI_ERR_INV_NOTIF_VAL;
+    }
+
+  const int reqs = 1 + _gaspi_write_notify_requests(segment_id_remote, rank, notification_value);
+
+  gaspi_return_t eret = _gaspi_queue_reserve (queue, reqs, timeout_ms);
+
+  if( eret != GASPI_SUCCESS )
+    return eret;
+
+  if( GASPI_ENDPOINT_DISCONNECTED == glb_gaspi_ctx.ep_conn[rank].cstat )
+    {
+      eret = pgaspi_connect((gaspi_rank_t) rank, timeout_ms);
+      if ( eret != GASPI_SUCCESS)
+	{
+	  goto endL;
+	}
+    }
+
+  eret = pgaspi_dev_write_notify(segment_id_local, offset_local, rank,
+				 segment_id_remote, offset_remote, size,
+				 notification_id, notification_value,
+				 queue);
+
+  if( eret != GASPI_SUCCESS )
+    {
+      glb_gaspi_ctx.qp_state_vec[queue][rank] = GASPI_STATE_CORRUPT;
+      goto endL;
+    }
+
+  GPI2_STATS_INC_COUNT(GASPI_STATS_COUNTER_NUM_WRITE_NOT, 1);
+  GPI2_STATS_INC_COUNT(GASPI_STATS_COUNTER_BYTES_WRITE, size);
+
+  return GASPI_SUCCESS;
+
+ endL:
+  _gaspi_queue_release (queue, reqs);
+  return eret;
+}
+
+
+#pragma weak gaspi_write_notify_add = pgaspi_write_notify_add
+gaspi_return_t
+pgaspi_write_notify_add (const gaspi_segment_id_t segment_id_local,
+			 const gaspi_offset_t offset_local,
+			 const gaspi_rank_t rank,
+			 const gaspi_segment_id_t segment_id_remote,
+			 const gaspi_offset_t offset_remote,
+			 const gaspi_size_t size,
+			 const gaspi_notification_id_t notification_id,
+			 const gaspi_notification_t notification_value,
+			 const gaspi_queue_id_t queue,
+			 const gaspi_timeout_t timeout_ms)
+{
+  gaspi_verify_init("gaspi_write_notify_add");
+  gaspi_verify_local_off(offset_local, segment_id_local, size);
+  gaspi_verify_remote_off(offset_remote, segment_id_remote, rank, size);
+  gaspi_verify_queue(queue);
+  gaspi_verify_comm_size(size, segment_id_local, segment_id_remote, rank, GASPI_MAX_TSIZE_C);
+
+  if(notification_value == 0)
+    {
+      gaspi_printf("Zero is not allowed as notification value.");
+      return GASPI_ERR_INV_NOTIF_VAL;
+    }
+
+  /* the add goes to the 8-byte word of the ID and the odd ID after it */
+  if(notification_id & 1)
+    {
+      gaspi_printf("Only even notification IDs can be added to.");
+      return GASPI_ERR_INV_NOTIF_ID;
+    }
+
+  const int reqs = 1 + _gaspi_notify_requests(segment_id_remote, rank);
+
+  gaspi_return_t eret = _gaspi_queue_reserve (queue, reqs, timeout_ms);
+
+  if( eret != GASPI_SUCCESS )
+    return eret;
+
+  if( GASPI_ENDPOINT_DISCONNECTED == glb_gaspi_ctx.ep_conn[rank].cstat )
+    {
+      eret = pgaspi_connect((gaspi_rank_t) rank, timeout_ms);
+      if ( eret != GASPI_SUCCESS)
+	{
+	  goto endL;
+	}
+    }
+
+  eret = pgaspi_dev_write_notify_add(segment_id_local, offset_local, rank,
+				     segment_id_remote, offset_remote, size,
+				     notification_id, notification_value,
+				     queue);
+
+  if( eret != GASPI_SUCCESS )
+    {
+      glb_gaspi_ctx.qp_state_vec[queue][rank] = GASPI_STATE_CORRUPT;
+      goto endL;
+    }
+
+  GPI2_STATS_INC_COUNT(GASPI_STATS_COUNTER_NUM_WRITE_NOT, 1);
+  GPI2_STATS_INC_COUNT(GASPI_STATS_COUNTER_BYTES_WRITE, size);
+
+  return GASPI_SUCCESS;
+
+ endL:
+  _gaspi_queue_release (queue, reqs);
+  return eret;
+}
+
+#pragma weak gaspi_write_list_notify = pgaspi_write_list_notify
+gaspi_return_t
+pgaspi_write_list_notify (const gaspi_number_t num,
+			  gaspi_segment_id_t * const segment_id_local,
+			  gaspi_offset_t * const offset_local,
+			  const gaspi_rank_t rank,
+			  gaspi_segment_id_t * const segment_id_remote,
+			  gaspi_offset_t * const offset_remote,
+			  gaspi_size_t * const size,
+			  const gaspi_segment_id_t segment_id_notification,
+			  const gaspi_notification_id_t notification_id,
+			  const gaspi_notification_t notification_value,
+			  const gaspi_queue_id_t queue,
+			  const gaspi_timeout_t timeout_ms)
+{
+  if(num == 0)
+    return GASPI_ERR_INV_NUM;
+
+  if(notification_value == 0)
+    {
+      gaspi_printf("Zero is not allowed as notification value.");
+      return GASPI_ERR_INV_NOTIF_VAL;
+    }
+
+#ifdef DEBUG
+  gaspi_verify_init("gaspi_write_list_notify");
+  gaspi_verify_queue(queue);
+
+  gaspi_number_t n;
+  for(n = 0; n < num; n++)
+    {
+      gaspi_verify_local_off(offset_local[n], segment_id_local[n], size[n]);
+      gaspi_verify_remote_off(offset_remote[n], segment_id_remote[n], rank, size[n]);
+      gaspi_verify_comm_size(size[n], segment_id_local[n], segment_id_remote[n], rank, GASPI_MAX_TSIZE_C);
+    }
+
+#endif
+
+  const int reqs = (int) num + _gaspi_write_notify_requests(segment_id_notification, rank, notification_value);
+
+  gaspi_return_t eret = _gaspi_queue_reserve (queue, reqs, timeout_ms);
+
+  if( eret != GASPI_SUCCESS )
+    return eret;
+
+  if( GASPI_ENDPOINT_DISCONNECTED == glb_gaspi_ctx.ep_conn[rank].cstat )
+    {
+      eret = pgaspi_connect((gaspi_rank_t) rank, timeout_ms);
+      if ( eret != GASPI_SUCCESS)
+	{
+	  goto endL;
+	}
+    }
+
+  eret = pgaspi_dev_write_list_notify(num,
+				      segment_id_local, offset_local, rank,
+				      segment_id_remote, offset_remote, size,
+				      segment_id_notification, notification_id, notification_value,
+				      queue);
+
+  if( eret != GASPI_SUCCESS )
+    {
+      glb_gaspi_ctx.qp_state_vec[queue][rank] = GASPI_STATE_CORRUPT;
+      goto endL;
+    }
+
+  return GASPI_SUCCESS;
+
+ endL:
+  _gaspi_queue_release (queue, reqs);
+  return eret;
+}
+
+#pragma weak gaspi_read_notify = pgaspi_read_notify
+gaspi_return_t
+pgaspi_read_notify (const gaspi_segment_id_t segment_id_local,
+		    const gaspi_offset_t offset_local,
+		    const gaspi_rank_t rank,
+		    const gaspi_segment_id_t segment_id_remote,
+		    const gaspi_offset_t offset_remote,
+		    const gaspi_size_t size,
+		    const gaspi_notification_id_t notification_id,
+		    const gaspi_queue_id_t queue,
+		    const gaspi_timeout_t timeout_ms)
+{
+  gaspi_verify_init("gaspi_read_notify");
+  gaspi_verify_local_off(offset_local, segment_id_local, size);
+  gaspi_verify_remote_off(offset_remote, segment_id_remote, rank, size);
+  gaspi_verify_queue(queue);
+  gaspi_verify_comm_size(size, segment_id_local, segment_id_remote, rank, GASPI_MAX_TSIZE_C);
+
+  const int reqs = 1 + _gaspi_read_notify_requests(segment_id_local);
+
+  gaspi_return_t eret = _gaspi_queue_reserve (queue, reqs, timeout_ms);
+
+  if( eret != GASPI_SUCCESS )
+    return eret;
+
+  if( GASPI_ENDPOINT_DISCONNECTED == glb_gaspi_ctx.ep_conn[rank].cstat )
+    {
+      eret = pgaspi_connect((gaspi_rank_t) rank, timeout_ms);
+      if ( eret != GASPI_SUCCESS)
+	{
+	  goto endL;
+	}
+    }
+
+  eret = pgaspi_dev_read_notify(segment_id_local, offset_local, rank,
+				segment_id_remote, offset_remote, size,
+				notification_id, queue);
+
+  if( eret != GASPI_SUCCESS )
+    {
+      glb_gaspi_ctx.qp_state_vec[queue][rank] = GASPI_STATE_CORRUPT;
+      goto endL;
+    }
+
+  GPI2_STATS_INC_COUNT(GASPI_STATS_COUNTER_NUM_READ, 1);
+  GPI2_STATS_INC_COUNT(GASPI_STATS_COUNTER_BYTES_READ, size);
+
+  return GASPI_SUCCESS;
+
+ endL:
+  _gaspi_queue_release (queue, reqs);
+  return eret;
+}
+
+#pragma weak gaspi_read_list_notify = pgaspi_read_list_notify
+gaspi_return_t
+pgaspi_read_list_notify (const gaspi_number_t num,
+			 gaspi_segment_id_t * const segment_id_local,
+			 gaspi_offset_t * const offset_local,
+			 const gaspi_rank_t rank,
+			 gaspi_segment_id_t * const segment_id_remote,
+			 gaspi_offset_t * const offset_remote,
+			 gaspi_size_t * const size,
+			 const gaspi_segment_id_t segment_id_notification,
+			 const gaspi_notification_id_t notification_id,
+			 const gaspi_queue_id_t queue,
+			 const gaspi_timeout_t timeout_ms)
+{
+  if(num == 0)
+    return GASPI_ERR_INV_NUM;
+
+#ifdef DEBUG
+  gaspi_verify_init("gaspi_read_list_notify");
+  gaspi_verify_queue(queue);
+
+  gaspi_number_t n;
+  for(n = 0; n < num; n++)
+    {
+      gaspi_verify_local_off(offset_local[n], segment_id_local[n], size[n]);
+      gaspi_verify_remote_off(offset_remote[n], segment_id_remote[n], rank, size[n]);
+      gaspi_verify_comm_size(size[n], segment_id_local[n], segment_id_remote[n], rank, GASPI_MAX_TSIZE_C);
+    }
+#endif
+
+  const int reqs = (int) num + _gaspi_read_notify_requests(segment_id_notification);
+
+  gaspi_return_t eret = _gaspi_queue_reserve (queue, reqs, timeout_ms);
+
+  if( eret != GASPI_SUCCESS )
+    return eret;
+
+  if( GASPI_ENDPOINT_DISCONNECTED == glb_gaspi_ctx.ep_conn[rank].cstat )
+    {
+      eret = pgaspi_connect((gaspi_rank_t) rank, timeout_ms);
+      if ( eret != GASPI_SUCCESS)
+	{
+	  goto endL;
+	}
+    }
+
+  eret = pgaspi_dev_read_list_notify(num,
+				     segment_id_local, offset_local, rank,
+				     segment_id_remote, offset_remote, size,
+				     segment_id_notification, notification_id,
+				     queue);
+
+  if( eret != GASPI_SUCCESS )
+    {
+      glb_gaspi_ctx.qp_state_vec[queue][rank] = GASPI_STATE_CORRUPT;
+      goto endL;
+    }
+
+  return GASPI_SUCCESS;
+
+ endL:
+  _gaspi_queue_release (queue, reqs);
+  return eret;
+}
+
+/* Strided transfers */
+
+/* Describe a strided transfer for the device: dimensions of one block
+   are dropped and those contiguous on both sides merged (into the
+   block or into the dimension before) */
+static gaspi_return_t
+_gaspi_strided_shape (gaspi_strided_t * const s,
+		      const gaspi_size_t * const stride_local,
+		      const gaspi_size_t * const stride_remote,
+		      const gaspi_size_t block_size,
+		      const gaspi_number_t * const count,
+		      const gaspi_number_t dims)
+{
+  gaspi_number_t d, k, n = dims;
+
+  if( dims > GASPI_STRIDED_MAX_DIMS || block_size == 0 )
+    {
+      return GASPI_ERR_INV_NUM;
+    }
+
+  if( dims > 0 && (count == NULL || stride_local == NULL || stride_remote == NULL) )
+    {
+      return GASPI_ERR_NULLPTR;
+    }
+
+  s->block = block_size;
+
+  for(d = 0; d < GASPI_STRIDED_MAX_DIMS; d++)
+    {
+      if( d < dims && count[d] == 0 )
+	{
+	  return GASPI_ERR_INV_NUM;
+	}
+
+      s->count[d] = (d < dims) ? count[d] : 1;
+      s->stride_local[d] = (d < dims) ? stride_local[d] : 0;
+      s->stride_remote[d] = (d < dims) ? stride_remote[d] : 0;
+    }
+
+  d = 0;
+  while( d < n )
+    {
+      if( s->count[d] == 1 )
+	{
+	  /* nothing to keep */
+	}
+      else if( d == 0
+	       && s->stride_local[0] == s->block
+	       && s->stride_remote[0] == s->block )
+	{
+	  s->block *= s->count[0];
+	}
+      else if( d > 0
+	       && s->stride_local[d] == s->stride_local[d - 1] * s->count[d - 1]
+	       && s->stride_remote[d] == s->stride_remote[d - 1] * s->count[d - 1] )
+	{
+	  s->count[d - 1] *= s->count[d];
+	}
+      else
+	{
+	  d++;
+	  continue;
+	}
+
+      for(k = d; k + 1 < n; k++)
+	{
+	  s->count[k] = s->count[k + 1];
+	  s->stride_local[k] = s->stride_local[k + 1];
+	  s->stride_remote[k] = s->stride_remote[k + 1];
+	}
+
+      n--;
+      s->count[n] = 1;
+      s->stride_local[n] = 0;
+      s->stride_remote[n] = 0;
+    }
+
+  return GASPI_SUCCESS;
+}
+
+static inline gaspi_size_t
+_gaspi_strided_size (const gaspi_strided_t * const s)
+{
+  gaspi_size_t size = s->block;
+  int d;
 
-		  return GASPI_SUCCESS;
-		}
-	    }
+  for(d = 0; d < GASPI_STRIDED_MAX_DIMS; d++)
+    {
+      size *= s->count[d];
+    }
 
-	  gaspi_delay ();
-	}
+  return size;
+}
+
+/* The bytes spanned at one side (stride) */
+static inline gaspi_size_t
+_gaspi_strided_extent (const gaspi_strided_t * const s,
+		       const gaspi_size_t * const stride)
+{
+  gaspi_size_t extent = s->block;
+  int d;
+
+  for(d = 0; d < GASPI_STRIDED_MAX_DIMS; d++)
+    {
+      extent += (s->count[d] - 1) * stride[d];
+    }
+
+  return extent;
+}
+
+static gaspi_return_t
+_gaspi_strided (const int is_read,
+		const gaspi_segment_id_t segment_id_local,
+		const gaspi_offset_t offset_local,
+		const gaspi_size_t * const stride_local,
+		const gaspi_rank_t rank,
+		const gaspi_segment_id_t segment_id_remote,
+		const gaspi_offset_t offset_remote,
+		const gaspi_size_t * const stride_remote,
+		const gaspi_size_t block_size,
+		const gaspi_number_t * const count,
+		const gaspi_number_t dims,
+		const int notify,
+		const gaspi_notification_id_t notification_id,
+		const gaspi_notification_t notification_value,
+		const gaspi_queue_id_t queue,
+		const gaspi_timeout_t timeout_ms)
+{
+  gaspi_strided_t shape;
+
+  gaspi_return_t eret = _gaspi_strided_shape (&shape, stride_local, stride_remote,
+					      block_size, count, dims);
+  if( eret != GASPI_SUCCESS )
+    return eret;
+
+  gaspi_verify_local_off(offset_local, segment_id_local,
+			 _gaspi_strided_extent (&shape, shape.stride_local));
+  gaspi_verify_remote_off(offset_remote, segment_id_remote, rank,
+			  _gaspi_strided_extent (&shape, shape.stride_remote));
+  gaspi_verify_queue(queue);
+  gaspi_verify_comm_size(_gaspi_strided_size (&shape), segment_id_local, segment_id_remote,
+			 rank, GASPI_MAX_TSIZE_C);
+
+  const int nreqs = notify ? _gaspi_notify_requests (segment_id_remote, rank) : 0;
+  const long limit = (long) glb_gaspi_cfg.queue_depth - nreqs;
+
+  if( limit < 1 )
+    return GASPI_ERR_MANY_Q_REQS;
+
+  if( GASPI_ENDPOINT_DISCONNECTED == glb_gaspi_ctx.ep_conn[rank].cstat )
+    {
+      eret = pgaspi_connect((gaspi_rank_t) rank, timeout_ms);
+      if( eret != GASPI_SUCCESS)
+	return eret;
     }
-  else if (timeout_ms == GASPI_TEST)
+
+  /* A transfer that may take more requests than the queue holds is
+     posted in pieces of up to step entries of dimension d (with all of
+     the dimensions below), at most limit blocks each: the pieces after
+     the first take completions of the queue to fit in */
+  int d = GASPI_STRIDED_MAX_DIMS - 1;
+  gaspi_number_t step = shape.count[d];
+
+  if( pgaspi_dev_strided_requests (&shape) > limit )
     {
+      unsigned long inner = 1;
 
-      for (n = notification_begin; n < (notification_begin + num); n++)
+      for(d = 0; d + 1 < GASPI_STRIDED_MAX_DIMS && inner * shape.count[d] <= (unsigned long) limit; d++)
 	{
-	  if (p[n])
-	    {
-	      *first_id = n;
-	      GPI2_STATS_STOP_TIMER(GASPI_WAITSOME_TIMER);
-	      GPI2_STATS_INC_TIMER( GASPI_STATS_TIME_WAITSOME,
-				    GPI2_STATS_GET_TIMER(GASPI_WAITSOME_TIMER));
-	      return GASPI_SUCCESS;
-	    }
+	  inner *= shape.count[d];
 	}
 
-      return GASPI_TIMEOUT;
+      step = (gaspi_number_t) MIN ((unsigned long) shape.count[d], limit / inner);
     }
 
+  gaspi_number_t idx[GASPI_STRIDED_MAX_DIMS] = { 0 };
   const gaspi_cycles_t s0 = gaspi_get_cycles ();
+  int first = 1, last = 0, e;
 
-  while (loop)
+  while( !last )
     {
-      for (n = notification_begin; n < (notification_begin + num); n++)
+      gaspi_strided_t piece = shape;
+      gaspi_offset_t off_local = offset_local, off_remote = offset_remote;
+      gaspi_timeout_t left = timeout_ms;
+      int posted = 0;
+
+      for(e = d; e < GASPI_STRIDED_MAX_DIMS; e++)
 	{
-	  if (p[n])
-	    {
-	      *first_id = n;
-	      loop = 0;
-	      break;
-	    }
+	  off_local += idx[e] * shape.stride_local[e];
+	  off_remote += idx[e] * shape.stride_remote[e];
+	  piece.count[e] = 1;
 	}
 
-      const gaspi_cycles_t s1 = gaspi_get_cycles ();
-      const gaspi_cycles_t tdelta = s1 - s0;
+      piece.count[d] = MIN (step, shape.count[d] - idx[d]);
 
-      const float ms = (float) tdelta * glb_gaspi_ctx.cycles_to_msecs;
-      if (ms > timeout_ms)
+      idx[d] += piece.count[d];
+      for(e = d; e + 1 < GASPI_STRIDED_MAX_DIMS && idx[e] == shape.count[e]; e++)
 	{
-	  GPI2_STATS_STOP_TIMER(GASPI_WAITSOME_TIMER);
-	  GPI2_STATS_INC_TIMER( GASPI_STATS_TIME_WAITSOME,
-				GPI2_STATS_GET_TIMER(GASPI_WAITSOME_TIMER));
-
-	  return GASPI_TIMEOUT;
+	  idx[e] = 0;
+	  idx[e + 1]++;
 	}
 
-      gaspi_delay ();
-    }
+      last = (idx[GASPI_STRIDED_MAX_DIMS - 1] == shape.count[GASPI_STRIDED_MAX_DIMS - 1]);
 
-  GPI2_STATS_STOP_TIMER(GASPI_WAITSOME_TIMER);
-  GPI2_STATS_INC_TIMER( GASPI_STATS_TIME_WAITSOME,
-			GPI2_STATS_GET_TIMER(GASPI_WAITSOME_TIMER));
+      if( !first && timeout_ms != GASPI_BLOCK && timeout_ms != GASPI_TEST )
+	{
+	  const float ms = (float) (gaspi_get_cycles () - s0) * glb_gaspi_ctx.cycles_to_msecs;
 
-  return GASPI_SUCCESS;
-}
+	  if( ms >= (float) timeout_ms )
+	    return GASPI_TIMEOUT;
 
+	  left = timeout_ms - (gaspi_timeout_t) ms;
+	}
 
-#pragma weak gaspi_notify_reset = pgaspi_notify_reset
-gaspi_return_t
-pgaspi_notify_reset (const gaspi_segment_id_t segment_id_local,
-		     const gaspi_notification_id_t notification_id,
-		     gaspi_notification_t * const old_notification_val)
-{
-  gaspi_verify_init("gaspi_notify_reset");
-  gaspi_verify_segment(segment_id_local);
-  gaspi_verify_null_ptr(glb_gaspi_ctx.rrmd[segment_id_local]);
+      const int bound = pgaspi_dev_strided_requests (&piece);
+      const int reqs = bound + (last ? nreqs : 0);
 
-#ifdef DEBUG
-  if(old_notification_val == NULL)
-    {
-      gaspi_print_warning("NULL pointer on parameter old_notification_val (gaspi_notify_reset).");
-    }
-#endif
+      eret = _gaspi_queue_reserve_policy (queue, reqs, left,
+					  first ? glb_gaspi_cfg.queue_full_policy
+					  : GASPI_QUEUE_FULL_REAP);
+      if( eret != GASPI_SUCCESS )
+	return eret;
 
-  volatile unsigned char *segPtr;
+      first = 0;
 
-#ifdef GPI2_CUDA
-  if(glb_gaspi_ctx.rrmd[segment_id_local][glb_gaspi_ctx.rank].cudaDevId >= 0)
-    segPtr =  (volatile unsigned char*)glb_gaspi_ctx.rrmd[segment_id_local][glb_gaspi_ctx.rank].host_addr;
-  else
-#endif
-    segPtr = (volatile unsigned char *)
-        glb_gaspi_ctx.rrmd[segment_id_local][glb_gaspi_ctx.rank].notif_spc.addr;
+      if( is_read )
+	{
+	  eret = pgaspi_dev_read_strided (segment_id_local, off_local, rank,
+					  segment_id_remote, off_remote, &piece,
+					  queue, &posted);
+	}
+      else
+	{
+	  eret = pgaspi_dev_write_strided (segment_id_local, off_local, rank,
+					   segment_id_remote, off_remote, &piece,
+					   queue, &posted);
+	}
 
-  volatile unsigned int *p = (volatile unsigned int *) segPtr;
+      /* posted behind the data on the same connection */
+      if( eret == GASPI_SUCCESS && last && notify )
+	{
+	  eret = pgaspi_dev_notify (segment_id_remote, rank, notification_id,
+				    notification_value, queue);
+	}
 
-  const unsigned int res = __sync_val_compare_and_swap (&p[notification_id], p[notification_id], 0);
+      if( eret != GASPI_SUCCESS )
+	{
+	  glb_gaspi_ctx.qp_state_vec[queue][rank] = GASPI_STATE_CORRUPT;
+	  _gaspi_queue_release (queue, reqs);
+	  return eret;
+	}
 
-  if(old_notification_val != NULL)
-    *old_notification_val = res;
+      /* requests of the bound left unused */
+      if( bound > posted )
+	{
+	  _gaspi_queue_release (queue, bound - posted);
+	}
+    }
+
+  if( is_read )
+    {
+      GPI2_STATS_INC_COUNT(GASPI_STATS_COUNTER_NUM_READ, 1);
+      GPI2_STATS_INC_COUNT(GASPI_STATS_COUNTER_BYTES_READ, _gaspi_strided_size (&shape));
+    }
+  else
+    {
+      GPI2_STATS_INC_COUNT(GASPI_STATS_COUNTER_NUM_WRITE, 1);
+      GPI2_STATS_INC_COUNT(GASPI_STATS_COUNTER_BYTES_WRITE, _gaspi_strided_size (&shape));
+    }
 
   return GASPI_SUCCESS;
 }
 
+#pragma weak gaspi_write_strided = pgaspi_write_strided
+gaspi_return_t
+pgaspi_write_strided (const gaspi_segment_id_t segment_id_local,
+		      const gaspi_offset_t offset_local,
+		      const gaspi_size_t * const stride_local,
+		      const gaspi_rank_t rank,
+		      const gaspi_segment_id_t segment_id_remote,
+		      const gaspi_offset_t offset_remote,
+		      const gaspi_size_t * const stride_remote,
+		      const gaspi_size_t block_size,
+		      const gaspi_number_t * const count,
+		      const gaspi_number_t dims,
+		      const gaspi_queue_id_t queue,
+		      const gaspi_timeout_t timeout_ms)
+{
+  gaspi_verify_init("gaspi_write_strided");
+
+  return _gaspi_strided (0, segment_id_local, offset_local, stride_local,
+			 rank, segment_id_remote, offset_remote, stride_remote,
+			 block_size, count, dims, 0, 0, 0, queue, timeout_ms);
+}
 
-#pragma weak gaspi_write_notify = pgaspi_write_notify
+#pragma weak gaspi_read_strided = pgaspi_read_strided
 gaspi_return_t
-pgaspi_write_notify (const gaspi_segment_id_t segment_id_local,
+pgaspi_read_strided (const gaspi_segment_id_t segment_id_local,
 		     const gaspi_offset_t offset_local,
+		     const gaspi_size_t * const stride_local,
 		     const gaspi_rank_t rank,
 		     const gaspi_segment_id_t segment_id_remote,
 		     const gaspi_offset_t offset_remote,
-		     const gaspi_size_t size,
-		     const gaspi_notification_id_t notification_id,
-		     const gaspi_notification_t notification_value,
+		     const gaspi_size_t * const stride_remote,
+		     const gaspi_size_t block_size,
+		     const gaspi_number_t * const count,
+		     const gaspi_number_t dims,
 		     const gaspi_queue_id_t queue,
 		     const gaspi_timeout_t timeout_ms)
 {
-  gaspi_verify_init("gaspi_write_notify");
-  gaspi_verify_local_off(offset_local, segment_id_local, size);
-  gaspi_verify_remote_off(offset_remote, segment_id_remote, rank, size);
-  gaspi_verify_queue(queue);
-  gaspi_verify_comm_size(size, segment_id_local, segment_id_remote, rank, GASPI_MAX_TSIZE_C);
-  gaspi_verify_queue_depth(glb_gaspi_ctx.ne_count_c[queue]);
+  gaspi_verify_init("gaspi_read_strided");
+
+  return _gaspi_strided (1, segment_id_local, offset_local, stride_local,
+			 rank, segment_id_remote, offset_remote, stride_remote,
+			 block_size, count, dims, 0, 0, 0, queue, timeout_ms);
+}
+
+#pragma weak gaspi_write_strided_notify = pgaspi_write_strided_notify
+gaspi_return_t
+pgaspi_write_strided_notify (const gaspi_segment_id_t segment_id_local,
+			     const gaspi_offset_t offset_local,
+			     const gaspi_size_t * const stride_local,
+			     const gaspi_rank_t rank,
+			     const gaspi_segment_id_t segment_id_remote,
+			     const gaspi_offset_t offset_remote,
+			     const gaspi_size_t * const stride_remote,
+			     const gaspi_size_t block_size,
+			     const gaspi_number_t * const count,
+			     const gaspi_number_t dims,
+			     const gaspi_notification_id_t notification_id,
+			     const gaspi_notification_t notification_value,
+			     const gaspi_queue_id_t queue,
+			     const gaspi_timeout_t timeout_ms)
+{
+  gaspi_verify_init("gaspi_write_strided_notify");
 
   if(notification_value == 0)
     {
@@ -721,110 +2254,267 @@ pgaspi_write_notify (const gaspi_segment_id_t segment_id_local,
       return GASPI_ERR_INV_NOTIF_VAL;
     }
 
-  gaspi_return_t eret = GASPI_ERROR;
+  return _gaspi_strided (0, segment_id_local, offset_local, stride_local,
+			 rank, segment_id_remote, offset_remote, stride_remote,
+			 block_size, count, dims, 1, notification_id, notification_value,
+			 queue, timeout_ms);
+}
 
-  if(lock_gaspi_tout (&glb_gaspi_ctx.lockC[queue], timeout_ms))
-    return GASPI_TIMEOUT;
+/* Striped transfers */
 
-  if( GASPI_ENDPOINT_DISCONNECTED == glb_gaspi_ctx.ep_conn[rank].cstat )
+/* Wait for a set of queues, the timeout covering all of them */
+#pragma weak gaspi_wait_queues = pgaspi_wait_queues
+gaspi_return_t
+pgaspi_wait_queues (const gaspi_queue_id_t queue_first,
+		    const gaspi_number_t num,
+		    const gaspi_timeout_t timeout_ms)
+{
+  gaspi_verify_init("gaspi_wait_queues");
+
+  if( num < 1 || queue_first + num > glb_gaspi_ctx.num_queues )
     {
-      eret = pgaspi_connect((gaspi_rank_t) rank, timeout_ms);
-      if ( eret != GASPI_SUCCESS)
-	{
-	  goto endL;
-	}
+      return GASPI_ERR_INV_QUEUE;
     }
 
-  eret = pgaspi_dev_write_notify(segment_id_local, offset_local, rank,
-				 segment_id_remote, offset_remote, size,
-				 notification_id, notification_value,
-				 queue);
+  const gaspi_cycles_t s0 = gaspi_get_cycles ();
+  gaspi_queue_id_t q;
 
-  if( eret != GASPI_SUCCESS )
+  for(q = queue_first; q < queue_first + num; q++)
     {
-      glb_gaspi_ctx.qp_state_vec[queue][rank] = GASPI_STATE_CORRUPT;
-      goto endL;
-    }
+      gaspi_timeout_t left = timeout_ms;
 
-  glb_gaspi_ctx.ne_count_c[queue] += 2;
+      if( timeout_ms != GASPI_BLOCK && timeout_ms != GASPI_TEST )
+	{
+	  const gaspi_timeout_t ms =
+	    (gaspi_timeout_t) ((float) (gaspi_get_cycles () - s0) * glb_gaspi_ctx.cycles_to_msecs);
 
-  GPI2_STATS_INC_COUNT(GASPI_STATS_COUNTER_NUM_WRITE_NOT, 1);
-  GPI2_STATS_INC_COUNT(GASPI_STATS_COUNTER_BYTES_WRITE, size);
+	  left = (ms < timeout_ms) ? timeout_ms - ms : GASPI_TEST;
+	}
 
- endL:
-  unlock_gaspi (&glb_gaspi_ctx.lockC[queue]);
-  return eret;
-}
+      const gaspi_return_t eret = pgaspi_wait (q, left);
+      if( eret != GASPI_SUCCESS )
+	{
+	  return eret;
+	}
+    }
 
+  return GASPI_SUCCESS;
+}
 
-#pragma weak gaspi_write_list_notify = pgaspi_write_list_notify
-gaspi_return_t
-pgaspi_write_list_notify (const gaspi_number_t num,
-			  gaspi_segment_id_t * const segment_id_local,
-			  gaspi_offset_t * const offset_local,
-			  const gaspi_rank_t rank,
-			  gaspi_segment_id_t * const segment_id_remote,
-			  gaspi_offset_t * const offset_remote,
-			  gaspi_size_t * const size,
-			  const gaspi_segment_id_t segment_id_notification,
-			  const gaspi_notification_id_t notification_id,
-			  const gaspi_notification_t notification_value,
-			  const gaspi_queue_id_t queue,
-			  const gaspi_timeout_t timeout_ms)
+/* A transfer is cut into stripes of at least GASPI_STRIPE_MIN bytes
+   (page aligned), one per queue of the set, and each stripe into
+   chunks of up to GASPI_MAX_TSIZE_C bytes, a request each. With a
+   notification, each stripe adds its share of the value behind its
+   chunks. All queues are reserved before anything is posted; an error
+   while posting leaves the stripes before it in flight. */
+static gaspi_return_t
+_gaspi_striped (const int is_read,
+		const gaspi_segment_id_t segment_id_local,
+		const gaspi_offset_t offset_local,
+		const gaspi_rank_t rank,
+		const gaspi_segment_id_t segment_id_remote,
+		const gaspi_offset_t offset_remote,
+		const gaspi_size_t size,
+		const int notify,
+		const gaspi_notification_id_t notification_id,
+		const gaspi_notification_t notification_value,
+		const gaspi_queue_id_t queue_first,
+		const gaspi_number_t num,
+		const gaspi_timeout_t timeout_ms)
 {
-  if(num == 0)
-    return GASPI_ERR_INV_NUM;
+  int reqs[GASPI_MAX_QP];
+  gaspi_number_t s, stripes;
+  gaspi_return_t eret = GASPI_SUCCESS;
 
-  if(notification_value == 0)
+  gaspi_verify_local_off(offset_local, segment_id_local, size);
+  gaspi_verify_remote_off(offset_remote, segment_id_remote, rank, size);
+
+  if( num < 1 || queue_first + num > glb_gaspi_ctx.num_queues )
     {
-      gaspi_printf("Zero is not allowed as notification value.");
-      return GASPI_ERR_INV_NOTIF_VAL;
+      return GASPI_ERR_INV_QUEUE;
     }
 
-#ifdef DEBUG
-  gaspi_verify_init("gaspi_write_list_notify");
-  gaspi_verify_queue(queue);
-  gaspi_verify_queue_depth(glb_gaspi_ctx.ne_count_c[queue]);
+  if( size == 0 )
+    {
+      return GASPI_ERR_INV_COMMSIZE;
+    }
 
-  gaspi_number_t n;
-  for(n = 0; n < num; n++)
+  stripes = (gaspi_number_t) MIN ((gaspi_size_t) num, (size + GASPI_STRIPE_MIN - 1) / GASPI_STRIPE_MIN);
+  if( notify && stripes > notification_value )
     {
-      gaspi_verify_local_off(offset_local[n], segment_id_local[n], size[n]);
-      gaspi_verify_remote_off(offset_remote[n], segment_id_remote[n], rank, size[n]);
-      gaspi_verify_comm_size(size[n], segment_id_local[n], segment_id_remote[n], rank, GASPI_MAX_TSIZE_C);
+      stripes = notification_value;
     }
 
-#endif
+  gaspi_size_t stripe = (size + stripes - 1) / stripes;
+  stripe = (stripe + GASPI_STRIPE_ALIGN - 1) & ~(GASPI_STRIPE_ALIGN - 1);
+  stripes = (gaspi_number_t) ((size + stripe - 1) / stripe);
 
-  gaspi_return_t eret = GASPI_ERROR;
+  for(s = 0; s < stripes; s++)
+    {
+      const gaspi_size_t len = MIN (stripe, size - s * stripe);
 
-  if(lock_gaspi_tout (&glb_gaspi_ctx.lockC[queue], timeout_ms))
-    return GASPI_TIMEOUT;
+      reqs[s] = (int) ((len + GASPI_MAX_TSIZE_C - 1) / GASPI_MAX_TSIZE_C)
+	+ (notify ? _gaspi_notify_requests (segment_id_remote, rank) : 0);
+
+      eret = _gaspi_queue_reserve (queue_first + s, reqs[s], timeout_ms);
+      if( eret != GASPI_SUCCESS )
+	{
+	  while( s-- > 0 )
+	    {
+	      _gaspi_queue_release (queue_first + s, reqs[s]);
+	    }
+	  return eret;
+	}
+    }
+
+  s = 0;
 
   if( GASPI_ENDPOINT_DISCONNECTED == glb_gaspi_ctx.ep_conn[rank].cstat )
     {
       eret = pgaspi_connect((gaspi_rank_t) rank, timeout_ms);
-      if ( eret != GASPI_SUCCESS)
+      if( eret != GASPI_SUCCESS)
 	{
 	  goto endL;
 	}
     }
 
-  eret = pgaspi_dev_write_list_notify(num,
-				      segment_id_local, offset_local, rank,
-				      segment_id_remote, offset_remote, size,
-				      segment_id_notification, notification_id, notification_value,
+  for(s = 0; s < stripes; s++)
+    {
+      const gaspi_queue_id_t queue = (gaspi_queue_id_t) (queue_first + s);
+      const gaspi_size_t end = MIN ((s + 1) * stripe, size);
+      gaspi_size_t off, chunk;
+
+      for(off = s * stripe; off < end; off += chunk)
+	{
+	  chunk = MIN (end - off, GASPI_MAX_TSIZE_C);
+
+	  if( is_read )
+	    {
+	      eret = pgaspi_dev_read (segment_id_local, offset_local + off, rank,
+				      segment_id_remote, offset_remote + off, chunk,
 				      queue);
+	    }
+	  else
+	    {
+	      eret = pgaspi_dev_write (segment_id_local, offset_local + off, rank,
+				       segment_id_remote, offset_remote + off, chunk,
+				       queue);
+	    }
 
-  if( eret != GASPI_SUCCESS )
+	  if( eret != GASPI_SUCCESS )
+	    {
+	      break;
+	    }
+	}
+
+      /* the first stripe adds the remainder of the value */
+      if( eret == GASPI_SUCCESS && notify )
+	{
+	  const gaspi_notification_t share = notification_value / stripes
+	    + ((s == 0) ? notification_value % stripes : 0);
+
+	  eret = pgaspi_dev_notify_add (segment_id_remote, rank, notification_id,
+					share, queue);
+	}
+
+      if( eret != GASPI_SUCCESS )
+	{
+	  glb_gaspi_ctx.qp_state_vec[queue][rank] = GASPI_STATE_CORRUPT;
+	  goto endL;
+	}
+    }
+
+  if( is_read )
     {
-      glb_gaspi_ctx.qp_state_vec[queue][rank] = GASPI_STATE_CORRUPT;
-      goto endL;
+      GPI2_STATS_INC_COUNT(GASPI_STATS_COUNTER_NUM_READ, 1);
+      GPI2_STATS_INC_COUNT(GASPI_STATS_COUNTER_BYTES_READ, size);
+    }
+  else
+    {
+      GPI2_STATS_INC_COUNT(GASPI_STATS_COUNTER_NUM_WRITE, 1);
+      GPI2_STATS_INC_COUNT(GASPI_STATS_COUNTER_BYTES_WRITE, size);
     }
 
-  glb_gaspi_ctx.ne_count_c[queue] += (int) (num + 1);
+  return GASPI_SUCCESS;
 
  endL:
-  unlock_gaspi (&glb_gaspi_ctx.lockC[queue]);
+  /* the stripes not (fully) posted */
+  for(; s < stripes; s++)
+    {
+      _gaspi_queue_release (queue_first + s, reqs[s]);
+    }
   return eret;
 }
+
+#pragma weak gaspi_write_striped = pgaspi_write_striped
+gaspi_return_t
+pgaspi_write_striped (const gaspi_segment_id_t segment_id_local,
+		      const gaspi_offset_t offset_local,
+		      const gaspi_rank_t rank,
+		      const gaspi_segment_id_t segment_id_remote,
+		      const gaspi_offset_t offset_remote,
+		      const gaspi_size_t size,
+		      const gaspi_queue_id_t queue_first,
+		      const gaspi_number_t num,
+		      const gaspi_timeout_t timeout_ms)
+{
+  gaspi_verify_init("gaspi_write_striped");
+
+  return _gaspi_striped (0, segment_id_local, offset_local, rank,
+			 segment_id_remote, offset_remote, size,
+			 0, 0, 0, queue_first, num, timeout_ms);
+}
+
+#pragma weak gaspi_read_striped = pgaspi_read_striped
+gaspi_return_t
+pgaspi_read_striped (const gaspi_segment_id_t segment_id_local,
+		     const gaspi_offset_t offset_local,
+		     const gaspi_rank_t rank,
+		     const gaspi_segment_id_t segment_id_remote,
+		     const gaspi_offset_t offset_remote,
+		     const gaspi_size_t size,
+		     const gaspi_queue_id_t queue_first,
+		     const gaspi_number_t num,
+		     const gaspi_timeout_t timeout_ms)
+{
+  gaspi_verify_init("gaspi_read_striped");
+
+  return _gaspi_striped (1, segment_id_local, offset_local, rank,
+			 segment_id_remote, offset_remote, size,
+			 0, 0, 0, queue_first, num, timeout_ms);
+}
+
+#pragma weak gaspi_write_striped_notify = pgaspi_write_striped_notify
+gaspi_return_t
+pgaspi_write_striped_notify (const gaspi_segment_id_t segment_id_local,
+			     const gaspi_offset_t offset_local,
+			     const gaspi_rank_t rank,
+			     const gaspi_segment_id_t segment_id_remote,
+			     const gaspi_offset_t offset_remote,
+			     const gaspi_size_t size,
+			     const gaspi_notification_id_t notification_id,
+			     const gaspi_notification_t notification_value,
+			     const gaspi_queue_id_t queue_first,
+			     const gaspi_number_t num,
+			     const gaspi_timeout_t timeout_ms)
+{
+  gaspi_verify_init("gaspi_write_striped_notify");
+
+  if(notification_value == 0)
+    {
+      gaspi_printf("Zero is not allowed as notification value.");
+      return GASPI_ERR_INV_NOTIF_VAL;
+    }
+
+  /* the add goes to the 8-byte word of the ID and the odd ID after it */
+  if(notification_id & 1)
+    {
+      gaspi_printf("Only even notification IDs can be added to.");
+      return GASPI_ERR_INV_NOTIF_ID;
+    }
+
+  return _gaspi_striped (0, segment_id_local, offset_local, rank,
+			 segment_id_remote, offset_remote, size,
+			 1, notification_id, notification_value,
+			 queue_first, num, timeout_ms);
+}
@@ -173,6 +173,15 @@ pgaspi_segment_avail_local (gaspi_segment_id_t * const avail_seg_id)
   return GASPI_SUCCESS;
 }
 
+/* The ones gaspi_read_notify reads from a segment into a local
+   notification and its summary flag */
+static inline void
+_gaspi_segment_read_ones (unsigned char * const notif_spc)
+{
+  *((gaspi_notification_t *) (notif_spc + NOTIFY_READ_ONE_OFFSET)) = 1;
+  *(notif_spc + NOTIFY_READ_FLAG_OFFSET) = 1;
+}
+
 #pragma weak gaspi_segment_alloc = pgaspi_segment_alloc
 gaspi_return_t
 pgaspi_segment_alloc (const gaspi_segment_id_t segment_id,
@@ -231,16 +240,19 @@ pgaspi_segment_alloc (const gaspi_segment_id_t segment_id,
 
   memset (glb_gaspi_ctx.rrmd[segment_id][glb_gaspi_ctx.rank].data.ptr, 0, NOTIFY_OFFSET);
 
-  if( alloc_policy == GASPI_MEM_INITIALIZED)
+  if( alloc_policy & GASPI_MEM_INITIALIZED)
     {
       memset (glb_gaspi_ctx.rrmd[segment_id][glb_gaspi_ctx.rank].data.ptr, 0, size + NOTIFY_OFFSET);
     }
 
+  _gaspi_segment_read_ones (glb_gaspi_ctx.rrmd[segment_id][glb_gaspi_ctx.rank].data.buf);
+
   glb_gaspi_ctx.rrmd[segment_id][glb_gaspi_ctx.rank].size = size;
   glb_gaspi_ctx.rrmd[segment_id][glb_gaspi_ctx.rank].notif_spc_size = NOTIFY_OFFSET;
   glb_gaspi_ctx.rrmd[segment_id][glb_gaspi_ctx.rank].notif_spc.addr = glb_gaspi_ctx.rrmd[segment_id][glb_gaspi_ctx.rank].data.addr;
   glb_gaspi_ctx.rrmd[segment_id][glb_gaspi_ctx.rank].data.addr += NOTIFY_OFFSET;
   glb_gaspi_ctx.rrmd[segment_id][glb_gaspi_ctx.rank].user_provided = 0;
+  glb_gaspi_ctx.rrmd[segment_id][glb_gaspi_ctx.rank].notif_summary = (alloc_policy & GASPI_MEM_NOTIFY_SUMMARY) ? 1 : 0;
 
   if(pgaspi_dev_register_mem(&(glb_gaspi_ctx.rrmd[segment_id][glb_gaspi_ctx.rank]), size + NOTIFY_OFFSET) < 0)
     {
@@ -301,6 +313,7 @@ pgaspi_segment_delete (const gaspi_segment_id_t segment_id)
   glb_gaspi_ctx.rrmd[segment_id][glb_gaspi_ctx.rank].rkey[0] = 0;
   glb_gaspi_ctx.rrmd[segment_id][glb_gaspi_ctx.rank].rkey[1] = 0;
   glb_gaspi_ctx.rrmd[segment_id][glb_gaspi_ctx.rank].user_provided = 0;
+  glb_gaspi_ctx.rrmd[segment_id][glb_gaspi_ctx.rank].notif_summary = 0;
 
   /* Reset trans info flag for all ranks */
   int r;
@@ -462,6 +475,7 @@ pgaspi_segment_bind ( gaspi_segment_id_t const segment_id,
     }
 
   memset (ctx->rrmd[segment_id][myrank].notif_spc.ptr, 0, NOTIFY_OFFSET);
+  _gaspi_segment_read_ones (ctx->rrmd[segment_id][myrank].notif_spc.buf);
 
   /* Set the segment data pointer and size */
   ctx->rrmd[segment_id][myrank].data.ptr = pointer;
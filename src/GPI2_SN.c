@@ -556,6 +556,7 @@ gaspi_sn_segment_register(const gaspi_cd_header snp)
   glb_gaspi_ctx.rrmd[snp.seg_id][snp.rank].rkey[1] = snp.rkey[1];
   glb_gaspi_ctx.rrmd[snp.seg_id][snp.rank].data.addr = snp.addr;
   glb_gaspi_ctx.rrmd[snp.seg_id][snp.rank].notif_spc.addr = snp.notif_addr;
+  glb_gaspi_ctx.rrmd[snp.seg_id][snp.rank].notif_summary = snp.notif_summary;
   glb_gaspi_ctx.rrmd[snp.seg_id][snp.rank].size = snp.size;
 
 #ifdef GPI2_CUDA
@@ -743,6 +744,7 @@ _gaspi_sn_segment_register_command(const gaspi_rank_t rank, const void * const a
   cdh.rkey[1] = glb_gaspi_ctx.rrmd[segment_id][glb_gaspi_ctx.rank].rkey[1];
   cdh.addr = glb_gaspi_ctx.rrmd[segment_id][glb_gaspi_ctx.rank].data.addr;
   cdh.notif_addr = glb_gaspi_ctx.rrmd[segment_id][glb_gaspi_ctx.rank].notif_spc.addr;
+  cdh.notif_summary = glb_gaspi_ctx.rrmd[segment_id][glb_gaspi_ctx.rank].notif_summary;
   cdh.size = glb_gaspi_ctx.rrmd[segment_id][glb_gaspi_ctx.rank].size;
 
 #ifdef GPI2_CUDA
@@ -47,7 +47,7 @@ enum gaspi_sn_status
 typedef struct
 {
   int op, op_len, rank, tnc;
-  int ret, rkey[2], seg_id;
+  int ret, rkey[2], seg_id, notif_summary;
   unsigned long addr, size, notif_addr;
 
 #ifdef GPI2_CUDA
@@ -90,4 +90,10 @@ int gaspi_sn_set_non_blocking(const int sock);
 int
 gaspi_sn_connect2port(const char *hn, const unsigned short port, const unsigned long timeout_ms);
 
+ssize_t
+gaspi_sn_writen(const int sockfd, const void * data_ptr, const size_t n);
+
+ssize_t
+gaspi_sn_readn(const int sockfd, const void * data_ptr, const size_t n);
+
 #endif
@@ -39,11 +39,15 @@ along with GPI-2. If not, see <http://www.gnu.org/licenses/>.
 #define GASPI_COLL_QP     (GASPI_MAX_QP)
 #define GASPI_PASSIVE_QP  (GASPI_MAX_QP+1)
 #define GASPI_SN          (GASPI_MAX_QP+2)
+#define GASPI_MAX_ENDPOINTS (1024)
 #define GASPI_MAX_TSIZE_C ((1ul<<31ul)-1ul)
 #define GASPI_MAX_TSIZE_P ((1ul<<16ul)-1ul)
+#define GASPI_STRIPE_MIN  ((1ul<<20ul))
+#define GASPI_STRIPE_ALIGN (4096ul)
 #define GASPI_MAX_QSIZE   (4096)
 #define GASPI_MAX_NOTIFICATION  (65536)
 #define GASPI_MAX_NUMAS   (4)
+#define GASPI_MAX_RAILS   (4)
 
 typedef struct
 {
@@ -51,6 +55,39 @@ typedef struct
   char dummy[63];
 } gaspi_lock_t;
 
+/* A communication queue: the count of its requests posted and not yet
+   completed, updated atomically by the posting threads, on a cache
+   line of its own, and the lock of the waits on the queue. ep_pool
+   marks the queues created for endpoints, ep_bound counts the
+   endpoints using the queue. */
+typedef struct
+{
+  ALIGN64 int ne_count;
+  char dummy[60];
+  gaspi_lock_t lock;
+  int ep_pool;
+  int ep_bound;
+} gaspi_comm_queue_t;
+
+/* A strided transfer as the devices get it: count[d] blocks of block
+   bytes in each dimension, stride_local[d] and stride_remote[d] bytes
+   apart. Dimensions contiguous on both sides are merged into the block
+   and the unused ones have a count of 1. */
+typedef struct
+{
+  gaspi_size_t block;
+  gaspi_number_t count[GASPI_STRIDED_MAX_DIMS];
+  gaspi_size_t stride_local[GASPI_STRIDED_MAX_DIMS];
+  gaspi_size_t stride_remote[GASPI_STRIDED_MAX_DIMS];
+} gaspi_strided_t;
+
+/* A thread endpoint: the queue it posts to */
+struct gaspi_endpoint
+{
+  int used;
+  gaspi_queue_id_t queue;
+};
+
 typedef struct
 {
   union
@@ -75,6 +112,7 @@ typedef struct
   int trans; /* info transmitted */
 
   int user_provided;
+  int notif_summary; /* notifications set their summary flag */
   gaspi_memory_description_t desc;
 
 #ifdef GPI2_CUDA
@@ -96,6 +134,8 @@ typedef struct
   int tnc;
   float mhz;
   float cycles_to_msecs;
+  gaspi_cycles_t wait_spin_cycles;  /* spin phase of waiting */
+  gaspi_cycles_t wait_yield_cycles; /* end of the yield phase */
   char mfile[1024];
   int *sockfd;
   char *hn_poff;
@@ -107,7 +147,6 @@ typedef struct
   char mtyp[64];
   gaspi_lock_t lockPS;
   gaspi_lock_t lockPR;
-  gaspi_lock_t lockC[GASPI_MAX_QP];
   pthread_t snt;
 
 #ifdef GPI2_CUDA
@@ -122,10 +161,17 @@ typedef struct
 
   /* Number of "created" communication queues */
   gaspi_number_t num_queues;
+  gaspi_comm_queue_t queues[GASPI_MAX_QP];
+
+  /* Thread endpoints */
+  gaspi_lock_t lockEP;
+  struct gaspi_endpoint endpoints[GASPI_MAX_ENDPOINTS];
 
-  /* Comm counters  */
-  int ne_count_grp;
-  int ne_count_c[GASPI_MAX_QP];
+  /* Comm counters: the requests in flight on the collectives queue
+     change atomically and lockGRP serializes polling it */
+  volatile int ne_count_grp;
+  gaspi_lock_t lockGRP;
+  volatile int nbc_active;
   unsigned char ne_count_p[8192]; //TODO: dynamic size
 
 } gaspi_context;
@@ -17,6 +17,7 @@ along with GPI-2. If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include <errno.h>
+#include <fcntl.h>
 #include <sys/mman.h>
 #include <sys/time.h>
 #include <sys/timeb.h>
@@ -184,6 +185,22 @@ pgaspi_dev_init_core (gaspi_config_t *gaspi_cfg)
       return -1;
     }
 
+  /* Completion channel (for blocking waits on the queues) */
+  glb_gaspi_ctx_ib.channelC = ibv_create_comp_channel (glb_gaspi_ctx_ib.context);
+  if(!glb_gaspi_ctx_ib.channelC)
+    {
+      gaspi_print_error ("Failed to create completion channel (libibverbs)");
+      return -1;
+    }
+
+  /* waiters of all queues share it: never block reading an event */
+  const int cflags = fcntl (glb_gaspi_ctx_ib.channelC->fd, F_GETFL);
+  if( cflags < 0 || fcntl (glb_gaspi_ctx_ib.channelC->fd, F_SETFL, cflags | O_NONBLOCK) < 0 )
+    {
+      gaspi_print_error ("Failed to set completion channel non-blocking");
+      return -1;
+    }
+
   /* Query device and print info */
   if(ibv_query_device(glb_gaspi_ctx_ib.context, &glb_gaspi_ctx_ib.device_attr))
     {
@@ -315,6 +332,30 @@ pgaspi_dev_init_core (gaspi_config_t *gaspi_cfg)
   if(gaspi_cfg->net_info)
     gaspi_printf ("\tusing port : %d\n", glb_gaspi_ctx_ib.ib_port);
 
+  /* Rails: the queues take the active ports of the device in turn
+     (the port in use first, then the other one if it is up on the same
+     link layer). Without another port all rails share the one in use. */
+  {
+    const int other = 3 - glb_gaspi_ctx_ib.ib_port;
+    const int other_ok = gaspi_cfg->port_check
+      && glb_gaspi_ctx_ib.device_attr.phys_port_cnt > 1
+      && glb_gaspi_ctx_ib.port_attr[other - 1].state == IBV_PORT_ACTIVE
+      && glb_gaspi_ctx_ib.port_attr[other - 1].phys_state == PORT_LINK_UP
+      && glb_gaspi_ctx_ib.port_attr[other - 1].link_layer
+      == glb_gaspi_ctx_ib.port_attr[glb_gaspi_ctx_ib.ib_port - 1].link_layer;
+
+    for(i = 0; i < GASPI_MAX_RAILS; i++)
+      {
+	glb_gaspi_ctx_ib.rail_port[i] = ((i % 2) && other_ok) ? other : glb_gaspi_ctx_ib.ib_port;
+      }
+
+    if(gaspi_cfg->net_info && gaspi_cfg->netdev_num > 1)
+      {
+	for(i = 1; i < (int) gaspi_cfg->netdev_num; i++)
+	  gaspi_printf ("\trail %d     : port %d\n", i, glb_gaspi_ctx_ib.rail_port[i]);
+      }
+  }
+
   if (gaspi_cfg->network == GASPI_IB)
     {
       if(gaspi_cfg->mtu == 0)
@@ -434,7 +475,7 @@ pgaspi_dev_init_core (gaspi_config_t *gaspi_cfg)
   /* One-sided Communication */
   for(c = 0; c < gaspi_cfg->queue_num; c++)
     {
-      glb_gaspi_ctx_ib.scqC[c] = ibv_create_cq (glb_gaspi_ctx_ib.context, gaspi_cfg->queue_depth, NULL, NULL, 0);
+      glb_gaspi_ctx_ib.scqC[c] = ibv_create_cq (glb_gaspi_ctx_ib.context, gaspi_cfg->queue_depth, NULL, glb_gaspi_ctx_ib.channelC, 0);
       if(!glb_gaspi_ctx_ib.scqC[c])
 	{
 	  gaspi_print_error ("Failed to create CQ (libibverbs)");
@@ -442,6 +483,73 @@ pgaspi_dev_init_core (gaspi_config_t *gaspi_cfg)
 	}
     }
 
+  /* Fused notifications: the comm QPs share the receives their
+     immediates take. A thread woken by their completions applies them
+     and posts the receives again, whatever the application is doing
+     (a sender finding no receive retries); the notification waits
+     also do on each round. */
+  if(GASPI_NOTIFY_FUSED == gaspi_cfg->notify_mode)
+    {
+      glb_gaspi_ctx_ib.srqC_depth = MIN ((int) (gaspi_cfg->queue_depth * gaspi_cfg->queue_num),
+					 glb_gaspi_ctx_ib.device_attr.max_srq_wr);
+
+      glb_gaspi_ctx_ib.channelN = ibv_create_comp_channel (glb_gaspi_ctx_ib.context);
+      if(!glb_gaspi_ctx_ib.channelN)
+	{
+	  gaspi_print_error ("Failed to create completion channel (libibverbs)");
+	  return -1;
+	}
+
+      glb_gaspi_ctx_ib.rcqC = ibv_create_cq (glb_gaspi_ctx_ib.context, glb_gaspi_ctx_ib.srqC_depth, NULL,
+					     glb_gaspi_ctx_ib.channelN, 0);
+      if(!glb_gaspi_ctx_ib.rcqC)
+	{
+	  gaspi_print_error ("Failed to create CQ (libibverbs)");
+	  return -1;
+	}
+
+      if(ibv_req_notify_cq (glb_gaspi_ctx_ib.rcqC, 0))
+	{
+	  gaspi_print_error ("Failed to request CQ notifications (libibverbs)");
+	  return -1;
+	}
+
+      struct ibv_srq_init_attr srqC_attr;
+      memset (&srqC_attr, 0, sizeof (struct ibv_srq_init_attr));
+
+      srqC_attr.attr.max_wr  = glb_gaspi_ctx_ib.srqC_depth;
+      srqC_attr.attr.max_sge = 1;
+
+      glb_gaspi_ctx_ib.srqC = ibv_create_srq (glb_gaspi_ctx_ib.pd, &srqC_attr);
+      if(!glb_gaspi_ctx_ib.srqC)
+	{
+	  gaspi_print_error ("Failed to create SRQ (libibverbs)");
+	  return -1;
+	}
+
+      /* the immediate is all they receive */
+      struct ibv_recv_wr rwr, *bad_wr;
+      memset (&rwr, 0, sizeof (struct ibv_recv_wr));
+
+      for(i = 0; i < glb_gaspi_ctx_ib.srqC_depth; i++)
+	{
+	  if(ibv_post_srq_recv (glb_gaspi_ctx_ib.srqC, &rwr, &bad_wr))
+	    {
+	      gaspi_print_error ("Failed to post SRQ receive (libibverbs)");
+	      return -1;
+	    }
+	}
+
+      glb_gaspi_ctx_ib.notify_lock.lock = 0;
+      glb_gaspi_ctx_ib.notify_failed = 0;
+
+      if(pthread_create (&glb_gaspi_ctx_ib.notify_thread, NULL, pgaspi_dev_notify_imm_thread, NULL) != 0)
+	{
+	  gaspi_print_error ("Failed to create notification thread");
+	  return -1;
+	}
+    }
+
   /* Allocate space for QPs */
   glb_gaspi_ctx_ib.qpGroups = (struct ibv_qp **) calloc (glb_gaspi_ctx.tnc, sizeof (struct ibv_qp *));
   if(!glb_gaspi_ctx_ib.qpGroups)
@@ -454,8 +562,24 @@ pgaspi_dev_init_core (gaspi_config_t *gaspi_cfg)
       glb_gaspi_ctx_ib.qpC[c] = (struct ibv_qp **) calloc (glb_gaspi_ctx.tnc, sizeof (struct ibv_qp *));
       if(!glb_gaspi_ctx_ib.qpC[c])
 	return -1;
+
+      glb_gaspi_ctx_ib.sigC[c] = (gaspi_ib_signal_t *) calloc (glb_gaspi_ctx.tnc, sizeof (gaspi_ib_signal_t));
+      if(!glb_gaspi_ctx_ib.sigC[c])
+	return -1;
     }
 
+  /* Selective signaling of the comm QPs (GPU transfers poll the comm
+     CQs for every request) */
+  memset(glb_gaspi_ctx_ib.unsignaledC, 0, sizeof(glb_gaspi_ctx_ib.unsignaledC));
+
+#ifdef GPI2_CUDA
+  glb_gaspi_ctx_ib.signal_period = 1;
+#else
+  glb_gaspi_ctx_ib.signal_period = MIN (GASPI_IB_SIGNAL_PERIOD, (int) gaspi_cfg->queue_depth);
+#endif
+
+  glb_gaspi_ctx_ib.max_sge = MIN (GASPI_IB_MAX_SGE, glb_gaspi_ctx_ib.device_attr.max_sge);
+
   glb_gaspi_ctx_ib.qpP = (struct ibv_qp **) calloc (glb_gaspi_ctx.tnc , sizeof (struct ibv_qp *));
   if(!glb_gaspi_ctx_ib.qpP)
     {
@@ -468,26 +592,29 @@ pgaspi_dev_init_core (gaspi_config_t *gaspi_cfg)
   /* RoCE */
   if(gaspi_cfg->network == GASPI_ROCE)
     {
-      const int ret = ibv_query_gid (glb_gaspi_ctx_ib.context, glb_gaspi_ctx_ib.ib_port,GASPI_GID_INDEX, &glb_gaspi_ctx_ib.gid);
-      if(ret)
-	{
-	  gaspi_print_error ("Failed to query gid (RoCE - libiverbs)");
-	  return -1;
-	}
+      int r;
 
-      if (!pgaspi_null_gid (&glb_gaspi_ctx_ib.gid))
+      for(r = 0; r < (int) gaspi_cfg->netdev_num; r++)
 	{
-	  if (gaspi_cfg->net_info)
-	    gaspi_printf
-	      ("gid[0]: %02x%02x:%02x%02x:%02x%02x:%02x%02x:%02x%02x:%02x%02x:%02x%02x:%02x%02x\n",
-	       glb_gaspi_ctx_ib.gid.raw[0], glb_gaspi_ctx_ib.gid.raw[1],
-	       glb_gaspi_ctx_ib.gid.raw[2], glb_gaspi_ctx_ib.gid.raw[3],
-	       glb_gaspi_ctx_ib.gid.raw[4], glb_gaspi_ctx_ib.gid.raw[5],
-	       glb_gaspi_ctx_ib.gid.raw[6], glb_gaspi_ctx_ib.gid.raw[7],
-	       glb_gaspi_ctx_ib.gid.raw[8], glb_gaspi_ctx_ib.gid.raw[9],
-	       glb_gaspi_ctx_ib.gid.raw[10], glb_gaspi_ctx_ib.gid.raw[11],
-	       glb_gaspi_ctx_ib.gid.raw[12], glb_gaspi_ctx_ib.gid.raw[13],
-	       glb_gaspi_ctx_ib.gid.raw[14], glb_gaspi_ctx_ib.gid.raw[15]);
+	  union ibv_gid * const gid = &glb_gaspi_ctx_ib.gid[r];
+
+	  if(ibv_query_gid (glb_gaspi_ctx_ib.context, glb_gaspi_ctx_ib.rail_port[r], GASPI_GID_INDEX, gid))
+	    {
+	      gaspi_print_error ("Failed to query gid (RoCE - libiverbs)");
+	      return -1;
+	    }
+
+	  if (!pgaspi_null_gid (gid))
+	    {
+	      if (gaspi_cfg->net_info)
+		gaspi_printf
+		  ("gid[%d]: %02x%02x:%02x%02x:%02x%02x:%02x%02x:%02x%02x:%02x%02x:%02x%02x:%02x%02x\n",
+		   r,
+		   gid->raw[0], gid->raw[1], gid->raw[2], gid->raw[3],
+		   gid->raw[4], gid->raw[5], gid->raw[6], gid->raw[7],
+		   gid->raw[8], gid->raw[9], gid->raw[10], gid->raw[11],
+		   gid->raw[12], gid->raw[13], gid->raw[14], gid->raw[15]);
+	    }
 	}
     }
 
@@ -505,7 +632,12 @@ pgaspi_dev_init_core (gaspi_config_t *gaspi_cfg)
   
   for(i = 0; i < glb_gaspi_ctx.tnc; i++)
     {
-      glb_gaspi_ctx_ib.local_info[i].lid = glb_gaspi_ctx_ib.port_attr[glb_gaspi_ctx_ib.ib_port - 1].lid;
+      int r;
+
+      for(r = 0; r < (int) gaspi_cfg->netdev_num; r++)
+	{
+	  glb_gaspi_ctx_ib.local_info[i].lid[r] = glb_gaspi_ctx_ib.port_attr[glb_gaspi_ctx_ib.rail_port[r] - 1].lid;
+	}
       
       struct timeval tv;
       gettimeofday (&tv, NULL);
@@ -514,7 +646,7 @@ pgaspi_dev_init_core (gaspi_config_t *gaspi_cfg)
       
       if(gaspi_cfg->port_check)
 	{
-	  if(!glb_gaspi_ctx_ib.local_info[i].lid && (gaspi_cfg->network == GASPI_IB))
+	  if(!glb_gaspi_ctx_ib.local_info[i].lid[0] && (gaspi_cfg->network == GASPI_IB))
 	    {
 	      gaspi_print_error("Failed to find topology! Is subnet-manager running ?");
 	      return -1;
@@ -523,7 +655,10 @@ pgaspi_dev_init_core (gaspi_config_t *gaspi_cfg)
 
       if(gaspi_cfg->network == GASPI_ROCE)
 	{
-	  glb_gaspi_ctx_ib.local_info[i].gid = glb_gaspi_ctx_ib.gid;
+	  for(r = 0; r < (int) gaspi_cfg->netdev_num; r++)
+	    {
+	      glb_gaspi_ctx_ib.local_info[i].gid[r] = glb_gaspi_ctx_ib.gid[r];
+	    }
 	}
     }
 
@@ -531,16 +666,17 @@ pgaspi_dev_init_core (gaspi_config_t *gaspi_cfg)
 }
 
 static struct ibv_qp *
-_pgaspi_dev_create_qp(struct ibv_cq *send_cq, struct ibv_cq *recv_cq, struct ibv_srq *srq)
+_pgaspi_dev_create_qp(struct ibv_cq *send_cq, struct ibv_cq *recv_cq, struct ibv_srq *srq,
+		      const int max_send_wr, const int max_send_sge, const int port)
 {
   struct ibv_qp *qp;
 
   /* Set initial attributes */
   struct ibv_qp_init_attr qpi_attr;
   memset (&qpi_attr, 0, sizeof (struct ibv_qp_init_attr));
-  qpi_attr.cap.max_send_wr = glb_gaspi_cfg.queue_depth;
+  qpi_attr.cap.max_send_wr = MIN (max_send_wr, glb_gaspi_ctx_ib.device_attr.max_qp_wr);
   qpi_attr.cap.max_recv_wr = glb_gaspi_cfg.queue_depth;
-  qpi_attr.cap.max_send_sge = 1;
+  qpi_attr.cap.max_send_sge = max_send_sge;
   qpi_attr.cap.max_recv_sge = 1;
   qpi_attr.cap.max_inline_data = MAX_INLINE_BYTES;
   qpi_attr.qp_type = IBV_QPT_RC;
@@ -562,7 +698,7 @@ _pgaspi_dev_create_qp(struct ibv_cq *send_cq, struct ibv_cq *recv_cq, struct ibv
 
   qp_attr.qp_state = IBV_QPS_INIT;
   qp_attr.pkey_index = 0;
-  qp_attr.port_num = glb_gaspi_ctx_ib.ib_port;
+  qp_attr.port_num = port;
   qp_attr.qp_access_flags = IBV_ACCESS_REMOTE_READ | IBV_ACCESS_REMOTE_WRITE |IBV_ACCESS_REMOTE_ATOMIC;
 
   if(ibv_modify_qp(qp, &qp_attr,
@@ -585,6 +721,30 @@ _pgaspi_dev_create_qp(struct ibv_cq *send_cq, struct ibv_cq *recv_cq, struct ibv
   return qp;
 }
 
+/* A comm QP keeps its unsignaled requests in the send queue until a
+   signaled one completes, and the flushes of gaspi_wait each cover at
+   least one of them: twice the queue depth holds both */
+static struct ibv_qp *
+_pgaspi_dev_create_comm_qp(const unsigned int queue, const int rank)
+{
+  gaspi_ib_signal_t * const sig = &glb_gaspi_ctx_ib.sigC[queue][rank];
+
+  __sync_fetch_and_sub (&glb_gaspi_ctx_ib.unsignaledC[queue], sig->unsignaled);
+  sig->unsignaled = 0;
+
+  /* (receives only the immediates of fused notifications) */
+  if(glb_gaspi_ctx_ib.srqC != NULL)
+    {
+      return _pgaspi_dev_create_qp(glb_gaspi_ctx_ib.scqC[queue], glb_gaspi_ctx_ib.rcqC, glb_gaspi_ctx_ib.srqC,
+				   2 * glb_gaspi_cfg.queue_depth, glb_gaspi_ctx_ib.max_sge,
+				   glb_gaspi_ctx_ib.rail_port[GASPI_IB_RAIL(queue)]);
+    }
+
+  return _pgaspi_dev_create_qp(glb_gaspi_ctx_ib.scqC[queue], glb_gaspi_ctx_ib.scqC[queue], NULL,
+			       2 * glb_gaspi_cfg.queue_depth, glb_gaspi_ctx_ib.max_sge,
+			       glb_gaspi_ctx_ib.rail_port[GASPI_IB_RAIL(queue)]);
+}
+
 int
 pgaspi_dev_comm_queue_delete(const unsigned int id)
 {
@@ -616,6 +776,11 @@ pgaspi_dev_comm_queue_delete(const unsigned int id)
 
   glb_gaspi_ctx_ib.qpC[id] = NULL;
 
+  free (glb_gaspi_ctx_ib.sigC[id]);
+
+  glb_gaspi_ctx_ib.sigC[id] = NULL;
+  glb_gaspi_ctx_ib.unsignaledC[id] = 0;
+
   if( 1 == glb_gaspi_ctx_ib.qpC_cstat[id] )
     {
       if( glb_gaspi_ctx_ib.scqC[id] )
@@ -641,7 +806,7 @@ pgaspi_dev_comm_queue_create(const unsigned int id, const unsigned short remote_
   if( 0 == glb_gaspi_ctx_ib.qpC_cstat[id] )
     {
       /* Completion queue */
-      glb_gaspi_ctx_ib.scqC[id] = ibv_create_cq (glb_gaspi_ctx_ib.context, glb_gaspi_cfg.queue_depth, NULL, NULL, 0);
+      glb_gaspi_ctx_ib.scqC[id] = ibv_create_cq (glb_gaspi_ctx_ib.context, glb_gaspi_cfg.queue_depth, NULL, glb_gaspi_ctx_ib.channelC, 0);
       if(!glb_gaspi_ctx_ib.scqC[id])
 	{
 	  gaspi_print_error ("Failed to create CQ (libibverbs)");
@@ -655,17 +820,24 @@ pgaspi_dev_comm_queue_create(const unsigned int id, const unsigned short remote_
 	  gaspi_print_error ("Failed to memory allocation");
 	  return -1;
 	}
+
+      glb_gaspi_ctx_ib.sigC[id] = (gaspi_ib_signal_t *) calloc (glb_gaspi_ctx.tnc, sizeof (gaspi_ib_signal_t));
+      if( glb_gaspi_ctx_ib.sigC[id] == NULL)
+	{
+	  gaspi_print_error ("Failed to memory allocation");
+	  return -1;
+	}
       
       glb_gaspi_ctx_ib.qpC_cstat[id] = 1;
     }
 
-  if( glb_gaspi_ctx_ib.qpC[id] == NULL)
+  if( glb_gaspi_ctx_ib.qpC[id] == NULL || glb_gaspi_ctx_ib.sigC[id] == NULL)
     {
       gaspi_print_error ("Failed to memory allocation");
       return -1;
     }
   
-  glb_gaspi_ctx_ib.qpC[id][remote_node] = _pgaspi_dev_create_qp(glb_gaspi_ctx_ib.scqC[id], glb_gaspi_ctx_ib.scqC[id], NULL);
+  glb_gaspi_ctx_ib.qpC[id][remote_node] = _pgaspi_dev_create_comm_qp(id, remote_node);
   if( glb_gaspi_ctx_ib.qpC[id][remote_node] == NULL )
     {
       gaspi_print_error ("Failed to create QP (libibverbs)");
@@ -684,7 +856,8 @@ pgaspi_dev_create_endpoint(const int i)
 
   /* Groups QP*/
   glb_gaspi_ctx_ib.qpGroups[i] =
-    _pgaspi_dev_create_qp(glb_gaspi_ctx_ib.scqGroups, glb_gaspi_ctx_ib.rcqGroups, NULL);
+    _pgaspi_dev_create_qp(glb_gaspi_ctx_ib.scqGroups, glb_gaspi_ctx_ib.rcqGroups, NULL,
+			  glb_gaspi_cfg.queue_depth, 1, glb_gaspi_ctx_ib.ib_port);
 
   if (glb_gaspi_ctx_ib.qpGroups[i] == NULL)
     return -1;
@@ -694,8 +867,7 @@ pgaspi_dev_create_endpoint(const int i)
   /* IO QPs*/
   for(c = 0; c < glb_gaspi_cfg.queue_num; c++)
     {
-      glb_gaspi_ctx_ib.qpC[c][i] =
-	_pgaspi_dev_create_qp(glb_gaspi_ctx_ib.scqC[c], glb_gaspi_ctx_ib.scqC[c], NULL);
+      glb_gaspi_ctx_ib.qpC[c][i] = _pgaspi_dev_create_comm_qp(c, i);
 
       if( glb_gaspi_ctx_ib.qpC[c][i] == NULL )
 	return -1;
@@ -705,7 +877,8 @@ pgaspi_dev_create_endpoint(const int i)
 
   /* Passive QP */
   glb_gaspi_ctx_ib.qpP[i] =
-    _pgaspi_dev_create_qp(glb_gaspi_ctx_ib.scqP, glb_gaspi_ctx_ib.rcqP, glb_gaspi_ctx_ib.srqP);
+    _pgaspi_dev_create_qp(glb_gaspi_ctx_ib.scqP, glb_gaspi_ctx_ib.rcqP, glb_gaspi_ctx_ib.srqP,
+			  glb_gaspi_cfg.queue_depth, 1, glb_gaspi_ctx_ib.ib_port);
 
   if( glb_gaspi_ctx_ib.qpP[i] == NULL )
     return -1;
@@ -754,7 +927,7 @@ pgaspi_dev_disconnect_context(const int i)
 }
 
 static int
-_pgaspi_dev_qp_set_ready(struct ibv_qp *qp, int target, int target_qp)
+_pgaspi_dev_qp_set_ready(struct ibv_qp *qp, int target, int target_qp, int rail)
 {
   struct ibv_qp_attr qp_attr;
 
@@ -788,18 +961,18 @@ _pgaspi_dev_qp_set_ready(struct ibv_qp *qp, int target, int target_qp)
   if(glb_gaspi_cfg.network == GASPI_IB)
     {
       qp_attr.ah_attr.is_global = 0;
-      qp_attr.ah_attr.dlid = (unsigned short) glb_gaspi_ctx_ib.remote_info[target].lid;
+      qp_attr.ah_attr.dlid = (unsigned short) glb_gaspi_ctx_ib.remote_info[target].lid[rail];
     }
   else
     {
       qp_attr.ah_attr.is_global = 1;
-      qp_attr.ah_attr.grh.dgid = glb_gaspi_ctx_ib.remote_info[target].gid;
+      qp_attr.ah_attr.grh.dgid = glb_gaspi_ctx_ib.remote_info[target].gid[rail];
       qp_attr.ah_attr.grh.hop_limit = 1;
     }
 
   qp_attr.ah_attr.sl = 0;
   qp_attr.ah_attr.src_path_bits = 0;
-  qp_attr.ah_attr.port_num = glb_gaspi_ctx_ib.ib_port;
+  qp_attr.ah_attr.port_num = glb_gaspi_ctx_ib.rail_port[rail];
 
   if(ibv_modify_qp( qp, &qp_attr,
 		    IBV_QP_STATE
@@ -849,7 +1022,8 @@ pgaspi_dev_comm_queue_connect(const unsigned short q, const int i)
 
   return _pgaspi_dev_qp_set_ready(glb_gaspi_ctx_ib.qpC[q][i],
 				  i,
-				  glb_gaspi_ctx_ib.remote_info[i].qpnC[q]);
+				  glb_gaspi_ctx_ib.remote_info[i].qpnC[q],
+				  GASPI_IB_RAIL(q));
 }
 
 /* TODO: rename to endpoint */
@@ -859,14 +1033,14 @@ pgaspi_dev_connect_context(const int i)
   unsigned int c;
   if( 0 != _pgaspi_dev_qp_set_ready(glb_gaspi_ctx_ib.qpGroups[i],
 				    i,
-				    glb_gaspi_ctx_ib.remote_info[i].qpnGroup) )
+				    glb_gaspi_ctx_ib.remote_info[i].qpnGroup, 0) )
     {
       return -1;
     }
 
   if( 0 != _pgaspi_dev_qp_set_ready(glb_gaspi_ctx_ib.qpP[i],
 				    i,
-				    glb_gaspi_ctx_ib.remote_info[i].qpnP) )
+				    glb_gaspi_ctx_ib.remote_info[i].qpnP, 0) )
     {
       return -1;
     }
@@ -875,7 +1049,8 @@ pgaspi_dev_connect_context(const int i)
     {
       if( 0 != _pgaspi_dev_qp_set_ready(glb_gaspi_ctx_ib.qpC[c][i],
 					i,
-					glb_gaspi_ctx_ib.remote_info[i].qpnC[c]) )
+					glb_gaspi_ctx_ib.remote_info[i].qpnC[c],
+					GASPI_IB_RAIL(c)) )
 	{
 	  return -1;
 	}
@@ -926,6 +1101,8 @@ pgaspi_dev_cleanup_core (gaspi_config_t *gaspi_cfg)
   for(c = 0; c < gaspi_cfg->queue_num; c++)
     {
       free(glb_gaspi_ctx_ib.qpC[c]);
+      free(glb_gaspi_ctx_ib.sigC[c]);
+      glb_gaspi_ctx_ib.sigC[c] = NULL;
     }
 
   if(ibv_destroy_cq (glb_gaspi_ctx_ib.scqGroups))
@@ -958,6 +1135,34 @@ pgaspi_dev_cleanup_core (gaspi_config_t *gaspi_cfg)
       return -1;
     }
 
+  if(glb_gaspi_ctx_ib.srqC != NULL)
+    {
+      /* (it is blocked reading an event) */
+      pthread_cancel (glb_gaspi_ctx_ib.notify_thread);
+      pthread_join (glb_gaspi_ctx_ib.notify_thread, NULL);
+
+      if(ibv_destroy_srq (glb_gaspi_ctx_ib.srqC))
+	{
+	  gaspi_print_error ("Failed to destroy SRQ (libibverbs)");
+	  return -1;
+	}
+      glb_gaspi_ctx_ib.srqC = NULL;
+
+      if(ibv_destroy_cq (glb_gaspi_ctx_ib.rcqC))
+	{
+	  gaspi_print_error ("Failed to destroy CQ (libibverbs)");
+	  return -1;
+	}
+      glb_gaspi_ctx_ib.rcqC = NULL;
+
+      if(ibv_destroy_comp_channel (glb_gaspi_ctx_ib.channelN))
+	{
+	  gaspi_print_error ("Failed to destroy completion channel (libibverbs)");
+	  return -1;
+	}
+      glb_gaspi_ctx_ib.channelN = NULL;
+    }
+
   /*  TODO: to remove from here <<< LOOP*/
   for(i = 0; i < GASPI_MAX_MSEGS; i++)
     {
@@ -1046,6 +1251,15 @@ pgaspi_dev_cleanup_core (gaspi_config_t *gaspi_cfg)
 	  return -1;
 	}
     }
+
+  if(glb_gaspi_ctx_ib.channelC)
+    {
+      if(ibv_destroy_comp_channel (glb_gaspi_ctx_ib.channelC))
+	{
+	  gaspi_print_error("Failed to destroy completion channel (libibverbs)");
+	  return -1;
+	}
+    }
   
   if(ibv_close_device (glb_gaspi_ctx_ib.context))
     {
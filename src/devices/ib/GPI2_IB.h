@@ -19,6 +19,7 @@ along with GPI-2. If not, see <http://www.gnu.org/licenses/>.
 #ifndef _GPI2_IB_H_
 #define _GPI2_IB_H_
 
+#include <pthread.h>
 #include <infiniband/verbs.h>
 #include <infiniband/driver.h>
 
@@ -28,29 +29,49 @@ along with GPI-2. If not, see <http://www.gnu.org/licenses/>.
 #define GASPI_QP_TIMEOUT  (20)
 #define GASPI_QP_RETRY    (7)
 
+/* A comm QP signals one work request out of this many (at most) */
+#define GASPI_IB_SIGNAL_PERIOD (16)
+
+/* The scatter/gather entries of a comm work request (strided
+   transfers gather their local blocks), at most */
+#define GASPI_IB_MAX_SGE (16)
+
+/* The rail (port) of a comm queue: queues take the rails round-robin */
+#define GASPI_IB_RAIL(queue) ((int) ((queue) % glb_gaspi_cfg.netdev_num))
+
 /* IB-specific */
 struct ib_ctx_info
 {
-  int lid;  
+  int lid[GASPI_MAX_RAILS];
   int psn;
-  union ibv_gid gid;
+  union ibv_gid gid[GASPI_MAX_RAILS];
   int qpnGroup;
   int qpnP;
   int qpnC[GASPI_MAX_QP];
 };
 
+/* Unsignaled requests posted on a comm QP: completed by the next
+   signaled one */
+typedef struct
+{
+  gaspi_lock_t lock;
+  int unsignaled;
+} gaspi_ib_signal_t;
+
 typedef struct
 {
   int ib_card_typ;
   int num_dev;
   int max_rd_atomic;
   int ib_port;
+  int rail_port[GASPI_MAX_RAILS];
   int num_queues;
 
   struct ibv_device **dev_list;
   struct ibv_device *ib_dev;
   struct ibv_context *context;
   struct ibv_comp_channel *channelP;
+  struct ibv_comp_channel *channelC;
   struct ibv_pd *pd;
   struct ibv_device_attr device_attr;
   struct ibv_port_attr port_attr[2];
@@ -63,8 +84,22 @@ typedef struct
   struct ibv_cq *scqP;
   struct ibv_cq *rcqP;
   struct ibv_cq *scqC[GASPI_MAX_QP];
+  /* fused notifications (GASPI_NOTIFY_FUSED): the receives the
+     immediates of the comm QPs take, the thread applying them as
+     they arrive and whether one failed since the last notify wait */
+  struct ibv_srq *srqC;
+  struct ibv_cq *rcqC;
+  struct ibv_comp_channel *channelN;
+  pthread_t notify_thread;
+  gaspi_lock_t notify_lock;
+  int srqC_depth;
+  volatile int notify_failed;
   struct ibv_qp **qpC[GASPI_MAX_QP];
-  union ibv_gid gid;
+  gaspi_ib_signal_t *sigC[GASPI_MAX_QP];
+  int unsignaledC[GASPI_MAX_QP];
+  int signal_period;
+  int max_sge;
+  union ibv_gid gid[GASPI_MAX_RAILS];
 
   struct ib_ctx_info *local_info;
   struct ib_ctx_info *remote_info;
@@ -75,5 +110,9 @@ typedef struct
 
 gaspi_ib_ctx glb_gaspi_ctx_ib;
 
+/* The thread applying fused notifications (GPI2_IB_IO.c) */
+void *
+pgaspi_dev_notify_imm_thread (void *);
+
 
 #endif // _GPI2_IB_H_
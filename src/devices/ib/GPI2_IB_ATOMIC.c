@@ -52,10 +52,11 @@ pgaspi_dev_atomic_fetch_add (const gaspi_segment_id_t segment_id,
     }
 
   //TODO
-  glb_gaspi_ctx.ne_count_grp++;
+  __sync_fetch_and_add (&glb_gaspi_ctx.ne_count_grp, 1);
 
   int ne = 0;
-  for (i = 0; i < glb_gaspi_ctx.ne_count_grp; i++)
+  const int nr = glb_gaspi_ctx.ne_count_grp;
+  for (i = 0; i < nr; i++)
     {
       do
 	{
@@ -71,7 +72,7 @@ pgaspi_dev_atomic_fetch_add (const gaspi_segment_id_t segment_id,
     }
 
   //TODO: remove from here
-  glb_gaspi_ctx.ne_count_grp = 0;
+  __sync_fetch_and_sub (&glb_gaspi_ctx.ne_count_grp, nr);
 
   return GASPI_SUCCESS;
 }
@@ -111,10 +112,11 @@ pgaspi_dev_atomic_compare_swap (const gaspi_segment_id_t segment_id,
       return GASPI_ERROR;
     }
 
-  glb_gaspi_ctx.ne_count_grp++;
+  __sync_fetch_and_add (&glb_gaspi_ctx.ne_count_grp, 1);
 
   int ne = 0;
-  for (i = 0; i < glb_gaspi_ctx.ne_count_grp; i++)
+  const int nr = glb_gaspi_ctx.ne_count_grp;
+  for (i = 0; i < nr; i++)
     {
       do
 	{
@@ -130,7 +132,7 @@ pgaspi_dev_atomic_compare_swap (const gaspi_segment_id_t segment_id,
     }
 
   //TODO:
-  glb_gaspi_ctx.ne_count_grp = 0;
+  __sync_fetch_and_sub (&glb_gaspi_ctx.ne_count_grp, nr);
   
   return GASPI_SUCCESS;
 }
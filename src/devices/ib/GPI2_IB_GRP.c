@@ -30,14 +30,17 @@ int
 pgaspi_dev_poll_groups(void)
 {
   int i;
-  
+
+  /* large collectives may have more requests in flight than wc entries */
+  const int nr = MIN(glb_gaspi_ctx.ne_count_grp, 64);
+
   const int pret = ibv_poll_cq( glb_gaspi_ctx_ib.scqGroups,
-				glb_gaspi_ctx.ne_count_grp,
+				nr,
 				glb_gaspi_ctx_ib.wc_grp_send );
   
   if (pret < 0)
     {
-      for (i = 0; i < glb_gaspi_ctx.ne_count_grp; i++)
+      for (i = 0; i < nr; i++)
 	{
 	  if (glb_gaspi_ctx_ib.wc_grp_send[i].status != IBV_WC_SUCCESS)
 	    {
@@ -83,3 +86,73 @@ pgaspi_dev_post_group_write(void *local_addr, int length, int dst, void *remote_
 
   return 0;
 }
+
+/* Write between user segments on the collectives queue */
+int
+pgaspi_dev_post_group_segment_write(const gaspi_segment_id_t segment_id_local,
+				    const gaspi_offset_t offset_local,
+				    const int dst,
+				    const gaspi_segment_id_t segment_id_remote,
+				    const gaspi_offset_t offset_remote,
+				    const unsigned int length)
+{
+  struct ibv_sge slist;
+  struct ibv_send_wr swr;
+  struct ibv_send_wr *bad_wr_send;
+
+  slist.addr = (uintptr_t) (glb_gaspi_ctx.rrmd[segment_id_local][glb_gaspi_ctx.rank].data.addr + offset_local);
+  slist.length = length;
+  slist.lkey = ((struct ibv_mr *) glb_gaspi_ctx.rrmd[segment_id_local][glb_gaspi_ctx.rank].mr[0])->lkey;
+
+  swr.sg_list = &slist;
+  swr.num_sge = 1;
+  swr.opcode = IBV_WR_RDMA_WRITE;
+  swr.send_flags = IBV_SEND_SIGNALED;
+  swr.next = NULL;
+
+  swr.wr.rdma.remote_addr = (uint64_t) (glb_gaspi_ctx.rrmd[segment_id_remote][dst].data.addr + offset_remote);
+  swr.wr.rdma.rkey = glb_gaspi_ctx.rrmd[segment_id_remote][dst].rkey[0];
+  swr.wr_id = dst;
+
+  if (ibv_post_send ((struct ibv_qp *) glb_gaspi_ctx_ib.qpGroups[dst], &swr, &bad_wr_send))
+    {
+      return 1;
+    }
+
+  return 0;
+}
+
+/* Write from a user segment into the collectives buffer of a group */
+int
+pgaspi_dev_post_group_segment_buf_write(const gaspi_segment_id_t segment_id_local,
+					const gaspi_offset_t offset_local,
+					const int dst,
+					const gaspi_group_t group,
+					const gaspi_offset_t offset_remote,
+					const unsigned int length)
+{
+  struct ibv_sge slist;
+  struct ibv_send_wr swr;
+  struct ibv_send_wr *bad_wr_send;
+
+  slist.addr = (uintptr_t) (glb_gaspi_ctx.rrmd[segment_id_local][glb_gaspi_ctx.rank].data.addr + offset_local);
+  slist.length = length;
+  slist.lkey = ((struct ibv_mr *) glb_gaspi_ctx.rrmd[segment_id_local][glb_gaspi_ctx.rank].mr[0])->lkey;
+
+  swr.sg_list = &slist;
+  swr.num_sge = 1;
+  swr.opcode = IBV_WR_RDMA_WRITE;
+  swr.send_flags = IBV_SEND_SIGNALED;
+  swr.next = NULL;
+
+  swr.wr.rdma.remote_addr = (uint64_t) (glb_gaspi_group_ctx[group].rrcd[dst].data.addr + offset_remote);
+  swr.wr.rdma.rkey = glb_gaspi_group_ctx[group].rrcd[dst].rkey[0];
+  swr.wr_id = dst;
+
+  if (ibv_post_send ((struct ibv_qp *) glb_gaspi_ctx_ib.qpGroups[dst], &swr, &bad_wr_send))
+    {
+      return 1;
+    }
+
+  return 0;
+}
@@ -15,15 +15,122 @@ GNU General Public License for more details.
 You should have received a copy of the GNU General Public License
 along with GPI-2. If not, see <http://www.gnu.org/licenses/>.
 */
+#include <limits.h>
+#include <poll.h>
+#include <arpa/inet.h>
+
 #include "GASPI.h"
 #include "GPI2.h"
+#include "GPI2_Dev.h"
 #include "GPI2_IB.h"
 
+extern gaspi_config_t glb_gaspi_cfg;
+
 #ifdef GPI2_CUDA
 #include "GPI2_GPU.h"
 #include <cuda.h>
 #endif
 
+/* Post the chain of work requests starting at first (one request each)
+   to rank on a comm queue. Only one work request out of signal_period
+   is signaled: the last of the chain, once the unsignaled requests of
+   the QP reach the period, completing all of them. The QP lock keeps
+   the count in order with the posts (the provider serializes the posts
+   to a QP anyway). */
+static int
+_pgaspi_dev_post_comm (const gaspi_queue_id_t queue,
+		       const gaspi_rank_t rank,
+		       struct ibv_send_wr *first)
+{
+  gaspi_ib_signal_t * const sig = &glb_gaspi_ctx_ib.sigC[queue][rank];
+  struct ibv_send_wr *bad_wr;
+  struct ibv_send_wr *wr, *last = first;
+  int reqs = 0, ret;
+
+  for (wr = first; wr != NULL; wr = wr->next)
+    {
+      wr->send_flags &= ~IBV_SEND_SIGNALED;
+      wr->wr_id = GASPI_DEV_WR_ID (rank, 1);
+      last = wr;
+      reqs++;
+    }
+
+  lock_gaspi (&sig->lock);
+
+  const int unsignaled = sig->unsignaled + reqs;
+  const int signaled = (unsignaled >= glb_gaspi_ctx_ib.signal_period);
+
+  if (signaled)
+    {
+      last->send_flags |= IBV_SEND_SIGNALED;
+      last->wr_id = GASPI_DEV_WR_ID (rank, unsignaled);
+    }
+
+  ret = ibv_post_send (glb_gaspi_ctx_ib.qpC[queue][rank], first, &bad_wr);
+
+  if (ret == 0)
+    {
+      const int delta = signaled ? -sig->unsignaled : reqs;
+
+      sig->unsignaled = signaled ? 0 : unsignaled;
+      __sync_fetch_and_add (&glb_gaspi_ctx_ib.unsignaledC[queue], delta);
+    }
+
+  unlock_gaspi (&sig->lock);
+
+  return ret;
+}
+
+/* Have the unsignaled requests of the queue completed: a signaled
+   empty write to each rank with some */
+static int
+_pgaspi_dev_flush_comm (const gaspi_queue_id_t queue)
+{
+  struct ibv_send_wr *bad_wr;
+  struct ibv_send_wr swr;
+  int i;
+
+  if (glb_gaspi_ctx_ib.unsignaledC[queue] == 0)
+    {
+      return 0;
+    }
+
+  for (i = 0; i < glb_gaspi_ctx.tnc; i++)
+    {
+      gaspi_ib_signal_t * const sig = &glb_gaspi_ctx_ib.sigC[queue][i];
+
+      if (sig->unsignaled == 0)
+	{
+	  continue;
+	}
+
+      lock_gaspi (&sig->lock);
+
+      if (sig->unsignaled > 0)
+	{
+	  memset (&swr, 0, sizeof (swr));
+	  swr.wr_id = GASPI_DEV_WR_ID (i, sig->unsignaled);
+	  swr.opcode = IBV_WR_RDMA_WRITE;
+	  swr.send_flags = IBV_SEND_SIGNALED;
+	  swr.sg_list = NULL;
+	  swr.num_sge = 0;
+
+	  if (ibv_post_send (glb_gaspi_ctx_ib.qpC[queue][i], &swr, &bad_wr))
+	    {
+	      unlock_gaspi (&sig->lock);
+	      return -1;
+	    }
+
+	  __sync_fetch_and_sub (&glb_gaspi_ctx_ib.unsignaledC[queue], sig->unsignaled);
+	  sig->unsignaled = 0;
+	}
+
+      unlock_gaspi (&sig->lock);
+    }
+
+  return 0;
+}
+
 /* Communication functions */
 gaspi_return_t
 pgaspi_dev_write (const gaspi_segment_id_t segment_id_local,
@@ -32,7 +139,6 @@ pgaspi_dev_write (const gaspi_segment_id_t segment_id_local,
 		  const gaspi_offset_t offset_remote, const gaspi_size_t size,
 		  const gaspi_queue_id_t queue)
 {
-  struct ibv_send_wr *bad_wr;
   struct ibv_sge slist;
   struct ibv_send_wr swr;
   enum ibv_send_flags sf;
@@ -75,7 +181,7 @@ pgaspi_dev_write (const gaspi_segment_id_t segment_id_local,
   swr.send_flags = sf;
   swr.next = NULL;
 
-  if( ibv_post_send (glb_gaspi_ctx_ib.qpC[queue][rank], &swr, &bad_wr) )
+  if (_pgaspi_dev_post_comm (queue, rank, &swr))
     {
       return GASPI_ERROR;
     }
@@ -90,7 +196,6 @@ pgaspi_dev_read (const gaspi_segment_id_t segment_id_local,
 		 const gaspi_offset_t offset_remote, const gaspi_size_t size,
 		 const gaspi_queue_id_t queue)
 {
-  struct ibv_send_wr *bad_wr;
   struct ibv_sge slist;
   struct ibv_send_wr swr;
 
@@ -125,7 +230,7 @@ pgaspi_dev_read (const gaspi_segment_id_t segment_id_local,
   swr.send_flags = IBV_SEND_SIGNALED;// | IBV_SEND_FENCE;
   swr.next = NULL;
 
-  if (ibv_post_send (glb_gaspi_ctx_ib.qpC[queue][rank], &swr, &bad_wr))
+  if (_pgaspi_dev_post_comm (queue, rank, &swr))
     {
       return GASPI_ERROR;
     }
@@ -133,108 +238,217 @@ pgaspi_dev_read (const gaspi_segment_id_t segment_id_local,
   return GASPI_SUCCESS;
 }
 
-gaspi_return_t
-pgaspi_dev_purge (const gaspi_queue_id_t queue,
-		  int * counter,
-		  const gaspi_timeout_t timeout_ms)
+/* Block until a queue completes a request (the channel is shared by
+   all queues and another waiter may take the event) */
+static void
+_pgaspi_dev_wait_cq_event (const long timeout_us)
 {
-  int ne = 0, i;
-  struct ibv_wc wc;
-
-  const int nr = *counter;
-  const gaspi_cycles_t s0 = gaspi_get_cycles ();
+  struct ibv_cq *ev_cq;
+  void *ev_ctx;
 
-  for (i = 0; i < nr; i++)
+  struct pollfd pfd =
     {
-      do
-	{
-	  ne = ibv_poll_cq (glb_gaspi_ctx_ib.scqC[queue], 1, &wc);
-	  *counter -= ne;
+      .fd = glb_gaspi_ctx_ib.channelC->fd,
+      .events = POLLIN,
+      .revents = 0
+    };
 
-	  if (ne == 0)
-	    {
-	      const gaspi_cycles_t s1 = gaspi_get_cycles ();
-	      const gaspi_cycles_t tdelta = s1 - s0;
+  const struct timespec timeout =
+    {
+      .tv_sec = timeout_us / 1000000,
+      .tv_nsec = (timeout_us % 1000000) * 1000
+    };
 
-	      const float ms = (float) tdelta * glb_gaspi_ctx.cycles_to_msecs;
-	      if (ms > timeout_ms)
-		{
-		  return GASPI_TIMEOUT;
-		}
-	    }
-	}
-      while (ne == 0);
+  if (ppoll (&pfd, 1, &timeout, NULL) < 1)
+    {
+      return;
     }
 
-#ifdef GPI2_CUDA
-  int j, k;
-  for(k = 0;k < glb_gaspi_ctx.gpu_count; k++)
+  if (ibv_get_cq_event (glb_gaspi_ctx_ib.channelC, &ev_cq, &ev_ctx) == 0)
     {
-      for(j = 0; j < GASPI_CUDA_EVENTS; j++)
-	gpus[k].events[queue][j].ib_use = 0;
+      ibv_ack_cq_events (ev_cq, 1);
     }
-#endif
+}
 
-  return GASPI_SUCCESS;
+/* Take reqs completed requests off the counter, not below zero: the
+   requests of a broken connection complete (flushed) on their own and
+   again for the completion that covers them, or after a purge
+   discarded them. */
+static inline void
+_pgaspi_dev_count_done (int * counter, const int reqs)
+{
+  int old = *counter;
+
+  for (;;)
+    {
+      const int take = MIN (old, reqs);
+
+      if (take <= 0)
+	{
+	  return;
+	}
+
+      const int seen = __sync_val_compare_and_swap (counter, old, old - take);
+
+      if (seen == old)
+	{
+	  return;
+	}
+
+      old = seen;
+    }
 }
 
-gaspi_return_t
-pgaspi_dev_wait (const gaspi_queue_id_t queue,
-		 int * counter,
-		 const gaspi_timeout_t timeout_ms)
+/* Take the completions of num requests of the queue, in batches (a
+   completion covers the unsignaled requests before it). The unsignaled
+   requests are flushed whenever the CQ is empty: a request counted in
+   the queue may be posted only after the wait started. A failed request
+   counts like a successful one and, if report is set, breaks the queue
+   to its rank. */
+static gaspi_return_t
+_pgaspi_dev_poll_comm (const gaspi_queue_id_t queue,
+		       int * counter,
+		       const int num,
+		       const gaspi_timeout_t timeout_ms,
+		       const int report)
 {
+  struct ibv_wc wc[GASPI_DEV_WC_BATCH];
+  gaspi_return_t eret = GASPI_SUCCESS;
+  int done = 0, ne, i;
 
-  int ne = 0, i;
-  struct ibv_wc wc;
+  gaspi_waiter_t w;
+  long block_us;
+  int armed = 0;
 
-  const int nr = *counter;
-  const gaspi_cycles_t s0 = gaspi_get_cycles ();
+  gaspi_waiter_init (&w, timeout_ms);
 
-  for (i = 0; i < nr; i++)
+  while (done < num)
     {
-      do
+      ne = ibv_poll_cq (glb_gaspi_ctx_ib.scqC[queue], MIN (num - done, GASPI_DEV_WC_BATCH), wc);
+
+      if (ne < 0)
 	{
-	  ne = ibv_poll_cq (glb_gaspi_ctx_ib.scqC[queue], 1, &wc);
-	  *counter -= ne;
+	  gaspi_print_error ("Failed to poll CQ of queue %d", queue);
+	  return GASPI_ERROR;
+	}
+
+      for (i = 0; i < ne; i++)
+	{
+	  const int reqs = GASPI_DEV_WR_REQS (wc[i].wr_id);
 
-	  if (ne == 0)
+	  _pgaspi_dev_count_done (counter, reqs);
+	  done += reqs;
+
+	  if (report && wc[i].status != IBV_WC_SUCCESS)
 	    {
-	      const gaspi_cycles_t s1 = gaspi_get_cycles ();
-	      const gaspi_cycles_t tdelta = s1 - s0;
+	      const gaspi_rank_t rank = GASPI_DEV_WR_RANK (wc[i].wr_id);
+
+	      //TODO: for now here, but has to go  out of device
+	      glb_gaspi_ctx.qp_state_vec[queue][rank] = GASPI_STATE_CORRUPT;
 
-	      const float ms = (float) tdelta * glb_gaspi_ctx.cycles_to_msecs;
-	      if (ms > timeout_ms)
+	      if (eret == GASPI_SUCCESS)
 		{
-		  return GASPI_TIMEOUT;
+		  gaspi_print_error("Failed request to %u. Queue %d might be broken %s",
+				    rank, queue, ibv_wc_status_str(wc[i].status) );
 		}
+
+	      eret = GASPI_ERROR;
 	    }
 	}
-      while (ne == 0);
 
+      if (eret != GASPI_SUCCESS)
+	{
+	  return eret;
+	}
 
-      if ((ne < 0) || (wc.status != IBV_WC_SUCCESS))
+      if (ne == 0)
 	{
-	  //TODO: for now here, but has to go  out of device
-	  glb_gaspi_ctx.qp_state_vec[queue][wc.wr_id] = GASPI_STATE_CORRUPT;
-	  gaspi_print_error("Failed request to %lu. Queue %d might be broken %s",
-			    wc.wr_id, queue, ibv_wc_status_str(wc.status) );
+	  if (_pgaspi_dev_flush_comm (queue))
+	    {
+	      gaspi_print_error ("Failed to flush queue %d", queue);
+	      return GASPI_ERROR;
+	    }
 
-	  return GASPI_ERROR;
+	  const int phase = gaspi_waiter_idle (&w, &block_us);
+
+	  if (phase == GASPI_WAIT_PHASE_EXPIRED)
+	    {
+	      return GASPI_TIMEOUT;
+	    }
+
+	  /* arm the CQ and poll it once more before blocking */
+	  if (phase == GASPI_WAIT_PHASE_BLOCK)
+	    {
+	      if (!armed)
+		{
+		  armed = !ibv_req_notify_cq (glb_gaspi_ctx_ib.scqC[queue], 0);
+		}
+	      else
+		{
+		  _pgaspi_dev_wait_cq_event (block_us);
+		  armed = 0;
+		}
+	    }
 	}
     }
+
 #ifdef GPI2_CUDA
-  int j,k;
+  int j, k;
   for(k = 0;k < glb_gaspi_ctx.gpu_count; k++)
     {
       for(j = 0; j < GASPI_CUDA_EVENTS; j++)
 	gpus[k].events[queue][j].ib_use = 0;
     }
-
 #endif
 
   return GASPI_SUCCESS;
 }
 
+gaspi_return_t
+pgaspi_dev_purge (const gaspi_queue_id_t queue,
+		  int * counter,
+		  const gaspi_timeout_t timeout_ms)
+{
+  struct ibv_wc wc[GASPI_DEV_WC_BATCH];
+  int ne;
+
+  gaspi_return_t eret = _pgaspi_dev_poll_comm (queue, counter, *counter, timeout_ms, 0);
+
+  if (eret != GASPI_SUCCESS)
+    {
+      return eret;
+    }
+
+  /* the flushed requests of a broken connection may complete beyond
+     the count: drain the CQ and discard the queue */
+  if (_pgaspi_dev_flush_comm (queue))
+    {
+      gaspi_print_error ("Failed to flush queue %d", queue);
+      return GASPI_ERROR;
+    }
+
+  while ((ne = ibv_poll_cq (glb_gaspi_ctx_ib.scqC[queue], GASPI_DEV_WC_BATCH, wc)) > 0);
+
+  if (ne < 0)
+    {
+      gaspi_print_error ("Failed to poll CQ of queue %d", queue);
+      return GASPI_ERROR;
+    }
+
+  __sync_lock_test_and_set (counter, 0);
+
+  return GASPI_SUCCESS;
+}
+
+gaspi_return_t
+pgaspi_dev_wait (const gaspi_queue_id_t queue,
+		 int * counter,
+		 const int num,
+		 const gaspi_timeout_t timeout_ms)
+{
+  return _pgaspi_dev_poll_comm (queue, counter, num, timeout_ms, 1);
+}
+
 gaspi_return_t
 pgaspi_dev_write_list (const gaspi_number_t num,
 		       gaspi_segment_id_t * const segment_id_local,
@@ -246,7 +460,6 @@ pgaspi_dev_write_list (const gaspi_number_t num,
 
 {
 
-  struct ibv_send_wr *bad_wr;
   struct ibv_sge slist[256];
   struct ibv_send_wr swr[256];
   gaspi_number_t i;
@@ -287,7 +500,7 @@ pgaspi_dev_write_list (const gaspi_number_t num,
 	swr[i].next = &swr[i + 1];
     }
 
-  if (ibv_post_send (glb_gaspi_ctx_ib.qpC[queue][rank], &swr[0], &bad_wr))
+  if (_pgaspi_dev_post_comm (queue, rank, &swr[0]))
     {
       return GASPI_ERROR;
     }
@@ -305,7 +518,6 @@ pgaspi_dev_read_list (const gaspi_number_t num,
 
 {
 
-  struct ibv_send_wr *bad_wr;
   struct ibv_sge slist[256];
   struct ibv_send_wr swr[256];
   gaspi_number_t i;
@@ -346,14 +558,372 @@ slist[i].length = size[i];
 	swr[i].next = &swr[i + 1];
     }
 
-  if (ibv_post_send (glb_gaspi_ctx_ib.qpC[queue][rank], &swr[0], &bad_wr))
+  if (_pgaspi_dev_post_comm (queue, rank, &swr[0]))
+    {
+      return GASPI_ERROR;
+    }
+
+  return GASPI_SUCCESS;
+}
+
+/* Strided transfers: a work request per run of blocks contiguous in
+   the remote segment, gathering their local blocks (merged when
+   contiguous too) in up to max_sge entries. The work requests are
+   posted in chains of GASPI_DEV_WC_BATCH; their number is returned. */
+static int
+_pgaspi_dev_strided (const enum ibv_wr_opcode opcode,
+		     const gaspi_segment_id_t segment_id_local,
+		     const gaspi_offset_t offset_local,
+		     const gaspi_rank_t rank,
+		     const gaspi_segment_id_t segment_id_remote,
+		     const gaspi_offset_t offset_remote,
+		     const gaspi_strided_t * const shape,
+		     const gaspi_queue_id_t queue)
+{
+  struct ibv_sge slist[GASPI_DEV_WC_BATCH][GASPI_IB_MAX_SGE];
+  struct ibv_send_wr swr[GASPI_DEV_WC_BATCH];
+  uintptr_t local_end = 0;
+  uint64_t remote_end = 0;
+  gaspi_number_t i, j, k;
+  int n = 0, wrs = 0;
+
+  const uintptr_t local = (uintptr_t) (glb_gaspi_ctx.rrmd[segment_id_local][glb_gaspi_ctx.rank].data.addr + offset_local);
+  const uint32_t lkey = ((struct ibv_mr *) glb_gaspi_ctx.rrmd[segment_id_local][glb_gaspi_ctx.rank].mr[0])->lkey;
+  const uint64_t remote = glb_gaspi_ctx.rrmd[segment_id_remote][rank].data.addr + offset_remote;
+  const uint32_t rkey = glb_gaspi_ctx.rrmd[segment_id_remote][rank].rkey[0];
+
+  for (k = 0; k < shape->count[2]; k++)
+    for (j = 0; j < shape->count[1]; j++)
+      for (i = 0; i < shape->count[0]; i++)
+	{
+	  const uintptr_t l = local + k * shape->stride_local[2]
+	    + j * shape->stride_local[1] + i * shape->stride_local[0];
+	  const uint64_t r = remote + k * shape->stride_remote[2]
+	    + j * shape->stride_remote[1] + i * shape->stride_remote[0];
+
+	  struct ibv_send_wr * const cur = &swr[(n > 0) ? n - 1 : 0];
+
+	  /* the remote run goes on */
+	  int extend = (wrs > 0 && r == remote_end
+			&& remote_end - cur->wr.rdma.remote_addr + shape->block <= GASPI_MAX_TSIZE_C);
+
+	  if (extend)
+	    {
+	      if (l == local_end)
+		{
+		  cur->sg_list[cur->num_sge - 1].length += shape->block;
+		}
+	      else if (cur->num_sge < glb_gaspi_ctx_ib.max_sge)
+		{
+		  cur->sg_list[cur->num_sge].addr = l;
+		  cur->sg_list[cur->num_sge].length = shape->block;
+		  cur->sg_list[cur->num_sge].lkey = lkey;
+		  cur->num_sge++;
+		}
+	      else
+		{
+		  extend = 0;
+		}
+	    }
+
+	  local_end = l + shape->block;
+	  remote_end = r + shape->block;
+
+	  if (extend)
+	    {
+	      continue;
+	    }
+
+	  if (n == GASPI_DEV_WC_BATCH)
+	    {
+	      if (_pgaspi_dev_post_comm (queue, rank, &swr[0]))
+		{
+		  return -1;
+		}
+	      n = 0;
+	    }
+
+	  slist[n][0].addr = l;
+	  slist[n][0].length = shape->block;
+	  slist[n][0].lkey = lkey;
+
+	  memset (&swr[n], 0, sizeof (struct ibv_send_wr));
+	  swr[n].wr.rdma.remote_addr = r;
+	  swr[n].wr.rdma.rkey = rkey;
+	  swr[n].sg_list = slist[n];
+	  swr[n].num_sge = 1;
+	  swr[n].wr_id = rank;
+	  swr[n].opcode = opcode;
+	  swr[n].send_flags = IBV_SEND_SIGNALED;
+	  swr[n].next = NULL;
+
+	  if (n > 0)
+	    {
+	      swr[n - 1].next = &swr[n];
+	    }
+
+	  n++;
+	  wrs++;
+	}
+
+  if (n > 0 && _pgaspi_dev_post_comm (queue, rank, &swr[0]))
+    {
+      return -1;
+    }
+
+  return wrs;
+}
+
+/* A request per block at most (a block is at most GASPI_MAX_TSIZE_C) */
+int
+pgaspi_dev_strided_requests (const gaspi_strided_t * const shape)
+{
+  const unsigned long blocks = (unsigned long) shape->count[0] * shape->count[1];
+
+  if (shape->count[2] > INT_MAX / MAX (blocks, 1UL))
+    {
+      return INT_MAX;
+    }
+
+  return (int) (blocks * shape->count[2]);
+}
+
+gaspi_return_t
+pgaspi_dev_write_strided (const gaspi_segment_id_t segment_id_local,
+			  const gaspi_offset_t offset_local,
+			  const gaspi_rank_t rank,
+			  const gaspi_segment_id_t segment_id_remote,
+			  const gaspi_offset_t offset_remote,
+			  const gaspi_strided_t * const shape,
+			  const gaspi_queue_id_t queue,
+			  int * const reqs)
+{
+  *reqs = _pgaspi_dev_strided (IBV_WR_RDMA_WRITE, segment_id_local, offset_local,
+			       rank, segment_id_remote, offset_remote,
+			       shape, queue);
+
+  return (*reqs < 0) ? GASPI_ERROR : GASPI_SUCCESS;
+}
+
+gaspi_return_t
+pgaspi_dev_read_strided (const gaspi_segment_id_t segment_id_local,
+			 const gaspi_offset_t offset_local,
+			 const gaspi_rank_t rank,
+			 const gaspi_segment_id_t segment_id_remote,
+			 const gaspi_offset_t offset_remote,
+			 const gaspi_strided_t * const shape,
+			 const gaspi_queue_id_t queue,
+			 int * const reqs)
+{
+  *reqs = _pgaspi_dev_strided (IBV_WR_RDMA_READ, segment_id_local, offset_local,
+			       rank, segment_id_remote, offset_remote,
+			       shape, queue);
+
+  return (*reqs < 0) ? GASPI_ERROR : GASPI_SUCCESS;
+}
+
+/* Chain the write of the summary flag of notification_id behind the
+   notification write swrN when the remote segment keeps a summary:
+   being written after it, a set flag always covers the notification */
+static inline void
+_pgaspi_dev_notify_summary (const gaspi_segment_id_t segment_id_remote,
+			    const gaspi_rank_t rank,
+			    const gaspi_notification_id_t notification_id,
+			    struct ibv_send_wr *swrN,
+			    struct ibv_send_wr *swrS,
+			    struct ibv_sge *slistS)
+{
+  if( !glb_gaspi_ctx.rrmd[segment_id_remote][rank].notif_summary )
+    {
+      return;
+    }
+
+  const unsigned long block = NOTIFY_SUMMARY_OFFSET + notification_id / NOTIFY_SUMMARY_BLOCK;
+
+  slistS->addr = (uintptr_t) (glb_gaspi_ctx.nsrc.notif_spc.buf + block);
+
+  *((unsigned char *) slistS->addr) = 1;
+
+  slistS->length = 1;
+  slistS->lkey = ((struct ibv_mr *) glb_gaspi_ctx.nsrc.mr[0])->lkey;
+
+  swrS->wr.rdma.remote_addr = glb_gaspi_ctx.rrmd[segment_id_remote][rank].notif_spc.addr + block;
+  swrS->wr.rdma.rkey = glb_gaspi_ctx.rrmd[segment_id_remote][rank].rkey[1];
+  swrS->sg_list = slistS;
+  swrS->num_sge = 1;
+  swrS->wr_id = rank;
+  swrS->opcode = IBV_WR_RDMA_WRITE;
+  swrS->send_flags = IBV_SEND_SIGNALED | IBV_SEND_INLINE;
+  swrS->next = swrN->next;
+
+  swrN->next = swrS;
+}
+
+/* Fused notifications (notify_mode GASPI_NOTIFY_FUSED): the last
+   write swr carries the notification as its immediate, if the value
+   fits, and nothing follows it */
+static inline int
+_pgaspi_dev_notify_imm (const gaspi_segment_id_t segment_id_notification,
+			const gaspi_notification_id_t notification_id,
+			const gaspi_notification_t notification_value,
+			struct ibv_send_wr *swr)
+{
+  if( GASPI_NOTIFY_FUSED != glb_gaspi_cfg.notify_mode
+      || notification_value > NOTIFY_IMM_VALUE_MAX )
+    {
+      return 0;
+    }
+
+  swr->opcode = IBV_WR_RDMA_WRITE_WITH_IMM;
+  swr->imm_data = htonl (NOTIFY_IMM (segment_id_notification, notification_id, notification_value));
+  swr->next = NULL;
+
+  return 1;
+}
+
+static inline void
+_pgaspi_dev_notify_imm_apply (const uint32_t imm)
+{
+  const gaspi_segment_id_t seg = (gaspi_segment_id_t) NOTIFY_IMM_SEG (imm);
+  const unsigned int id = NOTIFY_IMM_ID (imm);
+
+  if(glb_gaspi_ctx.rrmd[seg] == NULL)
     {
+      return;
+    }
+
+  volatile unsigned char *notif_spc =
+    (volatile unsigned char *) glb_gaspi_ctx.rrmd[seg][glb_gaspi_ctx.rank].notif_spc.addr;
+
+  ((volatile gaspi_notification_t *) notif_spc)[id] = NOTIFY_IMM_VALUE (imm);
+
+  if(glb_gaspi_ctx.rrmd[seg][glb_gaspi_ctx.rank].notif_summary)
+    {
+      __sync_synchronize ();
+      notif_spc[NOTIFY_SUMMARY_OFFSET + id / NOTIFY_SUMMARY_BLOCK] = 1;
+    }
+}
+
+/* Set the notifications the immediates received carry (their data is
+   in place) and post their receives again. A failed receive is kept
+   for the next notification wait to report. The thread of the device,
+   the waiters and the resets take turns: the immediates of one
+   notification are applied in the order they arrived. */
+static void
+_pgaspi_dev_notify_imm_progress (void)
+{
+  struct ibv_wc wc[GASPI_DEV_WC_BATCH];
+  struct ibv_recv_wr rwr, *bad_wr;
+  int i, ne;
+
+  memset (&rwr, 0, sizeof (struct ibv_recv_wr));
+
+  lock_gaspi (&glb_gaspi_ctx_ib.notify_lock);
+
+  do
+    {
+      ne = ibv_poll_cq (glb_gaspi_ctx_ib.rcqC, GASPI_DEV_WC_BATCH, wc);
+
+      for(i = 0; i < ne; i++)
+	{
+	  if(wc[i].status != IBV_WC_SUCCESS)
+	    {
+	      glb_gaspi_ctx_ib.notify_failed = 1;
+	    }
+	  else
+	    {
+	      _pgaspi_dev_notify_imm_apply (ntohl (wc[i].imm_data));
+	    }
+
+	  if(ibv_post_srq_recv (glb_gaspi_ctx_ib.srqC, &rwr, &bad_wr))
+	    {
+	      glb_gaspi_ctx_ib.notify_failed = 1;
+	    }
+	}
+    }
+  while(ne == GASPI_DEV_WC_BATCH);
+
+  unlock_gaspi (&glb_gaspi_ctx_ib.notify_lock);
+
+  if(ne < 0)
+    {
+      glb_gaspi_ctx_ib.notify_failed = 1;
+    }
+}
+
+/* Woken by the completions of the receives: keeps them posted while
+   nobody waits for notifications (the progress is not cancelled
+   halfway) */
+void *
+pgaspi_dev_notify_imm_thread (void *arg)
+{
+  struct ibv_cq *ev_cq;
+  void *ev_ctx;
+
+  for(;;)
+    {
+      if(ibv_get_cq_event (glb_gaspi_ctx_ib.channelN, &ev_cq, &ev_ctx))
+	{
+	  glb_gaspi_ctx_ib.notify_failed = 1;
+	  return NULL;
+	}
+
+      pthread_setcancelstate (PTHREAD_CANCEL_DISABLE, NULL);
+
+      ibv_ack_cq_events (ev_cq, 1);
+
+      if(ibv_req_notify_cq (glb_gaspi_ctx_ib.rcqC, 0))
+	{
+	  glb_gaspi_ctx_ib.notify_failed = 1;
+	}
+
+      _pgaspi_dev_notify_imm_progress ();
+
+      pthread_setcancelstate (PTHREAD_CANCEL_ENABLE, NULL);
+    }
+
+  return NULL;
+}
+
+/* Incoming writes raise no event: blocking waits for notifications
+   sleep instead. Each round of the waits applies the fused
+   notifications received (not to wait for the thread to). */
+unsigned int
+pgaspi_dev_progress_seq (void)
+{
+  if(glb_gaspi_ctx_ib.rcqC != NULL)
+    {
+      _pgaspi_dev_notify_imm_progress ();
+    }
+
+  return 0;
+}
+
+gaspi_return_t
+pgaspi_dev_notify_status (void)
+{
+  if(glb_gaspi_ctx_ib.notify_failed
+     && __sync_lock_test_and_set (&glb_gaspi_ctx_ib.notify_failed, 0))
+    {
+      gaspi_print_error ("Failed to receive notification (libibverbs)");
       return GASPI_ERROR;
     }
 
   return GASPI_SUCCESS;
 }
 
+void
+pgaspi_dev_progress_wait (const unsigned int seq, const long timeout_us)
+{
+  const struct timespec sleep_time =
+    {
+      .tv_sec = timeout_us / 1000000,
+      .tv_nsec = (timeout_us % 1000000) * 1000
+    };
+
+  nanosleep (&sleep_time, NULL);
+}
+
 gaspi_return_t
 pgaspi_dev_notify (const gaspi_segment_id_t segment_id_remote,
 		   const gaspi_rank_t rank,
@@ -362,9 +932,8 @@ pgaspi_dev_notify (const gaspi_segment_id_t segment_id_remote,
 		   const gaspi_queue_id_t queue)
 {
 
-  struct ibv_send_wr *bad_wr;
-  struct ibv_sge slistN;
-  struct ibv_send_wr swrN;
+  struct ibv_sge slistN, slistS;
+  struct ibv_send_wr swrN, swrS;
 
   slistN.addr = (uintptr_t) (glb_gaspi_ctx.nsrc.notif_spc.buf + notification_id * sizeof(gaspi_notification_t));
 
@@ -393,7 +962,9 @@ pgaspi_dev_notify (const gaspi_segment_id_t segment_id_remote,
   swrN.send_flags = IBV_SEND_SIGNALED | IBV_SEND_INLINE;
   swrN.next = NULL;
 
-  if (ibv_post_send (glb_gaspi_ctx_ib.qpC[queue][rank], &swrN, &bad_wr))
+  _pgaspi_dev_notify_summary (segment_id_remote, rank, notification_id, &swrN, &swrS, &slistS);
+
+  if (_pgaspi_dev_post_comm (queue, rank, &swrN))
     {
       return GASPI_ERROR;
     }
@@ -408,16 +979,15 @@ pgaspi_dev_write_notify (const gaspi_segment_id_t segment_id_local,
 			 const gaspi_rank_t rank,
 			 const gaspi_segment_id_t segment_id_remote,
 			 const gaspi_offset_t offset_remote,
-			 const unsigned int size,
+			 const gaspi_size_t size,
 			 const gaspi_notification_id_t notification_id,
 			 const gaspi_notification_t notification_value,
 			 const gaspi_queue_id_t queue)
 {
 
 
-  struct ibv_send_wr *bad_wr;
-  struct ibv_sge slist, slistN;
-  struct ibv_send_wr swr, swrN;
+  struct ibv_sge slist, slistN, slistS;
+  struct ibv_send_wr swr, swrN, swrS;
 
 #ifdef GPI2_CUDA
   if(glb_gaspi_ctx.rrmd[segment_id_local][glb_gaspi_ctx.rank].cudaDevId >= 0)
@@ -447,6 +1017,16 @@ pgaspi_dev_write_notify (const gaspi_segment_id_t segment_id_local,
   swr.send_flags = IBV_SEND_SIGNALED;
   swr.next = &swrN;
 
+  if (_pgaspi_dev_notify_imm (segment_id_remote, notification_id, notification_value, &swr))
+    {
+      if (_pgaspi_dev_post_comm (queue, rank, &swr))
+	{
+	  return GASPI_ERROR;
+	}
+
+      return GASPI_SUCCESS;
+    }
+
   slistN.addr = (uintptr_t) (glb_gaspi_ctx.nsrc.notif_spc.buf + notification_id * sizeof(gaspi_notification_t));
 
   *((unsigned int *) slistN.addr) = notification_value;
@@ -474,7 +1054,265 @@ pgaspi_dev_write_notify (const gaspi_segment_id_t segment_id_local,
   swrN.send_flags = IBV_SEND_SIGNALED | IBV_SEND_INLINE;;
   swrN.next = NULL;
 
-  if (ibv_post_send (glb_gaspi_ctx_ib.qpC[queue][rank], &swr, &bad_wr))
+  _pgaspi_dev_notify_summary (segment_id_remote, rank, notification_id, &swrN, &swrS, &slistS);
+
+  if (_pgaspi_dev_post_comm (queue, rank, &swr))
+    {
+      return GASPI_ERROR;
+    }
+
+  return GASPI_SUCCESS;
+}
+
+/* The local notification of a read: a read of the 1 kept in the
+   notification space of the remote segment into it, fenced behind the
+   reads before (and of the 1 for its summary flag, if any) */
+static void
+_pgaspi_dev_read_notify_wr (const gaspi_segment_id_t segment_id_notification,
+			    const gaspi_notification_id_t notification_id,
+			    const gaspi_rank_t rank,
+			    const gaspi_segment_id_t segment_id_remote,
+			    struct ibv_send_wr *swrN,
+			    struct ibv_sge *slistN,
+			    struct ibv_send_wr *swrS,
+			    struct ibv_sge *slistS)
+{
+  const gaspi_rc_mseg * const seg = &glb_gaspi_ctx.rrmd[segment_id_notification][glb_gaspi_ctx.rank];
+  const gaspi_rc_mseg * const rseg = &glb_gaspi_ctx.rrmd[segment_id_remote][rank];
+
+  slistN->addr = (uintptr_t) (seg->notif_spc.buf + notification_id * sizeof(gaspi_notification_t));
+  slistN->length = sizeof(gaspi_notification_t);
+  slistN->lkey = ((struct ibv_mr *) seg->mr[1])->lkey;
+
+  swrN->wr.rdma.remote_addr = rseg->notif_spc.addr + NOTIFY_READ_ONE_OFFSET;
+  swrN->wr.rdma.rkey = rseg->rkey[1];
+  swrN->sg_list = slistN;
+  swrN->num_sge = 1;
+  swrN->wr_id = rank;
+  swrN->opcode = IBV_WR_RDMA_READ;
+  swrN->send_flags = IBV_SEND_SIGNALED | IBV_SEND_FENCE;
+  swrN->next = NULL;
+
+  if( !seg->notif_summary )
+    {
+      return;
+    }
+
+  slistS->addr = (uintptr_t) (seg->notif_spc.buf + NOTIFY_SUMMARY_OFFSET + notification_id / NOTIFY_SUMMARY_BLOCK);
+  slistS->length = 1;
+  slistS->lkey = slistN->lkey;
+
+  swrS->wr.rdma.remote_addr = rseg->notif_spc.addr + NOTIFY_READ_FLAG_OFFSET;
+  swrS->wr.rdma.rkey = rseg->rkey[1];
+  swrS->sg_list = slistS;
+  swrS->num_sge = 1;
+  swrS->wr_id = rank;
+  swrS->opcode = IBV_WR_RDMA_READ;
+  swrS->send_flags = IBV_SEND_SIGNALED | IBV_SEND_FENCE;
+  swrS->next = NULL;
+
+  swrN->next = swrS;
+}
+
+gaspi_return_t
+pgaspi_dev_read_notify (const gaspi_segment_id_t segment_id_local,
+			const gaspi_offset_t offset_local,
+			const gaspi_rank_t rank,
+			const gaspi_segment_id_t segment_id_remote,
+			const gaspi_offset_t offset_remote,
+			const gaspi_size_t size,
+			const gaspi_notification_id_t notification_id,
+			const gaspi_queue_id_t queue)
+{
+  struct ibv_sge slist, slistN, slistS;
+  struct ibv_send_wr swr, swrN, swrS;
+
+  slist.addr = (uintptr_t) (glb_gaspi_ctx.rrmd[segment_id_local][glb_gaspi_ctx.rank].data.addr +
+			    offset_local);
+  slist.length = size;
+  slist.lkey = ((struct ibv_mr *)glb_gaspi_ctx.rrmd[segment_id_local][glb_gaspi_ctx.rank].mr[0])->lkey;
+
+  swr.wr.rdma.remote_addr = (glb_gaspi_ctx.rrmd[segment_id_remote][rank].data.addr +
+			     offset_remote);
+  swr.wr.rdma.rkey = glb_gaspi_ctx.rrmd[segment_id_remote][rank].rkey[0];
+  swr.sg_list = &slist;
+  swr.num_sge = 1;
+  swr.wr_id = rank;
+  swr.opcode = IBV_WR_RDMA_READ;
+  swr.send_flags = IBV_SEND_SIGNALED;
+  swr.next = &swrN;
+
+  _pgaspi_dev_read_notify_wr (segment_id_local, notification_id, rank, segment_id_remote,
+			      &swrN, &slistN, &swrS, &slistS);
+
+  if (_pgaspi_dev_post_comm (queue, rank, &swr))
+    {
+      return GASPI_ERROR;
+    }
+
+  return GASPI_SUCCESS;
+}
+
+gaspi_return_t
+pgaspi_dev_read_list_notify (const gaspi_number_t num,
+			     gaspi_segment_id_t * const segment_id_local,
+			     gaspi_offset_t * const offset_local,
+			     const gaspi_rank_t rank,
+			     gaspi_segment_id_t * const segment_id_remote,
+			     gaspi_offset_t * const offset_remote,
+			     gaspi_size_t * const size,
+			     const gaspi_segment_id_t segment_id_notification,
+			     const gaspi_notification_id_t notification_id,
+			     const gaspi_queue_id_t queue)
+{
+  struct ibv_sge slist[256], slistN, slistS;
+  struct ibv_send_wr swr[256], swrN, swrS;
+  gaspi_number_t i;
+
+  for (i = 0; i < num; i++)
+    {
+      slist[i].addr = (uintptr_t) (glb_gaspi_ctx.rrmd[segment_id_local[i]][glb_gaspi_ctx.rank].data.addr +
+				   offset_local[i]);
+      slist[i].length = size[i];
+      slist[i].lkey = ((struct ibv_mr *) glb_gaspi_ctx.rrmd[segment_id_local[i]][glb_gaspi_ctx.rank].mr[0])->lkey;
+
+      swr[i].wr.rdma.remote_addr = (glb_gaspi_ctx.rrmd[segment_id_remote[i]][rank].data.addr +
+				    offset_remote[i]);
+      swr[i].wr.rdma.rkey = glb_gaspi_ctx.rrmd[segment_id_remote[i]][rank].rkey[0];
+      swr[i].sg_list = &slist[i];
+      swr[i].num_sge = 1;
+      swr[i].wr_id = rank;
+      swr[i].opcode = IBV_WR_RDMA_READ;
+      swr[i].send_flags = IBV_SEND_SIGNALED;
+      swr[i].next = (i == num - 1) ? &swrN : &swr[i + 1];
+    }
+
+  _pgaspi_dev_read_notify_wr (segment_id_notification, notification_id, rank, segment_id_remote[num - 1],
+			      &swrN, &slistN, &swrS, &slistS);
+
+  if (_pgaspi_dev_post_comm (queue, rank, &swr[0]))
+    {
+      return GASPI_ERROR;
+    }
+
+  return GASPI_SUCCESS;
+}
+
+/* The add to a notification is an atomic fetch-and-add on the 8-byte
+   word holding it (notifications are 4 bytes, the word is aligned as
+   the notification space is). Only even IDs are added to, so that the
+   notification is the low half of the word and the odd ID after it,
+   reserved, takes any carry. The old value lands in the sink of the
+   local source space. */
+static void
+_pgaspi_dev_notify_add_wr (const gaspi_segment_id_t segment_id_remote,
+			   const gaspi_rank_t rank,
+			   const gaspi_notification_id_t notification_id,
+			   const gaspi_notification_t notification_value,
+			   struct ibv_send_wr *swrN,
+			   struct ibv_sge *slistN)
+{
+  const unsigned long word = notification_id * sizeof(gaspi_notification_t);
+
+  slistN->addr = (uintptr_t) (glb_gaspi_ctx.nsrc.notif_spc.buf + NOTIFY_ADD_SINK_OFFSET);
+  slistN->length = sizeof(uint64_t);
+  slistN->lkey = ((struct ibv_mr *) glb_gaspi_ctx.nsrc.mr[1])->lkey;
+
+#ifdef GPI2_CUDA
+  if( glb_gaspi_ctx.rrmd[segment_id_remote][rank].cudaDevId >= 0)
+    {
+      swrN->wr.atomic.remote_addr = glb_gaspi_ctx.rrmd[segment_id_remote][rank].host_addr + word;
+      swrN->wr.atomic.rkey = glb_gaspi_ctx.rrmd[segment_id_remote][rank].host_rkey;
+    }
+  else
+#endif
+    {
+      swrN->wr.atomic.remote_addr = glb_gaspi_ctx.rrmd[segment_id_remote][rank].notif_spc.addr + word;
+      swrN->wr.atomic.rkey = glb_gaspi_ctx.rrmd[segment_id_remote][rank].rkey[1];
+    }
+
+  swrN->wr.atomic.compare_add = (uint64_t) notification_value;
+
+  swrN->sg_list = slistN;
+  swrN->num_sge = 1;
+  swrN->wr_id = rank;
+  swrN->opcode = IBV_WR_ATOMIC_FETCH_AND_ADD;
+  swrN->send_flags = IBV_SEND_SIGNALED;
+  swrN->next = NULL;
+}
+
+gaspi_return_t
+pgaspi_dev_notify_add (const gaspi_segment_id_t segment_id_remote,
+		       const gaspi_rank_t rank,
+		       const gaspi_notification_id_t notification_id,
+		       const gaspi_notification_t notification_value,
+		       const gaspi_queue_id_t queue)
+{
+  struct ibv_sge slistN, slistS;
+  struct ibv_send_wr swrN, swrS;
+
+  _pgaspi_dev_notify_add_wr (segment_id_remote, rank, notification_id, notification_value, &swrN, &slistN);
+  _pgaspi_dev_notify_summary (segment_id_remote, rank, notification_id, &swrN, &swrS, &slistS);
+
+  /* the summary flag must not overtake the atomic */
+  if( glb_gaspi_ctx.rrmd[segment_id_remote][rank].notif_summary )
+    {
+      swrS.send_flags |= IBV_SEND_FENCE;
+    }
+
+  if (_pgaspi_dev_post_comm (queue, rank, &swrN))
+    {
+      return GASPI_ERROR;
+    }
+
+  return GASPI_SUCCESS;
+}
+
+gaspi_return_t
+pgaspi_dev_write_notify_add (const gaspi_segment_id_t segment_id_local,
+			     const gaspi_offset_t offset_local,
+			     const gaspi_rank_t rank,
+			     const gaspi_segment_id_t segment_id_remote,
+			     const gaspi_offset_t offset_remote,
+			     const gaspi_size_t size,
+			     const gaspi_notification_id_t notification_id,
+			     const gaspi_notification_t notification_value,
+			     const gaspi_queue_id_t queue)
+{
+  struct ibv_sge slist, slistN, slistS;
+  struct ibv_send_wr swr, swrN, swrS;
+
+  slist.addr = (uintptr_t) (glb_gaspi_ctx.rrmd[segment_id_local][glb_gaspi_ctx.rank].data.addr +
+			    offset_local);
+  slist.length = size;
+  slist.lkey = ((struct ibv_mr *)glb_gaspi_ctx.rrmd[segment_id_local][glb_gaspi_ctx.rank].mr[0])->lkey;
+
+#ifdef GPI2_CUDA
+  if(glb_gaspi_ctx.rrmd[segment_id_remote][rank].cudaDevId >= 0)
+    swr.wr.rdma.remote_addr = (glb_gaspi_ctx.rrmd[segment_id_remote][rank].addr + offset_remote);
+  else
+#endif
+    swr.wr.rdma.remote_addr = (glb_gaspi_ctx.rrmd[segment_id_remote][rank].data.addr +
+			       offset_remote);
+
+  swr.wr.rdma.rkey = glb_gaspi_ctx.rrmd[segment_id_remote][rank].rkey[0];
+  swr.sg_list = &slist;
+  swr.num_sge = 1;
+  swr.wr_id = rank;
+  swr.opcode = IBV_WR_RDMA_WRITE;
+  swr.send_flags = IBV_SEND_SIGNALED;
+  swr.next = &swrN;
+
+  _pgaspi_dev_notify_add_wr (segment_id_remote, rank, notification_id, notification_value, &swrN, &slistN);
+  _pgaspi_dev_notify_summary (segment_id_remote, rank, notification_id, &swrN, &swrS, &slistS);
+
+  /* the summary flag must not overtake the atomic */
+  if( glb_gaspi_ctx.rrmd[segment_id_remote][rank].notif_summary )
+    {
+      swrS.send_flags |= IBV_SEND_FENCE;
+    }
+
+  if (_pgaspi_dev_post_comm (queue, rank, &swr))
     {
       return GASPI_ERROR;
     }
@@ -496,9 +1334,8 @@ pgaspi_dev_write_list_notify (const gaspi_number_t num,
 			      const gaspi_queue_id_t queue)
 
 {
-  struct ibv_send_wr *bad_wr;
-  struct ibv_sge slist[256], slistN;
-  struct ibv_send_wr swr[256], swrN;
+  struct ibv_sge slist[256], slistN, slistS;
+  struct ibv_send_wr swr[256], swrN, swrS;
   gaspi_number_t i;
 
   for (i = 0; i < num; i++)
@@ -541,6 +1378,16 @@ pgaspi_dev_write_list_notify (const gaspi_number_t num,
 	swr[i].next = &swr[i + 1];
     }
 
+  if (_pgaspi_dev_notify_imm (segment_id_notification, notification_id, notification_value, &swr[num - 1]))
+    {
+      if (_pgaspi_dev_post_comm (queue, rank, &swr[0]))
+	{
+	  return GASPI_ERROR;
+	}
+
+      return GASPI_SUCCESS;
+    }
+
   slistN.addr = (uintptr_t) (glb_gaspi_ctx.nsrc.notif_spc.buf + notification_id * sizeof(gaspi_notification_t));
 
   *((unsigned int *) slistN.addr) = notification_value;
@@ -568,7 +1415,9 @@ pgaspi_dev_write_list_notify (const gaspi_number_t num,
   swrN.send_flags = IBV_SEND_SIGNALED | IBV_SEND_INLINE;;
   swrN.next = NULL;
 
-  if (ibv_post_send (glb_gaspi_ctx_ib.qpC[queue][rank], &swr[0], &bad_wr))
+  _pgaspi_dev_notify_summary (segment_id_notification, rank, notification_id, &swrN, &swrS, &slistS);
+
+  if (_pgaspi_dev_post_comm (queue, rank, &swr[0]))
     {
       return GASPI_ERROR;
     }
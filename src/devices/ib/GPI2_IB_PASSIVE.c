@@ -16,6 +16,7 @@ You should have received a copy of the GNU General Public License
 along with GPI-2. If not, see <http://www.gnu.org/licenses/>.
 */
 #include "GPI2.h"
+#include "GPI2_Dev.h"
 #include "GPI2_IB.h"
 
 gaspi_return_t
@@ -30,7 +31,8 @@ pgaspi_dev_passive_send (const gaspi_segment_id_t segment_id_local,
   struct ibv_sge slist;
   struct ibv_send_wr swr;
   struct ibv_wc wc_send;
-  gaspi_cycles_t s0;
+  gaspi_waiter_t w;
+  long block_us;
 
   const int byte_id = rank >> 3;
   const int bit_pos = rank - (byte_id * 8);
@@ -62,23 +64,28 @@ pgaspi_dev_passive_send (const gaspi_segment_id_t segment_id_local,
 
  checkL:
 
-  s0 = gaspi_get_cycles ();
+  gaspi_waiter_init (&w, timeout_ms);
 
   int ne = 0;
   do
     {
+      const unsigned int seq = pgaspi_dev_progress_seq ();
+
       ne = ibv_poll_cq (glb_gaspi_ctx_ib.scqP, 1, &wc_send);
 
       if (ne == 0)
 	{
-	  const gaspi_cycles_t s1 = gaspi_get_cycles ();
-	  const gaspi_cycles_t tdelta = s1 - s0;
+	  const int phase = gaspi_waiter_idle (&w, &block_us);
 
-	  const float ms = (float) tdelta * glb_gaspi_ctx.cycles_to_msecs;
-	  if (ms > timeout_ms)
+	  if (phase == GASPI_WAIT_PHASE_EXPIRED)
 	    {
 	      return GASPI_TIMEOUT;
 	    }
+
+	  if (phase == GASPI_WAIT_PHASE_BLOCK)
+	    {
+	      pgaspi_dev_progress_wait (seq, block_us);
+	    }
 	}
     }
   while (ne == 0);
@@ -160,7 +160,7 @@ pgaspi_dev_segment_alloc (const gaspi_segment_id_t segment_id,
 	  goto errL;
 	}
 
-      if(alloc_policy == GASPI_MEM_INITIALIZED)
+      if(alloc_policy & GASPI_MEM_INITIALIZED)
 	cudaMemset(glb_gaspi_ctx.rrmd[segment_id][glb_gaspi_ctx.rank].ptr,0,size);
 
       glb_gaspi_ctx.rrmd[segment_id][glb_gaspi_ctx.rank].mr =
@@ -207,7 +207,7 @@ pgaspi_dev_segment_alloc (const gaspi_segment_id_t segment_id,
       memset (glb_gaspi_ctx.rrmd[segment_id][glb_gaspi_ctx.rank].ptr, 0,
 	      NOTIFY_OFFSET);
 
-      if (alloc_policy == GASPI_MEM_INITIALIZED)
+      if (alloc_policy & GASPI_MEM_INITIALIZED)
 	memset (glb_gaspi_ctx.rrmd[segment_id][glb_gaspi_ctx.rank].ptr, 0,
 		size + NOTIFY_OFFSET);
 
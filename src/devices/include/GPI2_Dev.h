@@ -42,6 +42,18 @@ pgaspi_dev_poll_groups(void);
 int
 pgaspi_dev_post_group_write(void *, int, int, void *, unsigned char);
 
+int
+pgaspi_dev_post_group_segment_write(const gaspi_segment_id_t, const gaspi_offset_t,
+				    const int,
+				    const gaspi_segment_id_t, const gaspi_offset_t,
+				    const unsigned int);
+
+int
+pgaspi_dev_post_group_segment_buf_write(const gaspi_segment_id_t, const gaspi_offset_t,
+					const int,
+					const gaspi_group_t, const gaspi_offset_t,
+					const unsigned int);
+
 //////////////////////////////////////////////////////////
 
 #ifdef GPI2_CUDA
@@ -104,8 +116,36 @@ pgaspi_dev_read (const gaspi_segment_id_t, const gaspi_offset_t, const gaspi_ran
 		 const gaspi_queue_id_t);
 
 
+/* Completions of the comm queues are taken in batches of up to
+   GASPI_DEV_WC_BATCH. A completion may stand for several requests (a
+   signaled request completes the unsignaled ones posted before it on
+   the same connection): its work request ID holds the rank and the
+   number of requests. */
+#define GASPI_DEV_WC_BATCH (64)
+
+#define GASPI_DEV_WR_ID(rank, reqs) ((uint64_t) (rank) | ((uint64_t) ((reqs) - 1) << 16))
+#define GASPI_DEV_WR_RANK(wr_id) ((gaspi_rank_t) ((wr_id) & 0xffff))
+#define GASPI_DEV_WR_REQS(wr_id) ((int) ((wr_id) >> 16) + 1)
+
+/* Take the completions of num requests of the queue (all posted
+   requests for *counter), decrementing *counter with them */
 gaspi_return_t
-pgaspi_dev_wait (const gaspi_queue_id_t, int *, const gaspi_timeout_t);
+pgaspi_dev_wait (const gaspi_queue_id_t, int *, const int num, const gaspi_timeout_t);
+
+/* Progress of the device (completions and incoming writes): read the
+   count before looking for what to wait for and block with it until
+   the count changes or timeout_us expires */
+unsigned int
+pgaspi_dev_progress_seq (void);
+
+void
+pgaspi_dev_progress_wait (const unsigned int seq, const long timeout_us);
+
+/* Whether notifications were lost since the last call (a fused
+   notification failed to arrive): GASPI_ERROR once, for the next
+   notification wait to return */
+gaspi_return_t
+pgaspi_dev_notify_status (void);
 
 
 gaspi_return_t
@@ -147,6 +187,24 @@ pgaspi_dev_write_notify (const gaspi_segment_id_t,
 			 const gaspi_queue_id_t);
 
 
+gaspi_return_t
+pgaspi_dev_notify_add (const gaspi_segment_id_t,
+		       const gaspi_rank_t,
+		       const gaspi_notification_id_t,
+		       const gaspi_notification_t,
+		       const gaspi_queue_id_t);
+
+gaspi_return_t
+pgaspi_dev_write_notify_add (const gaspi_segment_id_t,
+			     const gaspi_offset_t,
+			     const gaspi_rank_t,
+			     const gaspi_segment_id_t,
+			     const gaspi_offset_t,
+			     const gaspi_size_t,
+			     const gaspi_notification_id_t,
+			     const gaspi_notification_t,
+			     const gaspi_queue_id_t);
+
 gaspi_return_t
 pgaspi_dev_write_list_notify (const gaspi_number_t,
 			      gaspi_segment_id_t * const,
@@ -160,6 +218,54 @@ pgaspi_dev_write_list_notify (const gaspi_number_t,
 			      const gaspi_notification_t,
 			      const gaspi_queue_id_t);
 
+gaspi_return_t
+pgaspi_dev_read_notify (const gaspi_segment_id_t,
+			const gaspi_offset_t,
+			const gaspi_rank_t,
+			const gaspi_segment_id_t,
+			const gaspi_offset_t,
+			const gaspi_size_t,
+			const gaspi_notification_id_t,
+			const gaspi_queue_id_t);
+
+gaspi_return_t
+pgaspi_dev_read_list_notify (const gaspi_number_t,
+			     gaspi_segment_id_t * const,
+			     gaspi_offset_t * const,
+			     const gaspi_rank_t,
+			     gaspi_segment_id_t * const,
+			     gaspi_offset_t * const,
+			     gaspi_size_t* const,
+			     const gaspi_segment_id_t,
+			     const gaspi_notification_id_t,
+			     const gaspi_queue_id_t);
+
+/* An upper bound of the requests a strided transfer takes, at most
+   one per block, found without walking the blocks. The transfers
+   return the number of requests they posted. */
+int
+pgaspi_dev_strided_requests (const gaspi_strided_t * const);
+
+gaspi_return_t
+pgaspi_dev_write_strided (const gaspi_segment_id_t,
+			  const gaspi_offset_t,
+			  const gaspi_rank_t,
+			  const gaspi_segment_id_t,
+			  const gaspi_offset_t,
+			  const gaspi_strided_t * const,
+			  const gaspi_queue_id_t,
+			  int * const);
+
+gaspi_return_t
+pgaspi_dev_read_strided (const gaspi_segment_id_t,
+			 const gaspi_offset_t,
+			 const gaspi_rank_t,
+			 const gaspi_segment_id_t,
+			 const gaspi_offset_t,
+			 const gaspi_strided_t * const,
+			 const gaspi_queue_id_t,
+			 int * const);
+
 gaspi_return_t
 pgaspi_dev_atomic_fetch_add (const gaspi_segment_id_t,
 			     const gaspi_offset_t,
@@ -129,6 +129,15 @@ pgaspi_dev_print_info()
     {
       gaspi_printf("  Failed to retrieve more info\n");
     }
+
+  unsigned int rail;
+  for(rail = 1; rail < glb_gaspi_ctx_tcp.rails; rail++)
+    {
+      char* rip = tcp_dev_get_rail_ip(rail);
+      char* riface = tcp_dev_get_local_if(rip);
+      gaspi_printf("  rail %u  : %-8s: %s\n", rail, riface, rip);
+      free(riface);
+    }
   gaspi_printf("<<<<<<<<<<<<<<<<<<<<<<<<>>>>>>>>>>>>>>>>>>>>>>>>>\n");
 }
 
@@ -138,6 +147,15 @@ pgaspi_dev_init_core(gaspi_config_t *gaspi_cfg)
   unsigned int c;
   
   memset (&glb_gaspi_ctx_tcp, 0, sizeof (gaspi_tcp_ctx));
+
+  /* the comm queues take the rails in turn */
+  glb_gaspi_ctx_tcp.rails = gaspi_cfg->netdev_num;
+
+  if(tcp_dev_init_rails(gaspi_cfg->netdev_num) != 0)
+    {
+      gaspi_print_error("Failed to set up %u rails.", gaspi_cfg->netdev_num);
+      return -1;
+    }
   
   /* start virtual device (thread) */
   if(pthread_create(&tcp_dev_thread, NULL, tcp_virt_dev, NULL) != 0)
@@ -25,6 +25,10 @@ along with GPI-2. If not, see <http://www.gnu.org/licenses/>.
 
 #define QP_MAX_NUM 4096
 
+/* The rail (connections to each rank) the requests of a comm queue
+   take */
+#define GASPI_TCP_RAIL(queue) ((uint16_t) ((queue) % glb_gaspi_ctx_tcp.rails))
+
 typedef struct
 {
 
@@ -42,6 +46,8 @@ typedef struct
   /* Queues communication */
   struct tcp_cq *scqC[GASPI_MAX_QP];
   struct tcp_queue *qpC[GASPI_MAX_QP];
+
+  unsigned int rails;
   
 }  gaspi_tcp_ctx;
 
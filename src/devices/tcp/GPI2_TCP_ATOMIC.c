@@ -45,13 +45,14 @@ pgaspi_dev_atomic_fetch_add (const gaspi_segment_id_t segment_id,
     }
 
   //TODO: repeated code (what changes is the ctx)
-  glb_gaspi_ctx.ne_count_grp++; 
+  __sync_fetch_and_add (&glb_gaspi_ctx.ne_count_grp, 1);
 
   int ne = 0;
   int i;
   tcp_dev_wc_t wc;
   
-  for (i = 0; i < glb_gaspi_ctx.ne_count_grp; i++)
+  const int nr = glb_gaspi_ctx.ne_count_grp;
+  for (i = 0; i < nr; i++)
     {
       do
 	{
@@ -66,7 +67,7 @@ pgaspi_dev_atomic_fetch_add (const gaspi_segment_id_t segment_id,
     }
 
   //TODO: repeated code (what changes is the ctx)
-  glb_gaspi_ctx.ne_count_grp = 0;
+  __sync_fetch_and_sub (&glb_gaspi_ctx.ne_count_grp, nr);
 
   return GASPI_SUCCESS;
 }
@@ -98,13 +99,14 @@ pgaspi_dev_atomic_compare_swap (const gaspi_segment_id_t segment_id,
     }
 
   //TODO: repeated code (what changes is the ctx)
-  glb_gaspi_ctx.ne_count_grp++;
+  __sync_fetch_and_add (&glb_gaspi_ctx.ne_count_grp, 1);
 
   int ne = 0;
   int i;
   tcp_dev_wc_t wc;
   
-  for (i = 0; i < glb_gaspi_ctx.ne_count_grp; i++)
+  const int nr = glb_gaspi_ctx.ne_count_grp;
+  for (i = 0; i < nr; i++)
     {
       do
 	{
@@ -119,7 +121,7 @@ pgaspi_dev_atomic_compare_swap (const gaspi_segment_id_t segment_id,
     }
 
   //TODO: repeated code (what changes is the ctx)
-  glb_gaspi_ctx.ne_count_grp = 0;
+  __sync_fetch_and_sub (&glb_gaspi_ctx.ne_count_grp, nr);
   
   return GASPI_SUCCESS;
 }
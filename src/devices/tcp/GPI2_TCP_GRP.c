@@ -44,6 +44,68 @@ pgaspi_dev_post_group_write(void *local_addr, int length, int dst, void *remote_
   return 0;
 }
 
+/* Write between user segments on the collectives queue */
+int
+pgaspi_dev_post_group_segment_write(const gaspi_segment_id_t segment_id_local,
+				    const gaspi_offset_t offset_local,
+				    const int dst,
+				    const gaspi_segment_id_t segment_id_remote,
+				    const gaspi_offset_t offset_remote,
+				    const unsigned int length)
+{
+  tcp_dev_wr_t wr =
+    {
+      .cq_handle   = glb_gaspi_ctx_tcp.scqGroups->num,
+      .source      = glb_gaspi_ctx.rank,
+      .local_addr  = (uintptr_t) (glb_gaspi_ctx.rrmd[segment_id_local][glb_gaspi_ctx.rank].data.addr + offset_local),
+      .length      = length,
+      .swap        = 0,
+      .compare_add = 0,
+      .opcode      = POST_RDMA_WRITE,
+      .target      = dst,
+      .remote_addr = (glb_gaspi_ctx.rrmd[segment_id_remote][dst].data.addr + offset_remote),
+      .wr_id       = dst
+    };
+
+  if( write(glb_gaspi_ctx_tcp.qpGroups->handle, &wr, sizeof(tcp_dev_wr_t)) < (ssize_t) sizeof(tcp_dev_wr_t) )
+    {
+      return 1;
+    }
+
+  return 0;
+}
+
+/* Write from a user segment into the collectives buffer of a group */
+int
+pgaspi_dev_post_group_segment_buf_write(const gaspi_segment_id_t segment_id_local,
+					const gaspi_offset_t offset_local,
+					const int dst,
+					const gaspi_group_t group,
+					const gaspi_offset_t offset_remote,
+					const unsigned int length)
+{
+  tcp_dev_wr_t wr =
+    {
+      .cq_handle   = glb_gaspi_ctx_tcp.scqGroups->num,
+      .source      = glb_gaspi_ctx.rank,
+      .local_addr  = (uintptr_t) (glb_gaspi_ctx.rrmd[segment_id_local][glb_gaspi_ctx.rank].data.addr + offset_local),
+      .length      = length,
+      .swap        = 0,
+      .compare_add = 0,
+      .opcode      = POST_RDMA_WRITE,
+      .target      = dst,
+      .remote_addr = (glb_gaspi_group_ctx[group].rrcd[dst].data.addr + offset_remote),
+      .wr_id       = dst
+    };
+
+  if( write(glb_gaspi_ctx_tcp.qpGroups->handle, &wr, sizeof(tcp_dev_wr_t)) < (ssize_t) sizeof(tcp_dev_wr_t) )
+    {
+      return 1;
+    }
+
+  return 0;
+}
+
 /* TODO: number of elems to poll as arg */
 int
 pgaspi_dev_poll_groups(void)
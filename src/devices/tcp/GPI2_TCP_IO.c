@@ -17,6 +17,9 @@ along with GPI-2. If not, see <http://www.gnu.org/licenses/>.
 */
 #include "GASPI.h"
 #include "GPI2_TCP.h"
+#include "GPI2_Dev.h"
+
+extern gaspi_config_t glb_gaspi_cfg;
 
 /* Communication functions */
 gaspi_return_t
@@ -32,6 +35,7 @@ pgaspi_dev_write (const gaspi_segment_id_t segment_id_local,
     {
       .wr_id       = rank,
       .cq_handle   = glb_gaspi_ctx_tcp.scqC[queue]->num,
+      .rail        = GASPI_TCP_RAIL(queue),
       .source      = glb_gaspi_ctx.rank,
       .target      = rank,
       .local_addr  = (uintptr_t) (glb_gaspi_ctx.rrmd[segment_id_local][glb_gaspi_ctx.rank].data.addr + offset_local),
@@ -63,6 +67,7 @@ pgaspi_dev_read (const gaspi_segment_id_t segment_id_local,
     {
       .wr_id       = rank,
       .cq_handle   = glb_gaspi_ctx_tcp.scqC[queue]->num,
+      .rail        = GASPI_TCP_RAIL(queue),
       .source      = glb_gaspi_ctx.rank,
       .target       = rank,
       .local_addr  = (uintptr_t) (glb_gaspi_ctx.rrmd[segment_id_local][glb_gaspi_ctx.rank].data.addr + offset_local),
@@ -81,82 +86,105 @@ pgaspi_dev_read (const gaspi_segment_id_t segment_id_local,
   return GASPI_SUCCESS;
 }
 
-gaspi_return_t
-pgaspi_dev_purge (const gaspi_queue_id_t queue,
-		  int * counter,
-		  const gaspi_timeout_t timeout_ms)
+/* Take the completions of num requests of the queue, in batches.
+   Failed requests break the queue to their rank if report is set. */
+static gaspi_return_t
+_pgaspi_dev_poll_comm (const gaspi_queue_id_t queue,
+		       int *counter,
+		       const int num,
+		       const gaspi_timeout_t timeout_ms,
+		       const int report)
 {
-  int ne = 0, i;
-  tcp_dev_wc_t wc;
+  tcp_dev_wc_t wc[GASPI_DEV_WC_BATCH];
+  gaspi_return_t eret = GASPI_SUCCESS;
+  int done = 0, ne, i;
+
+  gaspi_waiter_t w;
+  long block_us;
 
-  const int nr = *counter;
-  const gaspi_cycles_t s0 = gaspi_get_cycles ();
+  gaspi_waiter_init (&w, timeout_ms);
 
-  for (i = 0; i < nr; i++)
+  while (done < num)
     {
-      do
+      const unsigned int seq = tcp_dev_progress_seq ();
+
+      ne = tcp_dev_return_wcs (glb_gaspi_ctx_tcp.scqC[queue], wc, MIN (num - done, GASPI_DEV_WC_BATCH));
+
+      if( ne < 0 )
 	{
-	  ne = tcp_dev_return_wc (glb_gaspi_ctx_tcp.scqC[queue], &wc);
-	  *counter -= ne;
+	  return GASPI_ERROR;
+	}
+
+      for (i = 0; i < ne; i++)
+	{
+	  const int reqs = GASPI_DEV_WR_REQS (wc[i].wr_id);
 
-	  if( ne == 0 )
+	  __sync_fetch_and_sub (counter, reqs);
+	  done += reqs;
+
+	  if( report && wc[i].status != TCP_WC_SUCCESS )
 	    {
-	      const gaspi_cycles_t s1 = gaspi_get_cycles ();
-	      const gaspi_cycles_t tdelta = s1 - s0;
-
-	      const float ms = (float) tdelta * glb_gaspi_ctx.cycles_to_msecs;
-	      if (ms > timeout_ms)
-		{
-		  return GASPI_TIMEOUT;
-		}
+	      glb_gaspi_ctx.qp_state_vec[queue][GASPI_DEV_WR_RANK (wc[i].wr_id)] = GASPI_STATE_CORRUPT;
+	      eret = GASPI_ERROR;
+	    }
+	}
+
+      if( eret != GASPI_SUCCESS )
+	{
+	  return eret;
+	}
+
+      if( ne == 0 )
+	{
+	  const int phase = gaspi_waiter_idle (&w, &block_us);
+
+	  if( phase == GASPI_WAIT_PHASE_EXPIRED )
+	    {
+	      return GASPI_TIMEOUT;
+	    }
+
+	  if( phase == GASPI_WAIT_PHASE_BLOCK )
+	    {
+	      tcp_dev_progress_wait (seq, block_us);
 	    }
 	}
-      while (ne == 0);
     }
 
   return GASPI_SUCCESS;
 }
 
+gaspi_return_t
+pgaspi_dev_purge (const gaspi_queue_id_t queue,
+		  int * counter,
+		  const gaspi_timeout_t timeout_ms)
+{
+  return _pgaspi_dev_poll_comm (queue, counter, *counter, timeout_ms, 0);
+}
+
 gaspi_return_t
 pgaspi_dev_wait (const gaspi_queue_id_t queue,
 		 int *counter,
+		 const int num,
 		 const gaspi_timeout_t timeout_ms)
 {
+  return _pgaspi_dev_poll_comm (queue, counter, num, timeout_ms, 1);
+}
 
-  int ne = 0, i;
-  tcp_dev_wc_t wc;
-
-  const int nr = *counter;
-  const gaspi_cycles_t s0 = gaspi_get_cycles ();
-
-  for (i = 0; i < nr; i++)
-    {
-      do
-	{
-	  ne = tcp_dev_return_wc (glb_gaspi_ctx_tcp.scqC[queue], &wc);
-	  *counter -= ne;
-
-	  if( ne == 0 )
-	    {
-	      const gaspi_cycles_t s1 = gaspi_get_cycles ();
-	      const gaspi_cycles_t tdelta = s1 - s0;
-
-	      const float ms = (float) tdelta * glb_gaspi_ctx.cycles_to_msecs;
-	      if (ms > timeout_ms)
-		{
-		  return GASPI_TIMEOUT;
-		}
-	    }
-	}
-      while (ne == 0);
+unsigned int
+pgaspi_dev_progress_seq (void)
+{
+  return tcp_dev_progress_seq ();
+}
 
-      if( (ne < 0) || (wc.status != TCP_WC_SUCCESS) )
-	{
-	  glb_gaspi_ctx.qp_state_vec[queue][wc.wr_id] = GASPI_STATE_CORRUPT;
-	  return GASPI_ERROR;
-	}
-    }
+void
+pgaspi_dev_progress_wait (const unsigned int seq, const long timeout_us)
+{
+  tcp_dev_progress_wait (seq, timeout_us);
+}
 
+gaspi_return_t
+pgaspi_dev_notify_status (void)
+{
   return GASPI_SUCCESS;
 }
 
@@ -175,6 +203,7 @@ pgaspi_dev_notify (const gaspi_segment_id_t segment_id_remote,
     {
       .wr_id       = rank,
       .cq_handle   = glb_gaspi_ctx_tcp.scqC[queue]->num,
+      .rail        = GASPI_TCP_RAIL(queue),
       .source      = glb_gaspi_ctx.rank,
       .target      = rank,
       .local_addr  = (uintptr_t) not_val_ptr,
@@ -184,6 +213,13 @@ pgaspi_dev_notify (const gaspi_segment_id_t segment_id_remote,
       .opcode      = POST_RDMA_WRITE_INLINED
     } ;
 
+  /* the target sets the summary flag (at swap) after the notification */
+  if( glb_gaspi_ctx.rrmd[segment_id_remote][rank].notif_summary )
+    {
+      wr.swap = glb_gaspi_ctx.rrmd[segment_id_remote][rank].notif_spc.addr
+	+ NOTIFY_SUMMARY_OFFSET + notification_id / NOTIFY_SUMMARY_BLOCK;
+    }
+
   if( write(glb_gaspi_ctx_tcp.qpC[queue]->handle, &wr, sizeof(tcp_dev_wr_t)) < (ssize_t) sizeof(tcp_dev_wr_t) )
     {
       return GASPI_ERROR;
@@ -193,6 +229,42 @@ pgaspi_dev_notify (const gaspi_segment_id_t segment_id_remote,
   
 }
 
+gaspi_return_t
+pgaspi_dev_notify_add (const gaspi_segment_id_t segment_id_remote,
+		       const gaspi_rank_t rank,
+		       const gaspi_notification_id_t notification_id,
+		       const gaspi_notification_t notification_value,
+		       const gaspi_queue_id_t queue)
+{
+  tcp_dev_wr_t wr =
+    {
+      .wr_id       = rank,
+      .cq_handle   = glb_gaspi_ctx_tcp.scqC[queue]->num,
+      .rail        = GASPI_TCP_RAIL(queue),
+      .source      = glb_gaspi_ctx.rank,
+      .target      = rank,
+      .local_addr  = 0,
+      .remote_addr = (glb_gaspi_ctx.rrmd[segment_id_remote][rank].notif_spc.addr + notification_id * sizeof(gaspi_notification_t)),
+      .length      = 0,
+      .swap        = 0,
+      .compare_add = notification_value,
+      .opcode      = POST_NOTIFY_ADD
+    } ;
+
+  if( glb_gaspi_ctx.rrmd[segment_id_remote][rank].notif_summary )
+    {
+      wr.swap = glb_gaspi_ctx.rrmd[segment_id_remote][rank].notif_spc.addr
+	+ NOTIFY_SUMMARY_OFFSET + notification_id / NOTIFY_SUMMARY_BLOCK;
+    }
+
+  if( write(glb_gaspi_ctx_tcp.qpC[queue]->handle, &wr, sizeof(tcp_dev_wr_t)) < (ssize_t) sizeof(tcp_dev_wr_t) )
+    {
+      return GASPI_ERROR;
+    }
+
+  return GASPI_SUCCESS;
+}
+
 gaspi_return_t
 pgaspi_dev_write_list (const gaspi_number_t num,
 		       gaspi_segment_id_t * const segment_id_local,
@@ -211,6 +283,7 @@ pgaspi_dev_write_list (const gaspi_number_t num,
 	{
 	  .wr_id       = rank,
 	  .cq_handle   = glb_gaspi_ctx_tcp.scqC[queue]->num,
+	  .rail        = GASPI_TCP_RAIL(queue),
 	  .source      = glb_gaspi_ctx.rank,
 	  .target        = rank,
 	  .local_addr  = (uintptr_t) (glb_gaspi_ctx.rrmd[segment_id_local[i]][glb_gaspi_ctx.rank].data.addr + offset_local[i]),
@@ -248,6 +321,7 @@ pgaspi_dev_read_list (const gaspi_number_t num,
 	{
 	  .wr_id       = rank,
 	  .cq_handle   = glb_gaspi_ctx_tcp.scqC[queue]->num,
+	  .rail        = GASPI_TCP_RAIL(queue),
 	  .source      = glb_gaspi_ctx.rank,
 	  .target        = rank,
 	  .local_addr  = (uintptr_t) (glb_gaspi_ctx.rrmd[segment_id_local[i]][glb_gaspi_ctx.rank].data.addr + offset_local[i]),
@@ -267,6 +341,150 @@ pgaspi_dev_read_list (const gaspi_number_t num,
   return GASPI_SUCCESS;
 }
 
+/* A read sets a local notification once its data is in place: the
+   request carries the notification (at compare_add) and its summary
+   flag (at swap, if any), which the response of the target brings
+   back */
+static inline void
+_pgaspi_dev_read_notify_wr (tcp_dev_wr_t * const wr,
+			    const gaspi_segment_id_t segment_id_notification,
+			    const gaspi_notification_id_t notification_id)
+{
+  const gaspi_rc_mseg * const seg = &glb_gaspi_ctx.rrmd[segment_id_notification][glb_gaspi_ctx.rank];
+
+  wr->compare_add = seg->notif_spc.addr + notification_id * sizeof(gaspi_notification_t);
+
+  if( seg->notif_summary )
+    {
+      wr->swap = seg->notif_spc.addr + NOTIFY_SUMMARY_OFFSET + notification_id / NOTIFY_SUMMARY_BLOCK;
+    }
+}
+
+gaspi_return_t
+pgaspi_dev_read_notify (const gaspi_segment_id_t segment_id_local,
+			const gaspi_offset_t offset_local,
+			const gaspi_rank_t rank,
+			const gaspi_segment_id_t segment_id_remote,
+			const gaspi_offset_t offset_remote,
+			const gaspi_size_t size,
+			const gaspi_notification_id_t notification_id,
+			const gaspi_queue_id_t queue)
+{
+  tcp_dev_wr_t wr =
+    {
+      .wr_id       = rank,
+      .cq_handle   = glb_gaspi_ctx_tcp.scqC[queue]->num,
+      .rail        = GASPI_TCP_RAIL(queue),
+      .source      = glb_gaspi_ctx.rank,
+      .target      = rank,
+      .local_addr  = (uintptr_t) (glb_gaspi_ctx.rrmd[segment_id_local][glb_gaspi_ctx.rank].data.addr + offset_local),
+      .remote_addr = (glb_gaspi_ctx.rrmd[segment_id_remote][rank].data.addr + offset_remote),
+      .length      = size,
+      .swap        = 0,
+      .compare_add = 0,
+      .opcode      = POST_RDMA_READ
+    } ;
+
+  _pgaspi_dev_read_notify_wr (&wr, segment_id_local, notification_id);
+
+  if( write(glb_gaspi_ctx_tcp.qpC[queue]->handle, &wr, sizeof(tcp_dev_wr_t)) < (ssize_t) sizeof(tcp_dev_wr_t) )
+    {
+      return GASPI_ERROR;
+    }
+
+  return GASPI_SUCCESS;
+}
+
+/* The responses of the reads to a rank come back in order: the last
+   one sets the notification */
+gaspi_return_t
+pgaspi_dev_read_list_notify (const gaspi_number_t num,
+			     gaspi_segment_id_t * const segment_id_local,
+			     gaspi_offset_t * const offset_local,
+			     const gaspi_rank_t rank,
+			     gaspi_segment_id_t * const segment_id_remote,
+			     gaspi_offset_t * const offset_remote,
+			     gaspi_size_t * const size,
+			     const gaspi_segment_id_t segment_id_notification,
+			     const gaspi_notification_id_t notification_id,
+			     const gaspi_queue_id_t queue)
+{
+  gaspi_number_t i;
+
+  for (i = 0; i < num; i++)
+    {
+      tcp_dev_wr_t wr =
+	{
+	  .wr_id       = rank,
+	  .cq_handle   = glb_gaspi_ctx_tcp.scqC[queue]->num,
+	  .rail        = GASPI_TCP_RAIL(queue),
+	  .source      = glb_gaspi_ctx.rank,
+	  .target      = rank,
+	  .local_addr  = (uintptr_t) (glb_gaspi_ctx.rrmd[segment_id_local[i]][glb_gaspi_ctx.rank].data.addr + offset_local[i]),
+	  .remote_addr = (glb_gaspi_ctx.rrmd[segment_id_remote[i]][rank].data.addr + offset_remote[i]),
+	  .length      = size[i],
+	  .swap        = 0,
+	  .compare_add = 0,
+	  .opcode      = POST_RDMA_READ
+	} ;
+
+      if( i == num - 1 )
+	{
+	  _pgaspi_dev_read_notify_wr (&wr, segment_id_notification, notification_id);
+	}
+
+      if( write(glb_gaspi_ctx_tcp.qpC[queue]->handle, &wr, sizeof(tcp_dev_wr_t)) < (ssize_t) sizeof(tcp_dev_wr_t) )
+	{
+	  return GASPI_ERROR;
+	}
+    }
+
+  return GASPI_SUCCESS;
+}
+
+/* A write and its notification as one message (notify_mode
+   GASPI_NOTIFY_FUSED): the target sets the notification once the data
+   is in place */
+static gaspi_return_t
+_pgaspi_dev_write_notify_fused (const gaspi_segment_id_t segment_id_local,
+				const gaspi_offset_t offset_local,
+				const gaspi_rank_t rank,
+				const gaspi_segment_id_t segment_id_remote,
+				const gaspi_offset_t offset_remote,
+				const gaspi_size_t size,
+				const gaspi_segment_id_t segment_id_notification,
+				const gaspi_notification_id_t notification_id,
+				const gaspi_notification_t notification_value,
+				const gaspi_queue_id_t queue)
+{
+  tcp_dev_wr_t wr =
+    {
+      .wr_id       = rank,
+      .cq_handle   = glb_gaspi_ctx_tcp.scqC[queue]->num,
+      .rail        = GASPI_TCP_RAIL(queue),
+      .source      = glb_gaspi_ctx.rank,
+      .target      = rank,
+      .local_addr  = (uintptr_t) (glb_gaspi_ctx.rrmd[segment_id_local][glb_gaspi_ctx.rank].data.addr + offset_local),
+      .remote_addr = (glb_gaspi_ctx.rrmd[segment_id_remote][rank].data.addr + offset_remote),
+      .length      = size,
+      .swap        = glb_gaspi_ctx.rrmd[segment_id_notification][rank].notif_spc.addr,
+      .compare_add = ((uint64_t) notification_value << 32) | notification_id,
+      .opcode      = POST_RDMA_WRITE_NOTIFY
+    } ;
+
+  if( glb_gaspi_ctx.rrmd[segment_id_notification][rank].notif_summary )
+    {
+      wr.swap |= 1;
+    }
+
+  if( write(glb_gaspi_ctx_tcp.qpC[queue]->handle, &wr, sizeof(tcp_dev_wr_t)) < (ssize_t) sizeof(tcp_dev_wr_t) )
+    {
+      return GASPI_ERROR;
+    }
+
+  return GASPI_SUCCESS;
+}
+
 gaspi_return_t
 pgaspi_dev_write_notify (const gaspi_segment_id_t segment_id_local,
 			 const gaspi_offset_t offset_local,
@@ -278,6 +496,14 @@ pgaspi_dev_write_notify (const gaspi_segment_id_t segment_id_local,
 			 const gaspi_notification_t notification_value,
 			 const gaspi_queue_id_t queue){
 
+  if( GASPI_NOTIFY_FUSED == glb_gaspi_cfg.notify_mode )
+    {
+      return _pgaspi_dev_write_notify_fused(segment_id_local, offset_local, rank,
+					    segment_id_remote, offset_remote, size,
+					    segment_id_remote, notification_id, notification_value,
+					    queue);
+    }
+
   if( pgaspi_dev_write(segment_id_local, offset_local, rank,
 		       segment_id_remote, offset_remote, size,
 		       queue) != GASPI_SUCCESS)
@@ -288,6 +514,27 @@ pgaspi_dev_write_notify (const gaspi_segment_id_t segment_id_local,
   return pgaspi_dev_notify(segment_id_remote, rank, notification_id, notification_value, queue);
 }
 
+gaspi_return_t
+pgaspi_dev_write_notify_add (const gaspi_segment_id_t segment_id_local,
+			     const gaspi_offset_t offset_local,
+			     const gaspi_rank_t rank,
+			     const gaspi_segment_id_t segment_id_remote,
+			     const gaspi_offset_t offset_remote,
+			     const gaspi_size_t size,
+			     const gaspi_notification_id_t notification_id,
+			     const gaspi_notification_t notification_value,
+			     const gaspi_queue_id_t queue)
+{
+  if( pgaspi_dev_write(segment_id_local, offset_local, rank,
+		       segment_id_remote, offset_remote, size,
+		       queue) != GASPI_SUCCESS)
+    {
+      return GASPI_ERROR;
+    }
+
+  return pgaspi_dev_notify_add(segment_id_remote, rank, notification_id, notification_value, queue);
+}
+
 gaspi_return_t
 pgaspi_dev_write_list_notify (const gaspi_number_t num,
 			      gaspi_segment_id_t * const segment_id_local,
@@ -301,6 +548,24 @@ pgaspi_dev_write_list_notify (const gaspi_number_t num,
 			      const gaspi_notification_t notification_value,
 			      const gaspi_queue_id_t queue)
 {
+  /* fused, the notification goes with the last write */
+  if( GASPI_NOTIFY_FUSED == glb_gaspi_cfg.notify_mode )
+    {
+      const gaspi_number_t l = num - 1;
+
+      if( pgaspi_dev_write_list(l, segment_id_local, offset_local, rank,
+				segment_id_remote, offset_remote, size,
+				queue) != GASPI_SUCCESS)
+	{
+	  return GASPI_ERROR;
+	}
+
+      return _pgaspi_dev_write_notify_fused(segment_id_local[l], offset_local[l], rank,
+					    segment_id_remote[l], offset_remote[l], size[l],
+					    segment_id_notification, notification_id, notification_value,
+					    queue);
+    }
+
   //TODO: check different with and without extra function calls
   if( pgaspi_dev_write_list(num, segment_id_local, offset_local, rank,
 			    segment_id_remote, offset_remote, size,
@@ -311,3 +576,90 @@ pgaspi_dev_write_list_notify (const gaspi_number_t num,
 
   return pgaspi_dev_notify(segment_id_notification, rank, notification_id, notification_value, queue);
 }
+
+/* Strided transfers: the device gets a copy of the shape, which it
+   releases, and moves the blocks as one message */
+int
+pgaspi_dev_strided_requests (const gaspi_strided_t * const shape)
+{
+  return 1;
+}
+
+static gaspi_return_t
+_pgaspi_dev_post_strided (const int opcode,
+			  const gaspi_segment_id_t segment_id_local,
+			  const gaspi_offset_t offset_local,
+			  const gaspi_rank_t rank,
+			  const gaspi_segment_id_t segment_id_remote,
+			  const gaspi_offset_t offset_remote,
+			  const gaspi_strided_t * const shape,
+			  const gaspi_queue_id_t queue)
+{
+  gaspi_strided_t *copy = malloc (sizeof (gaspi_strided_t));
+
+  if( copy == NULL )
+    {
+      return GASPI_ERR_MEMALLOC;
+    }
+
+  *copy = *shape;
+
+  tcp_dev_wr_t wr =
+    {
+      .wr_id       = rank,
+      .cq_handle   = glb_gaspi_ctx_tcp.scqC[queue]->num,
+      .rail        = GASPI_TCP_RAIL(queue),
+      .source      = glb_gaspi_ctx.rank,
+      .target      = rank,
+      .local_addr  = (uintptr_t) (glb_gaspi_ctx.rrmd[segment_id_local][glb_gaspi_ctx.rank].data.addr + offset_local),
+      .remote_addr = (glb_gaspi_ctx.rrmd[segment_id_remote][rank].data.addr + offset_remote),
+      .length      = shape->block * shape->count[0] * shape->count[1] * shape->count[2],
+      .swap        = (uintptr_t) copy,
+      .compare_add = 0,
+      .opcode      = opcode
+    } ;
+
+  if( write(glb_gaspi_ctx_tcp.qpC[queue]->handle, &wr, sizeof(tcp_dev_wr_t)) < (ssize_t) sizeof(tcp_dev_wr_t) )
+    {
+      free (copy);
+      return GASPI_ERROR;
+    }
+
+  return GASPI_SUCCESS;
+}
+
+gaspi_return_t
+pgaspi_dev_write_strided (const gaspi_segment_id_t segment_id_local,
+			  const gaspi_offset_t offset_local,
+			  const gaspi_rank_t rank,
+			  const gaspi_segment_id_t segment_id_remote,
+			  const gaspi_offset_t offset_remote,
+			  const gaspi_strided_t * const shape,
+			  const gaspi_queue_id_t queue,
+			  int * const reqs)
+{
+  *reqs = 1;
+
+  return _pgaspi_dev_post_strided (POST_RDMA_WRITE_STRIDED,
+				   segment_id_local, offset_local, rank,
+				   segment_id_remote, offset_remote,
+				   shape, queue);
+}
+
+gaspi_return_t
+pgaspi_dev_read_strided (const gaspi_segment_id_t segment_id_local,
+			 const gaspi_offset_t offset_local,
+			 const gaspi_rank_t rank,
+			 const gaspi_segment_id_t segment_id_remote,
+			 const gaspi_offset_t offset_remote,
+			 const gaspi_strided_t * const shape,
+			 const gaspi_queue_id_t queue,
+			 int * const reqs)
+{
+  *reqs = 1;
+
+  return _pgaspi_dev_post_strided (POST_RDMA_READ_STRIDED,
+				   segment_id_local, offset_local, rank,
+				   segment_id_remote, offset_remote,
+				   shape, queue);
+}
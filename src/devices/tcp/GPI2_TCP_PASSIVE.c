@@ -28,7 +28,8 @@ pgaspi_dev_passive_send (const gaspi_segment_id_t segment_id,
 			 const gaspi_timeout_t timeout_ms) 
 {
 
-  gaspi_cycles_t s0;
+  gaspi_waiter_t w;
+  long block_us;
 
   const int byte_id = rank >> 3;
   const int bit_pos = rank - (byte_id * 8);
@@ -61,25 +62,30 @@ pgaspi_dev_passive_send (const gaspi_segment_id_t segment_id,
   passive_counter[byte_id] |= bit_cmp;
   
  checkL:
-  s0 = gaspi_get_cycles();
+  gaspi_waiter_init (&w, timeout_ms);
 
   int ne = 0;
   tcp_dev_wc_t wc;
 
   do
     {
+      const unsigned int seq = tcp_dev_progress_seq ();
+
       ne = tcp_dev_return_wc (glb_gaspi_ctx_tcp.scqP, &wc);
 
       if(ne  == 0 )
 	{
-	  const gaspi_cycles_t s1 = gaspi_get_cycles ();
-	  const gaspi_cycles_t tdelta = s1 - s0;
+	  const int phase = gaspi_waiter_idle (&w, &block_us);
 
-	  const float ms = (float) tdelta * glb_gaspi_ctx.cycles_to_msecs;
-	  if( ms > timeout_ms )
+	  if( phase == GASPI_WAIT_PHASE_EXPIRED )
 	    {
 	      return GASPI_TIMEOUT;
 	    }
+
+	  if( phase == GASPI_WAIT_PHASE_BLOCK )
+	    {
+	      tcp_dev_progress_wait (seq, block_us);
+	    }
 	}
     }
   while (ne == 0);
@@ -47,3 +47,21 @@ inline int remove_ringbuffer(ringbuffer *rb, void **data)
 
   return ret;
 }
+
+/* Remove up to max elements at once, returns how many */
+inline int remove_ringbuffer_n(ringbuffer *rb, void **data, int max)
+{
+  int n = 0;
+
+  pthread_mutex_lock(&cq_lock);
+
+  while(n < max && rb->ipos != rb->rpos)
+  {
+    data[n++] = rb->cells[rb->rpos].data;
+    rb->rpos = (rb->rpos+1) % rb->mask;
+  }
+
+  pthread_mutex_unlock(&cq_lock);
+
+  return n;
+}
@@ -20,6 +20,7 @@ typedef struct ringbuffer ringbuffer;
 
 int insert_ringbuffer(ringbuffer *rb, void *data);
 int remove_ringbuffer(ringbuffer *rb, void **data);
+int remove_ringbuffer_n(ringbuffer *rb, void **data, int max);
 
 
 #endif
@@ -25,8 +25,12 @@ along with GPI-2. If not, see <http://www.gnu.org/licenses/>.
 #include <sys/types.h>
 #include <sys/un.h>
 #include <unistd.h>
+#include <net/if.h>
 #include <linux/if_link.h>
+#include <linux/futex.h>
 #include <ifaddrs.h>
+#include <limits.h>
+#include <sys/syscall.h>
 
 
 #ifdef __linux__
@@ -42,6 +46,11 @@ along with GPI-2. If not, see <http://www.gnu.org/licenses/>.
 volatile gaspi_tcp_dev_status_t gaspi_tcp_dev_status = GASPI_TCP_DEV_STATUS_DOWN;
 tcp_dev_conn_state_t **rank_state = NULL;
 
+/* the rails: the connections to each rank (rank_state[rail * tnc +
+   rank]) and the local address of each */
+static int tcp_dev_rails = 1;
+static struct in_addr tcp_dev_rail_addr[GASPI_MAX_RAILS];
+
 /* list of remote operations */
 list delayedList =
   {
@@ -67,6 +76,11 @@ int epollfd;
 
 struct tcp_cq *cqs_map[CQ_MAX_NUM];
 
+/* progress count (a futex) bumped for every completion and incoming
+   write, and the number of threads blocked on it */
+static volatile unsigned int tcp_dev_progress = 0;
+static volatile int tcp_dev_progress_waiters = 0;
+
 struct tcp_passive_channel *
 tcp_dev_create_passive_channel(void)
 {
@@ -90,23 +104,42 @@ tcp_dev_create_passive_channel(void)
 int
 tcp_dev_is_valid_state(gaspi_rank_t i)
 {
+  int rail;
+
   if( i < glb_gaspi_ctx.tnc )
     {
       if(rank_state != NULL)
 	{
-	  if(rank_state[i] != NULL)
+	  for(rail = 0; rail < tcp_dev_rails; rail++)
 	    {
-	      if(rank_state[i]->fd < 0)
+	      const tcp_dev_conn_state_t *state = rank_state[rail * glb_gaspi_ctx.tnc + i];
+
+	      if(state == NULL || state->fd < 0)
 		return 0;
-	      else
-		return 1;
 	    }
+
+	  return 1;
 	}
     }
 
   return 0;
 }
 
+/* All the rails to a rank are registered */
+static int
+_tcp_dev_rails_registered(const int rank)
+{
+  int rail;
+
+  for(rail = 0; rail < tcp_dev_rails; rail++)
+    {
+      if(rank_state[rail * glb_gaspi_ctx.tnc + rank] == NULL)
+	return 0;
+    }
+
+  return 1;
+}
+
 void
 tcp_dev_destroy_passive_channel(struct tcp_passive_channel *channel)
 {
@@ -242,7 +275,7 @@ _tcp_dev_alloc_remote_states (int n)
   if(rank_state != NULL)
     return 0;
 
-  rank_state = (tcp_dev_conn_state_t **) calloc(n, sizeof(tcp_dev_conn_state_t *));
+  rank_state = (tcp_dev_conn_state_t **) calloc(n * tcp_dev_rails, sizeof(tcp_dev_conn_state_t *));
   if(rank_state == NULL)
    {
       gaspi_print_error("Failed to allocate memory");
@@ -254,7 +287,7 @@ _tcp_dev_alloc_remote_states (int n)
 
 
 static inline tcp_dev_conn_state_t *
-_tcp_dev_add_new_conn(int rank, int conn_sock, int pollfd)
+_tcp_dev_add_new_conn(int rank, int rail, int conn_sock, int pollfd)
 {
   tcp_dev_conn_state_t *nstate = (tcp_dev_conn_state_t *) malloc(sizeof(tcp_dev_conn_state_t));
   if(nstate == NULL)
@@ -265,6 +298,7 @@ _tcp_dev_add_new_conn(int rank, int conn_sock, int pollfd)
 
   nstate->fd              = conn_sock;
   nstate->rank            = rank;
+  nstate->rail            = rail;
   nstate->read.wr_id      = 0;
   nstate->read.cq_handle  = CQ_HANDLE_NONE;
   nstate->read.opcode     = RECV_HEADER;
@@ -323,22 +357,25 @@ tcp_dev_get_local_if(char *ip)
 			  NULL, 0, NI_NUMERICHOST);
 	  if (s != 0)
 	    {
+	      freeifaddrs(ifaddr);
 	      return NULL;
 	    }
 
 	  if( strcmp(ip, host) == 0 )
 	    {
-	      char *myifa = malloc(8);
+	      char *myifa = malloc(IF_NAMESIZE + 1);
 	      if( myifa != NULL)
 		{
-		  sprintf(myifa, "%-8s", ifa->ifa_name);
+		  snprintf(myifa, IF_NAMESIZE + 1, "%-8s", ifa->ifa_name);
 		}
 
+	      freeifaddrs(ifaddr);
 	      return myifa;
 	    }
 	}
     }
 
+  freeifaddrs(ifaddr);
   return NULL;
 }
 
@@ -366,77 +403,251 @@ tcp_dev_get_local_ip(void)
   return inet_ntoa(addr);
 }
 
+/* The local addresses of the rails: the first is the one of the host
+   name, the others the remaining IPv4 addresses of the interfaces that
+   are up (loopback ones only if the host name is local), in turn if
+   there are fewer than rails. Each rank connects the rails from its
+   addresses to the ones of the remote rank. */
 int
-tcp_dev_connect_to(int i)
+tcp_dev_init_rails(const int num)
 {
-  /* no connections state map? */
-  if(rank_state == NULL)
+  struct in_addr others[GASPI_MAX_RAILS];
+  struct ifaddrs *ifaddr, *ifa;
+  int n = 0, rail;
+
+  tcp_dev_rails = num;
+
+  if(num == 1)
+    return 0;
+
+  const char *ip = tcp_dev_get_local_ip();
+  if(ip == NULL || inet_aton(ip, &tcp_dev_rail_addr[0]) == 0)
     {
+      gaspi_print_error("Failed to get the address of rank %u.", glb_gaspi_ctx.rank);
       return 1;
     }
 
-  /* connection already exists? */
-  if((rank_state[i] != NULL))
+  if(getifaddrs(&ifaddr) == -1)
     {
-      return 0;
+      gaspi_print_error("Failed to get the network interfaces.");
+      return 1;
     }
 
-  /* connect to node/rank */
-  int conn_sock = gaspi_sn_connect2port(gaspi_get_hn(i),
-				     TCP_DEV_PORT + glb_gaspi_ctx.poff[i],
-				     CONN_TIMEOUT);
+  const int local = ((ntohl(tcp_dev_rail_addr[0].s_addr) >> 24) == IN_LOOPBACKNET);
 
-  if(conn_sock == -1)
+  for(ifa = ifaddr; ifa != NULL && n < num - 1; ifa = ifa->ifa_next)
     {
-      gaspi_print_error("Error connecting to rank %i (%s) on port %i.",
-			i,
-			gaspi_get_hn(i),
-			TCP_DEV_PORT + glb_gaspi_ctx.poff[i]);
-      return 1;
+      if(ifa->ifa_addr == NULL
+	 || ifa->ifa_addr->sa_family != AF_INET
+	 || !(ifa->ifa_flags & IFF_UP)
+	 || ((ifa->ifa_flags & IFF_LOOPBACK) && !local))
+	continue;
+
+      const struct in_addr addr = ((struct sockaddr_in *) ifa->ifa_addr)->sin_addr;
+
+      if(addr.s_addr != tcp_dev_rail_addr[0].s_addr)
+	{
+	  others[n++] = addr;
+	}
+    }
+
+  freeifaddrs(ifaddr);
+
+  for(rail = 1; rail < num; rail++)
+    {
+      tcp_dev_rail_addr[rail] = (n > 0) ? others[(rail - 1) % n] : tcp_dev_rail_addr[0];
     }
 
-  /* prepare work request */
+  return 0;
+}
+
+char*
+tcp_dev_get_rail_ip(const int rail)
+{
+  return inet_ntoa(tcp_dev_rail_addr[rail]);
+}
+
+/* Connect a rail other than the first, from its local address */
+static int
+_tcp_dev_connect_rail(const int rail, const struct in_addr *addr, const unsigned short port)
+{
+  struct sockaddr_in local =
+    {
+      .sin_family = AF_INET,
+      .sin_port = 0,
+      .sin_addr = tcp_dev_rail_addr[rail]
+    };
+
+  struct sockaddr_in remote =
+    {
+      .sin_family = AF_INET,
+      .sin_port = htons(port),
+      .sin_addr = *addr
+    };
+
+  int opt = 1;
+
+  const int sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if(sock < 0)
+    {
+      return -1;
+    }
+
+  if(bind(sock, (struct sockaddr *) &local, sizeof(local)) < 0
+     || connect(sock, (struct sockaddr *) &remote, sizeof(remote)) < 0
+     || setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt)) < 0)
+    {
+      close(sock);
+      return -1;
+    }
+
+  return sock;
+}
+
+/* Answer the registration of the first rail of a rank with the
+   addresses of the rails */
+static int
+_tcp_dev_send_rails(const tcp_dev_conn_state_t *estate)
+{
   tcp_dev_wr_t wr;
   memset(&wr, 0, sizeof(tcp_dev_wr_t));
 
-  wr.wr_id       = glb_gaspi_ctx.tnc;
-  wr.cq_handle   = CQ_HANDLE_NONE;
-  wr.source      = glb_gaspi_ctx.rank;
-  wr.local_addr  = (uintptr_t) NULL;
-  wr.target      = i;
-  wr.remote_addr = (uintptr_t) NULL;
-  wr.length      = sizeof(tcp_dev_wr_t);
-  wr.opcode      = REGISTER_PEER;
+  wr.wr_id     = glb_gaspi_ctx.tnc;
+  wr.cq_handle = CQ_HANDLE_NONE;
+  wr.source    = glb_gaspi_ctx.rank;
+  wr.target    = estate->rank;
+  wr.length    = tcp_dev_rails * sizeof(struct in_addr);
+  wr.opcode    = REGISTER_PEER;
 
-  if(write(conn_sock, &wr, sizeof(tcp_dev_wr_t)) < 0)
+  if(gaspi_sn_writen(estate->fd, &wr, sizeof(tcp_dev_wr_t)) != sizeof(tcp_dev_wr_t)
+     || gaspi_sn_writen(estate->fd, tcp_dev_rail_addr, wr.length) != (ssize_t) wr.length)
     {
-      gaspi_print_error("Failed to send registration request to rank %i (%s)\n",
-			i, gaspi_get_hn(i));
-      close(conn_sock);
+      gaspi_print_error("Failed to send the rails to rank %i.", estate->rank);
       return 1;
     }
 
-  gaspi_sn_set_non_blocking(conn_sock);
+  return 0;
+}
+
+int
+tcp_dev_connect_to(int i)
+{
+  struct in_addr rail_addr[GASPI_MAX_RAILS];
+  int rail;
 
-  /* add new socket to epoll instance */
-  tcp_dev_conn_state_t *nstate;
-  nstate = _tcp_dev_add_new_conn(i, conn_sock, epollfd);
-  if( nstate == NULL)
+  /* no connections state map? */
+  if(rank_state == NULL)
     {
-      gaspi_print_error("Failed to add new connection to events instance");
       return 1;
     }
 
-  /* register rank */
-  rank_state[i] = nstate;
+  /* connection already exists? (the rank may still be connecting the
+     other rails) */
+  if((rank_state[i] != NULL))
+    {
+      while(!_tcp_dev_rails_registered(i))
+	{
+	  if(rank_state[i]->fd < 0)
+	    {
+	      return 1;
+	    }
+
+	  gaspi_delay();
+	}
+
+      return 0;
+    }
+
+  for(rail = 0; rail < tcp_dev_rails; rail++)
+    {
+      /* connect to node/rank */
+      int conn_sock;
+
+      if(rail == 0)
+	{
+	  conn_sock = gaspi_sn_connect2port(gaspi_get_hn(i),
+					    TCP_DEV_PORT + glb_gaspi_ctx.poff[i],
+					    CONN_TIMEOUT);
+	}
+      else
+	{
+	  conn_sock = _tcp_dev_connect_rail(rail, &rail_addr[rail],
+					    TCP_DEV_PORT + glb_gaspi_ctx.poff[i]);
+	}
+
+      if(conn_sock == -1)
+	{
+	  gaspi_print_error("Error connecting to rank %i (%s) on port %i (rail %d).",
+			    i,
+			    gaspi_get_hn(i),
+			    TCP_DEV_PORT + glb_gaspi_ctx.poff[i],
+			    rail);
+	  return 1;
+	}
+
+      /* prepare work request */
+      tcp_dev_wr_t wr;
+      memset(&wr, 0, sizeof(tcp_dev_wr_t));
+
+      wr.wr_id       = glb_gaspi_ctx.tnc;
+      wr.cq_handle   = CQ_HANDLE_NONE;
+      wr.source      = glb_gaspi_ctx.rank;
+      wr.local_addr  = (uintptr_t) NULL;
+      wr.target      = i;
+      wr.rail        = rail;
+      wr.remote_addr = (uintptr_t) NULL;
+      wr.length      = sizeof(tcp_dev_wr_t);
+      wr.opcode      = REGISTER_PEER;
+
+      if(write(conn_sock, &wr, sizeof(tcp_dev_wr_t)) < 0)
+	{
+	  gaspi_print_error("Failed to send registration request to rank %i (%s)\n",
+			    i, gaspi_get_hn(i));
+	  close(conn_sock);
+	  return 1;
+	}
+
+      /* the rank answers the first rail with the addresses of all */
+      if(rail == 0 && tcp_dev_rails > 1)
+	{
+	  tcp_dev_wr_t reply;
+
+	  if(gaspi_sn_readn(conn_sock, &reply, sizeof(tcp_dev_wr_t)) != sizeof(tcp_dev_wr_t)
+	     || reply.opcode != REGISTER_PEER
+	     || reply.length != tcp_dev_rails * sizeof(struct in_addr)
+	     || gaspi_sn_readn(conn_sock, rail_addr, reply.length) != (ssize_t) reply.length)
+	    {
+	      gaspi_print_error("Failed to get the rails of rank %i (%s)",
+				i, gaspi_get_hn(i));
+	      close(conn_sock);
+	      return 1;
+	    }
+	}
+
+      gaspi_sn_set_non_blocking(conn_sock);
+
+      /* add new socket to epoll instance */
+      tcp_dev_conn_state_t *nstate;
+      nstate = _tcp_dev_add_new_conn(i, rail, conn_sock, epollfd);
+      if( nstate == NULL)
+	{
+	  gaspi_print_error("Failed to add new connection to events instance");
+	  return 1;
+	}
+
+      /* register rank */
+      rank_state[rail * glb_gaspi_ctx.tnc + i] = nstate;
+    }
 
   return 0;
 }
 
+/* Take up to max (at most WC_MAX_BATCH) completions at once */
 inline int
-tcp_dev_return_wc(struct tcp_cq *cq, tcp_dev_wc_t *wc)
+tcp_dev_return_wcs(struct tcp_cq *cq, tcp_dev_wc_t *wc, const int max)
 {
-  void *ret;
+  void *ret[WC_MAX_BATCH];
+  int n, i;
 
   if(cq->rbuf == NULL)
     {
@@ -444,12 +655,55 @@ tcp_dev_return_wc(struct tcp_cq *cq, tcp_dev_wc_t *wc)
       return -1;
     }
 
-  if(remove_ringbuffer(cq->rbuf, &ret) < 0)
-    return 0;
+  n = remove_ringbuffer_n(cq->rbuf, ret, MIN(max, WC_MAX_BATCH));
 
-  *wc = *((tcp_dev_wc_t *) ret);
+  for(i = 0; i < n; i++)
+    {
+      wc[i] = *((tcp_dev_wc_t *) ret[i]);
+      free(ret[i]);
+    }
 
-  return 1;
+  return n;
+}
+
+inline int
+tcp_dev_return_wc(struct tcp_cq *cq, tcp_dev_wc_t *wc)
+{
+  return tcp_dev_return_wcs(cq, wc, 1);
+}
+
+static inline void
+_tcp_dev_progress_signal(void)
+{
+  __sync_fetch_and_add(&tcp_dev_progress, 1);
+
+  if( tcp_dev_progress_waiters > 0 )
+    {
+      syscall(SYS_futex, &tcp_dev_progress, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+    }
+}
+
+unsigned int
+tcp_dev_progress_seq(void)
+{
+  return tcp_dev_progress;
+}
+
+void
+tcp_dev_progress_wait(const unsigned int seq, const long timeout_us)
+{
+  struct timespec timeout =
+    {
+      .tv_sec  = timeout_us / 1000000,
+      .tv_nsec = (timeout_us % 1000000) * 1000
+    };
+
+  __sync_fetch_and_add(&tcp_dev_progress_waiters, 1);
+
+  /* returns at once if the count is no longer seq */
+  syscall(SYS_futex, &tcp_dev_progress, FUTEX_WAIT_PRIVATE, seq, &timeout, NULL, 0);
+
+  __sync_fetch_and_sub(&tcp_dev_progress_waiters, 1);
 }
 
 /* Post a work completion */
@@ -469,6 +723,7 @@ _tcp_dev_post_wc(uint64_t wr_id,
   wc->wr_id  = wr_id;
   wc->status = status;
   wc->opcode = opcode;
+  wc->sender = wr_id;
 
   /* TODO: better approach when queue is full ? */
   while(insert_ringbuffer(cqs_map[cq_handle]->rbuf, wc) < 0)
@@ -477,11 +732,12 @@ _tcp_dev_post_wc(uint64_t wr_id,
       __asm__ ( "pause;" );/* TODO */
     }
 
+  _tcp_dev_progress_signal();
+
   /* acknowledge receiver (if that's the case) */
   if(opcode == TCP_DEV_WC_RECV)
     {
       char ping = 1;
-      wc->sender = wr_id;
 
       if( write(cqs_map[cq_handle]->pchannel->write, &ping, 1) < 1)
 	{
@@ -493,6 +749,123 @@ _tcp_dev_post_wc(uint64_t wr_id,
   return 0;
 }
 
+/* Set the summary flag a notification write carries, once the
+   notification itself is in place */
+static inline void
+_tcp_dev_set_notify_summary(const uint64_t flag_addr)
+{
+  if(flag_addr)
+    {
+      __sync_synchronize();
+      *((volatile unsigned char *) flag_addr) = 1;
+    }
+}
+
+/* Set the notification a fused write carries, once its data is in
+   place */
+static inline void
+_tcp_dev_set_write_notify(const tcp_dev_wr_t *wr)
+{
+  const uint64_t notif_spc = wr->swap & ~1UL;
+  const uint32_t id = (uint32_t) (wr->compare_add & 0xffff);
+
+  __sync_synchronize();
+  ((volatile gaspi_notification_t *) notif_spc)[id] = (gaspi_notification_t) (wr->compare_add >> 32);
+
+  if(wr->swap & 1)
+    {
+      _tcp_dev_set_notify_summary(notif_spc + NOTIFY_SUMMARY_OFFSET + id / NOTIFY_SUMMARY_BLOCK);
+    }
+}
+
+/* Set the local notification a read carries (compare_add, with its
+   summary flag at swap) once its data is in place */
+static inline void
+_tcp_dev_set_read_notify(const tcp_dev_wr_t *wr)
+{
+  if(wr->compare_add)
+    {
+      __sync_synchronize();
+      *((volatile gaspi_notification_t *) wr->compare_add) = 1;
+
+      _tcp_dev_set_notify_summary(wr->swap);
+      _tcp_dev_progress_signal();
+    }
+}
+
+/* Copy the blocks of a strided transfer, each side with its strides
+   (NULL for the packed blocks of a message) */
+static void
+_tcp_dev_strided_copy(char *dst, const gaspi_size_t *dst_stride,
+		      const char *src, const gaspi_size_t *src_stride,
+		      const gaspi_strided_t *shape)
+{
+  gaspi_size_t packed[GASPI_STRIDED_MAX_DIMS];
+  gaspi_number_t i, j, k;
+  int d;
+
+  packed[0] = shape->block;
+  for(d = 1; d < GASPI_STRIDED_MAX_DIMS; d++)
+    {
+      packed[d] = packed[d - 1] * shape->count[d - 1];
+    }
+
+  if(dst_stride == NULL)
+    dst_stride = packed;
+  if(src_stride == NULL)
+    src_stride = packed;
+
+  for(k = 0; k < shape->count[2]; k++)
+    for(j = 0; j < shape->count[1]; j++)
+      for(i = 0; i < shape->count[0]; i++)
+	{
+	  memcpy(dst + k * dst_stride[2] + j * dst_stride[1] + i * dst_stride[0],
+		 src + k * src_stride[2] + j * src_stride[1] + i * src_stride[0],
+		 shape->block);
+	}
+}
+
+/* Release the buffers a delayed request owns when it is dropped */
+static inline void
+_tcp_dev_release_delayed(const tcp_dev_wr_t *wr)
+{
+  if(wr->opcode == NOTIFICATION_RDMA_WRITE_STRIDED
+     || wr->opcode == RESPONSE_RDMA_READ_STRIDED)
+    {
+      free((void *) wr->local_addr);
+    }
+  else if(wr->opcode == REQUEST_RDMA_READ_STRIDED)
+    {
+      free((void *) wr->swap);
+    }
+}
+
+/* Acknowledge a write (in wr_buff) once it is in place, if there
+   are several rails: its source completes it then */
+static inline void
+_tcp_dev_ack_write(const tcp_dev_conn_state_t *estate)
+{
+  if(tcp_dev_rails > 1)
+    {
+      tcp_dev_wr_t wr =
+	{
+	  .wr_id       = estate->wr_buff.wr_id,
+	  .cq_handle   = estate->wr_buff.cq_handle,
+	  .opcode      = RESPONSE_RDMA_WRITE,
+	  .source      = estate->wr_buff.target,
+	  .target      = estate->wr_buff.source,
+	  .rail        = estate->rail,
+	  .local_addr  = 0,
+	  .remote_addr = 0,
+	  .length      = 0,
+	  .compare_add = 0,
+	  .swap        = 0
+	};
+
+      list_insert(&delayedList, &wr);
+    }
+}
+
 static inline void
 _tcp_dev_set_default_read_conn_state(tcp_dev_conn_state_t *estate)
 {
@@ -517,13 +890,32 @@ _tcp_dev_process_recv_data(tcp_dev_conn_state_t *estate)
 	{
 	  /* TOPOLOGY OPERATIONS */
 	case REGISTER_PEER:
+	  if(estate->wr_buff.rail >= tcp_dev_rails)
+	    {
+	      gaspi_print_error("Rank %u registers rail %u (of %d).",
+				estate->wr_buff.source, estate->wr_buff.rail, tcp_dev_rails);
+	      return 1;
+	    }
+
 	  estate->rank = estate->wr_buff.source;
-	  rank_state[estate->rank] = estate;
+	  estate->rail = estate->wr_buff.rail;
+	  rank_state[estate->rail * glb_gaspi_ctx.tnc + estate->rank] = estate;
 
-	  /* set connected */
+	  if(estate->rail == 0 && tcp_dev_rails > 1)
+	    {
+	      if(_tcp_dev_send_rails(estate) != 0)
+		{
+		  return 1;
+		}
+	    }
+
+	  /* set connected (once all rails are) */
 	  /* TODO: (ugly) */
-	  glb_gaspi_ctx.ep_conn[estate->rank].cstat = 1;
-  
+	  if(_tcp_dev_rails_registered(estate->rank))
+	    {
+	      glb_gaspi_ctx.ep_conn[estate->rank].cstat = 1;
+	    }
+
 
 	  _tcp_dev_set_default_read_conn_state(estate);
 
@@ -532,6 +924,7 @@ _tcp_dev_process_recv_data(tcp_dev_conn_state_t *estate)
 	  /* RDMA OPERATIONS */
 	case POST_RDMA_WRITE:
 	case POST_RDMA_WRITE_INLINED:
+	case POST_RDMA_WRITE_NOTIFY:
 	case POST_RDMA_READ:
 
 	  if(estate->wr_buff.opcode == POST_RDMA_READ)
@@ -557,6 +950,20 @@ _tcp_dev_process_recv_data(tcp_dev_conn_state_t *estate)
 
 	      memcpy(dest, src, estate->wr_buff.length);
 
+	      if(estate->wr_buff.opcode == POST_RDMA_WRITE_INLINED)
+		{
+		  _tcp_dev_set_notify_summary(estate->wr_buff.swap);
+		}
+	      else if(estate->wr_buff.opcode == POST_RDMA_WRITE_NOTIFY)
+		{
+		  _tcp_dev_set_write_notify(&estate->wr_buff);
+		  _tcp_dev_progress_signal();
+		}
+	      else if(estate->wr_buff.opcode == POST_RDMA_READ)
+		{
+		  _tcp_dev_set_read_notify(&estate->wr_buff);
+		}
+
 	      if( _tcp_dev_post_wc(estate->wr_buff.wr_id,
 				   TCP_WC_SUCCESS,
 				   op,
@@ -579,16 +986,22 @@ _tcp_dev_process_recv_data(tcp_dev_conn_state_t *estate)
 		  .cq_handle   = estate->wr_buff.cq_handle,
 		  .source      = estate->wr_buff.source,
 		  .target      = estate->wr_buff.target,
+		  .rail        = estate->wr_buff.rail,
 		  .local_addr  = estate->wr_buff.local_addr,
 		  .remote_addr = estate->wr_buff.remote_addr,
 		  .length      = estate->wr_buff.length,
-		  .swap        = 0
+		  .swap        = estate->wr_buff.swap
 		} ;
 
 	      if(estate->wr_buff.opcode == POST_RDMA_READ)
 		{
 		  wr.opcode      = REQUEST_RDMA_READ;
-		  wr.compare_add = 0;
+		  wr.compare_add = estate->wr_buff.compare_add;
+		}
+	      else if(estate->wr_buff.opcode == POST_RDMA_WRITE_NOTIFY)
+		{
+		  wr.opcode      = NOTIFICATION_RDMA_WRITE_NOTIFY;
+		  wr.compare_add = estate->wr_buff.compare_add;
 		}
 	      else
 		{
@@ -645,6 +1058,7 @@ _tcp_dev_process_recv_data(tcp_dev_conn_state_t *estate)
 		  .cq_handle   = estate->wr_buff.cq_handle,
 		  .source      = estate->wr_buff.source,
 		  .target      = estate->wr_buff.target,
+		  .rail        = estate->wr_buff.rail,
 		  .local_addr  = estate->wr_buff.local_addr,
 		  .remote_addr = estate->wr_buff.remote_addr,
 		  .length      = estate->wr_buff.length,
@@ -667,6 +1081,130 @@ _tcp_dev_process_recv_data(tcp_dev_conn_state_t *estate)
 	    }
 	  _tcp_dev_set_default_read_conn_state(estate);
 
+	  break;
+	  /* strided write: copied right away or gathered into one
+	     message behind its shape */
+	case POST_RDMA_WRITE_STRIDED:
+	  {
+	    gaspi_strided_t *shape = (gaspi_strided_t *) estate->wr_buff.swap;
+
+	    if(estate->wr_buff.target == glb_gaspi_ctx.rank)
+	      {
+		_tcp_dev_strided_copy((char *) estate->wr_buff.remote_addr, shape->stride_remote,
+				      (char *) estate->wr_buff.local_addr, shape->stride_local,
+				      shape);
+		free(shape);
+
+		if( _tcp_dev_post_wc(estate->wr_buff.wr_id,
+				     TCP_WC_SUCCESS,
+				     TCP_DEV_WC_RDMA_WRITE,
+				     estate->wr_buff.cq_handle) != 0)
+		  {
+		    return 1;
+		  }
+	      }
+	    else
+	      {
+		char *msg = (char *) malloc(sizeof(gaspi_strided_t) + estate->wr_buff.length);
+
+		if(msg == NULL)
+		  {
+		    gaspi_print_error("Failed to allocate strided message.");
+		    free(shape);
+
+		    if( _tcp_dev_post_wc(estate->wr_buff.wr_id,
+					 TCP_WC_ERROR,
+					 TCP_DEV_WC_RDMA_WRITE,
+					 estate->wr_buff.cq_handle) != 0)
+		      {
+			return 1;
+		      }
+		  }
+		else
+		  {
+		    memcpy(msg, shape, sizeof(gaspi_strided_t));
+		    _tcp_dev_strided_copy(msg + sizeof(gaspi_strided_t), NULL,
+					  (char *) estate->wr_buff.local_addr, shape->stride_local,
+					  shape);
+		    free(shape);
+
+		    tcp_dev_wr_t wr = estate->wr_buff;
+
+		    wr.opcode     = NOTIFICATION_RDMA_WRITE_STRIDED;
+		    wr.local_addr = (uintptr_t) msg;
+		    wr.length     = sizeof(gaspi_strided_t) + estate->wr_buff.length;
+		    wr.swap       = 0;
+
+		    /* TODO: retval */
+		    list_insert(&delayedList, &wr);
+		  }
+	      }
+	  }
+	  _tcp_dev_set_default_read_conn_state(estate);
+
+	  break;
+	  /* strided read: the shape stays with the source until the
+	     response */
+	case POST_RDMA_READ_STRIDED:
+	  if(estate->wr_buff.target == glb_gaspi_ctx.rank)
+	    {
+	      gaspi_strided_t *shape = (gaspi_strided_t *) estate->wr_buff.swap;
+
+	      _tcp_dev_strided_copy((char *) estate->wr_buff.local_addr, shape->stride_local,
+				    (char *) estate->wr_buff.remote_addr, shape->stride_remote,
+				    shape);
+	      free(shape);
+
+	      if( _tcp_dev_post_wc(estate->wr_buff.wr_id,
+				   TCP_WC_SUCCESS,
+				   TCP_DEV_WC_RDMA_READ,
+				   estate->wr_buff.cq_handle) != 0)
+		{
+		  return 1;
+		}
+	    }
+	  else
+	    {
+	      tcp_dev_wr_t wr = estate->wr_buff;
+
+	      wr.opcode = REQUEST_RDMA_READ_STRIDED;
+
+	      /* TODO: retval */
+	      list_insert(&delayedList, &wr);
+	    }
+	  _tcp_dev_set_default_read_conn_state(estate);
+
+	  break;
+	  /* add to a notification (compare_add), setting its summary
+	     flag (swap) */
+	case POST_NOTIFY_ADD:
+
+	  if(estate->wr_buff.target == glb_gaspi_ctx.rank)
+	    {
+	      __sync_fetch_and_add((uint32_t *) estate->wr_buff.remote_addr,
+				   (uint32_t) estate->wr_buff.compare_add);
+
+	      _tcp_dev_set_notify_summary(estate->wr_buff.swap);
+
+	      if( _tcp_dev_post_wc(estate->wr_buff.wr_id,
+				   TCP_WC_SUCCESS,
+				   TCP_DEV_WC_RDMA_WRITE,
+				   estate->wr_buff.cq_handle) != 0)
+		{
+		  return 1;
+		}
+	    }
+	  else
+	    {
+	      tcp_dev_wr_t wr = estate->wr_buff;
+
+	      wr.opcode = NOTIFICATION_NOTIFY_ADD;
+
+	      /* TODO: retval */
+	      list_insert(&delayedList, &wr);
+	    }
+	  _tcp_dev_set_default_read_conn_state(estate);
+
 	  break;
 	case POST_SEND:
 	case POST_SEND_INLINED:
@@ -678,6 +1216,7 @@ _tcp_dev_process_recv_data(tcp_dev_conn_state_t *estate)
 	      .opcode      = NOTIFICATION_SEND,
 	      .source      = estate->wr_buff.source,
 	      .target      = estate->wr_buff.target,
+	      .rail        = estate->wr_buff.rail,
 	      .local_addr  = estate->wr_buff.local_addr,
 	      .remote_addr = estate->wr_buff.remote_addr,
 	      .length      = estate->wr_buff.length,
@@ -697,6 +1236,7 @@ _tcp_dev_process_recv_data(tcp_dev_conn_state_t *estate)
 
 	  break;
 	case NOTIFICATION_RDMA_WRITE:
+	case NOTIFICATION_RDMA_WRITE_NOTIFY:
 	  estate->read.wr_id     = estate->wr_buff.wr_id;
 	  estate->read.cq_handle = estate->wr_buff.cq_handle;
 	  estate->read.opcode    = RECV_RDMA_WRITE;
@@ -704,6 +1244,57 @@ _tcp_dev_process_recv_data(tcp_dev_conn_state_t *estate)
 	  estate->read.length    = estate->wr_buff.length;
 	  estate->read.done      = 0;
 
+	  break;
+	  /* the message is scattered once received */
+	case NOTIFICATION_RDMA_WRITE_STRIDED:
+	case RESPONSE_RDMA_READ_STRIDED:
+	  {
+	    void *msg = malloc(estate->wr_buff.length);
+
+	    if(msg == NULL)
+	      {
+		gaspi_print_error("Failed to allocate strided message.");
+		return 1;
+	      }
+
+	    estate->read.wr_id     = estate->wr_buff.wr_id;
+	    estate->read.cq_handle = estate->wr_buff.cq_handle;
+	    estate->read.opcode    = (estate->wr_buff.opcode == RESPONSE_RDMA_READ_STRIDED) ? RECV_RDMA_READ : RECV_RDMA_WRITE;
+	    estate->read.addr      = (uintptr_t) msg;
+	    estate->read.length    = estate->wr_buff.length;
+	    estate->read.done      = 0;
+	  }
+
+	  break;
+	case REQUEST_RDMA_READ_STRIDED:
+	  {
+	    void *shape = malloc(sizeof(gaspi_strided_t));
+
+	    if(shape == NULL)
+	      {
+		gaspi_print_error("Failed to allocate strided message.");
+		return 1;
+	      }
+
+	    estate->read.wr_id     = estate->wr_buff.wr_id;
+	    estate->read.cq_handle = estate->wr_buff.cq_handle;
+	    estate->read.opcode    = RECV_STRIDED_SHAPE;
+	    estate->read.addr      = (uintptr_t) shape;
+	    estate->read.length    = sizeof(gaspi_strided_t);
+	    estate->read.done      = 0;
+	  }
+
+	  break;
+	case NOTIFICATION_NOTIFY_ADD:
+	  __sync_fetch_and_add((uint32_t *) estate->wr_buff.remote_addr,
+			       (uint32_t) estate->wr_buff.compare_add);
+
+	  _tcp_dev_set_notify_summary(estate->wr_buff.swap);
+	  _tcp_dev_progress_signal();
+	  _tcp_dev_ack_write(estate);
+
+	  _tcp_dev_set_default_read_conn_state(estate);
+
 	  break;
 	case REQUEST_RDMA_READ:
 	  {
@@ -714,6 +1305,7 @@ _tcp_dev_process_recv_data(tcp_dev_conn_state_t *estate)
 		.opcode      = RESPONSE_RDMA_READ,
 		.source      = estate->wr_buff.target,
 		.target      = estate->wr_buff.source,
+		.rail        = estate->rail,
 		.local_addr  = estate->wr_buff.remote_addr,
 		.remote_addr = estate->wr_buff.local_addr,
 		.length      = estate->wr_buff.length,
@@ -746,6 +1338,7 @@ _tcp_dev_process_recv_data(tcp_dev_conn_state_t *estate)
 		.opcode      = (estate->wr_buff.opcode == REQUEST_ATOMIC_CMP_AND_SWP) ? RESPONSE_ATOMIC_CMP_AND_SWP : RESPONSE_ATOMIC_FETCH_AND_ADD,
 		.source      = estate->wr_buff.target,
 		.target      = estate->wr_buff.source,
+		.rail        = estate->rail,
 		.local_addr  = estate->wr_buff.remote_addr,
 		.remote_addr = estate->wr_buff.local_addr,
 		.length      = estate->wr_buff.length,
@@ -829,6 +1422,7 @@ _tcp_dev_process_recv_data(tcp_dev_conn_state_t *estate)
 		  .opcode      = RESPONSE_SEND,
 		  .source      = swr.target,
 		  .target      = swr.source,
+		  .rail        = estate->rail,
 		  .local_addr  = swr.local_addr,
 		  .remote_addr = swr.remote_addr,
 		  .length      = swr.length,
@@ -858,17 +1452,67 @@ _tcp_dev_process_recv_data(tcp_dev_conn_state_t *estate)
 
 	  _tcp_dev_set_default_read_conn_state(estate);
 
+	  break;
+	case RESPONSE_RDMA_WRITE:
+	  if(_tcp_dev_post_wc(estate->wr_buff.wr_id,
+			      TCP_WC_SUCCESS,
+			      TCP_DEV_WC_RDMA_WRITE,
+			      estate->wr_buff.cq_handle) != 0)
+	    {
+	      return 1;
+	    }
+
+	  _tcp_dev_set_default_read_conn_state(estate);
+
 	  break;
 	} /* switch opcode */
     } /* if RECV_HEADER*/
 
   else if(estate->read.opcode == RECV_RDMA_WRITE)
     {
+      /* the header of the write is still in wr_buff */
+      if(estate->wr_buff.opcode == NOTIFICATION_RDMA_WRITE_STRIDED)
+	{
+	  char *msg = (char *) estate->read.addr;
+	  gaspi_strided_t *shape = (gaspi_strided_t *) msg;
+
+	  _tcp_dev_strided_copy((char *) estate->wr_buff.remote_addr, shape->stride_remote,
+				msg + sizeof(gaspi_strided_t), NULL,
+				shape);
+	  free(msg);
+	}
+
+      if(estate->wr_buff.opcode == NOTIFICATION_RDMA_WRITE_NOTIFY)
+	{
+	  _tcp_dev_set_write_notify(&estate->wr_buff);
+	}
+      else
+	{
+	  _tcp_dev_set_notify_summary(estate->wr_buff.swap);
+	}
+      _tcp_dev_progress_signal();
+      _tcp_dev_ack_write(estate);
+
       _tcp_dev_set_default_read_conn_state(estate);
     }
 
   else if(estate->read.opcode == RECV_RDMA_READ)
     {
+      if(estate->wr_buff.opcode == RESPONSE_RDMA_READ_STRIDED)
+	{
+	  gaspi_strided_t *shape = (gaspi_strided_t *) estate->wr_buff.swap;
+
+	  _tcp_dev_strided_copy((char *) estate->wr_buff.remote_addr, shape->stride_local,
+				(char *) estate->read.addr, NULL,
+				shape);
+	  free((void *) estate->read.addr);
+	  free(shape);
+	}
+      else
+	{
+	  _tcp_dev_set_read_notify(&estate->wr_buff);
+	}
+
       if(_tcp_dev_post_wc(estate->read.wr_id,
 			  TCP_WC_SUCCESS,
 			  TCP_DEV_WC_RDMA_READ,
@@ -880,6 +1524,44 @@ _tcp_dev_process_recv_data(tcp_dev_conn_state_t *estate)
       _tcp_dev_set_default_read_conn_state(estate);
     }
 
+  else if(estate->read.opcode == RECV_STRIDED_SHAPE)
+    {
+      /* gather the blocks into the response */
+      gaspi_strided_t *shape = (gaspi_strided_t *) estate->read.addr;
+      char *msg = (char *) malloc(estate->wr_buff.length);
+
+      if(msg == NULL)
+	{
+	  gaspi_print_error("Failed to allocate strided message.");
+	  free(shape);
+	  return 1;
+	}
+
+      _tcp_dev_strided_copy(msg, NULL,
+			    (char *) estate->wr_buff.remote_addr, shape->stride_remote,
+			    shape);
+      free(shape);
+
+      tcp_dev_wr_t wr =
+	{
+	  .wr_id       = estate->wr_buff.wr_id,
+	  .cq_handle   = estate->wr_buff.cq_handle,
+	  .opcode      = RESPONSE_RDMA_READ_STRIDED,
+	  .source      = estate->wr_buff.target,
+	  .target      = estate->wr_buff.source,
+	  .rail        = estate->rail,
+	  .local_addr  = (uintptr_t) msg,
+	  .remote_addr = estate->wr_buff.local_addr,
+	  .length      = estate->wr_buff.length,
+	  .compare_add = 0,
+	  .swap        = estate->wr_buff.swap
+	};
+
+      list_insert(&delayedList, &wr);
+
+      _tcp_dev_set_default_read_conn_state(estate);
+    }
+
   else if(estate->read.opcode == RECV_SEND)
     {
       if(_tcp_dev_post_wc(estate->read.wr_id,
@@ -905,7 +1587,10 @@ _tcp_dev_process_recv_data(tcp_dev_conn_state_t *estate)
 static int
 _tcp_dev_process_sent_data(int pollfd, tcp_dev_conn_state_t *estate)
 {
-  if(estate->write.opcode == SEND_RDMA_WRITE)
+  /* with several rails, writes complete once acknowledged */
+  if(tcp_dev_rails == 1
+     && (estate->write.opcode == SEND_RDMA_WRITE
+	 || estate->write.opcode == SEND_RDMA_WRITE_STAGED))
     {
       if(_tcp_dev_post_wc(estate->write.wr_id,
 			  TCP_WC_SUCCESS,
@@ -916,6 +1601,13 @@ _tcp_dev_process_sent_data(int pollfd, tcp_dev_conn_state_t *estate)
 	}
     }
 
+  /* the messages of strided transfers */
+  if(estate->write.opcode == SEND_RDMA_WRITE_STAGED
+     || estate->write.opcode == SEND_RDMA_READ_STAGED)
+    {
+      free((void *) estate->write.addr);
+    }
+
   struct epoll_event ev =
     {
       .data.ptr = estate,
@@ -950,17 +1642,21 @@ _tcp_dev_process_delayed(int pollfd)
 
   while(element != NULL)
     {
-      tcp_dev_conn_state_t *state = rank_state[element->wr.target];
+      tcp_dev_conn_state_t *state = rank_state[element->wr.rail * glb_gaspi_ctx.tnc + element->wr.target];
       tcp_dev_wr_t wr = element->wr;
 
       if(state == NULL && !(wr.opcode == NOTIFICATION_SEND && wr.target == glb_gaspi_ctx.rank))
 	{
-	  if( _tcp_dev_post_wc(wr.wr_id, TCP_WC_REM_OP_ERROR, TCP_DEV_WC_RDMA_WRITE, wr.cq_handle) != 0)
+	  /* (acknowledgments have nothing to complete here) */
+	  if( wr.opcode != RESPONSE_RDMA_WRITE
+	      && _tcp_dev_post_wc(wr.wr_id, TCP_WC_REM_OP_ERROR, TCP_DEV_WC_RDMA_WRITE, wr.cq_handle) != 0)
 	    {
 	      gaspi_print_error("Failed to post completion error.");
 	      return 1;
 	    }
 
+	  _tcp_dev_release_delayed(&wr);
+
 	  delete = element;
 	}
       else if(wr.opcode == NOTIFICATION_SEND && (wr.target == glb_gaspi_ctx.rank))
@@ -1028,7 +1724,8 @@ _tcp_dev_process_delayed(int pollfd)
 		    gaspi_print_error("writing to node %d.", wr.target);
 		  }
 
-		  if( _tcp_dev_post_wc(wr.wr_id, TCP_WC_REM_OP_ERROR, TCP_DEV_WC_RDMA_WRITE, wr.cq_handle) != 0)
+		  if( wr.opcode != RESPONSE_RDMA_WRITE
+		      && _tcp_dev_post_wc(wr.wr_id, TCP_WC_REM_OP_ERROR, TCP_DEV_WC_RDMA_WRITE, wr.cq_handle) != 0)
 		    {
 		      gaspi_print_error("Failed to post completion error.");
 		    }
@@ -1079,10 +1776,11 @@ _tcp_dev_process_delayed(int pollfd)
 	      enum tcp_dev_wc_opcode op;
 
 	      wr.opcode == NOTIFICATION_RDMA_WRITE ? op = TCP_DEV_WC_RDMA_WRITE : TCP_DEV_WC_SEND;
-	      if(_tcp_dev_post_wc(element->wr.wr_id,
-				  TCP_WC_SUCCESS,
-				  TCP_DEV_WC_RDMA_WRITE,
-				  element->wr.cq_handle) != 0)
+	      if((tcp_dev_rails == 1 || wr.opcode != NOTIFICATION_RDMA_WRITE)
+		 && _tcp_dev_post_wc(element->wr.wr_id,
+				     TCP_WC_SUCCESS,
+				     TCP_DEV_WC_RDMA_WRITE,
+				     element->wr.cq_handle) != 0)
 		{
 		  gaspi_print_error("Failed to post completion success.");
 		  return 1;
@@ -1090,17 +1788,76 @@ _tcp_dev_process_delayed(int pollfd)
 
 	      free((void *) element->wr.local_addr);
 	    }
+	  else if( wr.opcode == NOTIFICATION_NOTIFY_ADD )
+	    {
+	      /* the add is all in the header */
+	      if(!found_error && tcp_dev_rails == 1)
+		{
+		  if(_tcp_dev_post_wc(wr.wr_id,
+				      TCP_WC_SUCCESS,
+				      TCP_DEV_WC_RDMA_WRITE,
+				      wr.cq_handle) != 0)
+		    {
+		      gaspi_print_error("Failed to post completion success.");
+		      return 1;
+		    }
+		}
+	    }
+	  else if( wr.opcode == REQUEST_RDMA_READ_STRIDED )
+	    {
+	      /* the shape follows the header (the source keeps it for
+		 the response) */
+	      size_t sdone = 0;
+
+	      while(!found_error && sdone < sizeof(gaspi_strided_t))
+		{
+		  const int bytes_sent = write(state->fd, (char *) wr.swap + sdone, sizeof(gaspi_strided_t) - sdone);
+
+		  if(bytes_sent <= 0 && !(errno == EAGAIN || errno == EWOULDBLOCK))
+		    {
+		      gaspi_print_error("writing to node %d.", wr.target);
+
+		      if( _tcp_dev_post_wc(wr.wr_id, TCP_WC_REM_OP_ERROR, TCP_DEV_WC_RDMA_READ, wr.cq_handle) != 0)
+			{
+			  gaspi_print_error("Failed to post completion error.");
+			}
+
+		      found_error = 1;
+		    }
+		  else if( bytes_sent > 0)
+		    {
+		      sdone += bytes_sent;
+		    }
+		}
+
+	      if(found_error)
+		{
+		  _tcp_dev_release_delayed(&wr);
+		}
+	    }
 	  else if( wr.opcode == NOTIFICATION_RDMA_WRITE
+		   || wr.opcode == NOTIFICATION_RDMA_WRITE_NOTIFY
 		   || wr.opcode == RESPONSE_RDMA_READ
-		   || wr.opcode == NOTIFICATION_SEND )
+		   || wr.opcode == NOTIFICATION_SEND
+		   || wr.opcode == NOTIFICATION_RDMA_WRITE_STRIDED
+		   || wr.opcode == RESPONSE_RDMA_READ_STRIDED )
 	    {
-	      if(!found_error)
+	      if(found_error)
+		{
+		  _tcp_dev_release_delayed(&wr);
+		}
+	      else
 		{
 		  /* enable write notification */
-		  if(wr.opcode == NOTIFICATION_RDMA_WRITE)
+		  if(wr.opcode == NOTIFICATION_RDMA_WRITE
+		     || wr.opcode == NOTIFICATION_RDMA_WRITE_NOTIFY)
 		    state->write.opcode = SEND_RDMA_WRITE;
 		  else if(wr.opcode == RESPONSE_RDMA_READ)
 		    state->write.opcode = SEND_RDMA_READ;
+		  else if(wr.opcode == NOTIFICATION_RDMA_WRITE_STRIDED)
+		    state->write.opcode = SEND_RDMA_WRITE_STAGED;
+		  else if(wr.opcode == RESPONSE_RDMA_READ_STRIDED)
+		    state->write.opcode = SEND_RDMA_READ_STAGED;
 		  else
 		    state->write.opcode = SEND_SEND;
 
@@ -1190,7 +1947,7 @@ _tcp_dev_cleanup_connections(int pollfd)
 {
   int k;
 
-  for(k = 0; k < glb_gaspi_ctx.tnc; k++)
+  for(k = 0; k < tcp_dev_rails * glb_gaspi_ctx.tnc; k++)
     {
       if(rank_state == NULL || rank_state[k] == NULL || rank_state[k]->fd < 0)
 	continue;
@@ -1200,14 +1957,14 @@ _tcp_dev_cleanup_connections(int pollfd)
 
       if(shutdown(rank_state[k]->fd, SHUT_RDWR) != 0)
 	{
-	  gaspi_print_error("Rank %u: in shutdown with %d (%d)", glb_gaspi_ctx.rank, k, rank_state[k]->fd);
+	  gaspi_print_error("Rank %u: in shutdown with %d (%d)", glb_gaspi_ctx.rank, k % glb_gaspi_ctx.tnc, rank_state[k]->fd);
 	}
 
       _tcp_dev_wait_outstanding(rank_state[k]->fd);
 
       if(close(rank_state[k]->fd) != 0)
 	{
-	  gaspi_print_error("Rank %u: in close with %d", glb_gaspi_ctx.rank, k);
+	  gaspi_print_error("Rank %u: in close with %d", glb_gaspi_ctx.rank, k % glb_gaspi_ctx.tnc);
 	}
 
       free(rank_state[k]);
@@ -1253,7 +2010,7 @@ tcp_dev_stop_device(void)
 
       /* read / write to remote ranks */
       int i;
-      for(i = 0; i < glb_gaspi_ctx.tnc; i++)
+      for(i = 0; i < tcp_dev_rails * glb_gaspi_ctx.tnc; i++)
 	{
 	  if(!rank_state || !rank_state[i]) continue;
 
@@ -1368,6 +2125,7 @@ tcp_virt_dev(void *args)
 
   lstate->fd = listen_sock;
   lstate->rank = -1;
+  lstate->rail = 0;
 
   struct epoll_event lev =
     {
@@ -1449,7 +2207,7 @@ tcp_virt_dev(void *args)
 
 		  gaspi_sn_set_non_blocking(conn_sock);
 
-		  if(_tcp_dev_add_new_conn(-1, conn_sock, epollfd) == NULL)
+		  if(_tcp_dev_add_new_conn(-1, 0, conn_sock, epollfd) == NULL)
 		    {
 		      gaspi_print_error("Failed to add to events instance");
 		    }
@@ -1595,6 +2353,12 @@ tcp_virt_dev(void *args)
 		      gaspi_print_error("Failed to post completion error.");
 		    }
 
+		  if(estate->write.opcode == SEND_RDMA_WRITE_STAGED
+		     || estate->write.opcode == SEND_RDMA_READ_STAGED)
+		    {
+		      free((void *) estate->write.addr);
+		    }
+
 		    estate->write.wr_id     = 0;
 		    estate->write.cq_handle = CQ_HANDLE_NONE;
 		    estate->write.opcode    = SEND_DISABLED;
@@ -1619,6 +2383,16 @@ tcp_virt_dev(void *args)
 		      {
 			gaspi_print_error("Failed to post completion error.");
 		      }
+
+		  /* the buffers of strided transfers */
+		  if( estate->read.opcode == RECV_STRIDED_SHAPE
+		      || (estate->read.opcode == RECV_RDMA_WRITE
+			  && estate->wr_buff.opcode == NOTIFICATION_RDMA_WRITE_STRIDED)
+		      || (estate->read.opcode == RECV_RDMA_READ
+			  && estate->wr_buff.opcode == RESPONSE_RDMA_READ_STRIDED) )
+		    {
+		      free((void *) estate->read.addr);
+		    }
 		}
 
 	      shutdown(event_fd, SHUT_RDWR);
@@ -1626,7 +2400,7 @@ tcp_virt_dev(void *args)
 	      close(event_fd);
 
 	      if(event_rank >= 0)
-		rank_state[event_rank]->fd = -2; /* just invalidate fd */
+		rank_state[estate->rail * glb_gaspi_ctx.tnc + event_rank]->fd = -2; /* just invalidate fd */
 	      /* rank_state[event_rank] = NULL; */
 	    }
 	} /* for all triggered events */
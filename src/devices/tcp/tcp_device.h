@@ -28,6 +28,7 @@ along with GPI-2. If not, see <http://www.gnu.org/licenses/>.
 #define MR_MAX_NUM     1024
 #define CQ_MAX_NUM     1024
 #define CQ_MAX_SIZE    4096
+#define WC_MAX_BATCH   64
 #define QP_MAX_NUM     4096
 #define QP_MAX_RD_ATOM 4096
 
@@ -45,6 +46,17 @@ typedef enum
   } gaspi_tcp_dev_status_t;
 
 /* TODO: minimize sizes */
+/* With several rails (connections to each rank), requests name the
+   rail they take and writes are acknowledged by the target
+   (RESPONSE_RDMA_WRITE) once in place: a later request on another
+   rail cannot overtake them */
+/* A fused write with notification (*_RDMA_WRITE_NOTIFY) is one
+   message: the notification goes in the header, its id and value in
+   compare_add (value << 32 | id) and the notification space of the
+   target in swap (page aligned, bit 0 set for a summary flag) */
+/* Strided transfers (*_STRIDED) are one message of the packed blocks:
+   their shape (gaspi_strided_t) is posted in swap and goes ahead of
+   the packed data of a write and as the data of a read request */
 typedef struct 
 {
   uint64_t wr_id;
@@ -55,9 +67,13 @@ typedef struct
 
       POST_RDMA_WRITE,
       POST_RDMA_WRITE_INLINED,
+      POST_RDMA_WRITE_NOTIFY,
       POST_RDMA_READ,
       POST_ATOMIC_CMP_AND_SWP,
       POST_ATOMIC_FETCH_AND_ADD,
+      POST_NOTIFY_ADD,
+      POST_RDMA_WRITE_STRIDED,
+      POST_RDMA_READ_STRIDED,
       POST_SEND,
       POST_SEND_INLINED,
       POST_RECV,
@@ -72,9 +88,15 @@ typedef struct
       RESPONSE_RDMA_READ,
       NOTIFICATION_SEND,
       RESPONSE_SEND,
+      NOTIFICATION_NOTIFY_ADD,
+      NOTIFICATION_RDMA_WRITE_STRIDED,
+      REQUEST_RDMA_READ_STRIDED,
+      RESPONSE_RDMA_READ_STRIDED,
+      RESPONSE_RDMA_WRITE,
+      NOTIFICATION_RDMA_WRITE_NOTIFY,
     } opcode;
 
-  uint16_t target, source;
+  uint16_t target, source, rail;
   uint64_t compare_add, swap;
   uint64_t local_addr, remote_addr;
   uint32_t length;
@@ -82,7 +104,7 @@ typedef struct
 
 typedef struct 
 {
-  int fd, rank;
+  int fd, rank, rail;
 
   struct 
   {
@@ -91,7 +113,8 @@ typedef struct
 
     enum 
       {
-	RECV_HEADER, RECV_TOPOLOGY, RECV_RDMA_WRITE, RECV_RDMA_READ, RECV_SEND
+	RECV_HEADER, RECV_TOPOLOGY, RECV_RDMA_WRITE, RECV_RDMA_READ, RECV_SEND,
+	RECV_STRIDED_SHAPE
       } opcode;
     
     uint64_t addr;
@@ -105,7 +128,8 @@ typedef struct
 
     enum 
       {
-	SEND_DISABLED, SEND_RDMA_WRITE, SEND_RDMA_READ, SEND_SEND
+	SEND_DISABLED, SEND_RDMA_WRITE, SEND_RDMA_READ, SEND_SEND,
+	SEND_RDMA_WRITE_STAGED, SEND_RDMA_READ_STAGED
       } opcode;
 
     uint64_t addr;
@@ -189,6 +213,15 @@ tcp_dev_destroy_passive_channel(struct tcp_passive_channel *);
 int
 tcp_dev_return_wc(struct tcp_cq *, tcp_dev_wc_t *);
 
+int
+tcp_dev_return_wcs(struct tcp_cq *, tcp_dev_wc_t *, const int);
+
+unsigned int
+tcp_dev_progress_seq(void);
+
+void
+tcp_dev_progress_wait(const unsigned int, const long);
+
 void *
 tcp_virt_dev(void *);
 
@@ -201,6 +234,12 @@ tcp_dev_is_valid_state(unsigned short);
 int
 tcp_dev_connect_to(int i);
 
+int
+tcp_dev_init_rails(const int);
+
+char*
+tcp_dev_get_rail_ip(const int);
+
 char*
 tcp_dev_get_local_ip(void);
 
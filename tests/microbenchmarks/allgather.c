@@ -0,0 +1,82 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <GASPI.h>
+#include <GASPI_Ext.h>
+
+/* Latency and bandwidth of gaspi_allgather for block sizes from 1
+   byte to 4 MB, gathered into a segment. */
+
+#define ITERATIONS 100
+#define MAX_BLOCK (4 << 20)
+
+static int
+mcycles_compare (const void *aptr, const void *bptr)
+{
+  const gaspi_cycles_t *a = (gaspi_cycles_t *) aptr;
+  const gaspi_cycles_t *b = (gaspi_cycles_t *) bptr;
+  if (*a < *b)
+    return -1;
+  if (*a > *b)
+    return 1;
+  return 0;
+}
+
+int main(int argc, char *argv[])
+{
+  int i, t;
+  gaspi_size_t bsize;
+  gaspi_rank_t grank, gnum;
+  gaspi_float cpu_freq;
+  gaspi_cycles_t stamp[ITERATIONS], delta[ITERATIONS];
+
+  gaspi_proc_init(GASPI_BLOCK);
+
+  gaspi_cpu_frequency (&cpu_freq);
+  gaspi_proc_rank(&grank);
+  gaspi_proc_num(&gnum);
+
+  if(gaspi_segment_create(0, (gaspi_size_t) gnum * MAX_BLOCK, GASPI_GROUP_ALL,
+			  GASPI_BLOCK, GASPI_MEM_INITIALIZED) != GASPI_SUCCESS)
+    {
+      printf("Failed to create segment\n");
+      return EXIT_FAILURE;
+    }
+
+  if(0 == grank)
+    {
+      printf("CPU freq: %.2f\n", cpu_freq);
+      printf("Ranks: %u\n", gnum);
+      printf("#bytes\tusecs\tMB/s\n");
+    }
+
+  gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK);
+
+  for(bsize = 1; bsize <= MAX_BLOCK; bsize *= 2)
+    {
+      for(i = 0; i < ITERATIONS; i++)
+	{
+	  gaspi_allgather(0, 0, bsize, GASPI_GROUP_ALL, GASPI_BLOCK);
+	  gaspi_time_ticks(&(stamp[i]));
+	}
+
+      for (t = 0; t < (ITERATIONS - 1); t++)
+	delta[t] = stamp[t + 1] - stamp[t];
+
+      qsort (delta, (ITERATIONS - 1), sizeof *delta, mcycles_compare);
+
+      const double div = 1.0 / cpu_freq;
+      const double ts = (double) delta[ITERATIONS / 2] * div;
+      const double bw = (double) (bsize * gnum) / ts;
+
+      if(0 == grank)
+	printf("%lu\t%.2f\t%.2f\n", bsize, ts, bw);
+    }
+
+  gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK);
+
+  gaspi_proc_term(GASPI_BLOCK);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,130 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <GASPI.h>
+#include <GASPI_Ext.h>
+
+/* the kernels the library selected for this CPU */
+#include "GPI2_Coll.h"
+
+/* Throughput of the reduction kernels of the pre-defined allreduce
+   operations, per element type and operation, timed locally (no
+   communication) on large arrays of normal values. Argument: the
+   number of elements (default 1M). */
+
+#define ITERATIONS 50
+
+static int
+mcycles_compare (const void *aptr, const void *bptr)
+{
+  const gaspi_cycles_t *a = (gaspi_cycles_t *) aptr;
+  const gaspi_cycles_t *b = (gaspi_cycles_t *) bptr;
+  if (*a < *b)
+    return -1;
+  if (*a > *b)
+    return 1;
+  return 0;
+}
+
+/* values away from zero and from the limits of each type */
+static void
+fill (void *buf, const int type, const gaspi_number_t cnt, const int seed)
+{
+  gaspi_number_t i;
+
+  for(i = 0; i < cnt; i++)
+    {
+      const int v = (int) ((i * 7 + seed) % 1000) + 1;
+
+      switch(type)
+	{
+	case GASPI_TYPE_INT: ((int *) buf)[i] = v; break;
+	case GASPI_TYPE_UINT: ((unsigned int *) buf)[i] = (unsigned int) v; break;
+	case GASPI_TYPE_FLOAT: ((float *) buf)[i] = 1.0f + v * 0.25f; break;
+	case GASPI_TYPE_DOUBLE: ((double *) buf)[i] = 1.0 + v * 0.25; break;
+	case GASPI_TYPE_LONG: ((long *) buf)[i] = v; break;
+	case GASPI_TYPE_ULONG: ((unsigned long *) buf)[i] = (unsigned long) v; break;
+	}
+    }
+}
+
+int main(int argc, char *argv[])
+{
+  int i, t, op, type;
+  gaspi_rank_t grank;
+  gaspi_float cpu_freq;
+  gaspi_number_t cnt = 1 << 20;
+  gaspi_cycles_t stamp[ITERATIONS + 1], delta[ITERATIONS];
+
+  const char *op_names[] = { "min", "max", "sum" };
+  const char *type_names[] = { "int", "uint", "float", "double", "long", "ulong" };
+  const size_t type_sizes[] = { sizeof(int), sizeof(unsigned int), sizeof(float),
+				sizeof(double), sizeof(long), sizeof(unsigned long) };
+
+  if(argc > 1)
+    cnt = (gaspi_number_t) atol(argv[1]);
+
+  gaspi_proc_init(GASPI_BLOCK);
+
+  gaspi_cpu_frequency (&cpu_freq);
+  gaspi_proc_rank(&grank);
+
+  char *buf_a = (char *) malloc(cnt * sizeof(double));
+  char *buf_b = (char *) malloc(cnt * sizeof(double));
+  char *buf_res = (char *) malloc(cnt * sizeof(double));
+  if(buf_a == NULL || buf_b == NULL || buf_res == NULL)
+    {
+      printf("Failed to allocate memory\n");
+      return EXIT_FAILURE;
+    }
+
+  if(0 == grank)
+    {
+      printf("CPU freq: %.2f\n", cpu_freq);
+      printf("Elements: %u\n", cnt);
+      printf("#type\top\tusecs\tMB/s\n");
+    }
+
+  for(type = GASPI_TYPE_INT; type <= GASPI_TYPE_ULONG; type++)
+    {
+      fill(buf_a, type, cnt, 0);
+      fill(buf_b, type, cnt, 500);
+
+      for(op = GASPI_OP_MIN; op <= GASPI_OP_SUM; op++)
+	{
+	  gaspi_redux_fct_t const kernel = gaspi_redux_fct (op, type);
+
+	  /* warm up */
+	  kernel(buf_res, buf_a, buf_b, cnt);
+
+	  gaspi_time_ticks(&(stamp[0]));
+	  for(i = 0; i < ITERATIONS; i++)
+	    {
+	      kernel(buf_res, buf_a, buf_b, cnt);
+	      gaspi_time_ticks(&(stamp[i + 1]));
+	    }
+
+	  for (t = 0; t < ITERATIONS; t++)
+	    delta[t] = stamp[t + 1] - stamp[t];
+
+	  qsort (delta, ITERATIONS, sizeof *delta, mcycles_compare);
+
+	  const double div = 1.0 / cpu_freq;
+	  const double ts = (double) delta[ITERATIONS / 2] * div;
+	  /* two inputs read, one result written */
+	  const double bw = (double) (3 * cnt * type_sizes[type]) / ts;
+
+	  if(0 == grank)
+	    printf("%s\t%s\t%.2f\t%.2f\n", type_names[type], op_names[op], ts, bw);
+	}
+    }
+
+  gaspi_proc_term(GASPI_BLOCK);
+
+  free(buf_a);
+  free(buf_b);
+  free(buf_res);
+
+  return EXIT_SUCCESS;
+}
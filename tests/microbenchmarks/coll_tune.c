@@ -0,0 +1,188 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+
+#include <GASPI.h>
+#include <GASPI_Ext.h>
+
+#include "utils.h"
+
+/* Times every barrier and allreduce algorithm for groups of 2, 4, 8,
+   ... and all ranks and writes the fastest choices as decision table
+   (to the file given as argument, gpi2_coll_tuning.txt by default).
+   Runs with GASPI_COLL_TUNING pointing to it use the table. */
+
+#define TUNE_ITERATIONS 200
+#define TUNE_MAX_ELEMS 255
+
+#define GPI2_ASSERT(s) if(s != GASPI_SUCCESS) {printf("GASPI error:" #s " %d\n",__LINE__); fflush(stdout);_exit(EXIT_FAILURE);}
+
+static double one[TUNE_MAX_ELEMS], sum[TUNE_MAX_ELEMS];
+
+/* median time (usecs) of the slowest group member */
+static double
+tune_median(gaspi_group_t g, gaspi_float cpu_freq)
+{
+  double ts, ts_max;
+
+  qsort(delta, TUNE_ITERATIONS, sizeof *delta, mcycles_compare);
+  ts = (double) delta[TUNE_ITERATIONS / 2] / cpu_freq;
+
+  GPI2_ASSERT(gaspi_allreduce(&ts, &ts_max, 1, GASPI_OP_MAX, GASPI_TYPE_DOUBLE, g, GASPI_BLOCK));
+
+  return ts_max;
+}
+
+static double
+tune_barrier(gaspi_group_t g, gaspi_coll_algorithm_t alg, gaspi_float cpu_freq)
+{
+  int i;
+
+  GPI2_ASSERT(gaspi_coll_algorithm_set(g, alg, GASPI_COLL_ALG_AUTO));
+
+  for(i = 0; i < 10; i++)
+    {
+      GPI2_ASSERT(gaspi_barrier(g, GASPI_BLOCK));
+    }
+
+  for(i = 0; i < TUNE_ITERATIONS; i++)
+    {
+      const mcycles_t t0 = get_mcycles();
+      GPI2_ASSERT(gaspi_barrier(g, GASPI_BLOCK));
+      delta[i] = get_mcycles() - t0;
+    }
+
+  GPI2_ASSERT(gaspi_coll_algorithm_set(g, GASPI_COLL_ALG_AUTO, GASPI_COLL_ALG_AUTO));
+
+  return tune_median(g, cpu_freq);
+}
+
+static double
+tune_allreduce(gaspi_group_t g, gaspi_coll_algorithm_t alg, gaspi_number_t elems, gaspi_float cpu_freq)
+{
+  int i;
+
+  GPI2_ASSERT(gaspi_coll_algorithm_set(g, GASPI_COLL_ALG_AUTO, alg));
+
+  for(i = 0; i < 10; i++)
+    {
+      GPI2_ASSERT(gaspi_allreduce(one, sum, elems, GASPI_OP_SUM, GASPI_TYPE_DOUBLE, g, GASPI_BLOCK));
+    }
+
+  for(i = 0; i < TUNE_ITERATIONS; i++)
+    {
+      const mcycles_t t0 = get_mcycles();
+      GPI2_ASSERT(gaspi_allreduce(one, sum, elems, GASPI_OP_SUM, GASPI_TYPE_DOUBLE, g, GASPI_BLOCK));
+      delta[i] = get_mcycles() - t0;
+    }
+
+  GPI2_ASSERT(gaspi_coll_algorithm_set(g, GASPI_COLL_ALG_AUTO, GASPI_COLL_ALG_AUTO));
+
+  return tune_median(g, cpu_freq);
+}
+
+int
+main(int argc, char *argv[])
+{
+  gaspi_rank_t rank, tnc, r;
+  gaspi_float cpu_freq;
+  gaspi_size_t buf_size;
+  gaspi_group_t g;
+  char mtype[16];
+  int i, n, next;
+
+  const char *path = (argc > 1) ? argv[1] : "gpi2_coll_tuning.txt";
+  FILE *f = NULL;
+
+  GPI2_ASSERT(gaspi_proc_init(GASPI_BLOCK));
+
+  GPI2_ASSERT(gaspi_proc_rank(&rank));
+  GPI2_ASSERT(gaspi_proc_num(&tnc));
+  GPI2_ASSERT(gaspi_machine_type(mtype));
+  GPI2_ASSERT(gaspi_cpu_frequency(&cpu_freq));
+  GPI2_ASSERT(gaspi_allreduce_buf_size(&buf_size));
+
+  for(i = 0; i < TUNE_MAX_ELEMS; i++)
+    {
+      one[i] = 1.0;
+    }
+
+  if(0 == rank)
+    {
+      f = fopen(path, "w");
+      if(f == NULL)
+	{
+	  printf("Failed to open %s\n", path);
+	  _exit(EXIT_FAILURE);
+	}
+
+      fprintf(f, "# GPI-2 collectives decision table (%d ranks, %s)\n", tnc, mtype);
+      printf("#ranks\tdissemination\tnode\t\tallreduce switch\n");
+    }
+
+  for(n = 2; n <= tnc; n = next)
+    {
+      next = (n == tnc) ? tnc + 1 : ((2 * n > tnc) ? tnc : 2 * n);
+
+      GPI2_ASSERT(gaspi_group_create(&g));
+
+      for(r = 0; r < n; r++)
+	{
+	  GPI2_ASSERT(gaspi_group_add(g, r));
+	}
+
+      if(rank < n)
+	{
+	  GPI2_ASSERT(gaspi_group_commit(g, GASPI_BLOCK));
+
+	  const double t_diss = tune_barrier(g, GASPI_BARRIER_DISSEMINATION, cpu_freq);
+	  const double t_node = tune_barrier(g, GASPI_BARRIER_NODE, cpu_freq);
+
+	  /* the smallest size from which the reduce-scatter stays faster */
+	  gaspi_size_t threshold = buf_size;
+	  gaspi_number_t elems;
+
+	  for(elems = TUNE_MAX_ELEMS; elems >= 1; elems = (elems == TUNE_MAX_ELEMS) ? 128 : elems / 2)
+	    {
+	      const double t_dbl = tune_allreduce(g, GASPI_ALLREDUCE_DOUBLING, elems, cpu_freq);
+	      const double t_rsag = tune_allreduce(g, GASPI_ALLREDUCE_RSAG, elems, cpu_freq);
+
+	      if(t_rsag >= t_dbl)
+		{
+		  break;
+		}
+
+	      threshold = elems * sizeof(double);
+	    }
+
+	  if(0 == rank)
+	    {
+	      const int max_ranks = (next > tnc) ? 65535 : next - 1;
+	      const int min_ranks = (n == 2) ? 1 : n;
+
+	      fprintf(f, "barrier %d %d %s\n", min_ranks, max_ranks,
+		      (t_node < t_diss) ? "node" : "dissemination");
+	      fprintf(f, "allreduce %d %d %lu\n", min_ranks, max_ranks, threshold);
+
+	      printf("%d\t%.2f usecs\t%.2f usecs\t%lu bytes\n", n, t_diss, t_node, threshold);
+	    }
+	}
+
+      GPI2_ASSERT(gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+      GPI2_ASSERT(gaspi_group_delete(g));
+    }
+
+  if(0 == rank)
+    {
+      fclose(f);
+      printf("Decision table written to %s\n", path);
+    }
+
+  fflush(stdout);
+
+  GPI2_ASSERT(gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+  GPI2_ASSERT(gaspi_proc_term(GASPI_BLOCK));
+
+  return 0;
+}
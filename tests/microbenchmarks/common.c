@@ -1,3 +1,5 @@
+#include <string.h>
+
 #include "common.h"
 
 int
@@ -39,6 +41,25 @@ start_bench (int max_nodes)
   return 0;
 }
 
+/* "fused" as argument: write_notify carries the notification with
+   the data (notify_mode GASPI_NOTIFY_FUSED) */
+void
+bench_notify_mode (int argc, char *argv[])
+{
+  gaspi_config_t conf;
+
+  if (argc < 2 || strcmp (argv[1], "fused") != 0)
+    return;
+
+  gaspi_config_get (&conf);
+  conf.notify_mode = GASPI_NOTIFY_FUSED;
+
+  if (gaspi_config_set (conf) != GASPI_SUCCESS)
+    {
+      printf ("Failed to set notify_mode\n");
+      exit (-1);
+    }
+}
 
 void
 end_bench (void)
@@ -8,6 +8,8 @@
 
 int start_bench (int);
 
+void bench_notify_mode (int, char *[]);
+
 void end_bench (void);
 
 
@@ -0,0 +1,174 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include <GASPI.h>
+#include <GASPI_Ext.h>
+
+#include "utils.h"
+
+/* Message rate of small writes posted by many threads of rank 0 to
+   rank 1. Arguments: the number of threads (default 4) and of queues
+   they share (default 1, thread t posts to queue t % queues, or 0 for
+   an endpoint per thread). Each thread keeps at most its share of the
+   queue depth in flight. */
+
+#define MSG_RATE_SIZE 8
+#define MSG_RATE_TOTAL (1 << 18)
+
+#define GPI2_ASSERT(s) if(s != GASPI_SUCCESS) {printf("GASPI error:" #s " %d\n",__LINE__); fflush(stdout);_exit(EXIT_FAILURE);}
+
+static int num_threads = 4;
+static int num_queues = 1;
+static int batch;
+static gaspi_endpoint_t *endpoints;
+static int msgs_per_thread;
+
+static pthread_barrier_t start_barrier;
+
+static double
+now_usecs(void)
+{
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+
+  return tv.tv_sec * 1e6 + tv.tv_usec;
+}
+
+static void *
+poster(void *arg)
+{
+  const int t = (int) (long) arg;
+  const gaspi_offset_t off = (gaspi_offset_t) t * 64;
+  gaspi_queue_id_t q = (gaspi_queue_id_t) (t % (num_queues > 0 ? num_queues : 1));
+  int i, b;
+
+  if(endpoints != NULL)
+    {
+      GPI2_ASSERT(gaspi_endpoint_queue(endpoints[t], &q, NULL));
+    }
+
+  pthread_barrier_wait(&start_barrier);
+
+  for(i = 0; i < msgs_per_thread; i += batch)
+    {
+      for(b = 0; b < batch; b++)
+	{
+	  GPI2_ASSERT(gaspi_write(0, off, 1, 0, off, MSG_RATE_SIZE, q, GASPI_BLOCK));
+	}
+
+      GPI2_ASSERT(gaspi_wait(q, GASPI_BLOCK));
+    }
+
+  return NULL;
+}
+
+int
+main(int argc, char *argv[])
+{
+  gaspi_config_t conf;
+  gaspi_rank_t rank, nprocs;
+  pthread_t *threads;
+  int t;
+
+  if(argc > 1)
+    num_threads = atoi(argv[1]);
+  if(argc > 2)
+    num_queues = atoi(argv[2]);
+
+  GPI2_ASSERT(gaspi_config_get(&conf));
+
+  if(num_threads < 1 || num_queues < 0 || num_queues > (int) conf.queue_num)
+    {
+      printf("Usage: %s [threads] [queues (up to %d, 0 for endpoints)]\n", argv[0], conf.queue_num);
+      return EXIT_FAILURE;
+    }
+
+  /* endpoints get a queue each, up to 16 */
+  const int queues_used = (num_queues > 0) ? num_queues : (num_threads < 16 ? num_threads : 16);
+  const int threads_per_queue = (num_threads + queues_used - 1) / queues_used;
+
+  batch = conf.queue_depth / threads_per_queue;
+  if(batch > 256)
+    batch = 256;
+
+  msgs_per_thread = (MSG_RATE_TOTAL / num_threads / batch) * batch;
+
+  GPI2_ASSERT(gaspi_proc_init(GASPI_BLOCK));
+
+  GPI2_ASSERT(gaspi_proc_rank(&rank));
+  GPI2_ASSERT(gaspi_proc_num(&nprocs));
+
+  if(nprocs != 2)
+    {
+      printf("Run with 2 ranks.\n");
+      gaspi_proc_term(GASPI_BLOCK);
+      return EXIT_FAILURE;
+    }
+
+  GPI2_ASSERT(gaspi_segment_create(0, (gaspi_size_t) num_threads * 64, GASPI_GROUP_ALL,
+				   GASPI_BLOCK, GASPI_MEM_INITIALIZED));
+
+  GPI2_ASSERT(gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+
+  if(rank == 0)
+    {
+      threads = malloc(num_threads * sizeof(pthread_t));
+
+      if(num_queues == 0)
+	{
+	  endpoints = malloc(num_threads * sizeof(gaspi_endpoint_t));
+	  for(t = 0; t < num_threads; t++)
+	    {
+	      GPI2_ASSERT(gaspi_endpoint_create(&endpoints[t], GASPI_BLOCK));
+	    }
+	}
+
+      pthread_barrier_init(&start_barrier, NULL, num_threads + 1);
+
+      for(t = 0; t < num_threads; t++)
+	{
+	  pthread_create(&threads[t], NULL, poster, (void *) (long) t);
+	}
+
+      pthread_barrier_wait(&start_barrier);
+
+      const double t0 = now_usecs();
+
+      for(t = 0; t < num_threads; t++)
+	{
+	  pthread_join(threads[t], NULL);
+	}
+
+      const double t1 = now_usecs();
+      const double msgs = (double) msgs_per_thread * num_threads;
+
+      printf("#threads\tqueues\tmsgs\t\tMsgRate(Mpps)\n");
+      if(num_queues == 0)
+	printf("%d\t\tendp.\t%.0f\t\t%.4f\n", num_threads, msgs, msgs / (t1 - t0));
+      else
+	printf("%d\t\t%d\t%.0f\t\t%.4f\n", num_threads, num_queues, msgs, msgs / (t1 - t0));
+
+      if(endpoints != NULL)
+	{
+	  for(t = 0; t < num_threads; t++)
+	    {
+	      GPI2_ASSERT(gaspi_endpoint_delete(endpoints[t]));
+	    }
+	  free(endpoints);
+	}
+
+      pthread_barrier_destroy(&start_barrier);
+      free(threads);
+    }
+
+  fflush(stdout);
+
+  GPI2_ASSERT(gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+  GPI2_ASSERT(gaspi_proc_term(GASPI_BLOCK));
+
+  return 0;
+}
@@ -0,0 +1,109 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <GASPI.h>
+#include <GASPI_Ext.h>
+
+#include "utils.h"
+
+/* Time to take a burst of ready notifications spread over the whole
+   notification space: gaspi_notify_waitsome and gaspi_notify_reset per
+   notification against gaspi_notify_waitsome_multi, in a segment
+   without and in one with notification summary */
+
+#define HARVEST_ITERATIONS 200
+#define MAX_BURST 64
+
+#define GPI2_ASSERT(s) if(s != GASPI_SUCCESS) {printf("GASPI error:" #s " %d\n",__LINE__); fflush(stdout);_exit(EXIT_FAILURE);}
+
+static void
+post_burst(gaspi_segment_id_t seg, gaspi_rank_t rank, int burst)
+{
+  gaspi_notification_id_t id;
+  int i;
+
+  for(i = 0; i < burst; i++)
+    {
+      GPI2_ASSERT(gaspi_notify(seg, rank, (gaspi_notification_id_t) (i * 1021 + 3), 1, 0, GASPI_BLOCK));
+    }
+
+  GPI2_ASSERT(gaspi_wait(0, GASPI_BLOCK));
+
+  /* all of them landed */
+  GPI2_ASSERT(gaspi_notify_waitsome(seg, (gaspi_notification_id_t) ((burst - 1) * 1021 + 3), 1, &id, GASPI_BLOCK));
+}
+
+static double
+harvest_time(gaspi_segment_id_t seg, gaspi_rank_t rank, int burst, int multi, gaspi_float cpu_freq)
+{
+  gaspi_notification_id_t ids[MAX_BURST], id;
+  gaspi_notification_t values[MAX_BURST], val;
+  gaspi_number_t count;
+  int i, taken;
+
+  for(i = 0; i < HARVEST_ITERATIONS; i++)
+    {
+      post_burst(seg, rank, burst);
+
+      const mcycles_t t0 = get_mcycles();
+
+      for(taken = 0; taken < burst; taken += (multi ? count : 1))
+	{
+	  if(multi)
+	    {
+	      GPI2_ASSERT(gaspi_notify_waitsome_multi(seg, 0, 65535, ids, values, MAX_BURST, &count, GASPI_BLOCK));
+	    }
+	  else
+	    {
+	      GPI2_ASSERT(gaspi_notify_waitsome(seg, 0, 65535, &id, GASPI_BLOCK));
+	      GPI2_ASSERT(gaspi_notify_reset(seg, id, &val));
+	    }
+	}
+
+      delta[i] = get_mcycles() - t0;
+    }
+
+  qsort(delta, HARVEST_ITERATIONS, sizeof *delta, mcycles_compare);
+
+  return (double) delta[HARVEST_ITERATIONS / 2] / cpu_freq;
+}
+
+int
+main(int argc, char *argv[])
+{
+  gaspi_rank_t rank;
+  gaspi_float cpu_freq;
+  int burst;
+
+  GPI2_ASSERT(gaspi_proc_init(GASPI_BLOCK));
+
+  GPI2_ASSERT(gaspi_proc_rank(&rank));
+  GPI2_ASSERT(gaspi_cpu_frequency(&cpu_freq));
+
+  GPI2_ASSERT(gaspi_segment_create(0, 4096, GASPI_GROUP_ALL, GASPI_BLOCK, GASPI_MEM_INITIALIZED));
+  GPI2_ASSERT(gaspi_segment_create(1, 4096, GASPI_GROUP_ALL, GASPI_BLOCK,
+				   GASPI_MEM_INITIALIZED | GASPI_MEM_NOTIFY_SUMMARY));
+
+  if(0 == rank)
+    printf("#burst\twaitsome+reset (usecs)\twaitsome_multi (usecs)\tsummary: waitsome+reset\twaitsome_multi\n");
+
+  for(burst = 1; burst <= MAX_BURST; burst *= 2)
+    {
+      const double t_single = harvest_time(0, rank, burst, 0, cpu_freq);
+      const double t_multi = harvest_time(0, rank, burst, 1, cpu_freq);
+      const double t_sum_single = harvest_time(1, rank, burst, 0, cpu_freq);
+      const double t_sum_multi = harvest_time(1, rank, burst, 1, cpu_freq);
+
+      if(0 == rank)
+	printf("%d\t%.3f\t\t\t%.3f\t\t\t%.3f\t\t\t%.3f\n",
+	       burst, t_single, t_multi, t_sum_single, t_sum_multi);
+    }
+
+  fflush(stdout);
+
+  GPI2_ASSERT(gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+  GPI2_ASSERT(gaspi_proc_term(GASPI_BLOCK));
+
+  return 0;
+}
@@ -0,0 +1,99 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <GASPI.h>
+#include <GASPI_Ext.h>
+
+#include "utils.h"
+
+/* Cost of a notify_waitsome pass over growing windows of notification
+   ids: GASPI_TEST on an idle window scans all of it, and with the last
+   notification of the window set the scan runs up to it. In a segment
+   with a notification summary only the active blocks are scanned. */
+
+#define GPI2_ASSERT(s) if(s != GASPI_SUCCESS) {printf("GASPI error:" #s " %d\n",__LINE__); fflush(stdout);_exit(EXIT_FAILURE);}
+
+static double
+scan_time(gaspi_segment_id_t seg, gaspi_number_t num, gaspi_float cpu_freq, gaspi_return_t expected)
+{
+  gaspi_notification_id_t id;
+  int i;
+
+  for(i = 0; i < ITERATIONS; i++)
+    {
+      const mcycles_t t0 = get_mcycles();
+      const gaspi_return_t ret = gaspi_notify_waitsome(seg, 0, num, &id, GASPI_TEST);
+      delta[i] = get_mcycles() - t0;
+
+      if(ret != expected)
+	{
+	  printf("Unexpected return of waitsome over %u ids: %d\n", num, ret);
+	  _exit(EXIT_FAILURE);
+	}
+    }
+
+  qsort(delta, ITERATIONS, sizeof *delta, mcycles_compare);
+
+  return (double) delta[ITERATIONS / 2] / cpu_freq;
+}
+
+/* scan time with the last notification of the window set */
+static double
+set_time(gaspi_segment_id_t seg, gaspi_number_t num, gaspi_rank_t rank, gaspi_float cpu_freq)
+{
+  gaspi_notification_id_t id;
+  gaspi_notification_t val;
+
+  GPI2_ASSERT(gaspi_notify(seg, rank, (gaspi_notification_id_t) (num - 1), 1, 0, GASPI_BLOCK));
+  GPI2_ASSERT(gaspi_notify_waitsome(seg, (gaspi_notification_id_t) (num - 1), 1, &id, GASPI_BLOCK));
+
+  const double t = scan_time(seg, num, cpu_freq, GASPI_SUCCESS);
+
+  GPI2_ASSERT(gaspi_notify_reset(seg, id, &val));
+  GPI2_ASSERT(gaspi_wait(0, GASPI_BLOCK));
+
+  return t;
+}
+
+int
+main(int argc, char *argv[])
+{
+  gaspi_rank_t rank;
+  gaspi_float cpu_freq;
+  gaspi_number_t num;
+
+  GPI2_ASSERT(gaspi_proc_init(GASPI_BLOCK));
+
+  GPI2_ASSERT(gaspi_proc_rank(&rank));
+  GPI2_ASSERT(gaspi_cpu_frequency(&cpu_freq));
+
+  GPI2_ASSERT(gaspi_segment_create(0, 4096, GASPI_GROUP_ALL, GASPI_BLOCK, GASPI_MEM_INITIALIZED));
+  GPI2_ASSERT(gaspi_segment_create(1, 4096, GASPI_GROUP_ALL, GASPI_BLOCK,
+				   GASPI_MEM_INITIALIZED | GASPI_MEM_NOTIFY_SUMMARY));
+
+  if(0 == rank)
+    printf("#ids\tidle (usecs)\tlast set (usecs)\tnsecs/id\tsummary idle\tsummary last set\n");
+
+  for(num = 64; num <= 65536; num *= 2)
+    {
+      const gaspi_number_t n = (num == 65536) ? 65535 : num;
+
+      const double t_idle = scan_time(0, n, cpu_freq, GASPI_TIMEOUT);
+      const double t_set = set_time(0, n, rank, cpu_freq);
+
+      const double t_sum_idle = scan_time(1, n, cpu_freq, GASPI_TIMEOUT);
+      const double t_sum_set = set_time(1, n, rank, cpu_freq);
+
+      if(0 == rank)
+	printf("%u\t%.3f\t\t%.3f\t\t\t%.3f\t\t%.3f\t\t%.3f\n",
+	       n, t_idle, t_set, t_idle * 1000.0 / n, t_sum_idle, t_sum_set);
+    }
+
+  fflush(stdout);
+
+  GPI2_ASSERT(gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+  GPI2_ASSERT(gaspi_proc_term(GASPI_BLOCK));
+
+  return 0;
+}
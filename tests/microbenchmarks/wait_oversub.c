@@ -0,0 +1,112 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+
+#include <GASPI.h>
+
+#include "utils.h"
+
+/* A token passed around a ring of all ranks, the waits of the idle
+   ranks with the wait policy given as argument ("spin", the default,
+   or "adaptive" with the spin time in usecs as optional second
+   argument). Run with more ranks than cores to compare the policies
+   when oversubscribed: time per round and CPU time used per rank. */
+
+#define OVERSUB_ROUNDS 2000
+
+#define GPI2_ASSERT(s) if(s != GASPI_SUCCESS) {printf("GASPI error:" #s " %d\n",__LINE__); fflush(stdout);_exit(EXIT_FAILURE);}
+
+static double
+now_usecs(void)
+{
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+
+  return tv.tv_sec * 1e6 + tv.tv_usec;
+}
+
+static double
+cpu_usecs(void)
+{
+  struct rusage usage;
+
+  getrusage(RUSAGE_SELF, &usage);
+
+  return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1e6
+    + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+int
+main(int argc, char *argv[])
+{
+  gaspi_config_t conf;
+  gaspi_rank_t rank, nprocs;
+  gaspi_notification_id_t id;
+  gaspi_notification_t val;
+  int r;
+
+  GPI2_ASSERT(gaspi_config_get(&conf));
+
+  if(argc > 1 && strcmp(argv[1], "adaptive") == 0)
+    {
+      conf.wait_policy = GASPI_WAIT_ADAPTIVE;
+      if(argc > 2)
+	conf.wait_spin_us = atoi(argv[2]);
+    }
+
+  GPI2_ASSERT(gaspi_config_set(conf));
+
+  GPI2_ASSERT(gaspi_proc_init(GASPI_BLOCK));
+
+  GPI2_ASSERT(gaspi_proc_rank(&rank));
+  GPI2_ASSERT(gaspi_proc_num(&nprocs));
+
+  GPI2_ASSERT(gaspi_segment_create(0, 4096, GASPI_GROUP_ALL, GASPI_BLOCK, GASPI_MEM_INITIALIZED));
+
+  const gaspi_rank_t right = (rank + 1) % nprocs;
+
+  GPI2_ASSERT(gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+
+  const double t0 = now_usecs();
+  const double c0 = cpu_usecs();
+
+  for(r = 0; r < OVERSUB_ROUNDS; r++)
+    {
+      if(rank != 0 || r > 0)
+	{
+	  GPI2_ASSERT(gaspi_notify_waitsome(0, 0, 1, &id, GASPI_BLOCK));
+	  GPI2_ASSERT(gaspi_notify_reset(0, id, &val));
+	}
+
+      GPI2_ASSERT(gaspi_notify(0, right, 0, 1, 0, GASPI_BLOCK));
+      GPI2_ASSERT(gaspi_wait(0, GASPI_BLOCK));
+    }
+
+  if(rank == 0)
+    {
+      GPI2_ASSERT(gaspi_notify_waitsome(0, 0, 1, &id, GASPI_BLOCK));
+      GPI2_ASSERT(gaspi_notify_reset(0, id, &val));
+    }
+
+  const double t1 = now_usecs();
+  const double c1 = cpu_usecs();
+
+  if(0 == rank)
+    {
+      printf("#policy\tranks\tround (usecs)\tcpu rank 0 (%% of wall)\n");
+      printf("%s\t%d\t%.2f\t\t%.1f\n",
+	     (conf.wait_policy == GASPI_WAIT_ADAPTIVE) ? "adaptive" : "spin",
+	     nprocs, (t1 - t0) / OVERSUB_ROUNDS, 100.0 * (c1 - c0) / (t1 - t0));
+    }
+
+  fflush(stdout);
+
+  GPI2_ASSERT(gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+  GPI2_ASSERT(gaspi_proc_term(GASPI_BLOCK));
+
+  return 0;
+}
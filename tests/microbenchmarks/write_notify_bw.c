@@ -11,6 +11,8 @@ main (int argc, char *argv[])
   //on numa architectures you have to map this process to the numa node where nic is installed
   //if(gaspi_set_socket_affinity(1) != GASPI_SUCCESS){ printf("gaspi_set_socket_affinity failed !\n"); }
 
+  bench_notify_mode (argc, argv);
+
   if (start_bench (2) != 0)
     {
       printf ("Initialization failed\n");
@@ -10,6 +10,8 @@ main (int argc, char *argv[])
   char *ptr0;
 
 
+  bench_notify_mode (argc, argv);
+
   //on numa architectures you have to map this process to the numa node where nic is installed
   if (start_bench (2) != 0)
     {
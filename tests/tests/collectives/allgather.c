@@ -0,0 +1,146 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <test_utils.h>
+
+/* Allgather(v) of several block sizes, covering the log2 and the ring
+   algorithms, in GASPI_GROUP_ALL and in a group of the even ranks */
+
+#define SEG_SIZE (32 << 20)
+
+static unsigned char
+value(gaspi_rank_t rank, gaspi_size_t i, int iter)
+{
+  return (unsigned char) (rank * 31 + i * 7 + iter);
+}
+
+static void
+fill(unsigned char *block, gaspi_size_t size, gaspi_rank_t rank, int iter)
+{
+  gaspi_size_t i;
+
+  for(i = 0; i < size; i++)
+    {
+      block[i] = value(rank, i, iter);
+    }
+}
+
+static int
+check(unsigned char *buf, gaspi_size_t *sizes, gaspi_rank_t *ranks, gaspi_number_t n, int iter)
+{
+  gaspi_number_t r;
+  gaspi_size_t i;
+
+  for(r = 0; r < n; r++)
+    {
+      for(i = 0; i < sizes[r]; i++)
+	{
+	  if(buf[i] != value(ranks[r], i, iter))
+	    {
+	      gaspi_printf("block %u byte %lu is wrong\n", r, i);
+	      return 0;
+	    }
+	}
+      buf += sizes[r];
+    }
+
+  return 1;
+}
+
+static void
+run(gaspi_group_t g, gaspi_rank_t myrank, unsigned char *seg_ptr, int iter, int variable, gaspi_size_t bsize)
+{
+  gaspi_number_t n, r, me = 0;
+  gaspi_size_t off = 0;
+  gaspi_return_t ret;
+
+  ASSERT(gaspi_group_size(g, &n));
+
+  gaspi_rank_t *ranks = malloc(n * sizeof(gaspi_rank_t));
+  gaspi_size_t *sizes = malloc(n * sizeof(gaspi_size_t));
+  assert(ranks != NULL && sizes != NULL);
+
+  ASSERT(gaspi_group_ranks(g, ranks));
+
+  for(r = 0; r < n; r++)
+    {
+      sizes[r] = variable ? (bsize * (r + 1)) / n + (r % 3 == 1 ? 0 : 5) : bsize;
+      if(ranks[r] == myrank)
+	me = r;
+    }
+
+  for(r = 0; r < me; r++)
+    off += sizes[r];
+
+  memset(seg_ptr, 0, SEG_SIZE);
+  fill(seg_ptr + off, sizes[me], myrank, iter);
+
+  do
+    {
+      if(variable)
+	ret = gaspi_allgatherv(0, 0, sizes, g, (iter % 2) ? GASPI_TEST : GASPI_BLOCK);
+      else
+	ret = gaspi_allgather(0, 0, bsize, g, (iter % 2) ? GASPI_TEST : GASPI_BLOCK);
+      assert(ret != GASPI_ERROR);
+    }
+  while(ret != GASPI_SUCCESS);
+
+  assert(check(seg_ptr, sizes, ranks, n, iter));
+
+  free(ranks);
+  free(sizes);
+}
+
+int main(int argc, char *argv[])
+{
+  gaspi_rank_t nprocs, myrank, r;
+  gaspi_group_t g;
+  gaspi_pointer_t seg_ptr;
+  int s, iter = 0;
+
+  const gaspi_size_t sizes[] = { 1, 8, 1000, 4096, 100000, 1 << 20 };
+  const int nsizes = sizeof(sizes) / sizeof(sizes[0]);
+
+  TSUITE_INIT(argc, argv);
+
+  ASSERT (gaspi_proc_init(GASPI_BLOCK));
+
+  ASSERT(gaspi_proc_num(&nprocs));
+  ASSERT(gaspi_proc_rank(&myrank));
+
+  ASSERT(gaspi_segment_create(0, SEG_SIZE, GASPI_GROUP_ALL, GASPI_BLOCK, GASPI_MEM_INITIALIZED));
+  ASSERT(gaspi_segment_ptr(0, &seg_ptr));
+
+  for(s = 0; s < nsizes; s++)
+    {
+      run(GASPI_GROUP_ALL, myrank, seg_ptr, iter++, 0, sizes[s]);
+      run(GASPI_GROUP_ALL, myrank, seg_ptr, iter++, 1, sizes[s]);
+    }
+
+  if(nprocs > 2)
+    {
+      ASSERT(gaspi_group_create(&g));
+
+      for(r = 0; r < nprocs; r += 2)
+	{
+	  ASSERT(gaspi_group_add(g, r));
+	}
+
+      if(myrank % 2 == 0)
+	{
+	  ASSERT(gaspi_group_commit(g, GASPI_BLOCK));
+
+	  for(s = 0; s < nsizes; s++)
+	    {
+	      run(g, myrank, seg_ptr, iter++, 0, sizes[s]);
+	      run(g, myrank, seg_ptr, iter++, 1, sizes[s]);
+	    }
+	}
+    }
+
+  ASSERT (gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+
+  ASSERT (gaspi_proc_term(GASPI_BLOCK));
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,130 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <test_utils.h>
+
+/* Allreduce with element counts beyond gaspi_allreduce_elem_max */
+
+static int
+check_long(long *v, gaspi_number_t n, gaspi_operation_t op, gaspi_rank_t nprocs)
+{
+  gaspi_number_t i;
+
+  for(i = 0; i < n; i++)
+    {
+      long expected = 0;
+      switch(op)
+	{
+	case GASPI_OP_MIN: expected = (long) i;
+	  break;
+	case GASPI_OP_MAX: expected = (long) i + nprocs - 1;
+	  break;
+	case GASPI_OP_SUM: expected = (long) i * nprocs + (nprocs * (nprocs - 1)) / 2;
+	  break;
+	}
+
+      if(v[i] != expected)
+	{
+	  gaspi_printf("elem %u: expected %ld got %ld\n", i, expected, v[i]);
+	  return 0;
+	}
+    }
+
+  return 1;
+}
+
+static int
+check_double(double *v, gaspi_number_t n, gaspi_rank_t nprocs)
+{
+  gaspi_number_t i;
+
+  for(i = 0; i < n; i++)
+    {
+      const double expected = 0.5 * i * nprocs + (nprocs * (nprocs - 1)) / 2;
+      if(v[i] != expected)
+	{
+	  gaspi_printf("elem %u: expected %.2f got %.2f\n", i, expected, v[i]);
+	  return 0;
+	}
+    }
+
+  return 1;
+}
+
+int main(int argc, char *argv[])
+{
+  gaspi_rank_t nprocs, myrank;
+  gaspi_number_t i, s;
+  gaspi_operation_t op;
+  gaspi_return_t ret;
+
+  const gaspi_number_t sizes[] = { 256, 1000, 4103, 65536, 100003, 1 << 20 };
+  const gaspi_number_t nsizes = sizeof(sizes) / sizeof(sizes[0]);
+  const gaspi_number_t max_elems = 1 << 20;
+
+  TSUITE_INIT(argc, argv);
+
+  ASSERT (gaspi_proc_init(GASPI_BLOCK));
+
+  ASSERT(gaspi_proc_num(&nprocs));
+  ASSERT(gaspi_proc_rank(&myrank));
+
+  long *lsend = malloc(max_elems * sizeof(long));
+  long *lrecv = malloc(max_elems * sizeof(long));
+  double *dsend = malloc(max_elems * sizeof(double));
+  double *drecv = malloc(max_elems * sizeof(double));
+
+  if(lsend == NULL || lrecv == NULL || dsend == NULL || drecv == NULL)
+    return EXIT_FAILURE;
+
+  for(i = 0; i < max_elems; i++)
+    {
+      lsend[i] = (long) i + myrank;
+      dsend[i] = 0.5 * i + myrank;
+    }
+
+  ASSERT (gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+
+  for(s = 0; s < nsizes; s++)
+    {
+      for(op = GASPI_OP_MIN; op <= GASPI_OP_SUM; op++)
+	{
+	  ASSERT(gaspi_allreduce(lsend, lrecv, sizes[s], op, GASPI_TYPE_LONG,
+				 GASPI_GROUP_ALL, GASPI_BLOCK));
+	  assert(check_long(lrecv, sizes[s], op, nprocs));
+	}
+
+      ASSERT(gaspi_allreduce(dsend, drecv, sizes[s], GASPI_OP_SUM, GASPI_TYPE_DOUBLE,
+			     GASPI_GROUP_ALL, GASPI_BLOCK));
+      assert(check_double(drecv, sizes[s], nprocs));
+    }
+
+  /* interleave with small allreduces and resume after timeouts */
+  for(s = 0; s < 10; s++)
+    {
+      ASSERT(gaspi_allreduce(lsend, lrecv, 255, GASPI_OP_SUM, GASPI_TYPE_LONG,
+			     GASPI_GROUP_ALL, GASPI_BLOCK));
+      assert(check_long(lrecv, 255, GASPI_OP_SUM, nprocs));
+
+      do
+	{
+	  ret = gaspi_allreduce(lsend, lrecv, 70001, GASPI_OP_SUM, GASPI_TYPE_LONG,
+				GASPI_GROUP_ALL, GASPI_TEST);
+	  assert(ret != GASPI_ERROR);
+	}
+      while(ret != GASPI_SUCCESS);
+
+      assert(check_long(lrecv, 70001, GASPI_OP_SUM, nprocs));
+    }
+
+  ASSERT (gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+
+  free(lsend);
+  free(lrecv);
+  free(dsend);
+  free(drecv);
+
+  ASSERT (gaspi_proc_term(GASPI_BLOCK));
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,111 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <test_utils.h>
+
+/* Large allreduces (pre-defined and user reductions) called with
+   GASPI_TEST until they succeed, with a queue so short that the
+   collectives queue is found full in the middle of the steps: each
+   call resumes where the previous one stopped */
+
+#define DEPTH 2
+
+static gaspi_return_t
+my_sum (long * const a, long * const b, long * const r,
+	gaspi_state_t const state, const gaspi_number_t num,
+	const gaspi_size_t elem_size, const gaspi_timeout_t tout)
+{
+  gaspi_number_t i;
+
+  for(i = 0; i < num; i++)
+    {
+      r[i] = a[i] + b[i];
+    }
+
+  return GASPI_SUCCESS;
+}
+
+static void
+check_sum(long *v, gaspi_number_t n, gaspi_rank_t nprocs)
+{
+  gaspi_number_t i;
+
+  for(i = 0; i < n; i++)
+    {
+      assert(v[i] == (long) i * nprocs + (nprocs * (nprocs - 1)) / 2);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+  gaspi_config_t conf;
+  gaspi_rank_t nprocs, myrank;
+  gaspi_return_t ret;
+  gaspi_number_t i, s;
+
+  const gaspi_number_t sizes[] = { 256, 4103, 70001 };
+  const gaspi_number_t nsizes = sizeof(sizes) / sizeof(sizes[0]);
+  const gaspi_number_t max_elems = 70001;
+
+  TSUITE_INIT(argc, argv);
+
+  ASSERT(gaspi_config_get(&conf));
+  conf.queue_depth = DEPTH;
+  ASSERT(gaspi_config_set(conf));
+
+  ASSERT(gaspi_proc_init(GASPI_BLOCK));
+
+  ASSERT(gaspi_proc_num(&nprocs));
+  ASSERT(gaspi_proc_rank(&myrank));
+
+  long *send = malloc(max_elems * sizeof(long));
+  long *recv = malloc(max_elems * sizeof(long));
+
+  if(send == NULL || recv == NULL)
+    return EXIT_FAILURE;
+
+  for(i = 0; i < max_elems; i++)
+    {
+      send[i] = (long) i + myrank;
+    }
+
+  ASSERT(gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+
+  for(s = 0; s < nsizes; s++)
+    {
+      memset(recv, 0, sizes[s] * sizeof(long));
+
+      do
+	{
+	  ret = gaspi_allreduce(send, recv, sizes[s], GASPI_OP_SUM, GASPI_TYPE_LONG,
+				GASPI_GROUP_ALL, GASPI_TEST);
+	  assert(ret == GASPI_SUCCESS || ret == GASPI_TIMEOUT);
+	}
+      while(ret != GASPI_SUCCESS);
+
+      check_sum(recv, sizes[s], nprocs);
+
+      memset(recv, 0, sizes[s] * sizeof(long));
+
+      do
+	{
+	  ret = gaspi_allreduce_user(send, recv, sizes[s], sizeof(long),
+				     (gaspi_reduce_operation_t) my_sum, NULL,
+				     GASPI_GROUP_ALL, GASPI_TEST);
+	  assert(ret == GASPI_SUCCESS || ret == GASPI_TIMEOUT);
+	}
+      while(ret != GASPI_SUCCESS);
+
+      check_sum(recv, sizes[s], nprocs);
+    }
+
+  ASSERT(gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+
+  free(send);
+  free(recv);
+
+  ASSERT(gaspi_proc_term(GASPI_BLOCK));
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,124 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <test_utils.h>
+
+/* Allreduce on segments of several sizes, with one and with several
+   chunks, in GASPI_GROUP_ALL and in a group of the even ranks */
+
+#define MAX_ELEMS 100000
+#define SEG_SIZE (2 * MAX_ELEMS * sizeof(long) + 4096)
+
+static void
+run(gaspi_group_t g, gaspi_rank_t myrank, long *seg_ptr, gaspi_number_t elems, int iter)
+{
+  gaspi_number_t n, i;
+  gaspi_rank_t *ranks;
+  gaspi_return_t ret;
+  long lmin = -1, lsum = 0;
+
+  ASSERT(gaspi_group_size(g, &n));
+
+  ranks = malloc(n * sizeof(gaspi_rank_t));
+  assert(ranks != NULL);
+  ASSERT(gaspi_group_ranks(g, ranks));
+
+  for(i = 0; i < n; i++)
+    {
+      lsum += ranks[i];
+      if(lmin < 0 || ranks[i] < lmin)
+	lmin = ranks[i];
+    }
+
+  /* input at the start, result behind it at another offset */
+  long *send = seg_ptr + 1;
+  long *recv = seg_ptr + MAX_ELEMS + 3;
+
+  for(i = 0; i < elems; i++)
+    {
+      send[i] = (long) i * iter + myrank;
+      recv[i] = -1;
+    }
+
+  do
+    {
+      ret = gaspi_allreduce_segment(0, sizeof(long), 0, (MAX_ELEMS + 3) * sizeof(long), elems,
+				    (iter % 2) ? GASPI_OP_SUM : GASPI_OP_MIN, GASPI_TYPE_LONG,
+				    g, (iter % 3) ? GASPI_BLOCK : GASPI_TEST);
+      assert(ret != GASPI_ERROR);
+    }
+  while(ret != GASPI_SUCCESS);
+
+  for(i = 0; i < elems; i++)
+    {
+      const long expected = (iter % 2) ? (long) i * iter * n + lsum : (long) i * iter + lmin;
+      if(recv[i] != expected)
+	{
+	  gaspi_printf("allreduce_segment of %u: elem %u expected %ld got %ld\n",
+		       elems, i, expected, recv[i]);
+	  exit(EXIT_FAILURE);
+	}
+
+      /* the input is left alone */
+      assert(send[i] == (long) i * iter + myrank);
+    }
+
+  free(ranks);
+}
+
+int main(int argc, char *argv[])
+{
+  gaspi_rank_t nprocs, myrank, r;
+  gaspi_pointer_t seg_ptr;
+  gaspi_group_t g;
+  int s, iter = 0;
+
+  const gaspi_number_t sizes[] = { 0, 1, 7, 255, 1000, 4096, 5000, MAX_ELEMS };
+  const int nsizes = sizeof(sizes) / sizeof(sizes[0]);
+
+  TSUITE_INIT(argc, argv);
+
+  ASSERT (gaspi_proc_init(GASPI_BLOCK));
+
+  ASSERT(gaspi_proc_num(&nprocs));
+  ASSERT(gaspi_proc_rank(&myrank));
+
+  ASSERT(gaspi_segment_create(0, SEG_SIZE, GASPI_GROUP_ALL, GASPI_BLOCK, GASPI_MEM_INITIALIZED));
+  ASSERT(gaspi_segment_ptr(0, &seg_ptr));
+
+  /* no in place operation */
+  EXPECT_FAIL(gaspi_allreduce_segment(0, 0, 0, 8 * sizeof(long), 10, GASPI_OP_SUM, GASPI_TYPE_LONG,
+				      GASPI_GROUP_ALL, GASPI_BLOCK));
+
+  for(s = 0; s < nsizes; s++)
+    {
+      run(GASPI_GROUP_ALL, myrank, seg_ptr, sizes[s], iter++);
+      run(GASPI_GROUP_ALL, myrank, seg_ptr, sizes[s], iter++);
+    }
+
+  if(nprocs > 2)
+    {
+      ASSERT(gaspi_group_create(&g));
+
+      for(r = 0; r < nprocs; r += 2)
+	{
+	  ASSERT(gaspi_group_add(g, r));
+	}
+
+      if(myrank % 2 == 0)
+	{
+	  ASSERT(gaspi_group_commit(g, GASPI_BLOCK));
+
+	  for(s = 0; s < nsizes; s++)
+	    {
+	      run(g, myrank, seg_ptr, sizes[s], iter++);
+	    }
+	}
+    }
+
+  ASSERT (gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+
+  ASSERT (gaspi_proc_term(GASPI_BLOCK));
+
+  return EXIT_SUCCESS;
+}
@@ -67,6 +67,36 @@ int main(int argc, char *argv[])
   free(a);
   free(b);
 
+  /* beyond the small message buffer */
+  const int large[] = { 256, 4099, 100000 };
+  int l;
+
+  a = (double *) malloc(100000 * sizeof(double));
+  b = (double *) malloc(100000 * sizeof(double));
+
+  if(a == NULL || b == NULL)
+    return EXIT_FAILURE;
+
+  for(l = 0; l < 3; l++)
+    {
+      int i;
+
+      for(n = 0; n < large[l]; n++)
+	{
+	  a[n] = (double) ((myrank + n) % nprocs);
+	  b[n] = -1.0;
+	}
+
+      ASSERT(gaspi_allreduce_user(a, b, large[l], sizeof(double),
+				  (gaspi_reduce_operation_t) my_fun, NULL,
+				  GASPI_GROUP_ALL, GASPI_BLOCK));
+      for(i = 0; i < large[l]; i++)
+	assert(b[i] == nprocs - 1);
+    }
+
+  free(a);
+  free(b);
+
   //sync                                                                                                  
   ASSERT (gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
   ASSERT (gaspi_proc_term(GASPI_BLOCK));
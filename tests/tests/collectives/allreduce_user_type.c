@@ -2,6 +2,7 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
 #include <test_utils.h>
@@ -52,46 +53,58 @@ int main(int argc, char *argv[])
 
   if(myrank == 0)
     {
-      printf("Max buf size %lu max elem %d elem size %lu (will allow %lu elems).\n",
+      printf("Max buf size %lu max elem %d elem size %lu (%lu elems fit the buffer).\n",
 	     buf_size, elem_max, sizeof(struct elem), buf_size / sizeof(struct elem));
     }
 
-  struct elem * a = (struct elem *) calloc(elem_max, sizeof(struct elem) );
-  struct elem * b = (struct elem *) calloc(elem_max, sizeof(struct elem));
+  /* beyond the buffer (and elem_max) the reduction takes the large
+     message algorithm */
+  const gaspi_number_t large = 5000;
+
+  struct elem * a = (struct elem *) calloc(large, sizeof(struct elem) );
+  struct elem * b = (struct elem *) calloc(large, sizeof(struct elem));
 
   if(a == NULL || b == NULL)
     return EXIT_FAILURE;
 
-  for(n = 0; n < elem_max; n++)
+  for(n = 0; n < large; n++)
     {
-      a[n].a = b[n].a = myrank * 1.0;
+      a[n].a = myrank * 1.0 + n;
     }
 
   ASSERT (gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
 
-  for(n = 1; n <= elem_max; n++)
+  for(n = 1; n <= elem_max + 1; n++)
     {
       gaspi_number_t i;
-      if( (n * sizeof(struct elem)) > buf_size)
-	{
-	  EXPECT_FAIL(gaspi_allreduce_user(a, b, n, sizeof(struct elem),
-					   (gaspi_reduce_operation_t) my_fun, NULL,
-					   GASPI_GROUP_ALL,
-					   GASPI_BLOCK));
-	}
-      else
+
+      memset(b, 0, n * sizeof(struct elem));
+
+      ASSERT(gaspi_allreduce_user(a, b, n, sizeof(struct elem),
+				  (gaspi_reduce_operation_t) my_fun, NULL,
+				  GASPI_GROUP_ALL,
+				  GASPI_BLOCK));
+      for(i = 0; i < n; i++)
 	{
-	  ASSERT(gaspi_allreduce_user(a, b, n, sizeof(struct elem),
-				      (gaspi_reduce_operation_t) my_fun, NULL,
-				      GASPI_GROUP_ALL,
-				      GASPI_BLOCK));
-	  for(i = 0; i < n; i++)
-	    {
-	       assert(b[i].a == nprocs - 1);
-	    }
+	  assert(b[i].a == nprocs - 1 + i);
 	}
     }
 
+  {
+    gaspi_number_t i;
+
+    memset(b, 0, large * sizeof(struct elem));
+
+    ASSERT(gaspi_allreduce_user(a, b, large, sizeof(struct elem),
+				(gaspi_reduce_operation_t) my_fun, NULL,
+				GASPI_GROUP_ALL,
+				GASPI_BLOCK));
+    for(i = 0; i < large; i++)
+      {
+	assert(b[i].a == nprocs - 1 + i);
+      }
+  }
+
   //sync                                                                                                  
   ASSERT (gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
   free(a);
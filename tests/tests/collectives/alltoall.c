@@ -0,0 +1,158 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <test_utils.h>
+
+/* Alltoall(v) of several block sizes, in GASPI_GROUP_ALL and in a
+   group of the even ranks, including empty blocks and resuming after
+   timeouts */
+
+#define SEG_SIZE (16 << 20)
+
+static unsigned char
+value(gaspi_rank_t from, gaspi_rank_t to, gaspi_size_t i, int iter)
+{
+  return (unsigned char) (from * 31 + to * 17 + i * 7 + iter);
+}
+
+/* size of the block from the i-th to the j-th rank of the group */
+static gaspi_size_t
+block_size(gaspi_number_t i, gaspi_number_t j, int variable, gaspi_size_t bsize)
+{
+  if(!variable)
+    return bsize;
+
+  return ((i + 2 * j) % 4 == 3) ? 0 : bsize * ((i + j) % 3 + 1) / 2;
+}
+
+static void
+run(gaspi_group_t g, gaspi_rank_t myrank, unsigned char *seg_ptr, int iter, int variable, gaspi_size_t bsize)
+{
+  gaspi_number_t n, r, me = 0;
+  gaspi_size_t i, off;
+  gaspi_return_t ret;
+
+  unsigned char * const send = seg_ptr;
+  unsigned char * const recv = seg_ptr + SEG_SIZE / 2;
+
+  ASSERT(gaspi_group_size(g, &n));
+
+  gaspi_rank_t *ranks = malloc(n * sizeof(gaspi_rank_t));
+  gaspi_size_t *send_sizes = malloc(n * sizeof(gaspi_size_t));
+  gaspi_size_t *recv_sizes = malloc(n * sizeof(gaspi_size_t));
+  assert(ranks != NULL && send_sizes != NULL && recv_sizes != NULL);
+
+  ASSERT(gaspi_group_ranks(g, ranks));
+
+  for(r = 0; r < n; r++)
+    {
+      if(ranks[r] == myrank)
+	me = r;
+    }
+
+  off = 0;
+  for(r = 0; r < n; r++)
+    {
+      send_sizes[r] = block_size(me, r, variable, bsize);
+      recv_sizes[r] = block_size(r, me, variable, bsize);
+
+      for(i = 0; i < send_sizes[r]; i++)
+	{
+	  send[off + i] = value(myrank, ranks[r], i, iter);
+	}
+      off += send_sizes[r];
+    }
+
+  memset(recv, 0, SEG_SIZE / 2);
+
+  do
+    {
+      if(variable)
+	ret = gaspi_alltoallv(0, 0, send_sizes, 0, SEG_SIZE / 2, recv_sizes, g,
+			      (iter % 2) ? GASPI_TEST : GASPI_BLOCK);
+      else
+	ret = gaspi_alltoall(0, 0, 0, SEG_SIZE / 2, bsize, g,
+			     (iter % 2) ? GASPI_TEST : GASPI_BLOCK);
+      assert(ret != GASPI_ERROR);
+    }
+  while(ret != GASPI_SUCCESS);
+
+  off = 0;
+  for(r = 0; r < n; r++)
+    {
+      for(i = 0; i < recv_sizes[r]; i++)
+	{
+	  if(recv[off + i] != value(ranks[r], myrank, i, iter))
+	    {
+	      gaspi_printf("block from %u byte %lu is wrong\n", ranks[r], i);
+	      exit(EXIT_FAILURE);
+	    }
+	}
+      off += recv_sizes[r];
+    }
+
+  free(ranks);
+  free(send_sizes);
+  free(recv_sizes);
+}
+
+int main(int argc, char *argv[])
+{
+  gaspi_rank_t nprocs, myrank, r;
+  gaspi_group_t g;
+  gaspi_pointer_t seg_ptr;
+  int s, iter = 0;
+
+  const gaspi_size_t sizes[] = { 1, 8, 1000, 40000, 300000 };
+  const int nsizes = sizeof(sizes) / sizeof(sizes[0]);
+
+  TSUITE_INIT(argc, argv);
+
+  ASSERT (gaspi_proc_init(GASPI_BLOCK));
+
+  ASSERT(gaspi_proc_num(&nprocs));
+  ASSERT(gaspi_proc_rank(&myrank));
+
+  ASSERT(gaspi_segment_create(0, SEG_SIZE, GASPI_GROUP_ALL, GASPI_BLOCK, GASPI_MEM_INITIALIZED));
+  ASSERT(gaspi_segment_ptr(0, &seg_ptr));
+
+  for(s = 0; s < nsizes; s++)
+    {
+      run(GASPI_GROUP_ALL, myrank, seg_ptr, iter++, 0, sizes[s]);
+      run(GASPI_GROUP_ALL, myrank, seg_ptr, iter++, 1, sizes[s]);
+    }
+
+  /* interleaved with other collectives */
+  for(s = 0; s < 10; s++)
+    {
+      ASSERT(gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+      run(GASPI_GROUP_ALL, myrank, seg_ptr, iter++, s % 2, 100);
+    }
+
+  if(nprocs > 2)
+    {
+      ASSERT(gaspi_group_create(&g));
+
+      for(r = 0; r < nprocs; r += 2)
+	{
+	  ASSERT(gaspi_group_add(g, r));
+	}
+
+      if(myrank % 2 == 0)
+	{
+	  ASSERT(gaspi_group_commit(g, GASPI_BLOCK));
+
+	  for(s = 0; s < nsizes; s++)
+	    {
+	      run(g, myrank, seg_ptr, iter++, 0, sizes[s]);
+	      run(g, myrank, seg_ptr, iter++, 1, sizes[s]);
+	    }
+	}
+    }
+
+  ASSERT (gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+
+  ASSERT (gaspi_proc_term(GASPI_BLOCK));
+
+  return EXIT_SUCCESS;
+}
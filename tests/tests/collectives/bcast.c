@@ -0,0 +1,132 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <test_utils.h>
+
+/* Broadcast of several sizes from every root, in GASPI_GROUP_ALL
+   and in a group of the even ranks */
+
+static void
+fill(unsigned char *buf, gaspi_size_t size, gaspi_rank_t root, int iter)
+{
+  gaspi_size_t i;
+
+  for(i = 0; i < size; i++)
+    {
+      buf[i] = (unsigned char) (i * 7 + root * 13 + iter);
+    }
+}
+
+static int
+check(unsigned char *buf, gaspi_size_t size, gaspi_rank_t root, int iter)
+{
+  gaspi_size_t i;
+
+  for(i = 0; i < size; i++)
+    {
+      if(buf[i] != (unsigned char) (i * 7 + root * 13 + iter))
+	{
+	  gaspi_printf("root %u size %lu: byte %lu is wrong\n", root, size, i);
+	  return 0;
+	}
+    }
+
+  return 1;
+}
+
+int main(int argc, char *argv[])
+{
+  gaspi_rank_t nprocs, myrank, root;
+  gaspi_group_t g;
+  gaspi_return_t ret;
+  int s, iter = 0;
+
+  const gaspi_size_t sizes[] = { 1, 100, 16384, 16385, 100000, 1 << 20, (1 << 22) + 3 };
+  const int nsizes = sizeof(sizes) / sizeof(sizes[0]);
+  const gaspi_size_t max_size = (1 << 22) + 3;
+
+  TSUITE_INIT(argc, argv);
+
+  ASSERT (gaspi_proc_init(GASPI_BLOCK));
+
+  ASSERT(gaspi_proc_num(&nprocs));
+  ASSERT(gaspi_proc_rank(&myrank));
+
+  unsigned char *buf = malloc(max_size);
+  if(buf == NULL)
+    return EXIT_FAILURE;
+
+  ASSERT (gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+
+  for(s = 0; s < nsizes; s++)
+    {
+      for(root = 0; root < nprocs; root++)
+	{
+	  iter++;
+
+	  if(myrank == root)
+	    fill(buf, sizes[s], root, iter);
+	  else
+	    memset(buf, 0, sizes[s]);
+
+	  ASSERT(gaspi_bcast(buf, sizes[s], root, GASPI_GROUP_ALL, GASPI_BLOCK));
+	  assert(check(buf, sizes[s], root, iter));
+	}
+    }
+
+  /* resume after timeouts */
+  for(root = 0; root < nprocs; root++)
+    {
+      iter++;
+
+      if(myrank == root)
+	fill(buf, 300000, root, iter);
+      else
+	memset(buf, 0, 300000);
+
+      do
+	{
+	  ret = gaspi_bcast(buf, 300000, root, GASPI_GROUP_ALL, GASPI_TEST);
+	  assert(ret != GASPI_ERROR);
+	}
+      while(ret != GASPI_SUCCESS);
+
+      assert(check(buf, 300000, root, iter));
+    }
+
+  /* root must be in the group */
+  ASSERT(gaspi_group_create(&g));
+
+  for(root = 0; root < nprocs; root += 2)
+    {
+      ASSERT(gaspi_group_add(g, root));
+    }
+
+  if(nprocs > 2 && myrank % 2 == 0)
+    {
+      ASSERT(gaspi_group_commit(g, GASPI_BLOCK));
+
+      EXPECT_FAIL(gaspi_bcast(buf, 100, 1, g, GASPI_BLOCK));
+
+      for(root = 0; root < nprocs; root += 2)
+	{
+	  iter++;
+
+	  if(myrank == root)
+	    fill(buf, 70000, root, iter);
+	  else
+	    memset(buf, 0, 70000);
+
+	  ASSERT(gaspi_bcast(buf, 70000, root, g, GASPI_BLOCK));
+	  assert(check(buf, 70000, root, iter));
+	}
+    }
+
+  ASSERT (gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+
+  free(buf);
+
+  ASSERT (gaspi_proc_term(GASPI_BLOCK));
+
+  return EXIT_SUCCESS;
+}
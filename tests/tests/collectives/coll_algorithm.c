@@ -0,0 +1,122 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <test_utils.h>
+
+/* Barrier and allreduce with the algorithms from a decision table and
+   with every algorithm forced, switching between them in between */
+
+#define ITERATIONS 300
+
+static void
+allreduce(gaspi_group_t g, gaspi_number_t n, gaspi_number_t elems, int iter)
+{
+  static long send[1024], recv[1024];
+  gaspi_number_t i;
+  gaspi_rank_t myrank;
+
+  ASSERT(gaspi_proc_rank(&myrank));
+
+  for(i = 0; i < elems; i++)
+    send[i] = (long) i * iter + myrank;
+
+  ASSERT(gaspi_allreduce(send, recv, elems, GASPI_OP_MAX, GASPI_TYPE_LONG, g, GASPI_BLOCK));
+
+  for(i = 0; i < elems; i++)
+    {
+      if(recv[i] != (long) i * iter + n - 1)
+	{
+	  gaspi_printf("allreduce of %u: elem %u expected %ld got %ld\n",
+		       elems, i, (long) i * iter + n - 1, recv[i]);
+	  exit(EXIT_FAILURE);
+	}
+    }
+}
+
+int main(int argc, char *argv[])
+{
+  gaspi_coll_algorithm_t barrier, allred;
+  gaspi_rank_t nprocs;
+  char path[64];
+  int i, b, a;
+
+  const gaspi_number_t elems[] = { 1, 3, 8, 100, 255, 1024 };
+  const gaspi_coll_algorithm_t barriers[] = { GASPI_BARRIER_DISSEMINATION, GASPI_BARRIER_NODE };
+  const gaspi_coll_algorithm_t allreduces[] = { GASPI_ALLREDUCE_DOUBLING, GASPI_ALLREDUCE_RSAG };
+
+  TSUITE_INIT(argc, argv);
+
+  snprintf(path, sizeof(path), "/tmp/gpi2_coll_tuning.%d", (int) getpid());
+
+  FILE *f = fopen(path, "w");
+  assert(f != NULL);
+  fprintf(f, "# test table\n");
+  fprintf(f, "barrier 1 65535 dissemination\n");
+  fprintf(f, "barrier 1 65535 bogus\n");
+  fprintf(f, "allreduce 1 65535 64\n");
+  fclose(f);
+
+  setenv("GASPI_COLL_TUNING", path, 1);
+
+  ASSERT (gaspi_proc_init(GASPI_BLOCK));
+
+  unlink(path);
+
+  ASSERT(gaspi_proc_num(&nprocs));
+
+  ASSERT(gaspi_coll_algorithm_get(GASPI_GROUP_ALL, 7, GASPI_TYPE_DOUBLE, &barrier, &allred));
+  assert(barrier == GASPI_BARRIER_DISSEMINATION);
+  assert(allred == GASPI_ALLREDUCE_DOUBLING);
+
+  ASSERT(gaspi_coll_algorithm_get(GASPI_GROUP_ALL, 8, GASPI_TYPE_DOUBLE, &barrier, &allred));
+  assert(allred == GASPI_ALLREDUCE_RSAG);
+
+  for(i = 0; i < (int) (sizeof(elems) / sizeof(elems[0])); i++)
+    {
+      allreduce(GASPI_GROUP_ALL, nprocs, elems[i], i);
+    }
+
+  EXPECT_FAIL(gaspi_coll_algorithm_set(GASPI_GROUP_ALL, GASPI_ALLREDUCE_RSAG, GASPI_COLL_ALG_AUTO));
+  EXPECT_FAIL(gaspi_coll_algorithm_set(GASPI_GROUP_ALL, GASPI_COLL_ALG_AUTO, GASPI_BARRIER_NODE));
+
+  /* doubling is limited to the small message buffer */
+  ASSERT(gaspi_coll_algorithm_set(GASPI_GROUP_ALL, GASPI_BARRIER_NODE, GASPI_ALLREDUCE_DOUBLING));
+  ASSERT(gaspi_coll_algorithm_get(GASPI_GROUP_ALL, 1024, GASPI_TYPE_LONG, &barrier, &allred));
+  assert(barrier == GASPI_BARRIER_NODE);
+  assert(allred == GASPI_ALLREDUCE_RSAG);
+
+  for(b = 0; b < 2; b++)
+    {
+      for(a = 0; a < 2; a++)
+	{
+	  ASSERT(gaspi_coll_algorithm_set(GASPI_GROUP_ALL, barriers[b], allreduces[a]));
+
+	  for(i = 0; i < (int) (sizeof(elems) / sizeof(elems[0])); i++)
+	    {
+	      ASSERT(gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+	      allreduce(GASPI_GROUP_ALL, nprocs, elems[i], i);
+	    }
+	}
+    }
+
+  /* many barriers of one kind between those of the other */
+  for(i = 0; i < ITERATIONS; i++)
+    {
+      ASSERT(gaspi_coll_algorithm_set(GASPI_GROUP_ALL, barriers[(i / 100) % 2], GASPI_COLL_ALG_AUTO));
+      ASSERT(gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+
+      if(i % 100 == 0)
+	{
+	  allreduce(GASPI_GROUP_ALL, nprocs, 8, i);
+	}
+    }
+
+  ASSERT(gaspi_coll_algorithm_set(GASPI_GROUP_ALL, GASPI_COLL_ALG_AUTO, GASPI_COLL_ALG_AUTO));
+
+  ASSERT (gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+
+  ASSERT (gaspi_proc_term(GASPI_BLOCK));
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,200 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <test_utils.h>
+
+/* Non-blocking barrier and allreduce: several of them outstanding at
+   once, progressed by a ring exchange with notifications going on
+   meanwhile, in GASPI_GROUP_ALL and in a group of the even ranks */
+
+#define ITERATIONS 100
+#define NLONG 100
+#define NDOUBLE 10
+
+static gaspi_return_t
+my_max (double * const a,
+	double * const b,
+	double * const r,
+	gaspi_state_t const state,
+	const gaspi_number_t num,
+	const gaspi_size_t elem_size,
+	const gaspi_timeout_t tout)
+{
+  gaspi_number_t i;
+
+  for(i = 0; i < num; i++)
+    {
+      r[i] = (a[i] < b[i]) ? b[i] : a[i];
+    }
+
+  return GASPI_SUCCESS;
+}
+
+/* one iteration of the ring exchange, the wait calls progress the
+   outstanding collectives. A neighbour may be one iteration ahead,
+   hence a notification and buffers per parity of the iteration. */
+static void
+exchange(gaspi_rank_t myrank, gaspi_rank_t nprocs, int iter)
+{
+  gaspi_notification_id_t id;
+  gaspi_notification_t val;
+  gaspi_pointer_t seg_ptr;
+
+  const gaspi_rank_t right = (myrank + 1) % nprocs;
+  const gaspi_rank_t left = (myrank + nprocs - 1) % nprocs;
+  const int p = iter % 2;
+
+  ASSERT(gaspi_segment_ptr(0, &seg_ptr));
+  int *buf = (int *) seg_ptr + 2 * p;
+
+  buf[0] = iter * nprocs + myrank;
+
+  ASSERT(gaspi_write_notify(0, 2 * p * sizeof(int), right, 0, (2 * p + 1) * sizeof(int), sizeof(int),
+			    (gaspi_notification_id_t) p, (gaspi_notification_t) (iter + 1), 0, GASPI_BLOCK));
+
+  ASSERT(gaspi_notify_waitsome(0, (gaspi_notification_id_t) p, 1, &id, GASPI_BLOCK));
+  ASSERT(gaspi_notify_reset(0, id, &val));
+  assert(val == (gaspi_notification_t) (iter + 1));
+  assert(buf[1] == iter * nprocs + left);
+
+  ASSERT(gaspi_wait(0, GASPI_BLOCK));
+}
+
+static void
+run(gaspi_group_t g, gaspi_rank_t myrank, gaspi_rank_t nprocs, int ring)
+{
+  gaspi_number_t n, r, me = 0;
+  gaspi_coll_request_t req[4], extra;
+  long lsend[NLONG], lrecv[NLONG];
+  double dsend[NDOUBLE], drecv[NDOUBLE];
+  int isend, irecv, iter, i;
+
+  ASSERT(gaspi_group_size(g, &n));
+
+  gaspi_rank_t *ranks = malloc(n * sizeof(gaspi_rank_t));
+  assert(ranks != NULL);
+
+  ASSERT(gaspi_group_ranks(g, ranks));
+
+  for(r = 0; r < n; r++)
+    {
+      if(ranks[r] == myrank)
+	me = r;
+    }
+
+  for(iter = 0; iter < ITERATIONS; iter++)
+    {
+      for(i = 0; i < NLONG; i++)
+	lsend[i] = (long) i * iter + me;
+
+      for(i = 0; i < NDOUBLE; i++)
+	dsend[i] = (double) me * i + iter;
+
+      isend = iter - (int) me;
+
+      ASSERT(gaspi_ibarrier(g, &req[0]));
+      ASSERT(gaspi_iallreduce(lsend, lrecv, NLONG, GASPI_OP_SUM, GASPI_TYPE_LONG, g, &req[1]));
+      ASSERT(gaspi_iallreduce_user(dsend, drecv, NDOUBLE, sizeof(double),
+				   (gaspi_reduce_operation_t) my_max, NULL, g, &req[2]));
+      ASSERT(gaspi_iallreduce(&isend, &irecv, 1, GASPI_OP_MIN, GASPI_TYPE_INT, g, &req[3]));
+
+      /* no more than four at once */
+      if(iter == 0)
+	{
+	  EXPECT_FAIL(gaspi_ibarrier(g, &extra));
+	}
+
+      if(ring)
+	{
+	  exchange(myrank, nprocs, iter);
+	}
+
+      if(iter % 2)
+	{
+	  gaspi_number_t done[4] = { 0, 0, 0, 0 };
+	  int left = 4;
+
+	  while(left > 0)
+	    {
+	      for(i = 0; i < 4; i++)
+		{
+		  if(!done[i])
+		    {
+		      ASSERT(gaspi_coll_test(&req[i], &done[i]));
+		      if(done[i])
+			left--;
+		    }
+		}
+	    }
+	}
+      else
+	{
+	  for(i = 3; i >= 0; i--)
+	    {
+	      ASSERT(gaspi_coll_wait(&req[i], GASPI_BLOCK));
+	      assert(req[i] == NULL);
+	    }
+	}
+
+      for(i = 0; i < NLONG; i++)
+	{
+	  const long expected = (long) i * iter * n + (long) (n * (n - 1)) / 2;
+	  if(lrecv[i] != expected)
+	    {
+	      gaspi_printf("iallreduce: elem %d expected %ld got %ld\n", i, expected, lrecv[i]);
+	      exit(EXIT_FAILURE);
+	    }
+	}
+
+      for(i = 0; i < NDOUBLE; i++)
+	{
+	  assert(drecv[i] == (double) (n - 1) * i + iter);
+	}
+
+      assert(irecv == iter - (int) (n - 1));
+    }
+
+  free(ranks);
+}
+
+int main(int argc, char *argv[])
+{
+  gaspi_rank_t nprocs, myrank, r;
+  gaspi_group_t g;
+
+  TSUITE_INIT(argc, argv);
+
+  ASSERT (gaspi_proc_init(GASPI_BLOCK));
+
+  ASSERT(gaspi_proc_num(&nprocs));
+  ASSERT(gaspi_proc_rank(&myrank));
+
+  ASSERT(gaspi_segment_create(0, 4096, GASPI_GROUP_ALL, GASPI_BLOCK, GASPI_MEM_INITIALIZED));
+
+  ASSERT (gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+
+  run(GASPI_GROUP_ALL, myrank, nprocs, 1);
+
+  if(nprocs > 2)
+    {
+      ASSERT(gaspi_group_create(&g));
+
+      for(r = 0; r < nprocs; r += 2)
+	{
+	  ASSERT(gaspi_group_add(g, r));
+	}
+
+      if(myrank % 2 == 0)
+	{
+	  ASSERT(gaspi_group_commit(g, GASPI_BLOCK));
+
+	  run(g, myrank, nprocs, 0);
+	}
+    }
+
+  ASSERT (gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+
+  ASSERT (gaspi_proc_term(GASPI_BLOCK));
+
+  return EXIT_SUCCESS;
+}
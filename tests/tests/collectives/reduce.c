@@ -0,0 +1,203 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <test_utils.h>
+
+/* Reduce to every root and reduce-scatter of equal blocks, with
+   predefined and user operations, in GASPI_GROUP_ALL and in a group
+   of the even ranks */
+
+static gaspi_return_t
+my_max (double * const a,
+	double * const b,
+	double * const r,
+	gaspi_state_t const state,
+	const gaspi_number_t num,
+	const gaspi_size_t elem_size,
+	const gaspi_timeout_t tout)
+{
+  gaspi_number_t i;
+
+  for(i = 0; i < num; i++)
+    {
+      r[i] = (a[i] < b[i]) ? b[i] : a[i];
+    }
+
+  return GASPI_SUCCESS;
+}
+
+static void
+run(gaspi_group_t g, gaspi_rank_t myrank, long *lsend, long *lrecv, double *dsend, double *drecv,
+    gaspi_number_t cnt, int iter)
+{
+  gaspi_number_t n, r, me = 0, i;
+  gaspi_return_t ret;
+
+  ASSERT(gaspi_group_size(g, &n));
+
+  gaspi_rank_t *ranks = malloc(n * sizeof(gaspi_rank_t));
+  assert(ranks != NULL);
+
+  ASSERT(gaspi_group_ranks(g, ranks));
+
+  for(r = 0; r < n; r++)
+    {
+      if(ranks[r] == myrank)
+	me = r;
+    }
+
+  /* reduce: the sum of i + r and the maximum of r * i */
+  for(i = 0; i < cnt; i++)
+    {
+      lsend[i] = (long) i + me;
+      dsend[i] = (double) me * i;
+    }
+
+  for(r = 0; r < n; r++)
+    {
+      memset(lrecv, 0, cnt * sizeof(long));
+
+      do
+	{
+	  ret = gaspi_reduce(lsend, lrecv, cnt, GASPI_OP_SUM, GASPI_TYPE_LONG, ranks[r], g,
+			     (iter % 2) ? GASPI_TEST : GASPI_BLOCK);
+	  assert(ret != GASPI_ERROR);
+	}
+      while(ret != GASPI_SUCCESS);
+
+      if(r == me)
+	{
+	  for(i = 0; i < cnt; i++)
+	    {
+	      const long expected = (long) i * n + (long) (n * (n - 1)) / 2;
+	      if(lrecv[i] != expected)
+		{
+		  gaspi_printf("reduce to %u: elem %u expected %ld got %ld\n", ranks[r], i, expected, lrecv[i]);
+		  exit(EXIT_FAILURE);
+		}
+	    }
+	}
+
+      ASSERT(gaspi_reduce_user(dsend, drecv, cnt, sizeof(double), (gaspi_reduce_operation_t) my_max,
+			       NULL, ranks[r], g, GASPI_BLOCK));
+
+      if(r == me)
+	{
+	  for(i = 0; i < cnt; i++)
+	    {
+	      if(drecv[i] != (double) (n - 1) * i)
+		{
+		  gaspi_printf("reduce_user to %u: elem %u is wrong\n", ranks[r], i);
+		  exit(EXIT_FAILURE);
+		}
+	    }
+	}
+    }
+
+  /* reduce-scatter: block j of member r holds r + j + i */
+  for(r = 0; r < n; r++)
+    {
+      for(i = 0; i < cnt; i++)
+	{
+	  lsend[r * cnt + i] = (long) me + r + i;
+	  dsend[r * cnt + i] = (double) me * (r + i);
+	}
+    }
+
+  memset(lrecv, 0, cnt * sizeof(long));
+
+  do
+    {
+      ret = gaspi_reduce_scatter_block(lsend, lrecv, cnt, GASPI_OP_SUM, GASPI_TYPE_LONG, g,
+				       (iter % 2) ? GASPI_TEST : GASPI_BLOCK);
+      assert(ret != GASPI_ERROR);
+    }
+  while(ret != GASPI_SUCCESS);
+
+  ASSERT(gaspi_reduce_scatter_block_user(dsend, drecv, cnt, sizeof(double),
+					 (gaspi_reduce_operation_t) my_max, NULL, g, GASPI_BLOCK));
+
+  for(i = 0; i < cnt; i++)
+    {
+      const long expected = (long) (n * (n - 1)) / 2 + (long) n * (me + i);
+      if(lrecv[i] != expected)
+	{
+	  gaspi_printf("reduce_scatter_block: elem %u expected %ld got %ld\n", i, expected, lrecv[i]);
+	  exit(EXIT_FAILURE);
+	}
+
+      if(drecv[i] != (double) (n - 1) * (me + i))
+	{
+	  gaspi_printf("reduce_scatter_block_user: elem %u is wrong\n", i);
+	  exit(EXIT_FAILURE);
+	}
+    }
+
+  free(ranks);
+}
+
+int main(int argc, char *argv[])
+{
+  gaspi_rank_t nprocs, myrank, r;
+  gaspi_group_t g;
+  int s, iter = 0;
+
+  const gaspi_number_t sizes[] = { 1, 7, 1024, 1025, 5000, 70001 };
+  const int nsizes = sizeof(sizes) / sizeof(sizes[0]);
+  const gaspi_number_t max_cnt = 70001;
+
+  TSUITE_INIT(argc, argv);
+
+  ASSERT (gaspi_proc_init(GASPI_BLOCK));
+
+  ASSERT(gaspi_proc_num(&nprocs));
+  ASSERT(gaspi_proc_rank(&myrank));
+
+  long *lsend = malloc(nprocs * max_cnt * sizeof(long));
+  long *lrecv = malloc(max_cnt * sizeof(long));
+  double *dsend = malloc(nprocs * max_cnt * sizeof(double));
+  double *drecv = malloc(max_cnt * sizeof(double));
+
+  if(lsend == NULL || lrecv == NULL || dsend == NULL || drecv == NULL)
+    return EXIT_FAILURE;
+
+  ASSERT (gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+
+  EXPECT_FAIL(gaspi_reduce(lsend, lrecv, 1, GASPI_OP_SUM, GASPI_TYPE_LONG, nprocs, GASPI_GROUP_ALL, GASPI_BLOCK));
+
+  for(s = 0; s < nsizes; s++)
+    {
+      run(GASPI_GROUP_ALL, myrank, lsend, lrecv, dsend, drecv, sizes[s], iter++);
+    }
+
+  if(nprocs > 2)
+    {
+      ASSERT(gaspi_group_create(&g));
+
+      for(r = 0; r < nprocs; r += 2)
+	{
+	  ASSERT(gaspi_group_add(g, r));
+	}
+
+      if(myrank % 2 == 0)
+	{
+	  ASSERT(gaspi_group_commit(g, GASPI_BLOCK));
+
+	  for(s = 0; s < nsizes; s++)
+	    {
+	      run(g, myrank, lsend, lrecv, dsend, drecv, sizes[s], iter++);
+	    }
+	}
+    }
+
+  ASSERT (gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+
+  free(lsend);
+  free(lrecv);
+  free(dsend);
+  free(drecv);
+
+  ASSERT (gaspi_proc_term(GASPI_BLOCK));
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,206 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <test_utils.h>
+
+/* Inclusive and exclusive scans, with predefined and user operations,
+   in place and not, in GASPI_GROUP_ALL and in a group of the even
+   ranks */
+
+static gaspi_return_t
+my_max (double * const a,
+	double * const b,
+	double * const r,
+	gaspi_state_t const state,
+	const gaspi_number_t num,
+	const gaspi_size_t elem_size,
+	const gaspi_timeout_t tout)
+{
+  gaspi_number_t i;
+
+  for(i = 0; i < num; i++)
+    {
+      r[i] = (a[i] < b[i]) ? b[i] : a[i];
+    }
+
+  return GASPI_SUCCESS;
+}
+
+static void
+check_long(long *v, gaspi_number_t cnt, gaspi_number_t upto, const char *what)
+{
+  gaspi_number_t i;
+
+  /* sum of r + 1 + i over the members r < upto */
+  for(i = 0; i < cnt; i++)
+    {
+      const long expected = (long) (upto * (upto + 1)) / 2 + (long) upto * i;
+      if(v[i] != expected)
+	{
+	  gaspi_printf("%s: elem %u expected %ld got %ld\n", what, i, expected, v[i]);
+	  exit(EXIT_FAILURE);
+	}
+    }
+}
+
+static void
+run(gaspi_group_t g, gaspi_rank_t myrank, long *lsend, long *lrecv, double *dsend, double *drecv,
+    gaspi_number_t cnt, int iter)
+{
+  gaspi_number_t n, r, me = 0, i;
+  gaspi_return_t ret;
+  const gaspi_timeout_t timeout = (iter % 2) ? GASPI_TEST : GASPI_BLOCK;
+
+  ASSERT(gaspi_group_size(g, &n));
+
+  gaspi_rank_t *ranks = malloc(n * sizeof(gaspi_rank_t));
+  assert(ranks != NULL);
+
+  ASSERT(gaspi_group_ranks(g, ranks));
+
+  for(r = 0; r < n; r++)
+    {
+      if(ranks[r] == myrank)
+	me = r;
+    }
+
+  for(i = 0; i < cnt; i++)
+    {
+      lsend[i] = (long) me + 1 + i;
+      dsend[i] = (double) me * i;
+      lrecv[i] = -1;
+    }
+
+  do
+    {
+      ret = gaspi_scan(lsend, lrecv, cnt, GASPI_OP_SUM, GASPI_TYPE_LONG, g, timeout);
+      assert(ret != GASPI_ERROR);
+    }
+  while(ret != GASPI_SUCCESS);
+
+  check_long(lrecv, cnt, me + 1, "scan");
+
+  for(i = 0; i < cnt; i++)
+    {
+      lrecv[i] = -1;
+    }
+
+  do
+    {
+      ret = gaspi_exscan(lsend, lrecv, cnt, GASPI_OP_SUM, GASPI_TYPE_LONG, g, timeout);
+      assert(ret != GASPI_ERROR);
+    }
+  while(ret != GASPI_SUCCESS);
+
+  if(me == 0)
+    {
+      for(i = 0; i < cnt; i++)
+	{
+	  assert(lrecv[i] == -1);
+	}
+    }
+  else
+    {
+      check_long(lrecv, cnt, me, "exscan");
+    }
+
+  /* in place */
+  do
+    {
+      ret = gaspi_scan(lsend, lsend, cnt, GASPI_OP_SUM, GASPI_TYPE_LONG, g, timeout);
+      assert(ret != GASPI_ERROR);
+    }
+  while(ret != GASPI_SUCCESS);
+
+  check_long(lsend, cnt, me + 1, "scan in place");
+
+  ASSERT(gaspi_scan_user(dsend, drecv, cnt, sizeof(double), (gaspi_reduce_operation_t) my_max,
+			 NULL, g, GASPI_BLOCK));
+
+  for(i = 0; i < cnt; i++)
+    {
+      if(drecv[i] != (double) me * i)
+	{
+	  gaspi_printf("scan_user: elem %u is wrong\n", i);
+	  exit(EXIT_FAILURE);
+	}
+    }
+
+  ASSERT(gaspi_exscan_user(dsend, drecv, cnt, sizeof(double), (gaspi_reduce_operation_t) my_max,
+			   NULL, g, GASPI_BLOCK));
+
+  for(i = 0; me > 0 && i < cnt; i++)
+    {
+      if(drecv[i] != (double) (me - 1) * i)
+	{
+	  gaspi_printf("exscan_user: elem %u is wrong\n", i);
+	  exit(EXIT_FAILURE);
+	}
+    }
+
+  free(ranks);
+}
+
+int main(int argc, char *argv[])
+{
+  gaspi_rank_t nprocs, myrank, r;
+  gaspi_group_t g;
+  int s, iter = 0;
+
+  const gaspi_number_t sizes[] = { 1, 100, 1024, 1025, 100000 };
+  const int nsizes = sizeof(sizes) / sizeof(sizes[0]);
+  const gaspi_number_t max_cnt = 100000;
+
+  TSUITE_INIT(argc, argv);
+
+  ASSERT (gaspi_proc_init(GASPI_BLOCK));
+
+  ASSERT(gaspi_proc_num(&nprocs));
+  ASSERT(gaspi_proc_rank(&myrank));
+
+  long *lsend = malloc(max_cnt * sizeof(long));
+  long *lrecv = malloc(max_cnt * sizeof(long));
+  double *dsend = malloc(max_cnt * sizeof(double));
+  double *drecv = malloc(max_cnt * sizeof(double));
+
+  if(lsend == NULL || lrecv == NULL || dsend == NULL || drecv == NULL)
+    return EXIT_FAILURE;
+
+  ASSERT (gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+
+  for(s = 0; s < nsizes; s++)
+    {
+      run(GASPI_GROUP_ALL, myrank, lsend, lrecv, dsend, drecv, sizes[s], iter++);
+    }
+
+  if(nprocs > 2)
+    {
+      ASSERT(gaspi_group_create(&g));
+
+      for(r = 0; r < nprocs; r += 2)
+	{
+	  ASSERT(gaspi_group_add(g, r));
+	}
+
+      if(myrank % 2 == 0)
+	{
+	  ASSERT(gaspi_group_commit(g, GASPI_BLOCK));
+
+	  for(s = 0; s < nsizes; s++)
+	    {
+	      run(g, myrank, lsend, lrecv, dsend, drecv, sizes[s], iter++);
+	    }
+	}
+    }
+
+  ASSERT (gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+
+  free(lsend);
+  free(lrecv);
+  free(dsend);
+  free(drecv);
+
+  ASSERT (gaspi_proc_term(GASPI_BLOCK));
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,135 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <GASPI_Ext.h>
+#include <test_utils.h>
+
+/* With GASPI_QUEUE_FULL_REAP a post to a full queue takes just the
+   completions it needs; gaspi_queue_select picks the least loaded
+   queue of a set and makes room in it */
+
+#define DEPTH 64
+#define SLOT 64
+
+int main(int argc, char *argv[])
+{
+  gaspi_config_t conf;
+  gaspi_rank_t rank, nprocs;
+  gaspi_number_t qsize;
+  gaspi_notification_id_t id;
+  gaspi_notification_t val;
+  gaspi_queue_id_t q;
+  gaspi_pointer_t ptr;
+  int i;
+
+  TSUITE_INIT(argc, argv);
+
+  ASSERT(gaspi_config_get(&conf));
+  assert(conf.queue_full_policy == GASPI_QUEUE_FULL_ERROR);
+
+  conf.queue_full_policy = 5;
+  EXPECT_FAIL(gaspi_config_set(conf));
+
+  conf.queue_full_policy = GASPI_QUEUE_FULL_REAP;
+  conf.queue_depth = DEPTH;
+  ASSERT(gaspi_config_set(conf));
+
+  ASSERT(gaspi_proc_init(GASPI_BLOCK));
+  ASSERT(gaspi_proc_rank(&rank));
+  ASSERT(gaspi_proc_num(&nprocs));
+
+  const gaspi_rank_t right = (rank + 1) % nprocs;
+  const gaspi_rank_t left = (rank + nprocs - 1) % nprocs;
+  const int msgs = 10 * DEPTH;
+  const gaspi_size_t size = msgs * SLOT;
+
+  ASSERT(gaspi_segment_create(0, size, GASPI_GROUP_ALL, GASPI_BLOCK, GASPI_MEM_INITIALIZED));
+  ASSERT(gaspi_segment_create(1, size, GASPI_GROUP_ALL, GASPI_BLOCK, GASPI_MEM_INITIALIZED));
+
+  ASSERT(gaspi_segment_ptr(0, &ptr));
+  unsigned char *src = (unsigned char *) ptr;
+  for(i = 0; i < (int) size; i++)
+    {
+      src[i] = (unsigned char) (i / SLOT + rank);
+    }
+
+  ASSERT(gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+
+  /* never waited for: the posts make room themselves */
+  for(i = 0; i < msgs; i++)
+    {
+      const gaspi_offset_t off = (gaspi_offset_t) i * SLOT;
+
+      ASSERT(gaspi_write_notify(0, off, right, 1, off, SLOT, (gaspi_notification_id_t) i, 1, 0, GASPI_BLOCK));
+
+      ASSERT(gaspi_queue_size(0, &qsize));
+      assert(qsize <= DEPTH);
+    }
+
+  /* a full queue loses only what the next post needs */
+  ASSERT(gaspi_wait(0, GASPI_BLOCK));
+
+  for(i = 0; i < DEPTH; i++)
+    {
+      ASSERT(gaspi_write(0, 0, rank, 0, SLOT, 8, 0, GASPI_BLOCK));
+    }
+
+  /* (a completion may stand for several requests on some devices) */
+  ASSERT(gaspi_write(0, 0, rank, 0, SLOT, 8, 0, GASPI_BLOCK));
+  ASSERT(gaspi_queue_size(0, &qsize));
+  assert(qsize > 0 && qsize <= DEPTH);
+
+  ASSERT(gaspi_wait(0, GASPI_BLOCK));
+
+  for(i = 0; i < msgs; i++)
+    {
+      ASSERT(gaspi_notify_waitsome(1, (gaspi_notification_id_t) i, 1, &id, GASPI_BLOCK));
+      ASSERT(gaspi_notify_reset(1, id, &val));
+      assert(val == 1);
+    }
+
+  ASSERT(gaspi_segment_ptr(1, &ptr));
+  unsigned char *dst = (unsigned char *) ptr;
+  for(i = 0; i < (int) size; i++)
+    {
+      assert(dst[i] == (unsigned char) (i / SLOT + left));
+    }
+
+  /* queue sets */
+  for(i = 0; i < 5; i++)
+    ASSERT(gaspi_write(0, 0, rank, 0, SLOT, 8, 1, GASPI_BLOCK));
+  for(i = 0; i < 3; i++)
+    ASSERT(gaspi_write(0, 0, rank, 0, SLOT, 8, 2, GASPI_BLOCK));
+  for(i = 0; i < 4; i++)
+    ASSERT(gaspi_write(0, 0, rank, 0, SLOT, 8, 3, GASPI_BLOCK));
+
+  ASSERT(gaspi_queue_select(1, 3, 1, &q, GASPI_BLOCK));
+  assert(q == 2);
+  ASSERT(gaspi_queue_size(2, &qsize));
+  assert(qsize == 3);
+
+  for(i = 1; i < 4; i++)
+    {
+      ASSERT(gaspi_queue_size((gaspi_queue_id_t) i, &qsize));
+      for(; qsize < DEPTH; qsize++)
+	ASSERT(gaspi_write(0, 0, rank, 0, SLOT, 8, (gaspi_queue_id_t) i, GASPI_BLOCK));
+    }
+
+  ASSERT(gaspi_queue_select(1, 3, 2, &q, GASPI_BLOCK));
+  assert(q == 1);
+  ASSERT(gaspi_queue_size(1, &qsize));
+  assert(qsize <= DEPTH - 2);
+
+  EXPECT_FAIL(gaspi_queue_select(1, 0, 1, &q, GASPI_BLOCK));
+  EXPECT_FAIL(gaspi_queue_select(1, conf.queue_num, 1, &q, GASPI_BLOCK));
+  EXPECT_FAIL(gaspi_queue_select(1, 3, DEPTH + 1, &q, GASPI_BLOCK));
+
+  for(i = 1; i < 4; i++)
+    ASSERT(gaspi_wait((gaspi_queue_id_t) i, GASPI_BLOCK));
+
+  ASSERT(gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+
+  ASSERT(gaspi_proc_term(GASPI_BLOCK));
+
+  return EXIT_SUCCESS;
+}
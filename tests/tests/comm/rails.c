@@ -0,0 +1,98 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <GASPI_Ext.h>
+#include <test_utils.h>
+
+/* Two rails (queue q takes rail q % 2): data written on one rail and
+   completed is in place before a notification sent on the other, and
+   a large write striped over the queues of both rails arrives whole */
+
+#define SLICE (1 << 16)
+#define SIZE ((gaspi_size_t) (4 << 20) + 17)
+
+int main(int argc, char *argv[])
+{
+  gaspi_config_t conf;
+  gaspi_rank_t rank, nprocs;
+  gaspi_notification_id_t id;
+  gaspi_notification_t val;
+  gaspi_number_t queue_num;
+  gaspi_pointer_t ptr;
+  gaspi_size_t i;
+  int r;
+
+  TSUITE_INIT(argc, argv);
+
+  ASSERT(gaspi_config_get(&conf));
+  conf.netdev_num = 2;
+  ASSERT(gaspi_config_set(conf));
+
+  ASSERT(gaspi_proc_init(GASPI_BLOCK));
+  ASSERT(gaspi_proc_rank(&rank));
+  ASSERT(gaspi_proc_num(&nprocs));
+  ASSERT(gaspi_queue_num(&queue_num));
+
+  ASSERT(gaspi_config_get(&conf));
+  assert(conf.netdev_num == 2);
+
+  ASSERT(gaspi_segment_create(0, SIZE, GASPI_GROUP_ALL, GASPI_BLOCK, GASPI_MEM_INITIALIZED));
+  ASSERT(gaspi_segment_create(1, SIZE, GASPI_GROUP_ALL, GASPI_BLOCK, GASPI_MEM_INITIALIZED));
+
+  ASSERT(gaspi_segment_ptr(0, &ptr));
+  unsigned char *src = (unsigned char *) ptr;
+  ASSERT(gaspi_segment_ptr(1, &ptr));
+  unsigned char *dst = (unsigned char *) ptr;
+
+  const gaspi_rank_t right = (rank + 1) % nprocs;
+  const gaspi_rank_t left = (rank + nprocs - 1) % nprocs;
+
+  ASSERT(gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+
+  /* the data on queue 1, the notification on queue 0 */
+  for(r = 0; r < 20; r++)
+    {
+      memset(src, r + rank, SLICE);
+
+      ASSERT(gaspi_write(0, 0, right, 1, 0, SLICE, 1, GASPI_BLOCK));
+      ASSERT(gaspi_wait(1, GASPI_BLOCK));
+      ASSERT(gaspi_notify(1, right, 0, r + 1, 0, GASPI_BLOCK));
+      ASSERT(gaspi_wait(0, GASPI_BLOCK));
+
+      ASSERT(gaspi_notify_waitsome(1, 0, 1, &id, GASPI_BLOCK));
+      ASSERT(gaspi_notify_reset(1, id, &val));
+      assert(val == (gaspi_notification_t) (r + 1));
+
+      for(i = 0; i < SLICE; i++)
+	{
+	  assert(dst[i] == (unsigned char) (r + left));
+	}
+
+      ASSERT(gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+    }
+
+  /* striped over both rails */
+  for(i = 0; i < SIZE; i++)
+    {
+      src[i] = (unsigned char) (i * 3 + rank);
+    }
+
+  ASSERT(gaspi_write_striped_notify(0, 0, right, 1, 0, SIZE, 2, 4, 0,
+				    (queue_num < 4) ? queue_num : 4, GASPI_BLOCK));
+  ASSERT(gaspi_wait_queues(0, (queue_num < 4) ? queue_num : 4, GASPI_BLOCK));
+
+  ASSERT(gaspi_notify_wait_count(1, 2, 4, GASPI_BLOCK));
+  ASSERT(gaspi_notify_reset(1, 2, &val));
+
+  for(i = 0; i < SIZE; i++)
+    {
+      assert(dst[i] == (unsigned char) (i * 3 + left));
+    }
+
+  ASSERT(gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+
+  ASSERT(gaspi_proc_term(GASPI_BLOCK));
+
+  return EXIT_SUCCESS;
+}
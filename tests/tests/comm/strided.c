@@ -0,0 +1,198 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <GASPI_Ext.h>
+#include <test_utils.h>
+
+/* Strided writes and reads of subarrays of a 3D array (an x plane, a
+   y plane and a 3D subarray every other x) between ranks with
+   different layouts at both sides, checked element by element. The
+   queue is kept short: every other x of the whole array, strided at
+   both sides, takes more requests than it holds on Infiniband. */
+
+#define N 16
+
+/* the array of each rank in segment 0, the copies in segment 1 */
+#define ELEM(r, x, y, z) ((int) ((r) * 100000 + (z) * 256 + (y) * 16 + (x)))
+#define OFF(x, y, z) ((gaspi_offset_t) ((((z) * N + (y)) * N + (x)) * sizeof(int)))
+
+int main(int argc, char *argv[])
+{
+  gaspi_config_t conf;
+  gaspi_rank_t rank, nprocs;
+  gaspi_notification_id_t id;
+  gaspi_notification_t val;
+  gaspi_pointer_t ptr;
+  int x, y, z;
+
+  TSUITE_INIT(argc, argv);
+
+  ASSERT(gaspi_config_get(&conf));
+  conf.queue_depth = 64;
+  ASSERT(gaspi_config_set(conf));
+
+  ASSERT(gaspi_proc_init(GASPI_BLOCK));
+  ASSERT(gaspi_proc_rank(&rank));
+  ASSERT(gaspi_proc_num(&nprocs));
+
+  const gaspi_size_t size = N * N * N * sizeof(int);
+
+  ASSERT(gaspi_segment_create(0, size, GASPI_GROUP_ALL, GASPI_BLOCK, GASPI_MEM_INITIALIZED));
+  ASSERT(gaspi_segment_create(1, size, GASPI_GROUP_ALL, GASPI_BLOCK, GASPI_MEM_INITIALIZED));
+
+  ASSERT(gaspi_segment_ptr(0, &ptr));
+  int *a = (int *) ptr;
+  ASSERT(gaspi_segment_ptr(1, &ptr));
+  int *b = (int *) ptr;
+
+  for(z = 0; z < N; z++)
+    for(y = 0; y < N; y++)
+      for(x = 0; x < N; x++)
+	a[OFF(x, y, z) / sizeof(int)] = ELEM(rank, x, y, z);
+
+  const gaspi_rank_t right = (rank + 1) % nprocs;
+  const gaspi_rank_t left = (rank + nprocs - 1) % nprocs;
+
+  const gaspi_size_t strides[3] = { sizeof(int), N * sizeof(int), N * N * sizeof(int) };
+
+  ASSERT(gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+
+  /* the plane x = 3, packed at the right */
+  {
+    const gaspi_size_t stride_local[2] = { strides[1], strides[2] };
+    const gaspi_size_t stride_remote[2] = { sizeof(int), N * sizeof(int) };
+    const gaspi_number_t count[2] = { N, N };
+
+    ASSERT(gaspi_write_strided_notify(0, OFF(3, 0, 0), stride_local, right,
+				      1, 0, stride_remote, sizeof(int), count, 2,
+				      0, 1, 0, GASPI_BLOCK));
+    ASSERT(gaspi_wait(0, GASPI_BLOCK));
+
+    ASSERT(gaspi_notify_waitsome(1, 0, 1, &id, GASPI_BLOCK));
+    ASSERT(gaspi_notify_reset(1, id, &val));
+    assert(val == 1);
+
+    for(z = 0; z < N; z++)
+      for(y = 0; y < N; y++)
+	assert(b[z * N + y] == ELEM(left, 3, y, z));
+  }
+
+  ASSERT(gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+
+  /* every other x of a 3D subarray, to the same place of a packed
+     array at the right */
+  {
+    const gaspi_size_t stride_local[3] = { 2 * strides[0], strides[1], strides[2] };
+    const gaspi_size_t stride_remote[3] = { sizeof(int), 4 * sizeof(int), 4 * 8 * sizeof(int) };
+    const gaspi_number_t count[3] = { 4, 8, 8 };
+
+    memset(b, 0, size);
+
+    ASSERT(gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+
+    ASSERT(gaspi_write_strided_notify(0, OFF(1, 2, 4), stride_local, right,
+				      1, 0, stride_remote, sizeof(int), count, 3,
+				      1, 2, 0, GASPI_BLOCK));
+    ASSERT(gaspi_wait(0, GASPI_BLOCK));
+
+    ASSERT(gaspi_notify_waitsome(1, 1, 1, &id, GASPI_BLOCK));
+    ASSERT(gaspi_notify_reset(1, id, &val));
+    assert(val == 2);
+
+    for(z = 0; z < 8; z++)
+      for(y = 0; y < 8; y++)
+	for(x = 0; x < 4; x++)
+	  assert(b[(z * 8 + y) * 4 + x] == ELEM(left, 1 + 2 * x, 2 + y, 4 + z));
+
+    /* nothing beyond */
+    assert(b[4 * 8 * 8] == 0);
+  }
+
+  ASSERT(gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+
+  /* the even x of the whole array, to the odd x at the right */
+  {
+    const gaspi_size_t stride[3] = { 2 * strides[0], strides[1], strides[2] };
+    const gaspi_number_t count[3] = { N / 2, N, N };
+
+    memset(b, 0, size);
+
+    ASSERT(gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+
+    ASSERT(gaspi_write_strided_notify(0, 0, stride, right,
+				      1, OFF(1, 0, 0), stride, sizeof(int), count, 3,
+				      2, 3, 0, GASPI_BLOCK));
+    ASSERT(gaspi_wait(0, GASPI_BLOCK));
+
+    ASSERT(gaspi_notify_waitsome(1, 2, 1, &id, GASPI_BLOCK));
+    ASSERT(gaspi_notify_reset(1, id, &val));
+    assert(val == 3);
+
+    for(z = 0; z < N; z++)
+      for(y = 0; y < N; y++)
+	for(x = 0; x < N; x++)
+	  assert(b[OFF(x, y, z) / sizeof(int)] == ((x % 2) ? ELEM(left, x - 1, y, z) : 0));
+  }
+
+  ASSERT(gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+
+  /* read the plane y = 5 (rows of x) of the left, into the same place
+     of the local array, then the plane x = 7 of the right and of this
+     rank itself */
+  {
+    const gaspi_size_t stride[1] = { strides[2] };
+    const gaspi_number_t count[1] = { N };
+
+    memset(b, 0, size);
+
+    ASSERT(gaspi_read_strided(1, OFF(0, 5, 0), stride, left,
+			      0, OFF(0, 5, 0), stride, N * sizeof(int), count, 1,
+			      0, GASPI_BLOCK));
+    ASSERT(gaspi_wait(0, GASPI_BLOCK));
+
+    for(z = 0; z < N; z++)
+      for(y = 0; y < N; y++)
+	for(x = 0; x < N; x++)
+	  assert(b[OFF(x, y, z) / sizeof(int)] == ((y == 5) ? ELEM(left, x, y, z) : 0));
+  }
+
+  {
+    const gaspi_size_t stride_local[2] = { sizeof(int), N * sizeof(int) };
+    const gaspi_size_t stride_remote[2] = { strides[1], strides[2] };
+    const gaspi_number_t count[2] = { N, N };
+
+    ASSERT(gaspi_read_strided(1, 0, stride_local, right,
+			      0, OFF(7, 0, 0), stride_remote, sizeof(int), count, 2,
+			      0, GASPI_BLOCK));
+    ASSERT(gaspi_read_strided(1, N * N * sizeof(int), stride_local, rank,
+			      0, OFF(7, 0, 0), stride_remote, sizeof(int), count, 2,
+			      0, GASPI_BLOCK));
+    ASSERT(gaspi_wait(0, GASPI_BLOCK));
+
+    for(z = 0; z < N; z++)
+      for(y = 0; y < N; y++)
+	{
+	  assert(b[z * N + y] == ELEM(right, 7, y, z));
+	  assert(b[N * N + z * N + y] == ELEM(rank, 7, y, z));
+	}
+  }
+
+  /* invalid shapes */
+  {
+    const gaspi_size_t stride[4] = { 8, 64, 512, 4096 };
+    const gaspi_number_t count[4] = { 2, 2, 2, 0 };
+
+    EXPECT_FAIL(gaspi_write_strided(0, 0, stride, right, 1, 0, stride, 4, count, 4, 0, GASPI_BLOCK));
+    EXPECT_FAIL(gaspi_write_strided(0, 0, stride, right, 1, 0, stride, 0, count, 3, 0, GASPI_BLOCK));
+    EXPECT_FAIL(gaspi_read_strided(0, 0, stride + 1, right, 1, 0, stride + 1, 4, count + 1, 3, 0, GASPI_BLOCK));
+    EXPECT_FAIL(gaspi_write_strided_notify(0, 0, stride, right, 1, 0, stride, 4, count, 2,
+					   0, 0, 0, GASPI_BLOCK));
+  }
+
+  ASSERT(gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+
+  ASSERT(gaspi_proc_term(GASPI_BLOCK));
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,111 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <GASPI_Ext.h>
+#include <test_utils.h>
+
+/* Large writes and reads striped over a set of queues (and a small
+   one that takes a single stripe), completed with one wait on the set
+   or one notification */
+
+#define SIZE ((gaspi_size_t) (9 << 20) + 123)
+
+int main(int argc, char *argv[])
+{
+  gaspi_rank_t rank, nprocs;
+  gaspi_number_t queue_num, qsize;
+  gaspi_notification_id_t id;
+  gaspi_notification_t val;
+  gaspi_pointer_t ptr;
+  gaspi_size_t i;
+  gaspi_queue_id_t q;
+
+  TSUITE_INIT(argc, argv);
+
+  ASSERT(gaspi_proc_init(GASPI_BLOCK));
+  ASSERT(gaspi_proc_rank(&rank));
+  ASSERT(gaspi_proc_num(&nprocs));
+  ASSERT(gaspi_queue_num(&queue_num));
+
+  const gaspi_number_t num = (queue_num < 4) ? queue_num : 4;
+
+  ASSERT(gaspi_segment_create(0, SIZE, GASPI_GROUP_ALL, GASPI_BLOCK, GASPI_MEM_INITIALIZED));
+  ASSERT(gaspi_segment_create(1, SIZE, GASPI_GROUP_ALL, GASPI_BLOCK, GASPI_MEM_INITIALIZED));
+
+  ASSERT(gaspi_segment_ptr(0, &ptr));
+  unsigned char *src = (unsigned char *) ptr;
+  ASSERT(gaspi_segment_ptr(1, &ptr));
+  unsigned char *dst = (unsigned char *) ptr;
+
+  for(i = 0; i < SIZE; i++)
+    {
+      src[i] = (unsigned char) (i * 7 + rank);
+    }
+
+  const gaspi_rank_t right = (rank + 1) % nprocs;
+  const gaspi_rank_t left = (rank + nprocs - 1) % nprocs;
+
+  ASSERT(gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+
+  /* with a notification */
+  ASSERT(gaspi_write_striped_notify(0, 0, right, 1, 0, SIZE, 0, 5, 0, num, GASPI_BLOCK));
+  ASSERT(gaspi_wait_queues(0, num, GASPI_BLOCK));
+
+  for(q = 0; q < num; q++)
+    {
+      ASSERT(gaspi_queue_size(q, &qsize));
+      assert(qsize == 0);
+    }
+
+  ASSERT(gaspi_notify_wait_count(1, 0, 5, GASPI_BLOCK));
+  ASSERT(gaspi_notify_reset(1, 0, &val));
+  assert(val == 5);
+
+  for(i = 0; i < SIZE; i++)
+    {
+      assert(dst[i] == (unsigned char) (i * 7 + left));
+    }
+
+  ASSERT(gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+
+  /* a single stripe: the notification is set at once */
+  ASSERT(gaspi_write_striped_notify(0, 100, right, 1, 200, 4096, 2, 1, 0, num, GASPI_BLOCK));
+  ASSERT(gaspi_notify_waitsome(1, 2, 1, &id, GASPI_BLOCK));
+  ASSERT(gaspi_notify_reset(1, id, &val));
+  assert(val == 1);
+
+  for(i = 0; i < 4096; i++)
+    {
+      assert(dst[200 + i] == (unsigned char) ((100 + i) * 7 + left));
+    }
+
+  ASSERT(gaspi_wait_queues(0, num, GASPI_BLOCK));
+  ASSERT(gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+
+  /* read back, at an offset */
+  memset(dst, 0, SIZE);
+
+  ASSERT(gaspi_read_striped(1, 1, right, 0, 1, SIZE - 1, 0, num, GASPI_BLOCK));
+  ASSERT(gaspi_wait_queues(0, num, GASPI_BLOCK));
+
+  assert(dst[0] == 0);
+  for(i = 1; i < SIZE; i++)
+    {
+      assert(dst[i] == (unsigned char) (i * 7 + right));
+    }
+
+  /* invalid sets of queues and values */
+  EXPECT_FAIL(gaspi_write_striped(0, 0, right, 1, 0, SIZE, 0, 0, GASPI_BLOCK));
+  EXPECT_FAIL(gaspi_write_striped(0, 0, right, 1, 0, SIZE, 0, queue_num + 1, GASPI_BLOCK));
+  EXPECT_FAIL(gaspi_write_striped(0, 0, right, 1, 0, 0, 0, num, GASPI_BLOCK));
+  EXPECT_FAIL(gaspi_write_striped_notify(0, 0, right, 1, 0, SIZE, 0, 0, 0, num, GASPI_BLOCK));
+  EXPECT_FAIL(gaspi_write_striped_notify(0, 0, right, 1, 0, SIZE, 1, 5, 0, num, GASPI_BLOCK));
+  EXPECT_FAIL(gaspi_wait_queues(0, queue_num + 1, GASPI_BLOCK));
+
+  ASSERT(gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+
+  ASSERT(gaspi_proc_term(GASPI_BLOCK));
+
+  return EXIT_SUCCESS;
+}
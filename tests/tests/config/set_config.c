@@ -26,6 +26,29 @@ int main(int argc, char *argv[])
   default_conf.mtu = 2048;
   ASSERT (gaspi_config_set(default_conf));
 
+  //rails
+  default_conf.netdev_num = 0;
+  EXPECT_FAIL (gaspi_config_set(default_conf));
+
+  default_conf.netdev_num = 5;
+  EXPECT_FAIL (gaspi_config_set(default_conf));
+
+  default_conf.netdev_num = 2;
+  ASSERT (gaspi_config_set(default_conf));
+
+  default_conf.netdev_num = 1;
+  ASSERT (gaspi_config_set(default_conf));
+
+  //notification mode
+  default_conf.notify_mode = (gaspi_notify_mode_t) 2;
+  EXPECT_FAIL (gaspi_config_set(default_conf));
+
+  default_conf.notify_mode = GASPI_NOTIFY_FUSED;
+  ASSERT (gaspi_config_set(default_conf));
+
+  default_conf.notify_mode = GASPI_NOTIFY_SEPARATE;
+  ASSERT (gaspi_config_set(default_conf));
+
   //############################################//
   ASSERT (gaspi_proc_init(GASPI_BLOCK));
 
@@ -0,0 +1,119 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+
+#include <test_utils.h>
+
+/* With the adaptive wait policy, waits still complete and time out as
+   before but an idle wait leaves the CPU */
+
+static double
+cpu_ms(void)
+{
+  struct rusage usage;
+
+  getrusage(RUSAGE_SELF, &usage);
+
+  return usage.ru_utime.tv_sec * 1000.0 + usage.ru_utime.tv_usec / 1000.0
+    + usage.ru_stime.tv_sec * 1000.0 + usage.ru_stime.tv_usec / 1000.0;
+}
+
+static double
+wall_ms(void)
+{
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+
+  return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+int main(int argc, char *argv[])
+{
+  gaspi_config_t conf;
+  gaspi_rank_t rank, nprocs, to, sender;
+  gaspi_notification_id_t id;
+  gaspi_notification_t val;
+  int i;
+
+  TSUITE_INIT(argc, argv);
+
+  ASSERT (gaspi_config_get(&conf));
+  assert (conf.wait_policy == GASPI_WAIT_SPIN);
+
+  conf.wait_policy = 7;
+  EXPECT_FAIL (gaspi_config_set(conf));
+
+  conf.wait_policy = GASPI_WAIT_ADAPTIVE;
+  conf.wait_spin_us = 10;
+  ASSERT (gaspi_config_set(conf));
+
+  ASSERT (gaspi_config_get(&conf));
+  assert (conf.wait_policy == GASPI_WAIT_ADAPTIVE);
+  assert (conf.wait_spin_us == 10);
+
+  ASSERT (gaspi_proc_init(GASPI_BLOCK));
+
+  ASSERT (gaspi_proc_num(&nprocs));
+  ASSERT (gaspi_proc_rank(&rank));
+
+  to = (rank + 1) % nprocs;
+
+  ASSERT (gaspi_segment_create(0, 1 << 20, GASPI_GROUP_ALL, GASPI_BLOCK, GASPI_MEM_INITIALIZED));
+
+  /* timeout */
+  const double t0 = wall_ms();
+  const double c0 = cpu_ms();
+
+  assert (gaspi_notify_waitsome(0, 0, 1000, &id, 200) == GASPI_TIMEOUT);
+
+  const double c1 = cpu_ms();
+  const double t1 = wall_ms();
+
+  assert (t1 - t0 >= 190.0);
+  assert (c1 - c0 < 100.0);
+
+  assert (gaspi_notify_waitsome(0, 0, 1000, &id, GASPI_TEST) == GASPI_TIMEOUT);
+
+  ASSERT (gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+
+  /* notifications and completions arriving late */
+  for(i = 0; i < 10; i++)
+    {
+      usleep(i * 2000);
+
+      ASSERT (gaspi_write_notify(0, 0, to, 0, 4096, 4096, (gaspi_notification_id_t) i,
+				 (gaspi_notification_t) (i + 1), 0, GASPI_BLOCK));
+      ASSERT (gaspi_wait(0, GASPI_BLOCK));
+
+      ASSERT (gaspi_notify_waitsome(0, 0, 1000, &id, (i % 2) ? GASPI_BLOCK : 5000));
+      assert (id == i);
+      ASSERT (gaspi_notify_reset(0, id, &val));
+      assert (val == (gaspi_notification_t) (i + 1));
+    }
+
+  ASSERT (gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+
+  /* passive communication, sent late */
+  if(rank == 0)
+    {
+      for(i = 1; i < nprocs; i++)
+	{
+	  ASSERT (gaspi_passive_receive(0, 64, &sender, 64, GASPI_BLOCK));
+	  assert (sender > 0 && sender < nprocs);
+	}
+    }
+  else
+    {
+      usleep(5000);
+      ASSERT (gaspi_passive_send(0, 0, 0, 64, GASPI_BLOCK));
+    }
+
+  ASSERT (gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+
+  ASSERT (gaspi_proc_term(GASPI_BLOCK));
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,106 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <test_utils.h>
+
+/* The last rank dies with writes to it in the queue: the wait fails
+   and a purge empties the queue, which then works for the others */
+
+#define NWRITES 32
+
+int main(int argc, char *argv[])
+{
+  gaspi_rank_t nprocs, myrank, i;
+  gaspi_number_t qsize;
+  gaspi_group_t survivors;
+  int j, failed = 0;
+
+  TSUITE_INIT(argc, argv);
+
+  ASSERT (gaspi_proc_init(GASPI_BLOCK));
+  ASSERT (gaspi_proc_num(&nprocs));
+  ASSERT (gaspi_proc_rank(&myrank));
+
+  if( nprocs < 2 )
+    {
+      ASSERT (gaspi_proc_term(GASPI_BLOCK));
+      return EXIT_SUCCESS;
+    }
+
+  ASSERT (gaspi_segment_create(0, NWRITES * sizeof(int),
+			       GASPI_GROUP_ALL, GASPI_BLOCK,
+			       GASPI_MEM_INITIALIZED));
+
+  ASSERT (gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+
+  if( myrank == nprocs - 1 )
+    {
+      exit(-1);
+    }
+
+  /* (a group takes at least two ranks) */
+  const int sync = (nprocs > 2);
+
+  if( sync )
+    {
+      ASSERT (gaspi_group_create(&survivors));
+      for(i = 0; i < nprocs - 1; i++)
+	{
+	  ASSERT (gaspi_group_add(survivors, i));
+	}
+      ASSERT (gaspi_group_commit(survivors, GASPI_BLOCK));
+    }
+
+  sleep(2);
+
+  /* the failure shows once the connection is found broken */
+  for(j = 0; j < 100 && !failed; j++)
+    {
+      int k;
+      for(k = 0; k < NWRITES; k++)
+	{
+	  ASSERT (gaspi_write(0, k * sizeof(int), nprocs - 1,
+			      0, k * sizeof(int), sizeof(int),
+			      0, GASPI_BLOCK));
+	}
+
+      failed = (gaspi_wait(0, GASPI_BLOCK) != GASPI_SUCCESS);
+    }
+
+  assert (failed);
+
+  gaspi_state_vector_t vec = (gaspi_state_vector_t) malloc(nprocs);
+  assert (vec != NULL);
+
+  ASSERT (gaspi_state_vec_get(vec));
+  assert (vec[nprocs - 1] != GASPI_STATE_HEALTHY);
+
+  /* (GASPI.h declares only the profiling name) */
+  ASSERT (pgaspi_queue_purge(0, GASPI_BLOCK));
+
+  ASSERT (gaspi_queue_size(0, &qsize));
+  assert (qsize == 0);
+
+  /* the queue still works for the others */
+  for(i = 0; i < nprocs - 1; i++)
+    {
+      ASSERT (gaspi_write(0, 0, i, 0, myrank * sizeof(int), sizeof(int),
+			  0, GASPI_BLOCK));
+    }
+  ASSERT (gaspi_wait(0, GASPI_BLOCK));
+
+  ASSERT (gaspi_queue_size(0, &qsize));
+  assert (qsize == 0);
+
+  if( sync )
+    {
+      ASSERT (gaspi_barrier(survivors, GASPI_BLOCK));
+    }
+
+  free(vec);
+
+  ASSERT (gaspi_proc_term(GASPI_BLOCK));
+
+  return EXIT_SUCCESS;
+}
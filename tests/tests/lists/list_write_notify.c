@@ -69,8 +69,12 @@ int main(int argc, char *argv[])
 				   0, myrank, 1,
 				   0, GASPI_BLOCK));
 
+  //fused, the notification goes with the last write
+  gaspi_config_t conf;
+  ASSERT( gaspi_config_get(&conf) );
+
   ASSERT( gaspi_queue_size(0, &queue_size) );
-  assert( queue_size == nListElems + 1);
+  assert( queue_size == nListElems + (conf.notify_mode == GASPI_NOTIFY_FUSED ? 0 : 1));
 
   ASSERT (gaspi_wait(0, GASPI_BLOCK));
 
@@ -0,0 +1,94 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <GASPI_Ext.h>
+#include <test_utils.h>
+
+/* All ranks add to the same notifications of rank 0 (two even IDs,
+   the second with data written before), which waits for the sum with
+   gaspi_notify_wait_count */
+
+#define ROUNDS 10
+#define SLICE 1024
+
+int main(int argc, char *argv[])
+{
+  gaspi_rank_t rank, nprocs;
+  gaspi_notification_id_t id;
+  gaspi_notification_t val;
+  gaspi_segment_id_t seg;
+  gaspi_pointer_t ptr;
+  int r, i, j;
+
+  TSUITE_INIT(argc, argv);
+
+  ASSERT(gaspi_proc_init(GASPI_BLOCK));
+  ASSERT(gaspi_proc_rank(&rank));
+  ASSERT(gaspi_proc_num(&nprocs));
+
+  ASSERT(gaspi_segment_create(0, nprocs * SLICE, GASPI_GROUP_ALL, GASPI_BLOCK, GASPI_MEM_INITIALIZED));
+  ASSERT(gaspi_segment_create(1, nprocs * SLICE, GASPI_GROUP_ALL, GASPI_BLOCK,
+			      GASPI_MEM_INITIALIZED | GASPI_MEM_NOTIFY_SUMMARY));
+
+  EXPECT_FAIL(gaspi_notify_add(0, 0, 4, 0, 0, GASPI_BLOCK));
+  EXPECT_FAIL(gaspi_notify_add(0, 0, 5, 1, 0, GASPI_BLOCK));
+  EXPECT_FAIL(gaspi_write_notify_add(0, 0, 0, 0, 0, SLICE, 5, 1, 0, GASPI_BLOCK));
+  EXPECT_FAIL(gaspi_notify_wait_count(0, 4, 0, GASPI_BLOCK));
+
+  for(seg = 0; seg < 2; seg++)
+    {
+      ASSERT(gaspi_segment_ptr(seg, &ptr));
+      unsigned char *data = (unsigned char *) ptr;
+
+      for(r = 0; r < ROUNDS; r++)
+	{
+	  for(i = 0; i < SLICE; i++)
+	    {
+	      data[rank * SLICE + i] = (unsigned char) (rank + r);
+	    }
+
+	  ASSERT(gaspi_notify_add(seg, 0, 4, 3, 0, GASPI_BLOCK));
+	  ASSERT(gaspi_write_notify_add(seg, rank * SLICE, 0, seg, rank * SLICE, SLICE,
+					6, 1, 0, GASPI_BLOCK));
+	  ASSERT(gaspi_wait(0, GASPI_BLOCK));
+
+	  if(rank == 0)
+	    {
+	      ASSERT(gaspi_notify_wait_count(seg, 6, nprocs, GASPI_BLOCK));
+	      ASSERT(gaspi_notify_wait_count(seg, 4, 3 * nprocs, 10000));
+
+	      assert(gaspi_notify_wait_count(seg, 6, nprocs + 1, GASPI_TEST) == GASPI_TIMEOUT);
+	      assert(gaspi_notify_wait_count(seg, 6, nprocs + 1, 10) == GASPI_TIMEOUT);
+
+	      /* the data came along with the adds */
+	      for(j = 0; j < nprocs; j++)
+		{
+		  for(i = 0; i < SLICE; i++)
+		    {
+		      assert(data[j * SLICE + i] == (unsigned char) (j + r));
+		    }
+		}
+
+	      /* the adds also show as set notifications */
+	      ASSERT(gaspi_notify_waitsome(seg, 0, 100, &id, GASPI_TEST));
+	      assert(id == 4);
+
+	      ASSERT(gaspi_notify_reset(seg, 4, &val));
+	      assert(val == 3 * nprocs);
+	      ASSERT(gaspi_notify_reset(seg, 6, &val));
+	      assert(val == nprocs);
+
+	      /* the neighbours were left alone */
+	      assert(gaspi_notify_waitsome(seg, 0, 100, &id, GASPI_TEST) == GASPI_TIMEOUT);
+	    }
+
+	  ASSERT(gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+	}
+    }
+
+  ASSERT(gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+
+  ASSERT(gaspi_proc_term(GASPI_BLOCK));
+
+  return EXIT_SUCCESS;
+}
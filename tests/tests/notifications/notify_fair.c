@@ -0,0 +1,142 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <GASPI_Ext.h>
+#include <test_utils.h>
+
+/* Under sustained load (every notification of the range set again as
+   soon as it is consumed) the fair waitsome serves each notification
+   once per round over the range, while waitsome keeps serving the
+   lowest one */
+
+#define NIDS 48
+#define ROUNDS 20
+
+static void
+renotify(gaspi_segment_id_t seg, gaspi_rank_t rank, gaspi_notification_id_t n)
+{
+  gaspi_notification_id_t id;
+
+  ASSERT(gaspi_notify(seg, rank, n, 1, 0, GASPI_BLOCK));
+  ASSERT(gaspi_wait(0, GASPI_BLOCK));
+  ASSERT(gaspi_notify_waitsome(seg, n, 1, &id, GASPI_BLOCK));
+}
+
+/* largest number of calls between two services of the same id */
+static int
+serve(gaspi_segment_id_t seg, gaspi_rank_t rank, gaspi_notification_id_t begin,
+      gaspi_number_t num, int fair, int *served)
+{
+  gaspi_notification_id_t id;
+  gaspi_notification_t val;
+  int last[NIDS];
+  int i, gap = 0;
+
+  for(i = 0; i < NIDS; i++)
+    {
+      last[i] = -1;
+      served[i] = 0;
+    }
+
+  for(i = 0; i < ROUNDS * (int) num; i++)
+    {
+      if(fair)
+	{
+	  ASSERT(gaspi_notify_waitsome_fair(seg, begin, num, &id, GASPI_TEST));
+	}
+      else
+	{
+	  ASSERT(gaspi_notify_waitsome(seg, begin, num, &id, GASPI_TEST));
+	}
+
+      assert(id >= begin && id < begin + num);
+
+      ASSERT(gaspi_notify_reset(seg, id, &val));
+      assert(val == 1);
+
+      if(last[id - begin] >= 0 && i - last[id - begin] > gap)
+	gap = i - last[id - begin];
+
+      last[id - begin] = i;
+      served[id - begin]++;
+
+      renotify(seg, rank, id);
+    }
+
+  /* ids never served count as a gap of the whole run */
+  for(i = 0; i < (int) num; i++)
+    {
+      if(last[i] < 0)
+	gap = ROUNDS * num;
+    }
+
+  return gap;
+}
+
+int main(int argc, char *argv[])
+{
+  gaspi_rank_t rank;
+  gaspi_notification_id_t id;
+  gaspi_notification_t val;
+  gaspi_segment_id_t seg;
+  int served[NIDS];
+  int i, gap;
+
+  TSUITE_INIT(argc, argv);
+
+  ASSERT(gaspi_proc_init(GASPI_BLOCK));
+  ASSERT(gaspi_proc_rank(&rank));
+
+  ASSERT(gaspi_segment_create(0, 4096, GASPI_GROUP_ALL, GASPI_BLOCK, GASPI_MEM_INITIALIZED));
+  ASSERT(gaspi_segment_create(1, 4096, GASPI_GROUP_ALL, GASPI_BLOCK,
+			      GASPI_MEM_INITIALIZED | GASPI_MEM_NOTIFY_SUMMARY));
+
+  for(seg = 0; seg < 2; seg++)
+    {
+      /* a range across summary blocks */
+      const gaspi_notification_id_t begin = 40;
+
+      for(i = 0; i < NIDS; i++)
+	{
+	  renotify(seg, rank, (gaspi_notification_id_t) (begin + i));
+	}
+
+      gap = serve(seg, rank, begin, NIDS, 0, served);
+      assert(served[0] == ROUNDS * NIDS);
+      assert(gap == ROUNDS * NIDS);
+
+      gap = serve(seg, rank, begin, NIDS, 1, served);
+      assert(gap == NIDS);
+      for(i = 0; i < NIDS; i++)
+	{
+	  assert(served[i] == ROUNDS);
+	}
+
+      /* a smaller range (the cursor may lie outside of it) */
+      gap = serve(seg, rank, begin + 10, 7, 1, served);
+      assert(gap == 7);
+
+      for(i = 0; i < NIDS; i++)
+	{
+	  ASSERT(gaspi_notify_reset(seg, (gaspi_notification_id_t) (begin + i), &val));
+	}
+
+      assert(gaspi_notify_waitsome_fair(seg, begin, NIDS, &id, GASPI_TEST) == GASPI_TIMEOUT);
+      assert(gaspi_notify_waitsome_fair(seg, begin, NIDS, &id, 1) == GASPI_TIMEOUT);
+    }
+
+  /* the round goes on from the last one served */
+  renotify(0, rank, 3);
+  renotify(0, rank, 100);
+  ASSERT(gaspi_notify_waitsome_fair(0, 0, 1000, &id, GASPI_BLOCK));
+  ASSERT(gaspi_notify_waitsome_fair(0, 0, 1000, &id, GASPI_BLOCK));
+  const gaspi_notification_id_t second = id;
+  ASSERT(gaspi_notify_waitsome_fair(0, 0, 1000, &id, GASPI_BLOCK));
+  assert(id != second);
+
+  ASSERT(gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+
+  ASSERT(gaspi_proc_term(GASPI_BLOCK));
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,130 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <GASPI_Ext.h>
+#include <test_utils.h>
+
+/* Bursts of notifications from the left neighbour harvested with
+   gaspi_notify_waitsome_multi in batches of several sizes, on segments
+   with and without notification summary: every notification must be
+   taken exactly once, with its value, and be reset */
+
+#define BURST 200
+#define ROUNDS 10
+
+static gaspi_notification_id_t
+notif_id(int i, int round)
+{
+  return (gaspi_notification_id_t) ((i * 311 + round * 17) % 65535);
+}
+
+int main(int argc, char *argv[])
+{
+  gaspi_rank_t rank, nprocs, to, from;
+  gaspi_notification_id_t ids[64], id;
+  gaspi_notification_t values[64];
+  gaspi_number_t count, qmax, qsize;
+  gaspi_segment_id_t seg;
+  int round, i, j;
+
+  const gaspi_number_t batches[] = { 1, 7, 64 };
+  static char got[65536];
+
+  TSUITE_INIT(argc, argv);
+
+  ASSERT(gaspi_proc_init(GASPI_BLOCK));
+
+  ASSERT(gaspi_proc_num(&nprocs));
+  ASSERT(gaspi_proc_rank(&rank));
+  ASSERT(gaspi_queue_size_max(&qmax));
+
+  to = (rank + 1) % nprocs;
+  from = (rank + nprocs - 1) % nprocs;
+
+  ASSERT(gaspi_segment_create(0, 4096, GASPI_GROUP_ALL, GASPI_BLOCK, GASPI_MEM_INITIALIZED));
+  ASSERT(gaspi_segment_create(1, 4096, GASPI_GROUP_ALL, GASPI_BLOCK,
+			      GASPI_MEM_INITIALIZED | GASPI_MEM_NOTIFY_SUMMARY));
+
+  /* nothing set */
+  assert(gaspi_notify_waitsome_multi(0, 0, 65535, ids, values, 64, &count, GASPI_TEST) == GASPI_TIMEOUT);
+  assert(count == 0);
+  assert(gaspi_notify_waitsome_multi(1, 0, 65535, ids, values, 64, &count, 1) == GASPI_TIMEOUT);
+
+  ASSERT(gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+
+  for(seg = 0; seg < 2; seg++)
+    {
+      for(round = 0; round < ROUNDS; round++)
+	{
+	  const gaspi_number_t batch = batches[round % 3];
+	  int taken = 0;
+
+	  for(i = 0; i < BURST; i++)
+	    {
+	      ASSERT(gaspi_queue_size(0, &qsize));
+	      if(qsize >= qmax - 2)
+		{
+		  ASSERT(gaspi_wait(0, GASPI_BLOCK));
+		}
+
+	      ASSERT(gaspi_notify(seg, to, notif_id(i, round), (gaspi_notification_t) (i + 1), 0, GASPI_BLOCK));
+	    }
+
+	  ASSERT(gaspi_wait(0, GASPI_BLOCK));
+
+	  for(i = 0; i < 65536; i++)
+	    got[i] = 0;
+
+	  while(taken < BURST)
+	    {
+	      ASSERT(gaspi_notify_waitsome_multi(seg, 0, 65535, ids, (round % 2) ? values : NULL,
+						 batch, &count, GASPI_BLOCK));
+	      assert(count >= 1 && count <= batch);
+
+	      for(j = 0; j < (int) count; j++)
+		{
+		  assert(j == 0 || ids[j] > ids[j - 1]);
+		  assert(!got[ids[j]]);
+		  got[ids[j]] = 1;
+
+		  if(round % 2)
+		    {
+		      for(i = 0; i < BURST && notif_id(i, round) != ids[j]; i++);
+		      assert(i < BURST);
+		      assert(values[j] == (gaspi_notification_t) (i + 1));
+		    }
+		}
+
+	      taken += count;
+	    }
+
+	  for(i = 0; i < BURST; i++)
+	    {
+	      assert(got[notif_id(i, round)]);
+	    }
+
+	  /* all of them were reset */
+	  assert(gaspi_notify_waitsome(seg, 0, 65535, &id, GASPI_TEST) == GASPI_TIMEOUT);
+
+	  ASSERT(gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+	}
+    }
+
+  /* limited to the range */
+  ASSERT(gaspi_notify(0, rank, 10, 1, 0, GASPI_BLOCK));
+  ASSERT(gaspi_notify(0, rank, 20, 2, 0, GASPI_BLOCK));
+  ASSERT(gaspi_wait(0, GASPI_BLOCK));
+  ASSERT(gaspi_notify_waitsome(0, 20, 1, &id, GASPI_BLOCK));
+
+  ASSERT(gaspi_notify_waitsome_multi(0, 11, 100, ids, values, 64, &count, GASPI_BLOCK));
+  assert(count == 1 && ids[0] == 20 && values[0] == 2);
+
+  ASSERT(gaspi_notify_waitsome_multi(0, 0, 65535, ids, values, 64, &count, GASPI_TEST));
+  assert(count == 1 && ids[0] == 10 && values[0] == 1);
+
+  ASSERT(gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+
+  ASSERT(gaspi_proc_term(GASPI_BLOCK));
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,108 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <GASPI.h>
+#include <test_utils.h>
+
+/* Waitsome over windows of many sizes and alignments around a few set
+   notifications must find the first one set in the window (the block
+   scan and the scalar head and tail of it) */
+
+static const gaspi_notification_id_t set_ids[] =
+  { 0, 1, 31, 32, 63, 64, 100, 1000, 4095, 4096, 20000, 40001, 65534, 65535 };
+
+#define NSET (sizeof(set_ids) / sizeof(set_ids[0]))
+
+static long
+expected(unsigned int begin, unsigned int num)
+{
+  unsigned int i;
+  long first = -1;
+
+  for(i = 0; i < NSET; i++)
+    {
+      if(set_ids[i] >= begin && set_ids[i] < begin + num && (first < 0 || set_ids[i] < first))
+	first = set_ids[i];
+    }
+
+  return first;
+}
+
+static void
+check(unsigned int begin, unsigned int num)
+{
+  gaspi_notification_id_t id;
+  const long first = expected(begin, num);
+
+  gaspi_return_t ret = gaspi_notify_waitsome(0, (gaspi_notification_id_t) begin, num, &id, GASPI_TEST);
+
+  if(first < 0)
+    {
+      assert(ret == GASPI_TIMEOUT);
+
+      ret = gaspi_notify_waitsome(0, (gaspi_notification_id_t) begin, num, &id, 1);
+      assert(ret == GASPI_TIMEOUT);
+    }
+  else
+    {
+      assert(ret == GASPI_SUCCESS);
+      if(id != first)
+	{
+	  gaspi_printf("window %u + %u: expected %ld got %u\n", begin, num, first, id);
+	  exit(EXIT_FAILURE);
+	}
+
+      ASSERT(gaspi_notify_waitsome(0, (gaspi_notification_id_t) begin, num, &id, GASPI_BLOCK));
+      assert(id == first);
+
+      ASSERT(gaspi_notify_waitsome(0, (gaspi_notification_id_t) begin, num, &id, 1000));
+      assert(id == first);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+  gaspi_notification_id_t id;
+  gaspi_rank_t r;
+  unsigned int i, b, n;
+
+  const unsigned int begins[] = { 0, 1, 2, 3, 17, 31, 33, 63, 65, 101, 999, 1001, 4000, 4097, 20000, 40000, 65500 };
+  const unsigned int nums[] = { 1, 2, 7, 15, 16, 31, 33, 64, 65, 127, 129, 1000, 5000, 30000, 65535 };
+
+  TSUITE_INIT(argc, argv);
+
+  ASSERT(gaspi_proc_init(GASPI_BLOCK));
+  ASSERT(gaspi_proc_rank(&r));
+
+  ASSERT(gaspi_segment_create(0, 1, GASPI_GROUP_ALL, GASPI_BLOCK, GASPI_ALLOC_DEFAULT));
+
+  for(i = 0; i < NSET; i++)
+    {
+      ASSERT(gaspi_notify(0, r, set_ids[i], i + 1, 0, GASPI_BLOCK));
+    }
+
+  ASSERT(gaspi_wait(0, GASPI_BLOCK));
+
+  for(i = 0; i < NSET; i++)
+    {
+      ASSERT(gaspi_notify_waitsome(0, set_ids[i], 1, &id, GASPI_BLOCK));
+    }
+
+  for(b = 0; b < sizeof(begins) / sizeof(begins[0]); b++)
+    {
+      for(n = 0; n < sizeof(nums) / sizeof(nums[0]); n++)
+	{
+	  const unsigned int num = (begins[b] + nums[n] > 65536) ? 65536 - begins[b] : nums[n];
+	  check(begins[b], num);
+	}
+    }
+
+  /* nothing set in a large window */
+  check(41000, 20000);
+
+  ASSERT(gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+
+  ASSERT(gaspi_proc_term(GASPI_BLOCK));
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,161 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <GASPI_Ext.h>
+#include <test_utils.h>
+
+/* Sparse notifications (notify, write_notify and write_list_notify)
+   into a segment with a notification summary, found by waitany and by
+   waitsome over windows of all sizes, for several rounds in which the
+   summary flags are cleared and set again */
+
+#define ROUNDS 20
+#define NIDS 4
+
+static gaspi_notification_id_t
+notif_id(gaspi_rank_t r, int round, int k)
+{
+  const unsigned int ids[NIDS] = { 5, 4000, 32768, 65535 };
+
+  /* a different block every round, the last id of the space included */
+  if(k == 0)
+    return (gaspi_notification_id_t) (ids[k] + 64 * round + r);
+
+  return (gaspi_notification_id_t) (ids[k] - 64 * round - r);
+}
+
+static void
+receive(gaspi_segment_id_t seg, gaspi_rank_t from, int round, int use_waitany)
+{
+  gaspi_notification_id_t id;
+  gaspi_notification_t val;
+  int got[NIDS] = { 0 };
+  int n = 0, k;
+
+  while(n < NIDS)
+    {
+      if(use_waitany)
+	{
+	  ASSERT(gaspi_notify_waitany(seg, &id, GASPI_BLOCK));
+	}
+      /* waitsome does not reach the last id */
+      else if(n == NIDS - 1 && !got[NIDS - 1] && notif_id(from, round, NIDS - 1) == 65535)
+	{
+	  ASSERT(gaspi_notify_waitsome(seg, 65535, 1, &id, GASPI_BLOCK));
+	}
+      else
+	{
+	  ASSERT(gaspi_notify_waitsome(seg, 0, 65535, &id, GASPI_BLOCK));
+	}
+
+      ASSERT(gaspi_notify_reset(seg, id, &val));
+
+      for(k = 0; k < NIDS; k++)
+	{
+	  if(id == notif_id(from, round, k) && !got[k])
+	    {
+	      assert(val == (gaspi_notification_t) (round + k + 1));
+	      got[k] = 1;
+	      n++;
+	      break;
+	    }
+	}
+
+      if(k == NIDS)
+	{
+	  gaspi_printf("Unexpected notification %u (round %d)\n", id, round);
+	  exit(EXIT_FAILURE);
+	}
+    }
+
+  /* all consumed */
+  assert(gaspi_notify_waitany(seg, &id, GASPI_TEST) == GASPI_TIMEOUT);
+  assert(gaspi_notify_waitsome(seg, 0, 65535, &id, GASPI_TEST) == GASPI_TIMEOUT);
+}
+
+int main(int argc, char *argv[])
+{
+  gaspi_rank_t rank, nprocs, to, from;
+  gaspi_notification_id_t id;
+  gaspi_notification_t val;
+  gaspi_segment_id_t seg;
+  int round, k;
+
+  TSUITE_INIT(argc, argv);
+
+  ASSERT(gaspi_proc_init(GASPI_BLOCK));
+
+  ASSERT(gaspi_proc_num(&nprocs));
+  ASSERT(gaspi_proc_rank(&rank));
+
+  to = (rank + 1) % nprocs;
+  from = (rank + nprocs - 1) % nprocs;
+
+  /* with and without summary */
+  ASSERT(gaspi_segment_create(0, 4096, GASPI_GROUP_ALL, GASPI_BLOCK,
+			      GASPI_MEM_INITIALIZED | GASPI_MEM_NOTIFY_SUMMARY));
+  ASSERT(gaspi_segment_create(1, 4096, GASPI_GROUP_ALL, GASPI_BLOCK, GASPI_MEM_INITIALIZED));
+
+  for(seg = 0; seg < 2; seg++)
+    {
+      for(round = 0; round < ROUNDS; round++)
+	{
+	  for(k = 0; k < NIDS; k++)
+	    {
+	      const gaspi_notification_id_t n = notif_id(rank, round, k);
+	      const gaspi_notification_t v = (gaspi_notification_t) (round + k + 1);
+
+	      if(k % 3 == 0)
+		{
+		  ASSERT(gaspi_notify(seg, to, n, v, 0, GASPI_BLOCK));
+		}
+	      else if(k % 3 == 1)
+		{
+		  ASSERT(gaspi_write_notify(seg, 0, to, seg, 64, 8, n, v, 0, GASPI_BLOCK));
+		}
+	      else
+		{
+		  gaspi_segment_id_t segs[2] = { seg, seg };
+		  gaspi_offset_t offs[2] = { 0, 8 };
+		  gaspi_offset_t offs_rem[2] = { 128, 256 };
+		  gaspi_size_t sizes[2] = { 8, 8 };
+
+		  ASSERT(gaspi_write_list_notify(2, segs, offs, to, segs, offs_rem, sizes,
+						 seg, n, v, 0, GASPI_BLOCK));
+		}
+	    }
+
+	  ASSERT(gaspi_wait(0, GASPI_BLOCK));
+
+	  receive(seg, from, round, round % 2);
+
+	  ASSERT(gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+	}
+    }
+
+  /* a set notification in a block only partly in the window */
+  ASSERT(gaspi_notify(0, rank, 70, 1, 0, GASPI_BLOCK));
+  ASSERT(gaspi_wait(0, GASPI_BLOCK));
+  ASSERT(gaspi_notify_waitsome(0, 70, 1, &id, GASPI_BLOCK));
+
+  assert(gaspi_notify_waitsome(0, 0, 70, &id, GASPI_TEST) == GASPI_TIMEOUT);
+  assert(gaspi_notify_waitsome(0, 71, 1000, &id, GASPI_TEST) == GASPI_TIMEOUT);
+
+  ASSERT(gaspi_notify_waitsome(0, 65, 6, &id, GASPI_TEST));
+  assert(id == 70);
+  ASSERT(gaspi_notify_waitsome(0, 0, 1000, &id, GASPI_TEST));
+  assert(id == 70);
+  ASSERT(gaspi_notify_waitany(0, &id, GASPI_TEST));
+  assert(id == 70);
+
+  ASSERT(gaspi_notify_reset(0, 70, &val));
+  assert(val == 1);
+
+  assert(gaspi_notify_waitany(0, &id, 1) == GASPI_TIMEOUT);
+
+  ASSERT(gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+
+  ASSERT(gaspi_proc_term(GASPI_BLOCK));
+
+  return EXIT_SUCCESS;
+}
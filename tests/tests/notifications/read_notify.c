@@ -0,0 +1,120 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <GASPI_Ext.h>
+#include <test_utils.h>
+
+/* Reads from the right neighbour (and from the rank itself), each
+   setting its own local notification: every read is consumed as its
+   notification shows up, before the queue is waited on. Also with a
+   list of reads and into a segment with a notification summary. */
+
+#define NREADS 8
+#define CHUNK (1 << 17)
+
+int main(int argc, char *argv[])
+{
+  gaspi_rank_t rank, nprocs;
+  gaspi_notification_id_t id;
+  gaspi_notification_t val;
+  gaspi_segment_id_t seg;
+  gaspi_pointer_t ptr;
+  int n, i;
+
+  TSUITE_INIT(argc, argv);
+
+  ASSERT(gaspi_proc_init(GASPI_BLOCK));
+  ASSERT(gaspi_proc_rank(&rank));
+  ASSERT(gaspi_proc_num(&nprocs));
+
+  const gaspi_size_t size = 2 * NREADS * CHUNK;
+
+  ASSERT(gaspi_segment_create(0, size, GASPI_GROUP_ALL, GASPI_BLOCK, GASPI_MEM_INITIALIZED));
+  ASSERT(gaspi_segment_create(1, size, GASPI_GROUP_ALL, GASPI_BLOCK,
+			      GASPI_MEM_INITIALIZED | GASPI_MEM_NOTIFY_SUMMARY));
+
+  const gaspi_rank_t right = (rank + 1) % nprocs;
+
+  for(seg = 0; seg < 2; seg++)
+    {
+      ASSERT(gaspi_segment_ptr(seg, &ptr));
+      unsigned char *data = (unsigned char *) ptr;
+
+      /* the first half is read by the left neighbour into its second half */
+      for(i = 0; i < NREADS * CHUNK; i++)
+	{
+	  data[i] = (unsigned char) (i / CHUNK + rank * 7 + seg);
+	}
+
+      ASSERT(gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+
+      for(n = 0; n < NREADS; n++)
+	{
+	  const gaspi_offset_t off = (gaspi_offset_t) n * CHUNK;
+
+	  ASSERT(gaspi_read_notify(seg, NREADS * CHUNK + off, right, seg, off, CHUNK,
+				   (gaspi_notification_id_t) (100 + n), 0, GASPI_BLOCK));
+	}
+
+      /* consumed as they land, without waiting on the queue */
+      for(n = 0; n < NREADS; n++)
+	{
+	  ASSERT(gaspi_notify_waitsome(seg, 100, NREADS, &id, GASPI_BLOCK));
+	  ASSERT(gaspi_notify_reset(seg, id, &val));
+	  assert(val == 1);
+
+	  const int k = id - 100;
+	  for(i = 0; i < CHUNK; i++)
+	    {
+	      assert(data[NREADS * CHUNK + k * CHUNK + i] == (unsigned char) (k + right * 7 + seg));
+	    }
+	}
+
+      assert(gaspi_notify_waitsome(seg, 0, 1000, &id, GASPI_TEST) == GASPI_TIMEOUT);
+
+      ASSERT(gaspi_wait(0, GASPI_BLOCK));
+
+      /* a list of reads, the second from the rank itself */
+      {
+	gaspi_segment_id_t seg_local[2] = { seg, seg };
+	gaspi_segment_id_t seg_remote[2] = { seg, seg };
+	gaspi_offset_t off_local[2] = { NREADS * CHUNK, NREADS * CHUNK + CHUNK };
+	gaspi_offset_t off_remote[2] = { 3 * CHUNK, 5 * CHUNK };
+	gaspi_size_t sizes[2] = { CHUNK, CHUNK };
+
+	ASSERT(gaspi_read_list_notify(2, seg_local, off_local, right, seg_remote, off_remote, sizes,
+				      seg, 7, 0, GASPI_BLOCK));
+	ASSERT(gaspi_read_notify(seg, NREADS * CHUNK + 2 * CHUNK, rank, seg, 6 * CHUNK, CHUNK,
+				 8, 0, GASPI_BLOCK));
+
+	ASSERT(gaspi_notify_waitsome(seg, 7, 1, &id, GASPI_BLOCK));
+	ASSERT(gaspi_notify_reset(seg, id, &val));
+	assert(val == 1);
+
+	for(i = 0; i < CHUNK; i++)
+	  {
+	    assert(data[NREADS * CHUNK + i] == (unsigned char) (3 + right * 7 + seg));
+	    assert(data[NREADS * CHUNK + CHUNK + i] == (unsigned char) (5 + right * 7 + seg));
+	  }
+
+	ASSERT(gaspi_notify_waitsome(seg, 8, 1, &id, GASPI_BLOCK));
+	ASSERT(gaspi_notify_reset(seg, id, &val));
+	assert(val == 1);
+
+	for(i = 0; i < CHUNK; i++)
+	  {
+	    assert(data[NREADS * CHUNK + 2 * CHUNK + i] == (unsigned char) (6 + rank * 7 + seg));
+	  }
+
+	EXPECT_FAIL(gaspi_read_list_notify(0, seg_local, off_local, right, seg_remote, off_remote, sizes,
+					   seg, 7, 0, GASPI_BLOCK));
+      }
+
+      ASSERT(gaspi_wait(0, GASPI_BLOCK));
+      ASSERT(gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+    }
+
+  ASSERT(gaspi_proc_term(GASPI_BLOCK));
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,194 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <GASPI_Ext.h>
+#include <test_utils.h>
+
+/* Writes with notification fused into one request (notify_mode
+   GASPI_NOTIFY_FUSED), to the right neighbour and to the rank itself,
+   into segments with and without a notification summary: the data is
+   in place once the notification shows up. Also with a list of
+   writes notifying into another segment, and with a value too large
+   for an immediate. Last, many more writes than the queue holds to a
+   rank that only sits in a barrier, then reads its notifications
+   without waiting. */
+
+#define CHUNK (1 << 16)
+#define NWRITES 4
+
+static void
+check_chunk(unsigned char *data, int chunk, unsigned char base)
+{
+  int i;
+
+  for(i = 0; i < CHUNK; i++)
+    {
+      assert(data[chunk * CHUNK + i] == (unsigned char) (base + chunk));
+    }
+}
+
+int main(int argc, char *argv[])
+{
+  gaspi_config_t conf;
+  gaspi_rank_t rank, nprocs;
+  gaspi_notification_id_t id;
+  gaspi_notification_t val;
+  gaspi_number_t qsize;
+  gaspi_segment_id_t seg;
+  gaspi_pointer_t ptr;
+  int n, i;
+
+  TSUITE_INIT(argc, argv);
+
+  ASSERT(gaspi_config_get(&conf));
+  conf.notify_mode = GASPI_NOTIFY_FUSED;
+  ASSERT(gaspi_config_set(conf));
+
+  ASSERT(gaspi_proc_init(GASPI_BLOCK));
+  ASSERT(gaspi_proc_rank(&rank));
+  ASSERT(gaspi_proc_num(&nprocs));
+
+  const gaspi_size_t size = 2 * NWRITES * CHUNK;
+
+  ASSERT(gaspi_segment_create(0, size, GASPI_GROUP_ALL, GASPI_BLOCK, GASPI_MEM_INITIALIZED));
+  ASSERT(gaspi_segment_create(1, size, GASPI_GROUP_ALL, GASPI_BLOCK, GASPI_MEM_INITIALIZED));
+  ASSERT(gaspi_segment_create(2, size, GASPI_GROUP_ALL, GASPI_BLOCK,
+			      GASPI_MEM_INITIALIZED | GASPI_MEM_NOTIFY_SUMMARY));
+
+  ASSERT(gaspi_segment_ptr(0, &ptr));
+  unsigned char *src = (unsigned char *) ptr;
+
+  for(i = 0; i < (int) size; i++)
+    {
+      src[i] = (unsigned char) (i / CHUNK + rank * 16);
+    }
+
+  const gaspi_rank_t right = (rank + 1) % nprocs;
+  const gaspi_rank_t left = (rank + nprocs - 1) % nprocs;
+
+  for(seg = 1; seg < 3; seg++)
+    {
+      ASSERT(gaspi_segment_ptr(seg, &ptr));
+      unsigned char *dst = (unsigned char *) ptr;
+
+      ASSERT(gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+
+      /* one request each: the first half to the right, the second
+	 half to the rank itself */
+      for(n = 0; n < NWRITES; n++)
+	{
+	  const gaspi_offset_t off = (gaspi_offset_t) n * CHUNK;
+
+	  ASSERT(gaspi_write_notify(0, off, right, seg, off, CHUNK,
+				    (gaspi_notification_id_t) (1000 + n), n + 1, 0, GASPI_BLOCK));
+	  ASSERT(gaspi_queue_size(0, &qsize));
+	  assert(qsize == (gaspi_number_t) (2 * n + 1));
+
+	  ASSERT(gaspi_write_notify(0, off, rank, seg, NWRITES * CHUNK + off, CHUNK,
+				    (gaspi_notification_id_t) (2000 + n), n + 1, 0, GASPI_BLOCK));
+	}
+
+      for(n = 0; n < NWRITES; n++)
+	{
+	  ASSERT(gaspi_notify_waitsome(seg, 1000, NWRITES, &id, GASPI_BLOCK));
+	  ASSERT(gaspi_notify_reset(seg, id, &val));
+	  assert(val == (gaspi_notification_t) (id - 1000 + 1));
+	  check_chunk(dst, id - 1000, (unsigned char) (left * 16));
+	}
+
+      for(n = 0; n < NWRITES; n++)
+	{
+	  ASSERT(gaspi_notify_waitsome(seg, (gaspi_notification_id_t) (2000 + n), 1, &id, GASPI_BLOCK));
+	  ASSERT(gaspi_notify_reset(seg, id, &val));
+	  assert(val == (gaspi_notification_t) (n + 1));
+	  check_chunk(dst + NWRITES * CHUNK, n, (unsigned char) (rank * 16));
+	}
+
+      ASSERT(gaspi_wait(0, GASPI_BLOCK));
+      ASSERT(gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+    }
+
+  /* a list into segment 1, notified in segment 2, with a value too
+     large for an immediate and with a small one */
+  {
+    gaspi_segment_id_t seg_local[NWRITES], seg_remote[NWRITES];
+    gaspi_offset_t off_local[NWRITES], off_remote[NWRITES];
+    gaspi_size_t sizes[NWRITES];
+    const gaspi_notification_t values[2] = { 100000, 7 };
+    int v;
+
+    ASSERT(gaspi_segment_ptr(1, &ptr));
+    unsigned char *dst = (unsigned char *) ptr;
+
+    for(n = 0; n < NWRITES; n++)
+      {
+	seg_local[n] = 0;
+	seg_remote[n] = 1;
+	off_local[n] = (gaspi_offset_t) (NWRITES + n) * CHUNK;
+	off_remote[n] = (gaspi_offset_t) n * CHUNK;
+	sizes[n] = CHUNK;
+      }
+
+    for(v = 0; v < 2; v++)
+      {
+	ASSERT(gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+
+	ASSERT(gaspi_write_list_notify(NWRITES, seg_local, off_local, right,
+				       seg_remote, off_remote, sizes,
+				       2, 3333, values[v], 0, GASPI_BLOCK));
+
+	ASSERT(gaspi_notify_waitsome(2, 3000, 1000, &id, GASPI_BLOCK));
+	assert(id == 3333);
+	ASSERT(gaspi_notify_reset(2, id, &val));
+	assert(val == values[v]);
+
+	for(n = 0; n < NWRITES; n++)
+	  {
+	    check_chunk(dst, n, (unsigned char) (left * 16 + NWRITES));
+	  }
+
+	memset(dst, 0, NWRITES * CHUNK);
+
+	ASSERT(gaspi_wait(0, GASPI_BLOCK));
+      }
+  }
+
+  ASSERT(gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+
+  /* the last value of each of NIDS notifications is rounds */
+  {
+    const int nids = 16, rounds = 64;
+    gaspi_number_t qmax;
+
+    ASSERT(gaspi_queue_size_max(&qmax));
+
+    for(n = 0; n < nids * rounds; n++)
+      {
+	ASSERT(gaspi_queue_size(0, &qsize));
+	if(qsize >= qmax)
+	  {
+	    ASSERT(gaspi_wait(0, GASPI_BLOCK));
+	  }
+
+	ASSERT(gaspi_write_notify(0, 0, right, 1, 0, sizeof(int),
+				  (gaspi_notification_id_t) (5000 + n % nids),
+				  n / nids + 1, 0, GASPI_BLOCK));
+      }
+
+    ASSERT(gaspi_wait(0, GASPI_BLOCK));
+    ASSERT(gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+
+    for(n = 0; n < nids; n++)
+      {
+	ASSERT(gaspi_notify_reset(1, (gaspi_notification_id_t) (5000 + n), &val));
+	assert(val == (gaspi_notification_t) rounds);
+      }
+  }
+
+  ASSERT(gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+
+  ASSERT(gaspi_proc_term(GASPI_BLOCK));
+
+  return EXIT_SUCCESS;
+}
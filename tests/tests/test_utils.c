@@ -31,7 +31,12 @@ static gaspi_config_t tsuite_default_config =
     ((1ul<<16ul)-1ul),	  //passive_transfer_size_max
     278592,		  //allreduce_buf_size
     255,		  //allreduce_elem_max
-    GASPI_TOPOLOGY_STATIC //build_infrastructure
+    GASPI_TOPOLOGY_STATIC, //build_infrastructure
+    GASPI_WAIT_SPIN,	  //wait_policy
+    50,			  //wait_spin_us
+    GASPI_QUEUE_FULL_ERROR, //queue_full_policy
+    1,			  //netdev_num
+    GASPI_NOTIFY_SEPARATE //notify_mode
   };
 
 void tsuite_do_backtrace(int id, gaspi_rank_t node, FILE * bt_file)
@@ -112,6 +117,13 @@ void tsuite_init(int argc, char *argv[])
 	    tsuite_default_config.build_infrastructure = GASPI_TOPOLOGY_STATIC;
 	  if(strcmp(argv[i], "DYNAMIC_TOPO") == 0)
 	    tsuite_default_config.build_infrastructure = GASPI_TOPOLOGY_DYNAMIC;
+	  if(strcmp(argv[i], "WAIT_ADAPTIVE") == 0)
+	    tsuite_default_config.wait_policy = GASPI_WAIT_ADAPTIVE;
+	  if(strcmp(argv[i], "RAILS2") == 0)
+	    tsuite_default_config.netdev_num = 2;
+
+	  if(strcmp(argv[i], "NOTIFY_FUSED") == 0)
+	    tsuite_default_config.notify_mode = GASPI_NOTIFY_FUSED;
 
 	}
       ASSERT(gaspi_config_set(tsuite_default_config));
@@ -0,0 +1,170 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <GASPI_Ext.h>
+#include <test_utils.h>
+
+/* Endpoints get queues of their own until all queues exist, then
+   share them evenly; the queues of deleted endpoints are reused and
+   threads communicate through their endpoints */
+
+#define NEP 24
+#define NTHREADS 4
+#define ROUNDS 100
+#define SLOT 64
+
+static gaspi_rank_t rank, nprocs;
+static gaspi_endpoint_t eps[NEP];
+
+static void *
+poster(void *arg)
+{
+  const int t = (int) (long) arg;
+  const gaspi_rank_t right = (rank + 1) % nprocs;
+  gaspi_queue_id_t q;
+  int r;
+
+  ASSERT(gaspi_endpoint_queue(eps[t], &q, NULL));
+
+  for(r = 0; r < ROUNDS; r++)
+    {
+      const gaspi_offset_t off = (gaspi_offset_t) (t * ROUNDS + r) * SLOT;
+      const gaspi_notification_id_t id = (gaspi_notification_id_t) (t * ROUNDS + r);
+
+      ASSERT(gaspi_write_notify(0, off, right, 1, off, SLOT, id, 1, q, GASPI_BLOCK));
+
+      if(r % 16 == 15)
+	{
+	  ASSERT(gaspi_endpoint_wait(eps[t], GASPI_BLOCK));
+	}
+    }
+
+  ASSERT(gaspi_endpoint_wait(eps[t], GASPI_BLOCK));
+
+  return NULL;
+}
+
+int main(int argc, char *argv[])
+{
+  pthread_t threads[NTHREADS];
+  gaspi_number_t qnum, qinit, qmax, shared;
+  gaspi_notification_id_t id;
+  gaspi_notification_t val;
+  gaspi_queue_id_t q;
+  gaspi_pointer_t ptr;
+  int bound[16] = { 0 };
+  int t, i;
+
+  TSUITE_INIT(argc, argv);
+
+  ASSERT(gaspi_proc_init(GASPI_BLOCK));
+  ASSERT(gaspi_proc_rank(&rank));
+  ASSERT(gaspi_proc_num(&nprocs));
+
+  ASSERT(gaspi_queue_num(&qinit));
+  ASSERT(gaspi_queue_max(&qmax));
+  assert(qmax <= 16);
+
+  /* own queues first, then shared evenly */
+  for(i = 0; i < NEP; i++)
+    {
+      ASSERT(gaspi_endpoint_create(&eps[i], GASPI_BLOCK));
+      ASSERT(gaspi_endpoint_queue(eps[i], &q, &shared));
+      assert(q >= qinit && q < qmax);
+
+      if(i < (int) (qmax - qinit))
+	{
+	  assert(shared == 0);
+	  assert(bound[q] == 0);
+	}
+
+      bound[q]++;
+    }
+
+  ASSERT(gaspi_queue_num(&qnum));
+  assert(qnum == qmax);
+
+  for(i = qinit; i < (int) qmax; i++)
+    {
+      assert(bound[i] >= NEP / (int) (qmax - qinit));
+      assert(bound[i] <= (NEP + (int) (qmax - qinit) - 1) / (int) (qmax - qinit));
+    }
+
+  for(i = 0; i < NEP; i++)
+    {
+      ASSERT(gaspi_endpoint_delete(eps[i]));
+    }
+
+  EXPECT_FAIL(gaspi_endpoint_delete(eps[0]));
+
+  /* the queues are reused */
+  for(t = 0; t < NTHREADS; t++)
+    {
+      ASSERT(gaspi_endpoint_create(&eps[t], GASPI_BLOCK));
+      ASSERT(gaspi_endpoint_queue(eps[t], &q, &shared));
+      assert(shared == 0);
+    }
+
+  ASSERT(gaspi_queue_num(&qnum));
+  assert(qnum == qmax);
+
+  const gaspi_size_t size = NTHREADS * ROUNDS * SLOT;
+
+  ASSERT(gaspi_segment_create(0, size, GASPI_GROUP_ALL, GASPI_BLOCK, GASPI_MEM_INITIALIZED));
+  ASSERT(gaspi_segment_create(1, size, GASPI_GROUP_ALL, GASPI_BLOCK, GASPI_MEM_INITIALIZED));
+
+  ASSERT(gaspi_segment_ptr(0, &ptr));
+  unsigned char *src = (unsigned char *) ptr;
+  for(i = 0; i < (int) size; i++)
+    {
+      src[i] = (unsigned char) (i / SLOT + rank);
+    }
+
+  ASSERT(gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+
+  for(t = 0; t < NTHREADS; t++)
+    {
+      assert(pthread_create(&threads[t], NULL, poster, (void *) (long) t) == 0);
+    }
+
+  for(t = 0; t < NTHREADS; t++)
+    {
+      assert(pthread_join(threads[t], NULL) == 0);
+    }
+
+  const gaspi_rank_t left = (rank + nprocs - 1) % nprocs;
+
+  for(i = 0; i < NTHREADS * ROUNDS; i++)
+    {
+      ASSERT(gaspi_notify_waitsome(1, (gaspi_notification_id_t) i, 1, &id, GASPI_BLOCK));
+      ASSERT(gaspi_notify_reset(1, id, &val));
+      assert(val == 1);
+    }
+
+  ASSERT(gaspi_segment_ptr(1, &ptr));
+  unsigned char *dst = (unsigned char *) ptr;
+  for(i = 0; i < (int) size; i++)
+    {
+      assert(dst[i] == (unsigned char) (i / SLOT + left));
+    }
+
+  /* a queue is only deleted once no endpoint uses it */
+  ASSERT(gaspi_endpoint_queue(eps[0], &q, &shared));
+  assert(gaspi_queue_delete(q) == GASPI_ERR_INV_QUEUE);
+
+  for(t = 0; t < NTHREADS; t++)
+    {
+      ASSERT(gaspi_endpoint_delete(eps[t]));
+    }
+
+  ASSERT(gaspi_queue_delete(qmax - 1));
+  ASSERT(gaspi_queue_num(&qnum));
+  assert(qnum == qmax - 1);
+
+  ASSERT(gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+
+  ASSERT(gaspi_proc_term(GASPI_BLOCK));
+
+  return EXIT_SUCCESS;
+}
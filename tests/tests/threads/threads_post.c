@@ -0,0 +1,126 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <test_utils.h>
+
+/* Several threads post to the same queue at once (and wait on it):
+   every request is accounted for and a full queue rejects requests
+   without breaking it */
+
+#define NTHREADS 4
+#define ROUNDS 200
+#define SLOT 64
+
+static gaspi_rank_t rank, nprocs;
+
+static void *
+poster(void *arg)
+{
+  const int t = (int) (long) arg;
+  const gaspi_rank_t right = (rank + 1) % nprocs;
+  int r;
+
+  for(r = 0; r < ROUNDS; r++)
+    {
+      const gaspi_offset_t off = (gaspi_offset_t) (t * ROUNDS + r) * SLOT;
+      const gaspi_notification_id_t id = (gaspi_notification_id_t) (t * ROUNDS + r);
+
+      ASSERT(gaspi_write_notify(0, off, right, 1, off, SLOT, id, 1, 0, GASPI_BLOCK));
+
+      if(r % 16 == 15)
+	{
+	  ASSERT(gaspi_wait(0, GASPI_BLOCK));
+	}
+    }
+
+  ASSERT(gaspi_wait(0, GASPI_BLOCK));
+
+  return NULL;
+}
+
+int main(int argc, char *argv[])
+{
+  pthread_t threads[NTHREADS];
+  gaspi_number_t qsize, qmax;
+  gaspi_notification_id_t id;
+  gaspi_notification_t val;
+  gaspi_pointer_t ptr;
+  int t, i;
+
+  TSUITE_INIT(argc, argv);
+
+  ASSERT(gaspi_proc_init(GASPI_BLOCK));
+  ASSERT(gaspi_proc_rank(&rank));
+  ASSERT(gaspi_proc_num(&nprocs));
+
+  const gaspi_size_t size = NTHREADS * ROUNDS * SLOT;
+
+  ASSERT(gaspi_segment_create(0, size, GASPI_GROUP_ALL, GASPI_BLOCK, GASPI_MEM_INITIALIZED));
+  ASSERT(gaspi_segment_create(1, size, GASPI_GROUP_ALL, GASPI_BLOCK, GASPI_MEM_INITIALIZED));
+
+  ASSERT(gaspi_segment_ptr(0, &ptr));
+  unsigned char *src = (unsigned char *) ptr;
+  for(i = 0; i < (int) size; i++)
+    {
+      src[i] = (unsigned char) (i / SLOT + rank);
+    }
+
+  ASSERT(gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+
+  for(t = 0; t < NTHREADS; t++)
+    {
+      assert(pthread_create(&threads[t], NULL, poster, (void *) (long) t) == 0);
+    }
+
+  for(t = 0; t < NTHREADS; t++)
+    {
+      assert(pthread_join(threads[t], NULL) == 0);
+    }
+
+  ASSERT(gaspi_queue_size(0, &qsize));
+  assert(qsize == 0);
+
+  /* everything from the left neighbour arrived */
+  const gaspi_rank_t left = (rank + nprocs - 1) % nprocs;
+
+  for(i = 0; i < NTHREADS * ROUNDS; i++)
+    {
+      ASSERT(gaspi_notify_waitsome(1, (gaspi_notification_id_t) i, 1, &id, GASPI_BLOCK));
+      ASSERT(gaspi_notify_reset(1, id, &val));
+      assert(val == 1);
+    }
+
+  ASSERT(gaspi_segment_ptr(1, &ptr));
+  unsigned char *dst = (unsigned char *) ptr;
+  for(i = 0; i < (int) size; i++)
+    {
+      assert(dst[i] == (unsigned char) (i / SLOT + left));
+    }
+
+  /* a full queue */
+  ASSERT(gaspi_queue_size_max(&qmax));
+
+  for(i = 0; i < (int) qmax; i++)
+    {
+      ASSERT(gaspi_write(0, 0, rank, 1, 0, 8, 1, GASPI_BLOCK));
+    }
+
+  assert(gaspi_write(0, 0, rank, 1, 0, 8, 1, GASPI_BLOCK) == GASPI_ERR_MANY_Q_REQS);
+
+  ASSERT(gaspi_queue_size(1, &qsize));
+  assert(qsize == qmax);
+
+  ASSERT(gaspi_wait(1, GASPI_BLOCK));
+  ASSERT(gaspi_queue_size(1, &qsize));
+  assert(qsize == 0);
+
+  ASSERT(gaspi_write(0, 0, rank, 1, 0, 8, 1, GASPI_BLOCK));
+  ASSERT(gaspi_wait(1, GASPI_BLOCK));
+
+  ASSERT(gaspi_barrier(GASPI_GROUP_ALL, GASPI_BLOCK));
+
+  ASSERT(gaspi_proc_term(GASPI_BLOCK));
+
+  return EXIT_SUCCESS;
+}